@@ -0,0 +1,141 @@
+/*
+ * Alarm latency under saturating telemetry load
+ *
+ * TELEMETRY subscriptions are kept permanently ready (republished every
+ * round) and each callback burns TELEMETRY_COST_MS. One of them raises an
+ * alarm every ALARM_EVERY telemetry callbacks, i.e. in the middle of a spin,
+ * carrying its publish time. The alarm subscription was added first, so an
+ * in-order spin only reaches it on the next spin. Reports alarm latency per
+ * scheduling policy, plus deadline misses and budget overruns:
+ * - in-order:       rclc default, for comparison
+ * - fixed-priority: alarm priority 10, telemetry 0
+ * - EDF:            alarm deadline ALARM_DEADLINE_MS, telemetry TELEMETRY_DEADLINE_MS
+ * Under both policies the alarm must never wait for more than one telemetry
+ * callback, and the telemetry budget (below its cost) must flag every call.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/alarm_latency.cpp -o alarm_latency.js
+ * Run:            node alarm_latency.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "rcl_port_wasm.cpp"
+#include "rclc_port_wasm.cpp"
+#include "rosidl_typesupport_wasm.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#define TELEMETRY 20
+#define TELEMETRY_COST_MS 0.5
+#define TELEMETRY_BUDGET_MS 0.3
+#define TELEMETRY_DEADLINE_MS 50
+#define ALARM_DEADLINE_MS 2
+#define ALARM_EVERY 23  // More than TELEMETRY, so at most one alarm per spin
+#define ROUNDS 60
+
+static rcl_publisher_t telemetry_publishers[TELEMETRY];
+static rcl_subscription_t telemetry_subscriptions[TELEMETRY];
+static std_msgs__msg__Float64 telemetry_msgs[TELEMETRY];
+static rcl_publisher_t alarm_publisher;
+static rcl_subscription_t alarm_subscription;
+static std_msgs__msg__Float64 alarm_msg;
+static std::vector<double> alarm_latency_ms;
+static int telemetry_calls = 0;
+
+static void onTelemetry(const void*) {
+    double until = emscripten_get_now() + TELEMETRY_COST_MS;
+    while (emscripten_get_now() < until) {}
+    if (++telemetry_calls % ALARM_EVERY == 0) {
+        std_msgs__msg__Float64 alarm;
+        alarm.data = emscripten_get_now();
+        rcl_publish(&alarm_publisher, &alarm, NULL);
+    }
+}
+
+static void onAlarm(const void* msg) {
+    alarm_latency_ms.push_back(emscripten_get_now() - static_cast<const std_msgs__msg__Float64*>(msg)->data);
+}
+
+// Returns the worst alarm latency in ms
+static double run(const char* name, rclc_support_t* support, rcl_allocator_t* allocator,
+                  rclc_executor_sched_policy_t policy, bool* budget_ok) {
+    rclc_executor_t executor;
+    rclc_executor_init(&executor, support->context, TELEMETRY + 1, allocator);
+    rclc_executor_add_subscription(&executor, &alarm_subscription, &alarm_msg, onAlarm, ON_NEW_DATA);
+    rclc_executor_set_handle_scheduling(&executor, &alarm_subscription, 10, ALARM_DEADLINE_MS * 1000000LL, 0);
+    for (int i = 0; i < TELEMETRY; i++) {
+        rclc_executor_add_subscription(&executor, &telemetry_subscriptions[i], &telemetry_msgs[i], onTelemetry,
+                                       ON_NEW_DATA);
+        rclc_executor_set_handle_scheduling(&executor, &telemetry_subscriptions[i], 0,
+                                            TELEMETRY_DEADLINE_MS * 1000000LL,
+                                            static_cast<int64_t>(TELEMETRY_BUDGET_MS * 1000000));
+    }
+    rclc_executor_set_scheduling(&executor, policy);
+
+    alarm_latency_ms.clear();
+    telemetry_calls = 0;
+    std_msgs__msg__Float64 msg;
+    msg.data = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < TELEMETRY; i++) {
+            rcl_publish(&telemetry_publishers[i], &msg, NULL);
+        }
+        rclc_executor_spin_some(&executor, 0);
+    }
+    rclc_executor_spin_some(&executor, 0);  // Alarm raised by the last callback
+
+    rclc_executor_handle_stats_t alarm_stats, telemetry_stats;
+    rclc_executor_get_handle_stats(&executor, &alarm_subscription, &alarm_stats);
+    rclc_executor_get_handle_stats(&executor, &telemetry_subscriptions[0], &telemetry_stats);
+    rclc_executor_fini(&executor);
+
+    std::vector<double> sorted = alarm_latency_ms;
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    double worst = n ? sorted[n - 1] : 0.0;
+    fprintf(stderr, "%-15s %3zu alarms  latency p50 %.3f ms  max %.3f ms  deadline misses %llu  "
+            "telemetry overruns %llu/%llu\n",
+            name, n, n ? sorted[n / 2] : 0.0, worst,
+            static_cast<unsigned long long>(alarm_stats.deadline_misses),
+            static_cast<unsigned long long>(telemetry_stats.overruns),
+            static_cast<unsigned long long>(telemetry_stats.calls));
+    *budget_ok = telemetry_stats.calls > 0 && telemetry_stats.overruns == telemetry_stats.calls;
+    return n > 0 ? worst : 1e9;
+}
+
+int main() {
+    rclc_support_t support;
+    rcl_node_t node;
+    rcl_allocator_t allocator = rcl_get_default_allocator();
+    const rosidl_message_type_support_t* ts = ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Float64);
+    if (rclc_support_init(&support, 0, NULL, &allocator) != RCL_RET_OK ||
+        rclc_node_init_default(&node, "alarm_latency", "", &support) != RCL_RET_OK ||
+        rclc_publisher_init_default(&alarm_publisher, &node, ts, "/alarm") != RCL_RET_OK ||
+        rclc_subscription_init_default(&alarm_subscription, &node, ts, "/alarm") != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+    for (int i = 0; i < TELEMETRY; i++) {
+        char topic[32];
+        snprintf(topic, sizeof(topic), "/telemetry_%d", i);
+        if (rclc_publisher_init_default(&telemetry_publishers[i], &node, ts, topic) != RCL_RET_OK ||
+            rclc_subscription_init_default(&telemetry_subscriptions[i], &node, ts, topic) != RCL_RET_OK) {
+            fprintf(stderr, "FAIL: setup\n");
+            return 1;
+        }
+    }
+
+    // One telemetry callback plus scheduling overhead
+    double bound_ms = 2 * TELEMETRY_COST_MS;
+    bool in_order_budget, priority_budget, edf_budget;
+    run("in-order", &support, &allocator, RCLC_SCHED_IN_ORDER, &in_order_budget);
+    double priority_worst = run("fixed-priority", &support, &allocator, RCLC_SCHED_FIXED_PRIORITY, &priority_budget);
+    double edf_worst = run("EDF", &support, &allocator, RCLC_SCHED_EDF, &edf_budget);
+    fprintf(stderr, "bound %.3f ms\n", bound_ms);
+
+    if (priority_worst > bound_ms || edf_worst > bound_ms || !in_order_budget || !priority_budget || !edf_budget) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * Allocation-free steady state check
+ *
+ * Publishes and takes typed messages through rcl -> RMW -> DDS (same-participant
+ * delivery, no network peer needed). After a warm-up phase the publish/take
+ * loop runs under AllocationGuardWASM, which aborts on any operator new or
+ * default-allocator call. The same is then checked for dispatch through
+ * rclc_executor_spin_some. First the guard itself must count aligned new
+ * and the default rcl allocator.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc -DRMW_WASM_ALLOC_GUARD --bind bench/alloc_free_check.cpp -o alloc_free_check.js
+ * Run:            node alloc_free_check.js   (exit code 0 = pass)
+ */
+
+#ifndef RMW_WASM_ALLOC_GUARD
+#define RMW_WASM_ALLOC_GUARD
+#endif
+
+#include "rcl_port_wasm.cpp"
+#include "rclc_port_wasm.cpp"
+#include "rosidl_typesupport_wasm.h"
+#include "rcl_allocator_wasm.h"
+#include "rcl_allocator_guard_wasm.cpp"
+#include <cstdio>
+
+#define WARMUP_ITERATIONS 100
+#define GUARDED_ITERATIONS 1000
+
+static int dispatched = 0;
+
+static void onFloat(const void* msg) {
+    if (msg) dispatched++;
+}
+
+static void onString(const void* msg, void* context) {
+    if (msg && static_cast<const std_msgs__msg__String*>(msg)->data.size > 0) (*static_cast<int*>(context))++;
+}
+
+struct alignas(64) CacheLine {
+    char bytes[64];
+};
+
+// Each kind of allocation the guard must see, unguarded
+static size_t countedKinds() {
+    size_t before = AllocationGuardWASM::allocations();
+    CacheLine* volatile line = new CacheLine();  // volatile: keeps the new/delete pair from being elided
+    delete line;
+    CacheLine* volatile lines = new CacheLine[2];
+    delete[] lines;
+    rcl_allocator_t allocator = rcl_get_default_allocator();
+    void* pointer = allocator.allocate(16, allocator.state);
+    pointer = allocator.reallocate(pointer, 32, allocator.state);
+    allocator.deallocate(pointer, allocator.state);
+    allocator.deallocate(allocator.zero_allocate(4, 4, allocator.state), allocator.state);
+    return AllocationGuardWASM::allocations() - before;
+}
+
+int main() {
+    size_t counted = countedKinds();
+    printf("alloc_free_check: %zu of 5 aligned new / default allocator calls counted\n", counted);
+    if (counted != 5) {
+        fprintf(stderr, "FAIL: guard\n");
+        return 1;
+    }
+
+    ArenaAllocatorWASM arena(256 * 1024);
+    rcl_allocator_t allocator = arena.asRclAllocator();
+
+    rclc_support_t support;
+    rcl_node_t node;
+    rcl_publisher_t float_pub, string_pub;
+    rcl_subscription_t float_sub, string_sub;
+
+    if (rclc_support_init(&support, 0, NULL, &allocator) != RCL_RET_OK ||
+        rclc_node_init_default(&node, "alloc_free_check", "", &support) != RCL_RET_OK ||
+        rclc_publisher_init_default(&float_pub, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Float64), "/alloc/float") != RCL_RET_OK ||
+        rclc_publisher_init_default(&string_pub, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, String), "/alloc/string") != RCL_RET_OK ||
+        rclc_subscription_init_default(&float_sub, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Float64), "/alloc/float") != RCL_RET_OK ||
+        rclc_subscription_init_default(&string_sub, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, String), "/alloc/string") != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+
+    char text[64];
+    std_msgs__msg__Float64 float_out, float_in;
+    std_msgs__msg__String string_out, string_in;
+    std_msgs__msg__String__init(&string_in);
+    string_out.data.data = text;
+    string_out.data.capacity = sizeof(text);
+
+    int taken = 0;
+    auto iterate = [&](int i) {
+        float_out.data = 20.0 + i;
+        string_out.data.size = snprintf(text, sizeof(text), "{\"id\":%d,\"value\":%.2f}", i, float_out.data);
+        rcl_publish(&float_pub, &float_out, NULL);
+        rcl_publish(&string_pub, &string_out, NULL);
+        if (rcl_take(&float_sub, &float_in, NULL, NULL) == RCL_RET_OK && float_in.data == float_out.data) taken++;
+        if (rcl_take(&string_sub, &string_in, NULL, NULL) == RCL_RET_OK && string_in.data.size == string_out.data.size) taken++;
+    };
+
+    for (int i = 0; i < WARMUP_ITERATIONS; i++) {
+        iterate(i);
+    }
+
+    size_t allocations_before = AllocationGuardWASM::allocations();
+    {
+        AllocationGuardWASM guard("publish/take");
+        for (int i = 0; i < GUARDED_ITERATIONS; i++) {
+            iterate(WARMUP_ITERATIONS + i);
+        }
+    }
+    size_t allocations = AllocationGuardWASM::allocations() - allocations_before;
+
+    // Same traffic, dispatched by the executor (wait set built on the first spin)
+    rclc_executor_t executor;
+    if (rclc_executor_init(&executor, support.context, 2, &allocator) != RCL_RET_OK ||
+        rclc_executor_add_subscription(&executor, &float_sub, &float_in, onFloat, ON_NEW_DATA) != RCL_RET_OK ||
+        rclc_executor_add_subscription_with_context(&executor, &string_sub, &string_in, onString, &dispatched,
+                                                    ON_NEW_DATA) != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: executor setup\n");
+        return 1;
+    }
+    auto spin = [&](int i) {
+        float_out.data = 20.0 + i;
+        string_out.data.size = snprintf(text, sizeof(text), "{\"id\":%d,\"value\":%.2f}", i, float_out.data);
+        rcl_publish(&float_pub, &float_out, NULL);
+        rcl_publish(&string_pub, &string_out, NULL);
+        rclc_executor_spin_some(&executor, 0);
+    };
+    for (int i = 0; i < WARMUP_ITERATIONS; i++) {
+        spin(i);
+    }
+    allocations_before = AllocationGuardWASM::allocations();
+    {
+        AllocationGuardWASM guard("rclc_executor_spin_some");
+        for (int i = 0; i < GUARDED_ITERATIONS; i++) {
+            spin(WARMUP_ITERATIONS + i);
+        }
+    }
+    size_t executor_allocations = AllocationGuardWASM::allocations() - allocations_before;
+    rclc_executor_fini(&executor);
+
+    int expected = 2 * (WARMUP_ITERATIONS + GUARDED_ITERATIONS);
+    printf("alloc_free_check: %d/%d messages round-tripped, %zu heap allocations after warm-up, arena high water %zu bytes\n",
+           taken, expected, allocations, arena.getHighWater());
+    printf("alloc_free_check: %d/%d messages dispatched by the executor, %zu heap allocations after warm-up\n",
+           dispatched, expected, executor_allocations);
+    std_msgs__msg__String__fini(&string_in);
+
+    if (taken != expected || allocations != 0 || dispatched != expected || executor_allocations != 0) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
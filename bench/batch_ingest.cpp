@@ -0,0 +1,196 @@
+/*
+ * Batched ingestion benchmark
+ *
+ * A JS relay hands received messages to ROSSubscriberNodeWASM either one
+ * processMessage() call per message (an embind crossing plus a JS string ->
+ * std::string conversion each) or one processBatch() call per BATCH
+ * length-prefixed frames copied into WASM memory. Under Node.js the relay is
+ * JS (EM_JS below) and times:
+ * - envelopes, per message: processMessage(string)
+ * - envelopes, batched:     reserveBatchBuffer() + HEAPU8.set() + processBatch()
+ * - typed readings, batched (44-byte frames; these cannot go through a JS
+ *   string at all)
+ * The native build runs the same three from C++, without the crossings.
+ * Every message must be counted and batched readings must reach the value
+ * statistics; under Node.js batched ingestion must also be faster (natively
+ * there is no crossing to save, so the times are only reported).
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/batch_ingest.cpp -o batch_ingest.js
+ * Run:            node batch_ingest.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "ros_subscriber_wasm.cpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define MESSAGES 20000
+#define BATCH 1000
+#define TOPIC "/sensor_data"
+
+enum { PER_MESSAGE = 0, BATCHED_ENVELOPES = 1, BATCHED_READINGS = 2 };
+
+static const char* const mode_names[] = {"envelopes, per message", "envelopes, batched", "readings, batched"};
+
+#ifdef __EMSCRIPTEN__
+// Returns ns per message, or -1 if the node did not count every message
+EM_JS(double, jsIngest, (int mode, int messages, int batch, uint32_t topic_hash), {
+    const node = new Module['ROSSubscriberNodeWASM']('batch_ingest_js', '/sensor_data');
+    if (!node.init()) return -1;
+
+    const frames = [];
+    const encoder = new TextEncoder();
+    for (let i = 0; i < messages; i++) {
+        const value = (20 + (i % 10)).toFixed(2);
+        if (mode == 2) {
+            const frame = new DataView(new ArrayBuffer(44));
+            frame.setUint32(0, 0x42534444, true);
+            frame.setUint32(4, topic_hash, true);
+            frame.setUint32(8, i + 1, true);
+            frame.setUint32(12, 20, true);
+            frame.setUint32(32, i + 1, true);
+            frame.setFloat32(40, 20 + (i % 10), true);
+            frames.push(new Uint8Array(frame.buffer));
+        } else {
+            frames.push('{"topic":"/sensor_data","type":"std_msgs::msg::String","data":"value ' + value +
+                        '","seq":' + (i + 1) + ',"ts":' + Date.now() + '}');
+        }
+    }
+    // A relay would receive the batch as bytes; build them before timing
+    const batches = [];
+    for (let start = 0; mode != 0 && start < messages; start += batch) {
+        const chunk = frames.slice(start, start + batch).map(f => typeof f == 'string' ? encoder.encode(f) : f);
+        const bytes = new Uint8Array(chunk.reduce((n, f) => n + 4 + f.length, 0));
+        const view = new DataView(bytes.buffer);
+        let offset = 0;
+        for (const f of chunk) {
+            view.setUint32(offset, f.length, true);
+            bytes.set(f, offset + 4);
+            offset += 4 + f.length;
+        }
+        batches.push(bytes);
+    }
+
+    const start = performance.now();
+    if (mode == 0) {
+        for (const f of frames) node.processMessage(f);
+    } else {
+        for (const bytes of batches) {
+            const address = node.reserveBatchBuffer(bytes.length);
+            HEAPU8.set(bytes, address);
+            node.processBatch(address, bytes.length);
+        }
+    }
+    const ns = (performance.now() - start) * 1e6 / messages;
+    const ok = node.getMessagesReceived() == messages;
+    node.delete();
+    return ok ? ns : -1;
+});
+#endif
+
+static std::string envelope(uint32_t i) {
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer),
+             "{\"topic\":\"%s\",\"type\":\"std_msgs::msg::String\",\"data\":\"value %.2f\",\"seq\":%u,\"ts\":%llu}",
+             TOPIC, 20.0 + (i % 10), i + 1, static_cast<unsigned long long>(emscripten_get_now()));
+    return std::string(buffer);
+}
+
+static std::string readingFrame(uint32_t i) {
+    wasm_msgs__msg__SensorReading reading = {};
+    reading.id = i + 1;
+    reading.value = 20.0f + (i % 10);
+    DDSFrameHeader header = {};
+    header.magic = DDS_FRAME_MAGIC;
+    header.topic_hash = ddsTopicHash(TOPIC);
+    header.sequence_number = i + 1;
+    header.payload_length = sizeof(reading);
+    std::string frame(sizeof(header) + sizeof(reading), '\0');
+    memcpy(&frame[0], &header, sizeof(header));
+    memcpy(&frame[sizeof(header)], &reading, sizeof(reading));
+    return frame;
+}
+
+// Same relay as jsIngest, from C++ (no embind crossings to save)
+static double nativeIngest(ROSSubscriberNodeWASM& node, int mode) {
+    std::vector<std::string> frames;
+    for (uint32_t i = 0; i < MESSAGES; i++) {
+        frames.push_back(mode == BATCHED_READINGS ? readingFrame(i) : envelope(i));
+    }
+    std::vector<std::vector<uint8_t>> batches;
+    for (size_t start = 0; mode != PER_MESSAGE && start < frames.size(); start += BATCH) {
+        std::vector<uint8_t> bytes;
+        for (size_t i = start; i < start + BATCH && i < frames.size(); i++) {
+            uint32_t length = static_cast<uint32_t>(frames[i].size());
+            bytes.insert(bytes.end(), reinterpret_cast<uint8_t*>(&length), reinterpret_cast<uint8_t*>(&length) + 4);
+            bytes.insert(bytes.end(), frames[i].begin(), frames[i].end());
+        }
+        batches.push_back(bytes);
+    }
+
+    double start = emscripten_get_now();
+    if (mode == PER_MESSAGE) {
+        for (const std::string& frame : frames) node.processMessage(std::string(frame.data(), frame.size()));
+    } else {
+        for (const std::vector<uint8_t>& bytes : batches) {
+            uintptr_t address = node.reserveBatchBuffer(static_cast<int>(bytes.size()));
+            memcpy(reinterpret_cast<uint8_t*>(address), bytes.data(), bytes.size());
+            node.processBatch(address, static_cast<int>(bytes.size()));
+        }
+    }
+    return (emscripten_get_now() - start) * 1e6 / MESSAGES;
+}
+
+int main() {
+    bool ok = true;
+    double ns[3];
+
+#ifdef __EMSCRIPTEN__
+    const char* relay = "JS relay";
+    for (int mode = 0; mode < 3; mode++) {
+        ns[mode] = jsIngest(mode, MESSAGES, BATCH, ddsTopicHash(TOPIC));
+        ok = ok && ns[mode] > 0;
+    }
+#else
+    const char* relay = "native relay (no embind crossings)";
+    ROSSubscriberNodeWASM node("batch_ingest", TOPIC);
+    if (!node.init()) {
+        fprintf(stderr, "node setup failed\nFAIL\n");
+        return 1;
+    }
+    double stats[3][3];
+    for (int mode = 0; mode < 3; mode++) {
+        int before = node.getMessagesReceived();
+        ns[mode] = nativeIngest(node, mode);
+        ok = ok && node.getMessagesReceived() - before == MESSAGES;
+        stats[mode][0] = node.getAverageValue();
+        stats[mode][1] = node.getMinValue();
+        stats[mode][2] = node.getMaxValue();
+    }
+    // The envelopes carry no value the subscriber extracts; the readings end
+    // with one of each of 20..29 in the last-10 window
+    if (memcmp(stats[BATCHED_ENVELOPES], stats[PER_MESSAGE], sizeof(stats[0])) != 0 ||
+        std::fabs(stats[BATCHED_READINGS][0] - 24.5) > 1e-9 || stats[BATCHED_READINGS][1] != 20.0 ||
+        stats[BATCHED_READINGS][2] != 29.0) {
+        fprintf(stderr, "value statistics differ\n");
+        ok = false;
+    }
+#endif
+
+    fprintf(stderr, "%s, %d messages, batches of %d\n", relay, MESSAGES, BATCH);
+    for (int mode = 0; mode < 3; mode++) {
+        fprintf(stderr, "  %-24s %8.1f ns/msg  (%.1fx)\n", mode_names[mode], ns[mode], ns[PER_MESSAGE] / ns[mode]);
+    }
+#ifdef __EMSCRIPTEN__
+    ok = ok && ns[BATCHED_ENVELOPES] < ns[PER_MESSAGE];
+#endif
+
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ * Coroutine pipeline benchmark
+ *
+ * PIPELINES independent pipelines of three tasks each, all on one
+ * single-threaded CoroutineSchedulerWASM:
+ *   producer --/pipe_N_raw--> relay (doubles) --/pipe_N_out--> sink
+ * plus one task ticking on a TIMER_PERIOD_MS timer. Every producer sends
+ * MESSAGES values; every sink must see all of them, doubled and in order.
+ * The whole set runs twice:
+ * - native: scheduler.run(), sleeping on the reactor between passes
+ * - browser: MainLoopDriverWASM pump() calls, as requestAnimationFrame would
+ * Reports delivered messages/s (until the last sink is done) and passes for both, and the frame pool counters; the
+ * second run must reuse the first run's frames (no new pool chunks).
+ *
+ * Build (WASM):   emcc -O2 -std=c++20 -Isrc --bind bench/coroutine_pipeline.cpp -o coroutine_pipeline.js
+ * Run:            node coroutine_pipeline.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "rcl_port_wasm.cpp"
+#include "rclc_port_wasm.cpp"
+#include "rclc_coroutine_wasm.h"
+#include "rosidl_typesupport_wasm.h"
+#include <cstdio>
+
+#define PIPELINES 64
+#define MESSAGES 200
+#define TICKS 10
+#define TIMER_PERIOD_MS 5
+
+struct Pipeline {
+    rcl_publisher_t raw_publisher;
+    rcl_subscription_t raw_subscription;
+    rcl_publisher_t out_publisher;
+    rcl_subscription_t out_subscription;
+    int received;
+    int out_of_order;
+};
+
+static Pipeline pipelines[PIPELINES];
+static int timer_periods = 0;
+static int sinks_done = 0;
+static double sinks_done_ms = 0;
+
+static CoroutineTaskWASM producer(CoroutinePublisherWASM& out) {
+    std_msgs__msg__Float64 msg;
+    for (int i = 0; i < MESSAGES; i++) {
+        co_await out.ready();
+        msg.data = i;
+        out.publish(&msg);
+    }
+}
+
+static CoroutineTaskWASM relay(CoroutineSubscriptionWASM<std_msgs__msg__Float64>& in, CoroutinePublisherWASM& out) {
+    std_msgs__msg__Float64 doubled;
+    for (int i = 0; i < MESSAGES; i++) {
+        const std_msgs__msg__Float64& msg = co_await in.next();
+        doubled.data = msg.data * 2;
+        co_await out.ready();
+        out.publish(&doubled);
+    }
+}
+
+static CoroutineTaskWASM sink(CoroutineSubscriptionWASM<std_msgs__msg__Float64>& in, Pipeline& pipeline) {
+    for (int i = 0; i < MESSAGES; i++) {
+        const std_msgs__msg__Float64& msg = co_await in.next();
+        if (msg.data != i * 2) pipeline.out_of_order++;
+        pipeline.received++;
+    }
+    if (++sinks_done == PIPELINES) sinks_done_ms = emscripten_get_now();
+}
+
+static CoroutineTaskWASM ticker(CoroutineTimerWASM& timer) {
+    for (int i = 0; i < TICKS; i++) {
+        timer_periods += static_cast<int>(co_await timer.tick());
+    }
+}
+
+struct Streams {
+    CoroutinePublisherWASM* raw_out[PIPELINES];
+    CoroutinePublisherWASM* out_out[PIPELINES];
+    CoroutineSubscriptionWASM<std_msgs__msg__Float64>* raw_in[PIPELINES];
+    CoroutineSubscriptionWASM<std_msgs__msg__Float64>* out_in[PIPELINES];
+};
+
+static void spawnAll(CoroutineSchedulerWASM& scheduler, Streams& streams, CoroutineTimerWASM& timer) {
+    timer_periods = 0;
+    sinks_done = 0;
+    for (int i = 0; i < PIPELINES; i++) {
+        pipelines[i].received = 0;
+        pipelines[i].out_of_order = 0;
+        scheduler.spawn(sink(*streams.out_in[i], pipelines[i]));
+        scheduler.spawn(relay(*streams.raw_in[i], *streams.out_out[i]));
+        scheduler.spawn(producer(*streams.raw_out[i]));
+    }
+    scheduler.spawn(ticker(timer));
+}
+
+static bool check(const char* name, double start_ms, uint64_t passes, uint64_t frames) {
+    int received = 0, out_of_order = 0;
+    for (int i = 0; i < PIPELINES; i++) {
+        received += pipelines[i].received;
+        out_of_order += pipelines[i].out_of_order;
+    }
+    double elapsed_ms = sinks_done_ms - start_ms;
+    const CoroutineFramePoolStatsWASM& pool = CoroutineFramePoolWASM::local().getStats();
+    fprintf(stderr, "%-8s %d/%d messages  %d out of order  %d timer periods  %.1f ms  %.0f msg/s  "
+            "%llu passes  %llu frames  pool: %llu frames, %llu chunks, peak %llu\n",
+            name, received, PIPELINES * MESSAGES, out_of_order, timer_periods, elapsed_ms,
+            elapsed_ms > 0 ? received * 2 * 1000.0 / elapsed_ms : 0.0, static_cast<unsigned long long>(passes),
+            static_cast<unsigned long long>(frames), static_cast<unsigned long long>(pool.allocations),
+            static_cast<unsigned long long>(pool.chunks), static_cast<unsigned long long>(pool.peak_in_use));
+    return received == PIPELINES * MESSAGES && out_of_order == 0 && timer_periods >= TICKS;
+}
+
+int main() {
+    rclc_support_t support;
+    rcl_node_t node;
+    rcl_allocator_t allocator = rcl_get_default_allocator();
+    const rosidl_message_type_support_t* ts = ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Float64);
+    if (rclc_support_init(&support, 0, NULL, &allocator) != RCL_RET_OK ||
+        rclc_node_init_default(&node, "coroutine_pipeline", "", &support) != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+    for (int i = 0; i < PIPELINES; i++) {
+        char raw[32], out[32];
+        snprintf(raw, sizeof(raw), "/pipe_%d_raw", i);
+        snprintf(out, sizeof(out), "/pipe_%d_out", i);
+        Pipeline& pipeline = pipelines[i];
+        if (rclc_publisher_init_default(&pipeline.raw_publisher, &node, ts, raw) != RCL_RET_OK ||
+            rclc_subscription_init_default(&pipeline.raw_subscription, &node, ts, raw) != RCL_RET_OK ||
+            rclc_publisher_init_default(&pipeline.out_publisher, &node, ts, out) != RCL_RET_OK ||
+            rclc_subscription_init_default(&pipeline.out_subscription, &node, ts, out) != RCL_RET_OK) {
+            fprintf(stderr, "FAIL: setup\n");
+            return 1;
+        }
+    }
+
+    CoroutineSchedulerWASM scheduler(&support, 2 * PIPELINES + 1, &allocator);
+    Streams streams;
+    for (int i = 0; i < PIPELINES; i++) {
+        streams.raw_out[i] = new CoroutinePublisherWASM(scheduler, &pipelines[i].raw_publisher);
+        streams.out_out[i] = new CoroutinePublisherWASM(scheduler, &pipelines[i].out_publisher);
+        streams.raw_in[i] = new CoroutineSubscriptionWASM<std_msgs__msg__Float64>(scheduler,
+                                                                                 &pipelines[i].raw_subscription);
+        streams.out_in[i] = new CoroutineSubscriptionWASM<std_msgs__msg__Float64>(scheduler,
+                                                                                 &pipelines[i].out_subscription);
+    }
+    CoroutineTimerWASM timer(scheduler, &support, TIMER_PERIOD_MS * 1000000LL);
+
+    // Native: run() returns once every task has finished
+    spawnAll(scheduler, streams, timer);
+    uint64_t passes = scheduler.getPasses();
+    double start = emscripten_get_now();
+    scheduler.run();
+    bool native_ok = check("native", start, scheduler.getPasses() - passes, 0);
+    uint64_t chunks = CoroutineFramePoolWASM::local().getStats().chunks;
+
+    // Browser: the same tasks, pumped frame by frame
+    MainLoopDriverWASM driver(scheduler.mainLoopWork());
+    scheduler.attachMainLoop(&driver);
+    driver.start(MAIN_LOOP_ANIMATION_FRAME, MAIN_LOOP_WASM_DEFAULT_BUDGET_MS);
+    spawnAll(scheduler, streams, timer);
+    passes = scheduler.getPasses();
+    start = emscripten_get_now();
+    while (scheduler.getLiveTasks() > 0 && emscripten_get_now() - start < 5000) {
+        driver.pump();
+    }
+    bool browser_ok = check("browser", start, scheduler.getPasses() - passes,
+                            driver.getStats().busy_frames);
+    driver.stop();
+    scheduler.attachMainLoop(nullptr);
+    for (int i = 0; i < PIPELINES; i++) {
+        delete streams.raw_out[i];
+        delete streams.out_out[i];
+        delete streams.raw_in[i];
+        delete streams.out_in[i];
+    }
+
+    const CoroutineFramePoolStatsWASM& pool = CoroutineFramePoolWASM::local().getStats();
+    bool pool_ok = pool.chunks == chunks && pool.oversized == 0 && pool.in_use == 0;
+    fprintf(stderr, "frame pool reuse: %s\n", pool_ok ? "yes" : "no");
+
+    if (!native_ok || !browser_ok || !pool_ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * Entity metrics check
+ *
+ * Publishes on one participant and checks the counters that the
+ * participant, its sockets, its publisher and subscribers, and an RMW
+ * subscription report through getStats():
+ * - publisher messages/bytes, local deliveries and matched subscribers;
+ *   subscriber messages/bytes
+ * - discovery datagrams and bytes, the UDP socket counts of the same
+ *   datagrams, and poll calls
+ * - KEEP_LAST overwrites and peak depth of an RMW subscription
+ * - the metrics topic: a snapshot arrives on DDS_METRICS_TOPIC as a
+ *   std_msgs/String holding the getStats() JSON
+ * Also reports the time of one publish with its counters, of one getStats(),
+ * and of two threads counting on adjacent atomics vs one MetricWASM each.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/entity_metrics.cpp -o entity_metrics.js
+ * Run:            node entity_metrics.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "rmw_custom_wasm.cpp"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#define MESSAGES 1000
+#define PAYLOAD 64
+#define RMW_DEPTH 4
+#define RMW_MESSAGES 10
+#define TIMED_PUBLISHES 200000
+#define SNAPSHOTS 1000
+#define THREAD_INCREMENTS 20000000
+
+static int failures = 0;
+
+static void expect(const char* what, uint64_t value, uint64_t expected) {
+    bool ok = value == expected;
+    fprintf(stderr, "%-46s %10llu  (expected %llu)%s\n", what, static_cast<unsigned long long>(value),
+            static_cast<unsigned long long>(expected), ok ? "" : "  FAIL");
+    if (!ok) failures++;
+}
+
+static void discard(void*, const uint8_t*, size_t) {}
+
+// Last message on the metrics topic, decoded from std_msgs/String
+static void keepSnapshot(void* context, const uint8_t* payload, size_t length) {
+    uint32_t size = 0;
+    if (length < sizeof(size)) return;
+    memcpy(&size, payload, sizeof(size));
+    if (size > length - sizeof(size)) return;
+    static_cast<std::string*>(context)->assign(reinterpret_cast<const char*>(payload) + sizeof(size), size);
+}
+
+#if IO_HANDOFF_WASM_HAS_THREADS
+// ns per increment with two threads, each on its own counter
+template <typename Counter>
+static double contendedNs(Counter* first, Counter* second) {
+    double start = emscripten_get_now();
+    std::thread other([second] {
+        for (int i = 0; i < THREAD_INCREMENTS; i++) second->fetch_add(1, std::memory_order_relaxed);
+    });
+    for (int i = 0; i < THREAD_INCREMENTS; i++) first->fetch_add(1, std::memory_order_relaxed);
+    other.join();
+    return (emscripten_get_now() - start) * 1e6 / THREAD_INCREMENTS;
+}
+#endif
+
+int main() {
+    DDSParticipantWASM participant("metrics_check", 22);
+    if (!participant.init()) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+    MetricsRegistryWASM* registry = participant.getMetrics();
+
+    DDSPublisherWASM publisher(&participant, "/metrics_check/data", "metrics_check::msg::Blob");
+    DDSSubscriberWASM first(&participant, "/metrics_check/data", "metrics_check::msg::Blob");
+    DDSSubscriberWASM second(&participant, "/metrics_check/data", "metrics_check::msg::Blob");
+    first.setRawCallback(discard, nullptr);
+    second.setRawCallback(discard, nullptr);
+    if (!publisher.init() || !first.init() || !second.init()) {
+        fprintf(stderr, "FAIL: endpoints\n");
+        return 1;
+    }
+
+    uint8_t payload[PAYLOAD] = {};
+    for (int i = 0; i < MESSAGES; i++) publisher.publishSerialized(payload, sizeof(payload));
+    expect("publisher messages_published", publisher.getMetric(PUBLISHER_MESSAGES), MESSAGES);
+    expect("publisher bytes_published", publisher.getMetric(PUBLISHER_BYTES), MESSAGES * PAYLOAD);
+    expect("publisher local_deliveries", publisher.getMetric(PUBLISHER_LOCAL_DELIVERIES), 2 * MESSAGES);
+    expect("publisher matched_local", publisher.getMetric(PUBLISHER_MATCHED_LOCAL), 2);
+    expect("subscriber messages_received", first.getMetric(SUBSCRIBER_MESSAGES), MESSAGES);
+    expect("subscriber bytes_received", second.getMetric(SUBSCRIBER_BYTES), MESSAGES * PAYLOAD);
+    expect("registry: publisher", registry->get("publisher", "/metrics_check/data", "messages_published"),
+           MESSAGES);
+
+    // One announcement round: participant + 3 endpoints, all through the discovery socket
+    NetworkManagerWASM* net_mgr = participant.getNetworkManager();
+    uint64_t datagrams = net_mgr->getDiscoveryDatagramsSent();
+    uint64_t bytes = net_mgr->getDiscoveryBytesSent();
+    uint64_t polls = net_mgr->getMetric(NET_POLLS);
+    std::string discovery_socket = NetworkEndpoint("0.0.0.0", net_mgr->getDiscoveryPort()).toString();
+    uint64_t udp_datagrams = registry->get("udp_socket", discovery_socket, "datagrams_sent");
+    uint64_t udp_bytes = registry->get("udp_socket", discovery_socket, "bytes_sent");
+    participant.discoverParticipants();
+    uint64_t sent = net_mgr->getDiscoveryDatagramsSent() - datagrams;
+    expect("network discovery_datagrams_sent (one round)", sent, 4);
+    expect("udp_socket datagrams_sent (same round)",
+           registry->get("udp_socket", discovery_socket, "datagrams_sent") - udp_datagrams, sent);
+    expect("udp_socket bytes_sent = discovery bytes",
+           registry->get("udp_socket", discovery_socket, "bytes_sent") - udp_bytes,
+           net_mgr->getDiscoveryBytesSent() - bytes);
+    expect("network polls", net_mgr->getMetric(NET_POLLS) - polls, 1);
+
+    // KEEP_LAST: RMW_MESSAGES into a queue of RMW_DEPTH, none taken
+    RMWCustomWASM rmw;
+    void* rmw_participant = rmw.createParticipant("metrics_check_rmw", 22);
+    if (!rmw_participant) {
+        fprintf(stderr, "FAIL: rmw participant\n");
+        return 1;
+    }
+    void* rmw_publisher = rmw.createPublisher(rmw_participant, "/metrics_check/queue", "std_msgs::msg::String");
+    void* rmw_subscriber = rmw.createSubscriberWithDepth(rmw_participant, "/metrics_check/queue",
+                                                         "std_msgs::msg::String", RMW_DEPTH);
+    if (!rmw_publisher || !rmw_subscriber) {
+        fprintf(stderr, "FAIL: rmw endpoints\n");
+        return 1;
+    }
+    for (int i = 0; i < RMW_MESSAGES; i++) rmw.publish(rmw_publisher, "sample");
+    MetricsRegistryWASM* rmw_registry = static_cast<DDSParticipantWASM*>(rmw_participant)->getMetrics();
+    expect("rmw_subscription samples_queued",
+           rmw_registry->get("rmw_subscription", "/metrics_check/queue", "samples_queued"), RMW_MESSAGES);
+    expect("rmw_subscription samples_overwritten",
+           rmw_registry->get("rmw_subscription", "/metrics_check/queue", "samples_overwritten"),
+           RMW_MESSAGES - RMW_DEPTH);
+    expect("rmw_subscription queue_max_depth",
+           rmw_registry->get("rmw_subscription", "/metrics_check/queue", "queue_max_depth"), RMW_DEPTH);
+
+    // Metrics topic: the next announcement carries a snapshot
+    std::string snapshot;
+    DDSSubscriberWASM monitor(&participant, DDS_METRICS_TOPIC, "std_msgs::msg::String");
+    monitor.setRawCallback(keepSnapshot, &snapshot);
+    if (!monitor.init() || !participant.enableMetricsTopic(1000.0)) {
+        fprintf(stderr, "FAIL: metrics topic\n");
+        return 1;
+    }
+    participant.discoverParticipants();
+    participant.discoverParticipants();  // Not due again for a second
+    expect("participant metrics_published", participant.getMetric(PARTICIPANT_METRICS_PUBLISHED), 1);
+    expect("snapshot received", monitor.getMessagesReceived(), 1);
+    const char* fields[] = {"{\"participant\":\"metrics_check\"", "\"kind\":\"participant\"", "\"kind\":\"network\"",
+                            "\"kind\":\"udp_socket\"", "\"kind\":\"publisher\"", "\"kind\":\"subscriber\"",
+                            "\"messages_published\":1000,"};
+    int found = 0;
+    for (const char* field : fields) {
+        if (snapshot.find(field) != std::string::npos) {
+            found++;
+        } else {
+            fprintf(stderr, "snapshot lacks %s\n", field);
+        }
+    }
+    expect("snapshot fields found", found, sizeof(fields) / sizeof(fields[0]));
+    fprintf(stderr, "snapshot: %zu bytes, %zu groups\n", snapshot.size(), registry->getGroupCount());
+
+    // Costs
+    double start = emscripten_get_now();
+    for (int i = 0; i < TIMED_PUBLISHES; i++) publisher.publishSerialized(payload, sizeof(payload));
+    double publish_ns = (emscripten_get_now() - start) * 1e6 / TIMED_PUBLISHES;
+    start = emscripten_get_now();
+    size_t total = 0;
+    for (int i = 0; i < SNAPSHOTS; i++) total += participant.getStats().size();
+    double snapshot_us = (emscripten_get_now() - start) * 1000.0 / SNAPSHOTS;
+    fprintf(stderr, "publish to 2 local subscribers: %.1f ns, getStats(): %.2f us (%zu bytes)\n", publish_ns,
+            snapshot_us, total / SNAPSHOTS);
+#if IO_HANDOFF_WASM_HAS_THREADS
+    std::atomic<uint64_t> packed[2];
+    packed[0] = 0;
+    packed[1] = 0;
+    MetricWASM padded[2];
+    double packed_ns = contendedNs(&packed[0], &packed[1]);
+    double padded_ns = contendedNs(&padded[0].value, &padded[1].value);
+    fprintf(stderr, "two threads counting: adjacent atomics %.2f ns/add, one cache line each %.2f ns/add\n",
+            packed_ns, padded_ns);
+#endif
+
+    if (failures > 0) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
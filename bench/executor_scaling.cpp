@@ -0,0 +1,160 @@
+/*
+ * Multi-threaded executor scaling benchmark
+ *
+ * SUBSCRIPTIONS topics, each with a CPU-bound callback (CALLBACK_WORK
+ * iterations) and each in its own reentrant callback group, so they may all
+ * run in parallel. Every round publishes one message per topic and spins once.
+ * Reports callback throughput for 1, 2, 4 ... hardware threads and the
+ * speedup over one thread.
+ *
+ * Two more subscriptions share a mutually exclusive group; the benchmark
+ * fails if their callbacks are ever seen running at the same time, or if any
+ * callback is lost. The speedup check only applies when the machine has the
+ * cores for it.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -pthread -s PTHREAD_POOL_SIZE=8 -Isrc --bind bench/executor_scaling.cpp -o executor_scaling.js
+ * Run:            node executor_scaling.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "rcl_port_wasm.cpp"
+#include "rclc_port_wasm.cpp"
+#include "rosidl_typesupport_wasm.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#define SUBSCRIPTIONS 16
+#define ROUNDS 200
+#define CALLBACK_WORK 20000
+#define MIN_SPEEDUP_2_THREADS 1.5
+
+struct Topic {
+    rcl_publisher_t publisher;
+    rcl_subscription_t subscription;
+    std_msgs__msg__Float64 msg;
+    rclc_callback_group_t group;
+};
+
+static Topic topics[SUBSCRIPTIONS];
+static Topic exclusive[2];
+static rclc_callback_group_t exclusive_group;
+static std::atomic<int> callbacks(0);
+static std::atomic<int> exclusive_running(0);
+static std::atomic<int> exclusive_overlaps(0);
+static std::atomic<double> sink(0);
+
+static void burnCpu(double seed) {
+    double x = seed;
+    for (int i = 0; i < CALLBACK_WORK; i++) {
+        x = x * 1.0000001 + 0.5;
+    }
+    sink.store(x, std::memory_order_relaxed);
+}
+
+static void onMessage(const void* msg) {
+    burnCpu(static_cast<const std_msgs__msg__Float64*>(msg)->data);
+    callbacks.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void onExclusive(const void* msg) {
+    if (exclusive_running.fetch_add(1) != 0) {
+        exclusive_overlaps.fetch_add(1);
+    }
+    burnCpu(static_cast<const std_msgs__msg__Float64*>(msg)->data);
+    exclusive_running.fetch_sub(1);
+    callbacks.fetch_add(1, std::memory_order_relaxed);
+}
+
+static bool initTopic(Topic& topic, rcl_node_t* node, const char* prefix, int i) {
+    char name[64];
+    snprintf(name, sizeof(name), "/%s_%d", prefix, i);
+    const rosidl_message_type_support_t* ts = ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Float64);
+    return rclc_publisher_init_default(&topic.publisher, node, ts, name) == RCL_RET_OK &&
+           rclc_subscription_init_default(&topic.subscription, node, ts, name) == RCL_RET_OK;
+}
+
+// Callbacks per second with `threads` executor threads
+static double measure(rclc_support_t* support, rcl_allocator_t* allocator, size_t threads, int* lost) {
+    rclc_executor_t executor;
+    rclc_executor_init(&executor, support->context, SUBSCRIPTIONS + 2, allocator);
+    for (int i = 0; i < SUBSCRIPTIONS; i++) {
+        rclc_executor_add_subscription(&executor, &topics[i].subscription, &topics[i].msg, onMessage, ON_NEW_DATA);
+        rclc_callback_group_init(&topics[i].group, RCLC_CALLBACK_GROUP_REENTRANT);
+        rclc_executor_set_callback_group(&executor, &topics[i].subscription, &topics[i].group);
+    }
+    for (int i = 0; i < 2; i++) {
+        rclc_executor_add_subscription(&executor, &exclusive[i].subscription, &exclusive[i].msg, onExclusive,
+                                       ON_NEW_DATA);
+        rclc_executor_set_callback_group(&executor, &exclusive[i].subscription, &exclusive_group);
+    }
+    rclc_executor_set_num_threads(&executor, threads);
+
+    callbacks = 0;
+    std_msgs__msg__Float64 msg;
+    double start = emscripten_get_now();
+    for (int round = 0; round < ROUNDS; round++) {
+        msg.data = round;
+        for (int i = 0; i < SUBSCRIPTIONS; i++) {
+            rcl_publish(&topics[i].publisher, &msg, NULL);
+        }
+        rcl_publish(&exclusive[0].publisher, &msg, NULL);
+        rcl_publish(&exclusive[1].publisher, &msg, NULL);
+        rclc_executor_spin_some(&executor, 0);
+    }
+    double elapsed = emscripten_get_now() - start;
+    rclc_executor_fini(&executor);
+
+    *lost = ROUNDS * (SUBSCRIPTIONS + 2) - callbacks.load();
+    return callbacks.load() * 1000.0 / elapsed;
+}
+
+int main() {
+    rclc_support_t support;
+    rcl_node_t node;
+    rcl_allocator_t allocator = rcl_get_default_allocator();
+    if (rclc_support_init(&support, 0, NULL, &allocator) != RCL_RET_OK ||
+        rclc_node_init_default(&node, "executor_scaling", "", &support) != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+    for (int i = 0; i < SUBSCRIPTIONS; i++) {
+        if (!initTopic(topics[i], &node, "scaling", i)) {
+            fprintf(stderr, "FAIL: setup\n");
+            return 1;
+        }
+    }
+    if (!initTopic(exclusive[0], &node, "exclusive", 0) || !initTopic(exclusive[1], &node, "exclusive", 1)) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+    rclc_callback_group_init(&exclusive_group, RCLC_CALLBACK_GROUP_MUTUALLY_EXCLUSIVE);
+
+    unsigned int cores = std::thread::hardware_concurrency();
+    size_t max_threads = cores > 1 ? cores : 2;
+    if (max_threads > 16) max_threads = 16;
+
+    bool ok = true;
+    double single = 0, two = 0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        int lost = 0;
+        double rate = measure(&support, &allocator, threads, &lost);
+        if (threads == 1) single = rate;
+        if (threads == 2) two = rate;
+        fprintf(stderr, "%2zu threads  %9.0f callbacks/s  speedup %.2fx  lost %d\n",
+                threads, rate, rate / single, lost);
+        ok = ok && lost == 0;
+    }
+    fprintf(stderr, "exclusive group overlaps: %d (%u hardware threads)\n", exclusive_overlaps.load(), cores);
+    ok = ok && exclusive_overlaps.load() == 0;
+    if (cores >= 2 && two < single * MIN_SPEEDUP_2_THREADS) {
+        fprintf(stderr, "2 threads should be at least %.1fx faster\n", MIN_SPEEDUP_2_THREADS);
+        ok = false;
+    }
+
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
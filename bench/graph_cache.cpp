@@ -0,0 +1,111 @@
+/*
+ * Graph cache check
+ *
+ * Endpoint counts answered by rcl_count_publishers/rcl_count_subscribers
+ * from the RMW graph cache:
+ * - two subscriptions on one topic in one node count as two, and destroying
+ *   either leaves the other counted
+ * - a second node (participant) on the topic is counted once, although its
+ *   endpoints also reach the first node's participant through multicast
+ *   discovery
+ * - announcement rounds repeat every endpoint; they must not change the
+ *   counts or the graph version
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/graph_cache.cpp -o graph_cache.js
+ * Run:            node graph_cache.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "rcl_port_wasm.cpp"
+#include "rosidl_typesupport_wasm.h"
+#include <cstdio>
+
+#define TOPIC "/graph_check/data"
+#define ROUNDS 5
+#define POLLS_PER_ROUND 50
+
+static int failures = 0;
+
+static void expect(const char* what, size_t value, size_t expected) {
+    bool ok = value == expected;
+    fprintf(stderr, "%-56s %4zu  (expected %zu)%s\n", what, value, expected, ok ? "" : "  FAIL");
+    if (!ok) failures++;
+}
+
+static size_t subscribers(const rcl_node_t* node) {
+    size_t count = 0;
+    if (rcl_count_subscribers(node, TOPIC, &count) != RCL_RET_OK) return ~static_cast<size_t>(0);
+    return count;
+}
+
+static size_t publishers(const rcl_node_t* node) {
+    size_t count = 0;
+    if (rcl_count_publishers(node, TOPIC, &count) != RCL_RET_OK) return ~static_cast<size_t>(0);
+    return count;
+}
+
+// Every participant announces its endpoints, then reads the others' announcements
+static void discoveryRounds(rcl_node_t* first, rcl_node_t* second) {
+    DDSParticipantWASM* participants[] = {static_cast<DDSParticipantWASM*>(first->impl),
+                                          static_cast<DDSParticipantWASM*>(second->impl)};
+    for (int round = 0; round < ROUNDS; round++) {
+        for (DDSParticipantWASM* participant : participants) participant->discoverParticipants();
+        for (int poll = 0; poll < POLLS_PER_ROUND; poll++) {
+            for (DDSParticipantWASM* participant : participants) participant->getNetworkManager()->poll();
+        }
+    }
+}
+
+int main() {
+    rcl_context_t context;
+    rcl_node_t node, other;
+    if (rcl_init(0, nullptr, nullptr, &context) != RCL_RET_OK ||
+        rcl_node_init(&node, "graph_check", "", &context, nullptr) != RCL_RET_OK ||
+        rcl_node_init(&other, "graph_check_other", "", &context, nullptr) != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+    const rosidl_message_type_support_t* ts = ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Float64);
+    rcl_publisher_t publisher;
+    rcl_subscription_t first, second, remote;
+    if (rcl_publisher_init(&publisher, &node, ts, TOPIC, nullptr) != RCL_RET_OK ||
+        rcl_subscription_init(&first, &node, ts, TOPIC, nullptr) != RCL_RET_OK ||
+        rcl_subscription_init(&second, &node, ts, TOPIC, nullptr) != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: endpoints\n");
+        return 1;
+    }
+
+    expect("one node, two subscriptions: subscribers", subscribers(&node), 2);
+    expect("one node, one publisher: publishers", publishers(&node), 1);
+
+    double version = g_rmw_instance->getGraphVersion();
+    discoveryRounds(&node, &other);
+    expect("after announcement rounds: subscribers", subscribers(&node), 2);
+    expect("after announcement rounds: graph changes", g_rmw_instance->getGraphVersion() - version, 0);
+
+    if (rcl_subscription_init(&remote, &other, ts, TOPIC, nullptr) != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: second node's subscription\n");
+        return 1;
+    }
+    discoveryRounds(&node, &other);
+    expect("second node's subscription, announced: subscribers", subscribers(&node), 3);
+
+    expect("first subscription destroyed", rcl_subscription_fini(&first, &node), RCL_RET_OK);
+    expect("... subscribers", subscribers(&node), 2);
+    discoveryRounds(&node, &other);
+    expect("... after announcement rounds", subscribers(&node), 2);
+    expect("second subscription destroyed", rcl_subscription_fini(&second, &node), RCL_RET_OK);
+    expect("... subscribers", subscribers(&node), 1);
+    expect("second node's subscription destroyed", rcl_subscription_fini(&remote, &other), RCL_RET_OK);
+    expect("... subscribers", subscribers(&node), 0);
+    expect("... publishers", publishers(&node), 1);
+    expect("publisher destroyed", rcl_publisher_fini(&publisher, &node), RCL_RET_OK);
+    expect("... publishers", publishers(&node), 0);
+    expect("... topics", static_cast<size_t>(g_rmw_instance->getTopicCount()), 0);
+
+    if (failures > 0) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * Receive history check
+ *
+ * 1. ReceiveHistoryWASM against a deque of the same samples, after every
+ *    add, for several capacities: the latest size() values and times must be
+ *    contiguous, oldest first, and the change sequence must move with every
+ *    add(), touch() and configure().
+ * 2. Under Node.js, a dashboard refresh through ROSSubscriberNodeWASM: the
+ *    last message read with getLastMessage() (a std::string copied out and
+ *    decoded to a JS string, then parsed) against getLastMessageView() (a
+ *    DataView over the record in place), and the value history read in place.
+ *    Views must be faster, and getChangeSequence() must not move while
+ *    nothing arrives (so a dashboard could skip those refreshes).
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/history_views.cpp -o history_views.js
+ * Run:            node history_views.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "ros_subscriber_wasm.cpp"
+#include "receive_history_wasm.h"
+#include <cstdio>
+#include <deque>
+
+#define SAMPLES 5000
+#define REFRESHES 20000
+#define HISTORY 256
+
+static bool checkHistory(size_t capacity) {
+    ReceiveHistoryWASM history(capacity);
+    std::deque<double> expected;
+    int mismatches = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        uint64_t before = history.getSequence();
+        if (i % 7 == 3) {
+            history.touch();
+        } else {
+            history.add(i * 0.5, i);
+            expected.push_back(i * 0.5);
+            if (expected.size() > capacity) expected.pop_front();
+        }
+        bool ok = history.getSequence() == before + 1 && history.size() == expected.size();
+        for (size_t k = 0; ok && k < expected.size(); k++) {
+            ok = history.getValues()[k] == expected[k] && history.getTimes()[k] == expected[k] * 2;
+        }
+        if (!ok && mismatches++ == 0) {
+            fprintf(stderr, "capacity %zu: wrong history after sample %d\n", capacity, i);
+        }
+    }
+    uint64_t before = history.getSequence();
+    history.configure(capacity);
+    bool ok = mismatches == 0 && history.size() == 0 && history.getSequence() == before + 1;
+    fprintf(stderr, "capacity %-5zu %d samples  %s\n", capacity, SAMPLES, ok ? "ok" : "wrong");
+    return ok;
+}
+
+#ifdef __EMSCRIPTEN__
+// ns per dashboard refresh; -1 on a wrong read
+EM_JS(double, jsRefresh, (int by_view, int refreshes, int history, uint32_t topic_hash), {
+    const node = new Module['ROSSubscriberNodeWASM']('history_views_js', '/sensor_data');
+    if (!node.init()) return -1;
+    node.setHistoryCapacity(history);
+    for (let i = 0; i < history; i++) {
+        // A typed reading: magic, topic hash, seq, length, timestamp, then the record
+        const frame = new DataView(new ArrayBuffer(44));
+        frame.setUint32(0, 0x42534444, true);
+        frame.setUint32(4, topic_hash, true);
+        frame.setUint32(12, 20, true);
+        frame.setUint32(32, i, true);
+        frame.setFloat32(40, 20 + (i % 10), true);
+        const address = node.reserveBatchBuffer(48);
+        HEAPU8.set([44, 0, 0, 0], address);
+        HEAPU8.set(new Uint8Array(frame.buffer), address + 4);
+        node.processBatch(address, 48);
+    }
+
+    // Nothing arrives during the refreshes: the sequence must not move
+    const sequence = node.getChangeSequence();
+    let sum = 0;
+    const start = performance.now();
+    for (let r = 0; r < refreshes; r++) {
+        if (by_view) {
+            const bytes = node.getLastMessageView();
+            sum += new DataView(bytes.buffer, bytes.byteOffset, bytes.length).getFloat32(16, true);
+            const values = node.getValueHistory();
+            sum += values[values.length - 1];
+        } else {
+            const message = JSON.parse(node.getLastMessage());
+            sum += message.value * 2;
+        }
+    }
+    const ns = (performance.now() - start) * 1e6 / refreshes;
+    const unchanged = node.getChangeSequence() == sequence;
+    node.delete();
+    const expected = 2 * (20 + ((history - 1) % 10)) * refreshes;
+    return unchanged && Math.abs(sum - expected) < 1e-6 ? ns : -1;
+});
+#endif
+
+int main() {
+    bool ok = true;
+    for (size_t capacity : {1, 7, 256, 4096}) ok = checkHistory(capacity) && ok;
+
+#ifdef __EMSCRIPTEN__
+    double by_string = jsRefresh(0, REFRESHES, HISTORY, ddsTopicHash("/sensor_data"));
+    double by_view = jsRefresh(1, REFRESHES, HISTORY, ddsTopicHash("/sensor_data"));
+    fprintf(stderr, "refresh via getLastMessage() + JSON.parse  %7.1f ns\n", by_string);
+    fprintf(stderr, "refresh via views                          %7.1f ns\n", by_view);
+    ok = ok && by_string > 0 && by_view > 0 && by_view < by_string;
+#else
+    fprintf(stderr, "JS refresh   skipped (needs Node.js: views are typed arrays over WASM memory)\n");
+#endif
+
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,232 @@
+/*
+ * Network I/O hand-off benchmark
+ *
+ * 1. queue: PRODUCERS threads push FRAMES numbered frames each into an
+ *    IOHandoffWASM while a consumer, slowed to CONSUMER_COST_US per frame,
+ *    drains it in batches of BATCH after every wakeup. Every frame must be
+ *    delivered exactly once, in order per producer, or be counted as dropped
+ *    (the queue is smaller than the total on purpose), and wakeups must be
+ *    batched: far fewer than frames.
+ * 2. loopback (native only): DDS frames are sent over UDP to a participant on
+ *    127.0.0.1 whose socket is read by its I/O thread; a subscriber callback
+ *    of CONSUMER_COST_US drains them on this thread, woken by the hand-off.
+ *    Bursts of BURST frames stay below the buffer pool, so none may be lost.
+ * Reports throughput, wakeups, peak queue depth and hand-off latency.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -pthread -s PTHREAD_POOL_SIZE=4 -Isrc --bind bench/io_handoff.cpp -o io_handoff.js
+ * Run:            node io_handoff.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "dds_minimal_wasm.cpp"
+#include "io_handoff_wasm.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef __EMSCRIPTEN__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#define PRODUCERS 2
+#define FRAMES 20000
+#define QUEUE_FRAMES 1024
+#define BATCH 64
+#define CONSUMER_COST_US 5
+#define LOOPBACK_DOMAIN 42
+#define LOOPBACK_FRAMES 4000
+#define BURST 128
+#define TOPIC "/io_handoff"
+
+// Consumer side: sleeps until the hand-off's wakeup, like a main loop would
+struct Waker {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool pending = false;
+    uint64_t calls = 0;
+
+    static void onWake(void* context) {
+        Waker* self = static_cast<Waker*>(context);
+        std::lock_guard<std::mutex> lock(self->mutex);
+        self->pending = true;
+        self->calls++;
+        self->cv.notify_one();
+    }
+
+    void wait(int timeout_ms) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return pending; });
+        pending = false;
+    }
+};
+
+static void burn(double us) {
+    double until = emscripten_get_now() + us / 1000.0;
+    while (emscripten_get_now() < until) {}
+}
+
+static void report(const char* name, const IOHandoffStatsWASM& stats, double elapsed_ms) {
+    fprintf(stderr, "%-9s %llu delivered  %llu dropped  %llu wakeups  %.0f frames/s  depth peak %zu  "
+            "latency mean %.3f ms  max %.3f ms\n",
+            name, static_cast<unsigned long long>(stats.delivered), static_cast<unsigned long long>(stats.dropped),
+            static_cast<unsigned long long>(stats.wakeups),
+            elapsed_ms > 0 ? stats.delivered * 1000.0 / elapsed_ms : 0.0, stats.max_depth,
+            stats.mean_latency_ms, stats.max_latency_ms);
+}
+
+struct QueueCheck {
+    uint32_t next[PRODUCERS];
+    uint64_t out_of_order;
+    uint64_t delivered;
+};
+
+static void onQueueFrame(void* context, uint64_t source, const uint8_t* data, size_t length) {
+    QueueCheck* check = static_cast<QueueCheck*>(context);
+    uint32_t sequence;
+    memcpy(&sequence, data, sizeof(sequence));
+    // Drops leave gaps, never reorderings
+    if (source >= PRODUCERS || length != sizeof(sequence) || sequence < check->next[source]) {
+        check->out_of_order++;
+    } else {
+        check->next[source] = sequence + 1;
+    }
+    check->delivered++;
+    burn(CONSUMER_COST_US);
+}
+
+static bool runQueue() {
+    IOHandoffWASM handoff(QUEUE_FRAMES, sizeof(uint32_t));
+    Waker waker;
+    handoff.setWakeCallback(&Waker::onWake, &waker);
+    QueueCheck check = {};
+
+    std::atomic<int> running(PRODUCERS);
+    std::vector<std::thread> producers;
+    double start = emscripten_get_now();
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&handoff, &running, p] {
+            for (uint32_t i = 0; i < FRAMES; i++) {
+                handoff.push(reinterpret_cast<const uint8_t*>(&i), sizeof(i), p);
+                if (i % BATCH == 0) std::this_thread::yield();
+            }
+            running.fetch_sub(1);
+        });
+    }
+    while (running.load() > 0 || handoff.getDepth() > 0) {
+        if (handoff.getDepth() == 0) waker.wait(10);
+        handoff.drain(&onQueueFrame, &check, BATCH);
+    }
+    double elapsed = emscripten_get_now() - start;
+    for (std::thread& producer : producers) producer.join();
+
+    IOHandoffStatsWASM stats = handoff.getStats();
+    report("queue", stats, elapsed);
+    uint64_t total = static_cast<uint64_t>(PRODUCERS) * FRAMES;
+    bool ok = check.out_of_order == 0 && check.delivered == stats.delivered &&
+              stats.delivered + stats.dropped == total && stats.committed == stats.delivered &&
+              stats.wakeups == waker.calls && stats.wakeups * 4 < stats.delivered;
+    if (!ok) {
+        fprintf(stderr, "queue: %llu out of order, %llu + %llu of %llu accounted for\n",
+                static_cast<unsigned long long>(check.out_of_order), static_cast<unsigned long long>(stats.delivered),
+                static_cast<unsigned long long>(stats.dropped), static_cast<unsigned long long>(total));
+    }
+    return ok;
+}
+
+#ifndef __EMSCRIPTEN__
+static uint32_t loopback_received = 0;
+static uint32_t loopback_out_of_order = 0;
+
+static void onLoopbackPayload(void*, const uint8_t* payload, size_t length) {
+    uint32_t sequence = 0;
+    if (length >= sizeof(sequence)) memcpy(&sequence, payload, sizeof(sequence));
+    if (sequence != loopback_received) loopback_out_of_order++;
+    loopback_received++;
+    burn(CONSUMER_COST_US);
+}
+
+static bool runLoopback() {
+    Waker waker;  // Outlives the participant and its I/O thread
+    DDSParticipantWASM participant("io_handoff", LOOPBACK_DOMAIN);
+    DDSSubscriberWASM subscriber(&participant, TOPIC);
+    if (!participant.init() || !subscriber.init()) {
+        fprintf(stderr, "loopback: setup failed\n");
+        return false;
+    }
+    subscriber.setRawCallback(&onLoopbackPayload, nullptr);
+    NetworkManagerWASM* net_mgr = participant.getNetworkManager();
+    net_mgr->setReceiveWakeCallback(&Waker::onWake, &waker);
+    if (!participant.startIOThread()) {
+        fprintf(stderr, "loopback: no I/O thread\n");
+        return false;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(participant.getUnicastPort());
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    uint8_t frame[sizeof(DDSFrameHeader) + sizeof(uint32_t)];
+    DDSFrameHeader header = {};
+    header.magic = DDS_FRAME_MAGIC;
+    header.topic_hash = ddsTopicHash(TOPIC);
+    header.payload_length = sizeof(uint32_t);
+
+    std::thread sender([&] {
+        for (uint32_t i = 0; i < LOOPBACK_FRAMES; i++) {
+            header.sequence_number = i;
+            memcpy(frame, &header, sizeof(header));
+            memcpy(frame + sizeof(header), &i, sizeof(i));
+            sendto(fd, frame, sizeof(frame), 0, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+            // Bursts below the pool; the pause lets a CONSUMER_COST_US consumer catch up
+            if ((i + 1) % BURST == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(2 * BURST * CONSUMER_COST_US));
+            }
+        }
+    });
+
+    double start = emscripten_get_now();
+    double last_progress = start;
+    while (loopback_received < LOOPBACK_FRAMES && emscripten_get_now() - last_progress < 1000) {
+        if (!net_mgr->hasPendingReceives()) waker.wait(10);
+        uint32_t before = loopback_received;
+        net_mgr->pollUpTo(BATCH);
+        if (loopback_received != before) last_progress = emscripten_get_now();
+    }
+    double elapsed = emscripten_get_now() - start;
+    sender.join();
+    close(fd);
+
+    IOHandoffStatsWASM stats = net_mgr->getHandoff()->getStats();
+    report("loopback", stats, elapsed);
+    bool ok = loopback_received == LOOPBACK_FRAMES && loopback_out_of_order == 0 && stats.dropped == 0 &&
+              stats.wakeups < stats.delivered;
+    if (!ok) {
+        fprintf(stderr, "loopback: %u/%d received, %u out of order\n",
+                loopback_received, LOOPBACK_FRAMES, loopback_out_of_order);
+    }
+    return ok;
+}
+#endif
+
+int main() {
+    bool ok = runQueue();
+#ifndef __EMSCRIPTEN__
+    ok = runLoopback() && ok;
+#else
+    fprintf(stderr, "loopback  skipped (no UDP sockets under Emscripten)\n");
+#endif
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*
+ * JSON field extraction benchmark
+ *
+ * Compares JsonExtractorWASM with what the subscriber nodes did before:
+ * data.find("\"value\":") followed by sscanf("%lf"). Checks first:
+ * - compact and spaced payloads, exponents, negative numbers
+ * - a nested "value" and a "value" inside a string must not match
+ * - escaped quotes in strings, missing keys, malformed input
+ * Then times both on the publishers' sensor payload (padded with a long
+ * "note" string so the block scan matters), extracting the value alone and
+ * all four sensor fields. The extractor must be faster in both cases.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -msimd128 -Isrc bench/json_extract.cpp -o json_extract.js
+ * Run:            node json_extract.js   (exit code 0 = pass)
+ */
+
+#include "json_extract_wasm.h"
+#include "platform_wasm.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define MESSAGES 2000
+#define ROUNDS 200
+
+struct Case {
+    const char* json;
+    bool found;
+    double value;
+};
+
+static const Case cases[] = {
+    {"{\"id\": 1, \"sensor\": \"temperature\", \"value\": 23.45, \"unit\": \"celsius\"}", true, 23.45},
+    {"{\"id\":1,\"sensor\":\"temperature\",\"value\":23.45,\"unit\":\"celsius\"}", true, 23.45},
+    {"  {\n\t\"value\" :\n -1.5e3 }", true, -1500},
+    {"{\"meta\": {\"value\": 99}, \"value\": 7}", true, 7},
+    {"{\"note\": \"\\\"value\\\": 99\", \"value\": 8}", true, 8},
+    {"{\"list\": [1, {\"value\": 2}, \"]\"], \"value\": 9}", true, 9},
+    {"{\"id\": 3, \"unit\": \"celsius\"}", false, 0},
+    {"{\"value\": \"23.5\"}", false, 0},
+    {"{\"value\": }", false, 0},
+    {"[{\"value\": 1}]", false, 0},
+    {"", false, 0},
+};
+
+static bool checkCases() {
+    JsonExtractorWASM extractor({"value"});
+    bool ok = true;
+    for (const Case& c : cases) {
+        JsonFieldWASM value;
+        extractor.extract(c.json, strlen(c.json), &value);
+        bool found = value.type == JSON_FIELD_NUMBER;
+        if (found != c.found || (found && std::fabs(value.number - c.value) > 1e-9)) {
+            fprintf(stderr, "wrong result for %s: %s %g\n", c.json, found ? "found" : "missing", value.number);
+            ok = false;
+        }
+    }
+
+    const char* payload = "{\"id\":42,\"sensor\":\"temp\\\"erature\",\"ok\":true,\"value\":-0.25,\"unit\":\"celsius\"}";
+    JsonExtractorWASM fields({"id", "sensor", "value", "unit", "ok", "absent"});
+    JsonFieldWASM out[6];
+    size_t found = fields.extract(payload, strlen(payload), out);
+    ok = ok && found == 5 && out[0].number == 42 && std::string(out[1].text, out[1].length) == "temp\\\"erature" &&
+         out[2].number == -0.25 && std::string(out[3].text, out[3].length) == "celsius" &&
+         out[4].type == JSON_FIELD_BOOL && out[4].number == 1 && out[5].type == JSON_FIELD_MISSING;
+    fprintf(stderr, "%zu cases + multi-field payload: %s\n", sizeof(cases) / sizeof(cases[0]), ok ? "ok" : "wrong");
+    return ok;
+}
+
+// The subscriber nodes' old parsing
+static double baselineValue(const std::string& data) {
+    double value = 0;
+    size_t pos = data.find("\"value\":");
+    if (pos != std::string::npos) sscanf(data.c_str() + pos + 8, "%lf", &value);
+    return value;
+}
+
+static double baselineFields(const std::string& data, double* id, std::string* sensor, std::string* unit) {
+    size_t pos = data.find("\"id\":");
+    if (pos != std::string::npos) sscanf(data.c_str() + pos + 5, "%lf", id);
+    char text[64];
+    pos = data.find("\"sensor\":");
+    if (pos != std::string::npos && sscanf(data.c_str() + pos + 9, " \"%63[^\"]\"", text) == 1) *sensor = text;
+    pos = data.find("\"unit\":");
+    if (pos != std::string::npos && sscanf(data.c_str() + pos + 7, " \"%63[^\"]\"", text) == 1) *unit = text;
+    return baselineValue(data);
+}
+
+int main() {
+    bool ok = checkCases();
+
+    // ros_publisher_wasm.cpp's format, with the value after a longer string
+    std::vector<std::string> messages;
+    char buffer[512];
+    for (int i = 0; i < MESSAGES; i++) {
+        snprintf(buffer, sizeof(buffer),
+                 "{\"id\": %d, \"sensor\": \"temperature\", \"note\": \"calibrated 2024-01-01 by the "
+                 "field team, rack %d\", \"value\": %.2f, \"unit\": \"celsius\"}",
+                 i, i % 7, 20.0 + (i % 100) * 0.1);
+        messages.push_back(buffer);
+    }
+
+    JsonExtractorWASM value_field({"value"});
+    JsonExtractorWASM sensor_fields({"id", "sensor", "value", "unit"});
+    double sum_old = 0, sum_new = 0, sum_old4 = 0, sum_new4 = 0;
+    size_t text_old = 0, text_new = 0;
+
+    double start = emscripten_get_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (const std::string& m : messages) sum_old += baselineValue(m);
+    }
+    double old_ns = (emscripten_get_now() - start) * 1e6 / (ROUNDS * MESSAGES);
+
+    start = emscripten_get_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (const std::string& m : messages) {
+            JsonFieldWASM value;
+            value_field.extract(m.data(), m.size(), &value);
+            sum_new += value.number;
+        }
+    }
+    double new_ns = (emscripten_get_now() - start) * 1e6 / (ROUNDS * MESSAGES);
+
+    start = emscripten_get_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (const std::string& m : messages) {
+            double id = 0;
+            std::string sensor, unit;
+            sum_old4 += baselineFields(m, &id, &sensor, &unit) + id;
+            text_old += sensor.size() + unit.size();
+        }
+    }
+    double old4_ns = (emscripten_get_now() - start) * 1e6 / (ROUNDS * MESSAGES);
+
+    start = emscripten_get_now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (const std::string& m : messages) {
+            JsonFieldWASM fields[4];
+            sensor_fields.extract(m.data(), m.size(), fields);
+            sum_new4 += fields[2].number + fields[0].number;
+            text_new += fields[1].length + fields[3].length;
+        }
+    }
+    double new4_ns = (emscripten_get_now() - start) * 1e6 / (ROUNDS * MESSAGES);
+
+    fprintf(stderr, "block %d bytes, from_chars %s\n", JSON_EXTRACT_WASM_BLOCK,
+            JSON_EXTRACT_WASM_FROM_CHARS ? "yes" : "no (strtod)");
+    fprintf(stderr, "value only:  find+sscanf %7.1f ns/msg  extractor %6.1f ns/msg  (%.1fx)\n",
+            old_ns, new_ns, old_ns / new_ns);
+    fprintf(stderr, "four fields: find+sscanf %7.1f ns/msg  extractor %6.1f ns/msg  (%.1fx)\n",
+            old4_ns, new4_ns, old4_ns / new4_ns);
+
+    bool same = std::fabs(sum_old - sum_new) < 1e-6 * std::fabs(sum_old) &&
+                std::fabs(sum_old4 - sum_new4) < 1e-6 * std::fabs(sum_old4) && text_old == text_new;
+    if (!same) fprintf(stderr, "results differ from the baseline\n");
+    ok = ok && same && new_ns < old_ns && new4_ns < old4_ns;
+
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * Load generator runs
+ *
+ * ROSPublisherNodeWASM in load mode, from the same source for both builds:
+ * under Node.js the node's main loop timer (setTimeout) drives the sends,
+ * natively runLoad() pumps the same loop. With a profile on the command line
+ * (load_generator_wasm.h format) runs it and prints the report; otherwise
+ * runs PROFILES and checks against each one's schedule:
+ * - every scheduled message was sent, round robin over the topics
+ * - the actual rate is within RATE_TOLERANCE of the target (bursts included)
+ * - payload sizes follow the distribution (mean within tolerance)
+ * - burst windows carry their share of the messages
+ * Lag (send time - due time) is reported; it shows the host timer's
+ * granularity and is not checked.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/load_generator.cpp -o load_generator.js
+ * Run:            node load_generator.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ *                 node load_generator.js rate=5000 topics=8 duration=10000 payload=exp:512-8192 burst=1000:100:4
+ */
+
+#include "ros_publisher_wasm.cpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#define RATE_TOLERANCE 0.03
+
+struct LoadCase {
+    const char* profile;
+    double expected_payload_mean;  // 0 = not checked
+};
+
+static const LoadCase PROFILES[] = {
+    {"rate=2000 topics=1 duration=1000 payload=fixed:80", 80},
+    {"rate=5000 topics=8 duration=1000 payload=uniform:32-1024 seed=7", 528},
+    {"rate=1000 topics=4 duration=1000 payload=exp:256-4096 burst=250:50:10 seed=3", 256},
+};
+
+static ROSPublisherNodeWASM* node = nullptr;
+static std::string custom_profile;
+static size_t next_case = 0;
+static bool all_ok = true;
+
+// Report of the run that just finished; checks it unless it was a custom profile
+static bool finishRun(const char* profile, double expected_payload_mean) {
+    LoadProfileWASM p;
+    LoadGeneratorWASM::parseProfile(profile, &p);
+    double sent = node->getLoadSent();
+    double target = node->getLoadTargetRate();
+    double actual = node->getLoadActualRate();
+    double payload_mean = sent > 0 ? node->getLoadBytesSent() / sent : 0;
+    fprintf(stderr, "%s\n  sent %.0f, %.0f/s (target %.0f/s), payload mean %.0f B, lag mean %.3f ms p99 %.3f ms max %.3f ms\n",
+            profile, sent, actual, target, payload_mean, node->getLoadMeanLagMs(), node->getLoadP99LagMs(),
+            node->getLoadMaxLagMs());
+    if (custom_profile.size()) {
+        printf("%s\n", node->getLoadReport().c_str());
+        return true;
+    }
+
+    // The schedule is deterministic: count its due times inside the duration
+    double due = 0, expected = 0, expected_burst = 0;
+    while (due < p.duration_ms) {
+        bool burst = p.burst_period_ms > 0 && std::fmod(due, p.burst_period_ms) < p.burst_length_ms;
+        expected++;
+        if (burst) expected_burst++;
+        due += 1000.0 / (p.rate_hz * (burst ? p.burst_factor : 1.0));
+    }
+    // Due times are summed from the start time, not from 0: allow a message of
+    // slack at the end and at each burst window edge
+    bool all_sent = std::fabs(sent - expected) <= 1;
+    bool rate_ok = std::fabs(actual - target) <= RATE_TOLERANCE * target;
+    bool payload_ok = expected_payload_mean <= 0 ||
+                      std::fabs(payload_mean - expected_payload_mean) <= 0.1 * expected_payload_mean;
+    std::string report = node->getLoadReport();
+    size_t field = report.find("\"burst_sent\": ");
+    double burst_sent = field == std::string::npos ? -1 : atof(report.c_str() + field + 14);
+    double burst_windows = p.burst_period_ms > 0 ? std::ceil(p.duration_ms / p.burst_period_ms) : 0;
+    bool burst_ok = std::fabs(burst_sent - expected_burst) <= 2 * burst_windows;
+    fprintf(stderr, "  all scheduled sent %s (%.0f), rate %s, payload %s, bursts %s (%.0f of %.0f in bursts)\n",
+            all_sent ? "ok" : "wrong", expected, rate_ok ? "ok" : "wrong", payload_ok ? "ok" : "wrong",
+            burst_ok ? "ok" : "wrong", burst_sent, expected_burst);
+    return all_sent && rate_ok && payload_ok && burst_ok;
+}
+
+static bool startRun(const char* profile) {
+    return node->startLoad(profile);
+}
+
+static int finish() {
+    if (custom_profile.empty()) fprintf(stderr, "%s\n", all_ok ? "PASS" : "FAIL");
+    return all_ok ? 0 : 1;
+}
+
+#ifdef __EMSCRIPTEN__
+// The node's main loop timer sends; this only watches for the end of each run
+static void watch(void*) {
+    if (node->isLoadRunning()) {
+        emscripten_set_timeout(watch, 50, nullptr);
+        return;
+    }
+    const char* profile = custom_profile.size() ? custom_profile.c_str() : PROFILES[next_case].profile;
+    all_ok = finishRun(profile, custom_profile.size() ? 0 : PROFILES[next_case].expected_payload_mean) && all_ok;
+    next_case++;
+    if (custom_profile.empty() && next_case < sizeof(PROFILES) / sizeof(PROFILES[0])) {
+        all_ok = startRun(PROFILES[next_case].profile) && all_ok;
+        emscripten_set_timeout(watch, 50, nullptr);
+        return;
+    }
+    node->stopMainLoop();
+    emscripten_force_exit(finish());
+}
+#endif
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (i > 1) custom_profile += ' ';
+        custom_profile += argv[i];
+    }
+    node = new ROSPublisherNodeWASM("load_generator", "/load");
+    if (!node->init()) return 1;
+
+    size_t runs = custom_profile.size() ? 1 : sizeof(PROFILES) / sizeof(PROFILES[0]);
+#ifdef __EMSCRIPTEN__
+    if (!startRun(custom_profile.size() ? custom_profile.c_str() : PROFILES[0].profile)) return 1;
+    (void)runs;
+    emscripten_set_timeout(watch, 50, nullptr);
+    emscripten_exit_with_live_runtime();
+    return 0;
+#else
+    for (next_case = 0; next_case < runs; next_case++) {
+        const char* profile = custom_profile.size() ? custom_profile.c_str() : PROFILES[next_case].profile;
+        if (!startRun(profile)) return 1;
+        node->runLoad();
+        all_ok = finishRun(profile, custom_profile.size() ? 0 : PROFILES[next_case].expected_payload_mean) && all_ok;
+    }
+    return finish();
+#endif
+}
@@ -0,0 +1,182 @@
+/*
+ * Logging overhead benchmark
+ *
+ * The same per-message loop (a little arithmetic standing in for a receive)
+ * with one log statement per message, as the hot paths have:
+ * - none:          no statement (baseline)
+ * - compiled out:  WASM_LOG_DEBUG in a build at the default level
+ * - disabled:      compiled in, below the run-time level (setLevel)
+ * - recorded:      compiled in and enabled, recorded to the ring; flushed
+ *                  every FLUSH_EVERY messages outside the timed part
+ * - printf:        the old direct printf to stdout
+ * Checks LogWASM first: formatted lines, truncated string arguments, drops
+ * when the ring is full, the statistics. Compiled out must cost about the
+ * baseline, and recording must be cheaper than printf.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc bench/log_overhead.cpp -o log_overhead.js
+ * Run:            node log_overhead.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "log_wasm.h"
+#include "platform_wasm.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define MESSAGES 200000
+#define FLUSH_EVERY 256
+#define REPEATS 5
+
+static volatile double sink_value;
+static std::vector<std::string> captured;
+
+static void captureLine(int, const char* line) { captured.push_back(line); }
+
+static inline double receive(uint32_t i) { return 20.0 + (i % 10) * 0.25; }
+
+typedef double (*LoopFn)(uint32_t first, uint32_t count);
+
+static double loopNone(uint32_t first, uint32_t count) {
+    double sum = 0;
+    for (uint32_t i = first; i < first + count; i++) {
+        double value = receive(i);
+        sum += value;
+    }
+    return sum;
+}
+
+// LOG_WASM_LEVEL is read where a statement expands, so each loop gets its own
+#undef LOG_WASM_LEVEL
+#define LOG_WASM_LEVEL LOG_WASM_LEVEL_INFO
+static double loopCompiledOut(uint32_t first, uint32_t count) {
+    double sum = 0;
+    for (uint32_t i = first; i < first + count; i++) {
+        double value = receive(i);
+        WASM_LOG_DEBUG("WASM: Received message %u on '%s': %.2f\n", i, "/sensor_data", value);
+        sum += value;
+    }
+    return sum;
+}
+
+#undef LOG_WASM_LEVEL
+#define LOG_WASM_LEVEL LOG_WASM_LEVEL_DEBUG
+static double loopLogged(uint32_t first, uint32_t count) {
+    double sum = 0;
+    for (uint32_t i = first; i < first + count; i++) {
+        double value = receive(i);
+        WASM_LOG_DEBUG("WASM: Received message %u on '%s': %.2f\n", i, "/sensor_data", value);
+        sum += value;
+    }
+    return sum;
+}
+
+static double loopPrintf(uint32_t first, uint32_t count) {
+    double sum = 0;
+    for (uint32_t i = first; i < first + count; i++) {
+        double value = receive(i);
+        printf("WASM: Received message %u on '%s': %.2f\n", i, "/sensor_data", value);
+        sum += value;
+    }
+    return sum;
+}
+
+static bool checkLogger() {
+    LogWASM::setSink(&captureLine);
+    LogWASM::setLevel(LOG_WASM_LEVEL_DEBUG);
+    LogWASM::flush();
+    captured.clear();
+    LogStatsWASM before = LogWASM::getStats();
+
+    std::string long_text(200, 'x');
+    WASM_LOG_DEBUG("WASM: plain\n");
+    WASM_LOG_INFO("WASM: %d %u %lld %.3f %c %s|%s\n", -7, 42u, -1234567890123LL, 2.5, 'z', "topic", "");
+    WASM_LOG_DEBUG("WASM: long %s|%s\n", long_text.c_str(), "after");
+    LogWASM::flush();
+
+    std::string truncated(LOG_WASM_TEXT_BYTES - 1, 'x');
+    bool ok = captured.size() == 3 && captured[0] == "WASM: plain\n" &&
+              captured[1] == "WASM: -7 42 -1234567890123 2.500 z topic|\n" &&
+              captured[2] == "WASM: long " + truncated + "|\n";
+    fprintf(stderr, "formatted lines, truncated strings: %s\n", ok ? "ok" : "wrong");
+    for (size_t i = 0; !ok && i < captured.size(); i++) fprintf(stderr, "  %s", captured[i].c_str());
+
+    // Statements below the run-time level record nothing
+    LogWASM::setLevel(LOG_WASM_LEVEL_WARN);
+    WASM_LOG_INFO("WASM: not recorded %d\n", 1);
+    LogWASM::setLevel(LOG_WASM_LEVEL_DEBUG);
+
+    // Overfill the ring before any flush: the rest are dropped, not waited for
+    const int attempts = 4 * LOG_WASM_RING_ENTRIES;
+    LogStatsWASM mid = LogWASM::getStats();
+    for (int i = 0; i < attempts; i++) WASM_LOG_DEBUG("WASM: fill %d\n", i);
+    LogStatsWASM full = LogWASM::getStats();
+    LogWASM::flush();
+    LogStatsWASM after = LogWASM::getStats();
+
+    uint64_t recorded = full.recorded - mid.recorded;
+    uint64_t dropped = full.dropped - mid.dropped;
+    bool counts = mid.recorded - before.recorded == 3 && recorded + dropped == attempts && dropped > 0 &&
+                  after.flushed - before.flushed == 3 + recorded && captured.size() == 3 + recorded;
+    fprintf(stderr, "ring full: %llu recorded, %llu dropped, statistics %s\n",
+            static_cast<unsigned long long>(recorded), static_cast<unsigned long long>(dropped),
+            counts ? "ok" : "wrong");
+
+    LogWASM::setSink(nullptr);
+    captured.clear();
+    return ok && counts;
+}
+
+// Best of REPEATS, ns per message; the flush between chunks is not timed
+static double timeLoop(LoopFn loop) {
+    double best = 0;
+    for (int r = 0; r < REPEATS; r++) {
+        double elapsed = 0;
+        for (uint32_t first = 0; first < MESSAGES; first += FLUSH_EVERY) {
+            uint32_t count = MESSAGES - first < FLUSH_EVERY ? MESSAGES - first : FLUSH_EVERY;
+            double start = emscripten_get_now();
+            sink_value = loop(first, count);
+            elapsed += emscripten_get_now() - start;
+            LogWASM::flush();
+            fflush(stdout);
+        }
+        double ns = elapsed * 1e6 / MESSAGES;
+        if (r == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+int main() {
+    bool ok = checkLogger();
+
+    // stdout is where both the ring and printf write; the bench runs with
+    // stdout to /dev/null, so the two pay the same for the bytes themselves
+    LogWASM::setLevel(LOG_WASM_LEVEL_DEBUG);
+    double none = timeLoop(&loopNone);
+    double compiled_out = timeLoop(&loopCompiledOut);
+    LogWASM::setLevel(LOG_WASM_LEVEL_INFO);
+    double disabled = timeLoop(&loopLogged);
+    LogWASM::setLevel(LOG_WASM_LEVEL_DEBUG);
+    LogStatsWASM before = LogWASM::getStats();
+    double recorded = timeLoop(&loopLogged);
+    LogStatsWASM after = LogWASM::getStats();
+    double direct = timeLoop(&loopPrintf);
+
+    fprintf(stderr, "%d messages, one log statement each\n", MESSAGES);
+    fprintf(stderr, "  none           %7.2f ns/msg\n", none);
+    fprintf(stderr, "  compiled out   %7.2f ns/msg\n", compiled_out);
+    fprintf(stderr, "  disabled       %7.2f ns/msg\n", disabled);
+    fprintf(stderr, "  recorded       %7.2f ns/msg  (%llu dropped)\n", recorded,
+            static_cast<unsigned long long>(after.dropped - before.dropped));
+    fprintf(stderr, "  printf         %7.2f ns/msg  (%.1fx recorded)\n", direct, direct / recorded);
+
+    // Compiled out is the same loop as none; allow for timer noise
+    ok = ok && compiled_out < none * 1.5 + 1.0 && recorded < direct &&
+         after.recorded - before.recorded == static_cast<uint64_t>(REPEATS) * MESSAGES;
+
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
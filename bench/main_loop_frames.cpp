@@ -0,0 +1,129 @@
+/*
+ * Main loop frame budget benchmark
+ *
+ * Drives an executor through MainLoopDriverWASM the way requestAnimationFrame
+ * would (one pump() per simulated 16.7 ms frame) and reports the time spent
+ * in each frame:
+ * - idle:  no data and no timer due; frames must not spin at all
+ * - burst: a full subscription queue with a slow callback, BURSTS times; the
+ *          work must be spread over several frames, none as long as a whole burst
+ *          (the budget plus one callback, with headroom for host preemption)
+ * - timer: a 50 Hz timer alone; frames spin only when it is due
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/main_loop_frames.cpp -o main_loop_frames.js
+ * Run:            node main_loop_frames.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "rcl_port_wasm.cpp"
+#include "rclc_port_wasm.cpp"
+#include "rosidl_typesupport_wasm.h"
+#include <cstdio>
+
+#define FRAME_MS 16.7
+#define BUDGET_MS 4.0
+#define BURSTS 20
+#define CALLBACK_COST_MS 1.0
+#define TIMER_PERIOD_NS 20000000  // 50 Hz
+
+static int received = 0;
+static int ticks = 0;
+
+static void onMessage(const void* /* msg */) {
+    double until = emscripten_get_now() + CALLBACK_COST_MS;
+    while (emscripten_get_now() < until) {}
+    received++;
+}
+
+static void onTick(rcl_timer_t*, int64_t) {
+    ticks++;
+}
+
+static void waitForNextFrame(double frame_start) {
+    while (emscripten_get_now() - frame_start < FRAME_MS) {}
+}
+
+static void report(const char* name, const MainLoopDriverWASM& driver) {
+    const MainLoopFrameStatsWASM& stats = driver.getStats();
+    fprintf(stderr, "%-6s %llu frames, %llu busy, %llu deferred, %llu spins, frame mean %.3f ms  max %.3f ms\n",
+            name, static_cast<unsigned long long>(stats.frames), static_cast<unsigned long long>(stats.busy_frames),
+            static_cast<unsigned long long>(stats.deferred_frames), static_cast<unsigned long long>(stats.slices),
+            driver.getMeanFrameMs(), stats.max_frame_ms);
+}
+
+int main() {
+    rclc_support_t support;
+    rcl_node_t node;
+    rcl_publisher_t publisher;
+    rcl_subscription_t subscription;
+    rcl_timer_t timer;
+    rclc_executor_t executor;
+    std_msgs__msg__Float64 msg;
+    rcl_allocator_t allocator = rcl_get_default_allocator();
+
+    if (rclc_support_init(&support, 0, NULL, &allocator) != RCL_RET_OK ||
+        rclc_node_init_default(&node, "main_loop_frames", "", &support) != RCL_RET_OK ||
+        rclc_publisher_init_default(&publisher, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Float64),
+                                    "/main_loop_frames") != RCL_RET_OK ||
+        rclc_subscription_init_default(&subscription, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Float64),
+                                       "/main_loop_frames") != RCL_RET_OK ||
+        rclc_executor_init(&executor, support.context, 2, &allocator) != RCL_RET_OK ||
+        rclc_executor_add_subscription(&executor, &subscription, &msg, onMessage, ON_NEW_DATA) != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+
+    MainLoopDriverWASM driver(rclc_executor_main_loop_work(&executor));
+    rcl_context_add_activity_listener(support.context, &MainLoopDriverWASM::onActivity, &driver);
+    driver.start(MAIN_LOOP_ANIMATION_FRAME, BUDGET_MS);
+    driver.pump();  // Drains the start-up notification
+    driver.resetStats();
+
+    for (int i = 0; i < 30; i++) {
+        driver.pump();
+    }
+    report("idle", driver);
+    bool idle_ok = driver.getStats().busy_frames == 0;
+
+    // Each burst fills the subscription queue; at CALLBACK_COST_MS per message it
+    // takes several frames to drain
+    driver.resetStats();
+    for (int burst = 0; burst < BURSTS; burst++) {
+        for (int i = 0; i < RMW_WASM_SUBSCRIPTION_DEPTH; i++) {
+            msg.data = i;
+            rcl_publish(&publisher, &msg, NULL);
+        }
+        for (int frame = 0; frame < 100 && received < (burst + 1) * RMW_WASM_SUBSCRIPTION_DEPTH; frame++) {
+            double frame_start = emscripten_get_now();
+            driver.pump();
+            waitForNextFrame(frame_start);
+        }
+    }
+    report("burst", driver);
+    const MainLoopFrameStatsWASM& burst_stats = driver.getStats();
+    bool burst_ok = received == BURSTS * RMW_WASM_SUBSCRIPTION_DEPTH && burst_stats.deferred_frames > 0 &&
+                    burst_stats.max_frame_ms < RMW_WASM_SUBSCRIPTION_DEPTH * CALLBACK_COST_MS;
+
+    rclc_timer_init_default(&timer, &support, TIMER_PERIOD_NS, onTick);
+    rclc_executor_add_timer(&executor, &timer);
+    driver.resetStats();
+    for (int i = 0; i < 60; i++) {
+        double frame_start = emscripten_get_now();
+        driver.pump();
+        waitForNextFrame(frame_start);
+    }
+    report("timer", driver);
+    const MainLoopFrameStatsWASM& timer_stats = driver.getStats();
+    bool timer_ok = ticks > 0 && timer_stats.busy_frames < timer_stats.frames;
+
+    driver.stop();
+    rcl_context_remove_activity_listener(support.context, &MainLoopDriverWASM::onActivity, &driver);
+    rcl_timer_fini(&timer);
+    rclc_executor_fini(&executor);
+
+    if (!idle_ok || !burst_ok || !timer_ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,233 @@
+/*
+ * Multi-topic node benchmark
+ *
+ * A device with N sensor topics, each with a publisher and a subscription,
+ * built two ways:
+ * - per topic: what ROSPublisherNodeWASM::init() and ROSSubscriberNodeWASM::init()
+ *   create for each topic, a DDS participant (with its own network manager
+ *   and sockets) plus one endpoint; 2N participants.
+ * - shared:    one ROSMultiTopicNodeWASM with N publishers and N subscriptions
+ * Reports heap bytes per topic (operator new, aligned too; the frame buffers come from
+ * the rcl allocator and are the same either way), sockets in all, discovery
+ * bytes and datagrams per topic per announcement round, and the time of one
+ * spin of every topic. Checks first that the heap counter frees what it counts
+ * (aligned blocks too) and that the shared node delivers each topic's readings
+ * to that topic's subscription only.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/multi_topic.cpp -o multi_topic.js
+ * Run:            node multi_topic.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "multi_topic_node_wasm.cpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#define SPINS 200
+
+// Live heap bytes through operator new. Every form of new and delete goes
+// through countedNew/countedDelete, so a block is always freed with the offset
+// it was allocated with: the pointer sits one alignment (at least 16) into the
+// block and the size in the 16 bytes in front of it.
+static std::atomic<size_t> heap_bytes(0);
+
+static size_t blockAlignment(size_t align) {
+    return align < 16 ? 16 : align;
+}
+
+static void* countedNew(size_t size, size_t align) {
+    size_t alignment = blockAlignment(align);
+    char* block = static_cast<char*>(aligned_alloc(alignment, (size + 2 * alignment - 1) / alignment * alignment));
+    if (!block) throw std::bad_alloc();
+    *reinterpret_cast<size_t*>(block + alignment - 16) = size;
+    heap_bytes += size;
+    return block + alignment;
+}
+
+static void countedDelete(void* pointer, size_t align) noexcept {
+    if (!pointer) return;
+    size_t alignment = blockAlignment(align);
+    char* block = static_cast<char*>(pointer) - alignment;
+    heap_bytes -= *reinterpret_cast<size_t*>(block + alignment - 16);
+    free(block);
+}
+
+void* operator new(size_t size) { return countedNew(size, 16); }
+void* operator new[](size_t size) { return countedNew(size, 16); }
+void operator delete(void* pointer) noexcept { countedDelete(pointer, 16); }
+void operator delete[](void* pointer) noexcept { countedDelete(pointer, 16); }
+void operator delete(void* pointer, size_t) noexcept { countedDelete(pointer, 16); }
+void operator delete[](void* pointer, size_t) noexcept { countedDelete(pointer, 16); }
+
+// Over-aligned types (the entities' cache-line metrics)
+void* operator new(size_t size, std::align_val_t align) { return countedNew(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return countedNew(size, static_cast<size_t>(align)); }
+void operator delete(void* pointer, std::align_val_t align) noexcept {
+    countedDelete(pointer, static_cast<size_t>(align));
+}
+void operator delete[](void* pointer, std::align_val_t align) noexcept {
+    countedDelete(pointer, static_cast<size_t>(align));
+}
+void operator delete(void* pointer, size_t, std::align_val_t align) noexcept {
+    countedDelete(pointer, static_cast<size_t>(align));
+}
+void operator delete[](void* pointer, size_t, std::align_val_t align) noexcept {
+    countedDelete(pointer, static_cast<size_t>(align));
+}
+
+struct alignas(64) CacheLine {
+    char bytes[64];
+};
+
+// The counter itself: plain and over-aligned objects and arrays come back aligned and leave nothing counted
+static bool checkCounter() {
+    size_t before = heap_bytes;
+    CacheLine* line = new CacheLine();
+    CacheLine* lines = new CacheLine[3];
+    std::string* text = new std::string(32, 'x');
+    bool aligned = reinterpret_cast<uintptr_t>(line) % alignof(CacheLine) == 0 &&
+                   reinterpret_cast<uintptr_t>(lines) % alignof(CacheLine) == 0;
+    size_t counted = heap_bytes - before;
+    delete text;
+    delete[] lines;
+    delete line;
+    size_t left = heap_bytes - before;
+    fprintf(stderr, "counter: %zu B for 4 cache lines and a string, %zu B after delete, %s\n", counted, left,
+            aligned ? "64-byte aligned" : "NOT 64-byte aligned");
+    return aligned && counted > 4 * sizeof(CacheLine) && left == 0;
+}
+
+struct ModelCost {
+    double heap_bytes;
+    int sockets;
+    double discovery_bytes;
+    double discovery_datagrams;
+    double spin_us;
+    bool ok;
+};
+
+static std::string topicName(int i) {
+    return "/device/sensor_" + std::to_string(i);
+}
+
+static ModelCost perTopic(int topics) {
+    ModelCost cost = {};
+    size_t heap_before = heap_bytes;
+    const rosidl_message_type_support_t* ts = ROSIDL_GET_MSG_TYPE_SUPPORT(wasm_msgs, msg, SensorReading);
+    std::vector<DDSParticipantWASM*> participants;
+    std::vector<DDSPublisherWASM*> publishers;
+    std::vector<DDSSubscriberWASM*> subscribers;
+    cost.ok = true;
+    for (int i = 0; i < topics; i++) {
+        DDSParticipantWASM* pub_participant = new DDSParticipantWASM("pub_" + std::to_string(i), 0);
+        DDSParticipantWASM* sub_participant = new DDSParticipantWASM("sub_" + std::to_string(i), 0);
+        participants.push_back(pub_participant);
+        participants.push_back(sub_participant);
+        if (!pub_participant->init() || !sub_participant->init()) {
+            cost.ok = false;
+            break;
+        }
+        DDSPublisherWASM* publisher = new DDSPublisherWASM(pub_participant, topicName(i), ts->type_name, ts->type_hash);
+        DDSSubscriberWASM* subscriber =
+            new DDSSubscriberWASM(sub_participant, topicName(i), ts->type_name, ts->type_hash);
+        publishers.push_back(publisher);
+        subscribers.push_back(subscriber);
+        cost.ok = cost.ok && publisher->init() && publisher->reserveFrame(sizeof(wasm_msgs__msg__SensorReading)) &&
+                  subscriber->init();
+    }
+    cost.heap_bytes = static_cast<double>(heap_bytes - heap_before) / topics;
+    cost.sockets = 2 * static_cast<int>(participants.size());
+
+    if (cost.ok) {
+        uint64_t bytes = 0, datagrams = 0;
+        for (DDSParticipantWASM* participant : participants) {
+            uint64_t b = participant->getNetworkManager()->getDiscoveryBytesSent();
+            uint64_t d = participant->getNetworkManager()->getDiscoveryDatagramsSent();
+            participant->discoverParticipants();
+            bytes += participant->getNetworkManager()->getDiscoveryBytesSent() - b;
+            datagrams += participant->getNetworkManager()->getDiscoveryDatagramsSent() - d;
+        }
+        cost.discovery_bytes = static_cast<double>(bytes) / topics;
+        cost.discovery_datagrams = static_cast<double>(datagrams) / topics;
+
+        double start = emscripten_get_now();
+        for (int s = 0; s < SPINS; s++) {
+            for (DDSParticipantWASM* participant : participants) participant->discoverParticipants();
+        }
+        cost.spin_us = (emscripten_get_now() - start) * 1000.0 / SPINS;
+    }
+
+    for (DDSPublisherWASM* publisher : publishers) delete publisher;
+    for (DDSSubscriberWASM* subscriber : subscribers) delete subscriber;
+    for (DDSParticipantWASM* participant : participants) delete participant;
+    return cost;
+}
+
+static ModelCost shared(int topics) {
+    ModelCost cost = {};
+    size_t heap_before = heap_bytes;
+    ROSMultiTopicNodeWASM* node = new ROSMultiTopicNodeWASM("device", 0);
+    cost.ok = node->init();
+    for (int i = 0; cost.ok && i < topics; i++) {
+        cost.ok = node->addPublisher(topicName(i), i % 3) == i && node->addSubscription(topicName(i)) == i;
+    }
+    cost.heap_bytes = static_cast<double>(heap_bytes - heap_before) / topics;
+    cost.sockets = 2;
+
+    if (cost.ok) {
+        // Each reading reaches its own topic's subscription, through the participant
+        for (int i = 0; i < topics; i++) node->publishReading(i, 100.0 + i);
+        for (int i = 0; i < topics; i++) {
+            if (node->getMessagesReceived(i) != 1 || node->getLastValue(i) != 100.0 + i) {
+                fprintf(stderr, "topic %d: %d messages, last value %.1f\n", i, node->getMessagesReceived(i),
+                        node->getLastValue(i));
+                cost.ok = false;
+            }
+        }
+
+        double bytes = node->getDiscoveryBytesSent();
+        double datagrams = node->getDiscoveryDatagramsSent();
+        node->spinOnce();
+        cost.discovery_bytes = (node->getDiscoveryBytesSent() - bytes) / topics;
+        cost.discovery_datagrams = (node->getDiscoveryDatagramsSent() - datagrams) / topics;
+
+        double start = emscripten_get_now();
+        for (int s = 0; s < SPINS; s++) node->spinOnce();
+        cost.spin_us = (emscripten_get_now() - start) * 1000.0 / SPINS;
+    }
+
+    delete node;
+    return cost;
+}
+
+int main() {
+    bool ok = checkCounter();
+    fprintf(stderr, "%-7s %-10s %10s %8s %13s %10s %10s\n", "topics", "model", "heap B/top", "sockets",
+            "disc B/top", "disc dg/top", "spin us");
+    for (int topics : {1, 5, 20}) {
+        ModelCost separate = perTopic(topics);
+        ModelCost one = shared(topics);
+        const ModelCost* costs[2] = {&separate, &one};
+        const char* names[2] = {"per topic", "shared"};
+        for (int m = 0; m < 2; m++) {
+            fprintf(stderr, "%-7d %-10s %10.0f %8d %13.1f %10.2f %10.1f%s\n", topics, names[m], costs[m]->heap_bytes,
+                    costs[m]->sockets, costs[m]->discovery_bytes, costs[m]->discovery_datagrams, costs[m]->spin_us,
+                    costs[m]->ok ? "" : "  (setup failed)");
+        }
+        // With one topic the node's own state (main loop, extractor) is not yet amortized
+        ok = ok && separate.ok && one.ok && (topics == 1 || one.heap_bytes < separate.heap_bytes) &&
+             one.discovery_bytes < separate.discovery_bytes &&
+             one.discovery_datagrams < separate.discovery_datagrams;
+    }
+
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
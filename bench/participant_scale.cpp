@@ -0,0 +1,368 @@
+/*
+ * Participants per host check
+ *
+ * 1. capacity: DDS_MAX_PARTICIPANT_ID + 2 participants in one domain of one
+ *    process. The first DDS_MAX_PARTICIPANT_ID + 1 must get IDs 0.. in order
+ *    (one unicast port each, from the RTPS port formula), the next must fail;
+ *    an explicitly requested ID that is taken must fail and succeed once its
+ *    holder is gone (the port is released).
+ * 2. scale (native only): PROCESSES processes start PER_PROCESS participants
+ *    each in the same domain at the same time, all sharing the discovery
+ *    port. IDs must be unique across processes, and every participant must
+ *    discover every other one's endpoint over multicast within ROUNDS
+ *    announcement rounds. Under Emscripten (no fork, no host sockets) the
+ *    participants are started in one process and only the IDs are checked.
+ * 3. delivery (native only): a publisher's participant in this process and a
+ *    subscriber's in another, on one host, match through discovery; every
+ *    typed frame must reach the subscriber, in order, over UDP to its
+ *    participant's unicast port. Then DELIVERY_LARGE frames of
+ *    DELIVERY_LARGE_BYTES (sent as fragments) must arrive whole, and a
+ *    publish over DDS_MAX_FRAME_BYTES must fail without sending anything.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/participant_scale.cpp -o participant_scale.js
+ * Run:            node participant_scale.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "dds_minimal_wasm.cpp"
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifndef __EMSCRIPTEN__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define CAPACITY_DOMAIN 11
+#define SCALE_DOMAIN 12
+#define PROCESSES 4
+#define PER_PROCESS 27  // 108 participants
+#define ROUNDS 10
+#define ROUND_MS 100
+#define POLLS_PER_ROUND 400
+#define TOPIC "/participant_scale"
+#define DELIVERY_DOMAIN 13
+#define DELIVERY_TOPIC "/participant_scale/data"
+#define DELIVERY_TYPE "participant_scale::msg::Index"
+#define DELIVERY_MESSAGES 2000
+#define DELIVERY_BATCH 50  // Then a pause, so the receiver's socket buffer never fills
+#define DELIVERY_LARGE 20
+#define DELIVERY_LARGE_BYTES (256u << 10)  // 65 fragments; one frame per pause
+#define DELIVERY_TIMEOUT_MS 5000
+
+static bool checkCapacity() {
+    std::vector<DDSParticipantWASM*> participants;
+    bool ok = true;
+    for (int i = 0; i <= DDS_MAX_PARTICIPANT_ID + 1; i++) {
+        DDSParticipantWASM* participant = new DDSParticipantWASM("capacity_" + std::to_string(i), CAPACITY_DOMAIN);
+        bool started = participant->init();
+        bool expected = i <= DDS_MAX_PARTICIPANT_ID;
+        if (started != expected || (started && (participant->getParticipantId() != i ||
+                                                participant->getUnicastPort() != ddsPorts(CAPACITY_DOMAIN, i).user_unicast))) {
+            fprintf(stderr, "capacity: participant %d %s (ID %d, port %d)\n", i, started ? "started" : "failed",
+                    participant->getParticipantId(), participant->getUnicastPort());
+            ok = false;
+        }
+        participants.push_back(participant);
+    }
+
+    DDSParticipantWASM taken("capacity_taken", CAPACITY_DOMAIN, 5);
+    bool taken_failed = !taken.init();
+    delete participants[5];
+    participants[5] = nullptr;
+    DDSParticipantWASM reused("capacity_reused", CAPACITY_DOMAIN, 5);
+    bool reused_ok = reused.init() && reused.getParticipantId() == 5;
+    ok = ok && taken_failed && reused_ok;
+
+    fprintf(stderr, "capacity  %d IDs in domain %d (ports %d..%d), then full; explicit ID reuse %s\n",
+            DDS_MAX_PARTICIPANT_ID + 1, CAPACITY_DOMAIN, ddsPorts(CAPACITY_DOMAIN, 0).user_unicast,
+            ddsPorts(CAPACITY_DOMAIN, DDS_MAX_PARTICIPANT_ID).user_unicast,
+            taken_failed && reused_ok ? "ok" : "wrong");
+    for (DDSParticipantWASM* participant : participants) delete participant;
+    return ok;
+}
+
+// Endpoints on TOPIC seen by one participant, by participant GUID (its own included)
+struct Seen {
+    std::set<std::string> guids;
+
+    static void onEvent(void* context, const DDSDiscoveryEvent& event) {
+        if (event.kind == DDSDiscoveryEvent::ENDPOINT_ADDED && event.topic_name == TOPIC) {
+            static_cast<Seen*>(context)->guids.insert(event.participant_guid);
+        }
+    }
+};
+
+// Starts `count` participants with one publisher each; ids receives their IDs
+static bool startParticipants(int process, int count, std::vector<DDSParticipantWASM*>& participants,
+                              std::vector<DDSPublisherWASM*>& publishers, std::vector<Seen>& seen,
+                              std::vector<int>& ids) {
+    seen.resize(count);
+    for (int i = 0; i < count; i++) {
+        DDSParticipantWASM* participant =
+            new DDSParticipantWASM("scale_" + std::to_string(process) + "_" + std::to_string(i), SCALE_DOMAIN);
+        participant->setDiscoveryListener(&Seen::onEvent, &seen[i]);
+        participants.push_back(participant);
+        if (!participant->init()) return false;
+        DDSPublisherWASM* publisher = new DDSPublisherWASM(participant, TOPIC);
+        publishers.push_back(publisher);
+        if (!publisher->init()) return false;
+        ids.push_back(participant->getParticipantId());
+    }
+    return true;
+}
+
+static void stopParticipants(std::vector<DDSParticipantWASM*>& participants, std::vector<DDSPublisherWASM*>& publishers) {
+    for (DDSPublisherWASM* publisher : publishers) delete publisher;
+    for (DDSParticipantWASM* participant : participants) delete participant;
+}
+
+static bool uniqueIds(const std::vector<int>& ids, int expected) {
+    std::set<int> unique(ids.begin(), ids.end());
+    bool ok = static_cast<int>(ids.size()) == expected && static_cast<int>(unique.size()) == expected &&
+              *unique.begin() >= 0 && *unique.rbegin() <= DDS_MAX_PARTICIPANT_ID;
+    fprintf(stderr, "scale     %zu participants started, %zu distinct IDs (%d..%d)\n", ids.size(), unique.size(),
+            unique.empty() ? -1 : *unique.begin(), unique.empty() ? -1 : *unique.rbegin());
+    return ok;
+}
+
+#ifndef __EMSCRIPTEN__
+static bool writeAll(int fd, const void* data, size_t length) {
+    return write(fd, data, length) == static_cast<ssize_t>(length);
+}
+
+static bool readAll(int fd, void* data, size_t length) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t n = read(fd, static_cast<char*>(data) + done, length - done);
+        if (n <= 0) return false;
+        done += n;
+    }
+    return true;
+}
+
+// Child: start, report IDs, wait for every process, announce and listen, report
+static int runChild(int process, int results_fd, int go_fd) {
+    std::vector<DDSParticipantWASM*> participants;
+    std::vector<DDSPublisherWASM*> publishers;
+    std::vector<Seen> seen;
+    std::vector<int> ids;
+    bool started = startParticipants(process, PER_PROCESS, participants, publishers, seen, ids);
+    ids.resize(PER_PROCESS, -1);
+    writeAll(results_fd, ids.data(), ids.size() * sizeof(int));
+
+    char go = 0;
+    if (!readAll(go_fd, &go, 1) || !started || go != 'g') {
+        stopParticipants(participants, publishers);
+        return 1;
+    }
+
+    for (int round = 0; round < ROUNDS; round++) {
+        double round_end = emscripten_get_now() + ROUND_MS;
+        for (DDSParticipantWASM* participant : participants) participant->discoverParticipants();
+        while (emscripten_get_now() < round_end) {
+            for (DDSParticipantWASM* participant : participants) {
+                for (int p = 0; p < POLLS_PER_ROUND / 10; p++) participant->getNetworkManager()->poll();
+            }
+        }
+    }
+
+    int fewest = PROCESSES * PER_PROCESS;
+    for (const Seen& s : seen) {
+        if (static_cast<int>(s.guids.size()) < fewest) fewest = static_cast<int>(s.guids.size());
+    }
+    writeAll(results_fd, &fewest, sizeof(fewest));
+    stopParticipants(participants, publishers);
+    return 0;
+}
+
+static bool checkScale() {
+    int results[2], go[2];
+    if (pipe(results) != 0 || pipe(go) != 0) return false;
+    std::vector<pid_t> children;
+    for (int process = 0; process < PROCESSES; process++) {
+        pid_t child = fork();
+        if (child == 0) {
+            close(results[0]);
+            close(go[1]);
+            _exit(runChild(process, results[1], go[0]));
+        }
+        children.push_back(child);
+    }
+    close(results[1]);
+    close(go[0]);
+
+    // Reports arrive whole (PIPE_BUF), in any order
+    std::vector<int> ids;
+    for (int process = 0; process < PROCESSES; process++) {
+        int batch[PER_PROCESS];
+        if (!readAll(results[0], batch, sizeof(batch))) break;
+        for (int id : batch) {
+            if (id >= 0) ids.push_back(id);
+        }
+    }
+    bool ok = uniqueIds(ids, PROCESSES * PER_PROCESS);
+
+    double start = emscripten_get_now();
+    for (int process = 0; process < PROCESSES; process++) writeAll(go[1], ok ? "g" : "x", 1);
+    close(go[1]);
+    int fewest = PROCESSES * PER_PROCESS;
+    for (int process = 0; ok && process < PROCESSES; process++) {
+        int seen = 0;
+        if (!readAll(results[0], &seen, sizeof(seen))) seen = 0;
+        if (seen < fewest) fewest = seen;
+    }
+    double elapsed = emscripten_get_now() - start;
+    close(results[0]);
+    for (pid_t child : children) waitpid(child, nullptr, 0);
+
+    if (ok) {
+        fprintf(stderr, "scale     %d processes x %d: every participant discovered at least %d of %d endpoints "
+                        "(%d rounds, %.0f ms)\n",
+                PROCESSES, PER_PROCESS, fewest, PROCESSES * PER_PROCESS, ROUNDS, elapsed);
+    }
+    return ok && fewest == PROCESSES * PER_PROCESS;
+}
+
+// Small payloads are message indices; counts those received and those in
+// order. Large ones start with their index and end with its low byte.
+struct Received {
+    int count;
+    int in_order;
+    uint32_t next;
+    int large;
+    int large_intact;
+
+    static void onPayload(void* context, const uint8_t* payload, size_t length) {
+        Received* received = static_cast<Received*>(context);
+        uint32_t index;
+        if (length == DELIVERY_LARGE_BYTES) {
+            memcpy(&index, payload, sizeof(index));
+            if (index == static_cast<uint32_t>(received->large) && payload[length - 1] == static_cast<uint8_t>(index)) {
+                received->large_intact++;
+            }
+            received->large++;
+            return;
+        }
+        if (length != sizeof(index)) return;
+        memcpy(&index, payload, sizeof(index));
+        received->count++;
+        if (index == received->next) received->in_order++;
+        received->next = index + 1;
+    }
+};
+
+// Child: subscribe, announce every ROUND_MS and poll until everything arrived
+static int runSubscriber(int results_fd) {
+    DDSParticipantWASM participant("delivery_subscriber", DELIVERY_DOMAIN);
+    DDSSubscriberWASM subscriber(&participant, DELIVERY_TOPIC, DELIVERY_TYPE);
+    Received received = {0, 0, 0, 0, 0};
+    if (participant.init() && subscriber.init()) {
+        subscriber.setRawCallback(&Received::onPayload, &received);
+        double deadline = emscripten_get_now() + DELIVERY_TIMEOUT_MS;
+        double next_round = 0;
+        while ((received.count < DELIVERY_MESSAGES || received.large < DELIVERY_LARGE) &&
+               emscripten_get_now() < deadline) {
+            if (emscripten_get_now() >= next_round) {
+                participant.discoverParticipants();
+                next_round = emscripten_get_now() + ROUND_MS;
+            }
+            participant.getNetworkManager()->poll();
+        }
+    }
+    int counts[4] = {received.count, received.in_order, received.large, received.large_intact};
+    writeAll(results_fd, counts, sizeof(counts));
+    return 0;
+}
+
+static bool checkDelivery() {
+    int results[2];
+    if (pipe(results) != 0) return false;
+    pid_t child = fork();
+    if (child == 0) {
+        close(results[0]);
+        _exit(runSubscriber(results[1]));
+    }
+    close(results[1]);
+
+    bool matched = false;
+    int sent = 0;
+    bool oversize_refused = false;
+    double start = emscripten_get_now();
+    {
+        DDSParticipantWASM participant("delivery_publisher", DELIVERY_DOMAIN);
+        DDSPublisherWASM publisher(&participant, DELIVERY_TOPIC, DELIVERY_TYPE);
+        if (participant.init() && publisher.init()) {
+            double deadline = start + DELIVERY_TIMEOUT_MS;
+            while (!matched && emscripten_get_now() < deadline) {
+                participant.discoverParticipants();
+                double round_end = emscripten_get_now() + ROUND_MS;
+                while (!matched && emscripten_get_now() < round_end) {
+                    participant.getNetworkManager()->poll();
+                    matched = publisher.getMetric(PUBLISHER_MATCHED_REMOTE) > 0;
+                }
+            }
+        }
+        for (uint32_t i = 0; matched && i < DELIVERY_MESSAGES; i++) {
+            publisher.publishSerialized(reinterpret_cast<const uint8_t*>(&i), sizeof(i));
+            if (i % DELIVERY_BATCH == DELIVERY_BATCH - 1) usleep(1000);
+        }
+        std::vector<uint8_t> large(DELIVERY_LARGE_BYTES, 0x5A);
+        for (uint32_t i = 0; matched && i < DELIVERY_LARGE; i++) {
+            memcpy(large.data(), &i, sizeof(i));
+            large.back() = static_cast<uint8_t>(i);
+            publisher.publishSerialized(large.data(), large.size());
+            usleep(1000);
+        }
+        uint64_t sends = publisher.getMetric(PUBLISHER_REMOTE_SENDS);
+        std::vector<uint8_t> oversize(DDS_MAX_FRAME_BYTES);
+        oversize_refused = !publisher.publishSerialized(oversize.data(), oversize.size()) &&
+                           publisher.getMetric(PUBLISHER_REMOTE_SENDS) == sends;
+        sent = static_cast<int>(sends);
+    }
+
+    int counts[4] = {0, 0, 0, 0};
+    if (!readAll(results[0], counts, sizeof(counts))) counts[0] = counts[1] = counts[2] = counts[3] = 0;
+    close(results[0]);
+    waitpid(child, nullptr, 0);
+    fprintf(stderr, "delivery  %s; %d frames sent, %d received by the other process's participant, %d in order, "
+                    "%d of %d fragmented frames whole (%.0f ms)\n",
+            matched ? "subscriber matched" : "subscriber NOT matched", sent, counts[0], counts[1], counts[3],
+            DELIVERY_LARGE, emscripten_get_now() - start);
+    fprintf(stderr, "delivery  %u byte publish %s\n", DDS_MAX_FRAME_BYTES, oversize_refused ? "refused" : "NOT refused");
+    return matched && sent == DELIVERY_MESSAGES + DELIVERY_LARGE && counts[0] == DELIVERY_MESSAGES &&
+           counts[1] == DELIVERY_MESSAGES && counts[2] == DELIVERY_LARGE && counts[3] == DELIVERY_LARGE &&
+           oversize_refused;
+}
+#else
+static bool checkScale() {
+    std::vector<DDSParticipantWASM*> participants;
+    std::vector<DDSPublisherWASM*> publishers;
+    std::vector<Seen> seen;
+    std::vector<int> ids;
+    startParticipants(0, PROCESSES * PER_PROCESS, participants, publishers, seen, ids);
+    bool ok = uniqueIds(ids, PROCESSES * PER_PROCESS);
+    fprintf(stderr, "scale     discovery skipped (no host sockets under Emscripten)\n");
+    stopParticipants(participants, publishers);
+    return ok;
+}
+
+static bool checkDelivery() {
+    fprintf(stderr, "delivery  skipped (no host sockets under Emscripten)\n");
+    return true;
+}
+#endif
+
+int main() {
+    bool ok = checkCapacity();
+    ok = checkScale() && ok;
+    ok = checkDelivery() && ok;
+
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,247 @@
+/*
+ * Pipeline trace check
+ *
+ * Traces messages through the stages of trace_wasm.h and checks the
+ * exported Chrome Trace Event JSON:
+ * 1. local: typed std_msgs/String through RMW on one participant; every
+ *    message must show serialize, publish, recv, enqueue (KEEP_LAST queue)
+ *    and decode (take), all with its writer GUID and sequence number.
+ * 2. remote (native only): a writer on one participant publishes and its
+ *    frames are forwarded over UDP to a second participant, whose socket is
+ *    read by its I/O thread; every message must show publish on the writer
+ *    side and enqueue (I/O thread), dispatch, recv and callback on the
+ *    reader side, under the writer's key from the frame header.
+ * 3. overflow: a trace smaller than the spans drops (and counts) the rest.
+ * Reports the time of a publish + take with tracing off and on. With a file
+ * argument the trace of 1 and 2 is written there (open it in ui.perfetto.dev).
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/pipeline_trace.cpp -o pipeline_trace.js
+ * Run:            node pipeline_trace.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "rmw_custom_wasm.cpp"
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef __EMSCRIPTEN__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#define MESSAGES 100
+#define PAYLOAD 64
+#define LOCAL_TOPIC "/trace_check/local"
+#define REMOTE_TOPIC "/trace_check/remote"
+#define OVERFLOW_EVENTS 8
+#define TIMED_MESSAGES 50000
+
+static int failures = 0;
+
+static void check(const char* what, bool ok) {
+    fprintf(stderr, "%-52s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) failures++;
+}
+
+// Spans per (topic, stage) and per (topic, seq), read back from the export
+struct TraceCounts {
+    size_t spans;
+    std::map<std::pair<std::string, std::string>, int> stages;
+    std::map<std::pair<std::string, unsigned>, int> messages;
+};
+
+static std::string field(const std::string& event, const char* key) {
+    size_t start = event.find(key);
+    if (start == std::string::npos) return "";
+    start += strlen(key);
+    size_t end = event.find_first_of("\",}", start);
+    return event.substr(start, end - start);
+}
+
+static TraceCounts countSpans(const std::string& json) {
+    TraceCounts counts = {};
+    const std::string marker = "{\"ph\":\"X\"";
+    size_t at = json.find(marker);
+    while (at != std::string::npos) {
+        size_t next = json.find(marker, at + 1);
+        std::string event = json.substr(at, next == std::string::npos ? std::string::npos : next - at);
+        counts.spans++;
+        std::string topic = field(event, "\"topic\":\"");
+        std::string seq = field(event, "\"seq\":");
+        if (!topic.empty() && !seq.empty()) {
+            counts.stages[{topic, field(event, "\"name\":\"")}]++;
+            counts.messages[{topic, static_cast<unsigned>(atoi(seq.c_str()))}]++;
+        }
+        at = next;
+    }
+    return counts;
+}
+
+// Every message of a topic has exactly `spans` spans with its key
+static bool everyMessage(const TraceCounts& counts, const char* topic, int spans) {
+    for (unsigned seq = 1; seq <= MESSAGES; seq++) {
+        auto it = counts.messages.find({topic, seq});
+        if (it == counts.messages.end() || it->second != spans) {
+            fprintf(stderr, "%s #%u: %d spans (expected %d)\n", topic, seq,
+                    it == counts.messages.end() ? 0 : it->second, spans);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool stageCount(const TraceCounts& counts, const char* topic, const char* stage, int expected) {
+    auto it = counts.stages.find({topic, stage});
+    int found = it == counts.stages.end() ? 0 : it->second;
+    if (found != expected) fprintf(stderr, "%s %s: %d spans (expected %d)\n", topic, stage, found, expected);
+    return found == expected;
+}
+
+struct Endpoints {
+    void* publisher;
+    void* subscriber;
+};
+
+// MESSAGES publish + take pairs; false if a take came back empty
+static bool runLocal(RMWCustomWASM& rmw, const Endpoints& local, std_msgs__msg__String* sent,
+                     std_msgs__msg__String* received, int messages) {
+    bool ok = true;
+    for (int i = 0; i < messages; i++) {
+        ok = rmw.publishMessage(local.publisher, sent) && ok;
+        ok = rmw.takeMessage(local.subscriber, received) && ok;
+    }
+    return ok;
+}
+
+#ifndef __EMSCRIPTEN__
+static int remote_received = 0;
+
+static bool runRemote(DDSParticipantWASM& writer_participant, DDSParticipantWASM& reader_participant) {
+    DDSPublisherWASM writer(&writer_participant, REMOTE_TOPIC, "trace_check::msg::Blob");
+    DDSSubscriberWASM reader(&reader_participant, REMOTE_TOPIC, "trace_check::msg::Blob");
+    reader.setCallback([](const std::string&) { remote_received++; });
+    if (!writer.init() || !reader.init() || !reader_participant.startIOThread()) {
+        fprintf(stderr, "remote: setup failed\n");
+        return false;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in to = {};
+    to.sin_family = AF_INET;
+    to.sin_port = htons(reader_participant.getUnicastPort());
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    // A bridge: the writer's frame, header and all, as it would go on the wire
+    for (int i = 0; i < MESSAGES; i++) {
+        uint8_t* payload = writer.loanPayload(PAYLOAD);
+        memset(payload, i, PAYLOAD);
+        writer.publishLoaned(PAYLOAD);
+        sendto(fd, payload - sizeof(DDSFrameHeader), sizeof(DDSFrameHeader) + PAYLOAD, 0,
+               reinterpret_cast<sockaddr*>(&to), sizeof(to));
+    }
+    close(fd);
+
+    double deadline = emscripten_get_now() + 2000;
+    while (remote_received < MESSAGES && emscripten_get_now() < deadline) {
+        reader_participant.getNetworkManager()->poll();
+    }
+    reader_participant.getNetworkManager()->stopIOThread();
+    if (remote_received != MESSAGES) {
+        fprintf(stderr, "remote: %d/%d received\n", remote_received, MESSAGES);
+        return false;
+    }
+    return true;
+}
+#endif
+
+int main(int argc, char** argv) {
+    RMWCustomWASM rmw;
+    void* participant = rmw.createParticipant("trace_check", 23);
+    const rosidl_message_type_support_t* ts = ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, String);
+    Endpoints local = {};
+    if (participant) {
+        local.publisher = rmw.createTypedPublisher(participant, LOCAL_TOPIC, ts);
+        local.subscriber = rmw.createTypedSubscriber(participant, LOCAL_TOPIC, ts, MESSAGES);
+    }
+    if (!local.publisher || !local.subscriber) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+    std_msgs__msg__String sent, received;
+    rosidl_runtime_c__String__init(&sent.data);
+    rosidl_runtime_c__String__init(&received.data);
+    std::string filler(PAYLOAD, 'x');
+    rosidl_runtime_c__String__assignn(&sent.data, filler.data(), filler.size());
+
+    // 1 + 2
+    rmw.startTrace(0);
+    check("local: every publish taken", runLocal(rmw, local, &sent, &received, MESSAGES));
+#ifndef __EMSCRIPTEN__
+    DDSParticipantWASM writer_participant("trace_check_writer", 23);
+    DDSParticipantWASM reader_participant("trace_check_reader", 23);
+    bool remote = writer_participant.init() && reader_participant.init() &&
+                  runRemote(writer_participant, reader_participant);
+    check("remote: every frame delivered", remote);
+#endif
+    rmw.stopTrace();
+
+    std::string json = rmw.getTrace(participant);
+    TraceCounts counts = countSpans(json);
+    check("export: one X event per recorded span", counts.spans == traceWASMEventCount());
+    check("export: nothing dropped", traceWASMDropped() == 0);
+    check("export: JSON object with traceEvents",
+          json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0) == 0 && json.back() == '}');
+    check("local: 5 spans per message, each with its key", everyMessage(counts, LOCAL_TOPIC, 5));
+    bool stages = true;
+    for (const char* stage : {"serialize", "publish", "recv", "enqueue", "decode"}) {
+        stages = stageCount(counts, LOCAL_TOPIC, stage, MESSAGES) && stages;
+    }
+    check("local: serialize/publish/recv/enqueue/decode each", stages);
+#ifndef __EMSCRIPTEN__
+    check("remote: 5 spans per message, writer's key", everyMessage(counts, REMOTE_TOPIC, 5));
+    stages = true;
+    for (const char* stage : {"publish", "enqueue", "dispatch", "recv", "callback"}) {
+        stages = stageCount(counts, REMOTE_TOPIC, stage, MESSAGES) && stages;
+    }
+    check("remote: publish/enqueue/dispatch/recv/callback each", stages);
+    check("remote: I/O thread named in the trace", json.find("\"args\":{\"name\":\"dds_io\"}") != std::string::npos);
+#else
+    fprintf(stderr, "remote  skipped (no UDP sockets under Emscripten)\n");
+#endif
+    fprintf(stderr, "trace: %zu spans, %zu bytes of JSON\n", counts.spans, json.size());
+    if (argc > 1) {
+        check("trace written", traceWASMWriteFile(argv[1], "trace_check"));
+    }
+
+    // 3
+    rmw.startTrace(OVERFLOW_EVENTS);
+    runLocal(rmw, local, &sent, &received, MESSAGES);
+    rmw.stopTrace();
+    check("overflow: buffer full, the rest counted as dropped",
+          traceWASMEventCount() == OVERFLOW_EVENTS && traceWASMDropped() == 5 * MESSAGES - OVERFLOW_EVENTS);
+
+    // Costs
+    double start = emscripten_get_now();
+    runLocal(rmw, local, &sent, &received, TIMED_MESSAGES);
+    double off_ns = (emscripten_get_now() - start) * 1e6 / TIMED_MESSAGES;
+    rmw.startTrace(6 * TIMED_MESSAGES);
+    start = emscripten_get_now();
+    runLocal(rmw, local, &sent, &received, TIMED_MESSAGES);
+    double on_ns = (emscripten_get_now() - start) * 1e6 / TIMED_MESSAGES;
+    rmw.stopTrace();
+    fprintf(stderr, "publish + take: %.1f ns tracing off, %.1f ns on (%.1f ns per span)\n", off_ns, on_ns,
+            (on_ns - off_ns) / 5);
+
+    rosidl_runtime_c__String__fini(&sent.data);
+    rosidl_runtime_c__String__fini(&received.data);
+    if (failures > 0) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
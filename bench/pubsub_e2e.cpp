@@ -0,0 +1,613 @@
+/*
+ * End-to-end publisher -> subscriber benchmark
+ *
+ * Three paths:
+ * - dds:  DDSPublisherWASM::publishSerialized into raw subscriber callbacks,
+ *         the path the sensor nodes use (no receive queue), on one
+ *         participant (same-participant delivery, no network peer needed)
+ * - udp:  the same with the subscriptions on a second participant, matched
+ *         through discovery; each frame goes to that participant's unicast
+ *         port as one UDP datagram, or as fragments when it is larger
+ *         (native only). Sends go in bursts of E2E_UDP_BURST (fewer for large
+ *         payloads), each received before the next. A case whose burst would
+ *         not fit the receive buffer the kernel granted is printed as
+ *         unsupported instead of run.
+ * - rmw:  typed std_msgs/String publish, KEEP_LAST queue of the given depth,
+ *         takeMessage; the rcl_publish/rcl_take path
+ * Two modes:
+ * - throughput: one-way; rmw publishes a burst of `depth` messages, then
+ *   every subscription takes them. Latency = take time - send stamp.
+ * - pingpong:   one subscriber echoes each message on a pong topic; latency
+ *   is the round trip.
+ * Payloads carry a sequence number and a send stamp; every delivery is
+ * checked for order and content. Cases sweep payload size, subscriber
+ * count and depth (depth 0 = the dds and udp paths); a case holding more than E2E_MAX_QUEUED_BYTES in
+ * queues at once is skipped. Each case runs E2E_REPEATS times and reports
+ * its best msgs/s and its lowest p50 (with that run's p99).
+ *
+ *   pubsub_e2e [--full] [--csv FILE] [--json FILE] [--baseline FILE.csv] [--tolerance PCT]
+ *
+ * The default sweep is small (ctest); --full covers 16 B - 4 MiB, 1/4/16
+ * subscribers and depths 1/10/100. With --baseline, a case whose msgs/s
+ * fell or whose p50 rose by more than PCT (default 25) against the same
+ * case in an earlier --csv run fails the bench:
+ *   pubsub_e2e --full --csv baseline.csv            (on the reference build)
+ *   pubsub_e2e --full --baseline baseline.csv       (after the change)
+ * MB/s counts delivered bytes (payload x subscribers), MB = 10^6 bytes.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc -s NODERAWFS=1 -s ALLOW_MEMORY_GROWTH=1 --bind bench/pubsub_e2e.cpp -o pubsub_e2e.js
+ *                 (or build_microros_wasm.sh, which writes wasm_output/pubsub_e2e.js)
+ * Run:            node pubsub_e2e.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "rmw_custom_wasm.cpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define E2E_DOMAIN 21
+#define E2E_TYPE "e2e::msg::Blob"
+#define E2E_HEADER_BYTES 16                 // Sequence number, send stamp (ms)
+#define E2E_MAX_QUEUED_BYTES (128u << 20)   // Subscribers x depth x payload
+#define E2E_MIN_MESSAGES 50
+#define E2E_REPEATS 3
+#define E2E_UDP_BURST 32                    // Messages sent before the receiver reads them ...
+#define E2E_UDP_BURST_BYTES (1u << 20)      // ... or fewer, so a burst fits the socket buffer
+#define E2E_UDP_WAIT_MS 1000                // For a match, a burst or a round trip
+
+struct Sweep {
+    std::vector<size_t> payloads;
+    std::vector<int> subscribers;
+    std::vector<int> depths;     // 0 = dds and udp paths
+    size_t traffic_bytes;        // Per case, before the message count limits
+    size_t max_messages;
+};
+
+struct CaseResult {
+    std::string mode;
+    std::string path;
+    int depth;
+    size_t payload;
+    int subscribers;
+    size_t messages;
+    size_t delivered;
+    double p50_us;
+    double p99_us;
+    double msgs_per_s;
+    double mb_per_s;
+    bool intact;  // Every delivery in order and unchanged
+    bool unsupported;  // Not run: the udp burst exceeds the socket receive buffer
+};
+
+// What a receiving end expects next; one per subscription
+struct ReaderState {
+    uint64_t next_sequence;
+    size_t payload;
+    size_t delivered;
+    bool intact;
+    std::vector<double>* latencies_us;
+};
+
+static void stampPayload(uint8_t* payload, size_t length, uint64_t sequence) {
+    double now = emscripten_get_now();
+    memcpy(payload, &sequence, sizeof(sequence));
+    memcpy(payload + 8, &now, sizeof(now));
+    if (length > E2E_HEADER_BYTES) {
+        payload[E2E_HEADER_BYTES + (length - E2E_HEADER_BYTES) / 2] = static_cast<uint8_t>(sequence * 31);
+        payload[length - 1] = static_cast<uint8_t>(sequence);
+    }
+}
+
+static void checkPayload(ReaderState* reader, const uint8_t* payload, size_t length) {
+    double now = emscripten_get_now();
+    uint64_t sequence = 0;
+    double sent_ms = now;
+    if (length == reader->payload) {
+        memcpy(&sequence, payload, sizeof(sequence));
+        memcpy(&sent_ms, payload + 8, sizeof(sent_ms));
+    }
+    bool ok = length == reader->payload && sequence == reader->next_sequence;
+    if (ok && length > E2E_HEADER_BYTES) {
+        ok = payload[E2E_HEADER_BYTES + (length - E2E_HEADER_BYTES) / 2] == static_cast<uint8_t>(sequence * 31) &&
+             payload[length - 1] == static_cast<uint8_t>(sequence);
+    }
+    reader->intact = reader->intact && ok;
+    reader->next_sequence = sequence + 1;
+    reader->delivered++;
+    reader->latencies_us->push_back((now - sent_ms) * 1000.0);
+}
+
+static void onPayload(void* context, const uint8_t* payload, size_t length) {
+    checkPayload(static_cast<ReaderState*>(context), payload, length);
+}
+
+// Pingpong responder: echoes the ping on the pong publisher
+static void onPing(void* context, const uint8_t* payload, size_t length) {
+    static_cast<DDSPublisherWASM*>(context)->publishSerialized(payload, length);
+}
+
+static size_t messageCount(const Sweep& sweep, size_t payload, int depth) {
+    size_t messages = sweep.traffic_bytes / payload;
+    messages = std::max<size_t>(E2E_MIN_MESSAGES, std::min(messages, sweep.max_messages));
+    if (depth > 0) messages = (messages + depth - 1) / depth * depth;  // Whole bursts
+    return messages;
+}
+
+static std::string caseTopic(int case_index, const char* suffix) {
+    return "/e2e/case_" + std::to_string(case_index) + suffix;
+}
+
+static void summarize(CaseResult& result, std::vector<ReaderState>& readers, std::vector<double>& latencies,
+                      double elapsed_ms) {
+    result.delivered = 0;
+    result.intact = true;
+    for (const ReaderState& reader : readers) {
+        result.delivered += reader.delivered;
+        result.intact = result.intact && reader.intact;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    size_t n = latencies.size();
+    result.p50_us = n ? latencies[n / 2] : 0.0;
+    result.p99_us = n ? latencies[(n * 99) / 100] : 0.0;
+    double seconds = elapsed_ms > 0 ? elapsed_ms / 1000.0 : 1e-9;
+    result.msgs_per_s = result.messages / seconds;
+    result.mb_per_s = static_cast<double>(result.delivered) * result.payload / seconds / 1e6;
+}
+
+static CaseResult newCase(bool pingpong, const char* path, int depth, size_t payload, int subscribers,
+                          size_t messages) {
+    CaseResult result{};
+    result.mode = pingpong ? "pingpong" : "throughput";
+    result.path = path;
+    result.depth = depth;
+    result.payload = payload;
+    result.subscribers = subscribers;
+    result.messages = messages;
+    return result;
+}
+
+static std::vector<ReaderState> makeReaders(int count, size_t payload, std::vector<double>* latencies) {
+    ReaderState reader = {0, payload, 0, true, latencies};
+    return std::vector<ReaderState>(count, reader);
+}
+
+static CaseResult runDDS(DDSParticipantWASM* participant, int case_index, bool pingpong, size_t payload,
+                         int subscriber_count, size_t messages) {
+    CaseResult result = newCase(pingpong, "dds", 0, payload, subscriber_count, messages);
+    std::vector<double> latencies;
+    latencies.reserve(messages * subscriber_count);
+    std::vector<ReaderState> readers = makeReaders(subscriber_count, payload, &latencies);
+    std::vector<uint8_t> buffer(payload, 0x5A);
+
+    DDSPublisherWASM publisher(participant, caseTopic(case_index, ""), E2E_TYPE);
+    DDSPublisherWASM pong_publisher(participant, caseTopic(case_index, "/pong"), E2E_TYPE);
+    std::vector<DDSSubscriberWASM*> subscribers;
+    DDSSubscriberWASM pong_subscriber(participant, caseTopic(case_index, "/pong"), E2E_TYPE);
+    bool ok = publisher.init() && publisher.reserveFrame(payload);
+    for (int s = 0; s < subscriber_count; s++) {
+        DDSSubscriberWASM* subscriber = new DDSSubscriberWASM(participant, caseTopic(case_index, ""), E2E_TYPE);
+        if (pingpong) {
+            subscriber->setRawCallback(onPing, &pong_publisher);
+        } else {
+            subscriber->setRawCallback(onPayload, &readers[s]);
+        }
+        subscribers.push_back(subscriber);
+        ok = subscriber->init() && ok;
+    }
+    if (pingpong) {
+        pong_subscriber.setRawCallback(onPayload, &readers[0]);
+        ok = ok && pong_publisher.init() && pong_publisher.reserveFrame(payload) && pong_subscriber.init();
+    }
+
+    double start = emscripten_get_now();
+    for (size_t i = 0; ok && i < messages; i++) {
+        stampPayload(buffer.data(), payload, i);
+        publisher.publishSerialized(buffer.data(), payload);
+    }
+    double elapsed_ms = emscripten_get_now() - start;
+
+    for (DDSSubscriberWASM* subscriber : subscribers) delete subscriber;
+    summarize(result, readers, latencies, elapsed_ms);
+    return result;
+}
+
+static size_t delivered(const std::vector<ReaderState>& readers) {
+    size_t count = 0;
+    for (const ReaderState& reader : readers) count += reader.delivered;
+    return count;
+}
+
+// Poll both participants until the readers hold `target` deliveries; false on timeout
+static bool waitForDelivery(DDSParticipantWASM* local, DDSParticipantWASM* remote,
+                            const std::vector<ReaderState>& readers, size_t target) {
+    double deadline = emscripten_get_now() + E2E_UDP_WAIT_MS;
+    while (delivered(readers) < target) {
+        if (emscripten_get_now() > deadline) return false;
+        remote->getNetworkManager()->poll();
+        local->getNetworkManager()->poll();
+    }
+    return true;
+}
+
+// Announce both participants' endpoints until each writer has matched its remote readers
+static bool matchRemote(DDSParticipantWASM* local, DDSParticipantWASM* remote, DDSPublisherWASM* publisher,
+                        DDSPublisherWASM* pong_publisher) {
+    double deadline = emscripten_get_now() + E2E_UDP_WAIT_MS;
+    while (publisher->getMetric(PUBLISHER_MATCHED_REMOTE) == 0 ||
+           (pong_publisher && pong_publisher->getMetric(PUBLISHER_MATCHED_REMOTE) == 0)) {
+        if (emscripten_get_now() > deadline) return false;
+        local->discoverParticipants();
+        remote->discoverParticipants();
+        local->getNetworkManager()->poll();
+        remote->getNetworkManager()->poll();
+    }
+    return true;
+}
+
+static size_t udpBurst(size_t payload) {
+    return std::max<size_t>(1, std::min<size_t>(E2E_UDP_BURST, E2E_UDP_BURST_BYTES / payload));
+}
+
+// Receive buffer the frames in flight take (one for pingpong); on loopback
+// each datagram is charged about twice NET_MAX_DATAGRAM
+static size_t udpBurstBuffer(size_t payload, bool pingpong) {
+    size_t frame = payload + sizeof(DDSFrameHeader);
+    size_t datagrams = frame <= NET_MAX_DATAGRAM ? 1 : (frame + DDS_FRAGMENT_BYTES - 1) / DDS_FRAGMENT_BYTES;
+    return (pingpong ? 1 : udpBurst(payload)) * datagrams * 2 * NET_MAX_DATAGRAM;
+}
+
+// The dds path between two participants: publisher (and pong subscriber) on
+// local, subscriptions (and pong publisher) on remote
+static CaseResult runUDP(DDSParticipantWASM* local, DDSParticipantWASM* remote, int case_index, bool pingpong,
+                         size_t payload, int subscriber_count, size_t messages) {
+    CaseResult result = newCase(pingpong, "udp", 0, payload, subscriber_count, messages);
+    std::vector<double> latencies;
+    latencies.reserve(messages * subscriber_count);
+    std::vector<ReaderState> readers = makeReaders(subscriber_count, payload, &latencies);
+    std::vector<uint8_t> buffer(payload, 0x5A);
+
+    DDSPublisherWASM publisher(local, caseTopic(case_index, ""), E2E_TYPE);
+    DDSPublisherWASM pong_publisher(remote, caseTopic(case_index, "/pong"), E2E_TYPE);
+    std::vector<DDSSubscriberWASM*> subscribers;
+    DDSSubscriberWASM pong_subscriber(local, caseTopic(case_index, "/pong"), E2E_TYPE);
+    bool ok = publisher.init() && publisher.reserveFrame(payload);
+    for (int s = 0; s < subscriber_count; s++) {
+        DDSSubscriberWASM* subscriber = new DDSSubscriberWASM(remote, caseTopic(case_index, ""), E2E_TYPE);
+        if (pingpong) {
+            subscriber->setRawCallback(onPing, &pong_publisher);
+        } else {
+            subscriber->setRawCallback(onPayload, &readers[s]);
+        }
+        subscribers.push_back(subscriber);
+        ok = subscriber->init() && ok;
+    }
+    if (pingpong) {
+        pong_subscriber.setRawCallback(onPayload, &readers[0]);
+        ok = ok && pong_publisher.init() && pong_publisher.reserveFrame(payload) && pong_subscriber.init();
+    }
+    ok = ok && matchRemote(local, remote, &publisher, pingpong ? &pong_publisher : nullptr);
+    size_t burst = udpBurst(payload);
+
+    double start = emscripten_get_now();
+    for (size_t i = 0; ok && i < messages; i++) {
+        stampPayload(buffer.data(), payload, i);
+        publisher.publishSerialized(buffer.data(), payload);
+        if (pingpong) {
+            ok = waitForDelivery(local, remote, readers, i + 1);
+        } else if ((i + 1) % burst == 0 || i + 1 == messages) {
+            ok = waitForDelivery(local, remote, readers, (i + 1) * subscriber_count);
+        }
+    }
+    double elapsed_ms = emscripten_get_now() - start;
+
+    for (DDSSubscriberWASM* subscriber : subscribers) delete subscriber;
+    summarize(result, readers, latencies, elapsed_ms);
+    return result;
+}
+
+// The rmw instance has no destroy calls: each case adds endpoints on fresh topics
+static CaseResult runRMW(RMWCustomWASM* rmw, void* participant, int case_index, bool pingpong, size_t payload,
+                         int subscriber_count, int depth, size_t messages) {
+    CaseResult result = newCase(pingpong, "rmw", depth, payload, subscriber_count, messages);
+    std::vector<double> latencies;
+    latencies.reserve(messages * subscriber_count);
+    std::vector<ReaderState> readers = makeReaders(subscriber_count, payload, &latencies);
+    const rosidl_message_type_support_t* ts = ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, String);
+
+    void* publisher = rmw->createTypedPublisher(participant, caseTopic(case_index, ""), ts);
+    std::vector<void*> subscribers;
+    for (int s = 0; s < subscriber_count; s++) {
+        subscribers.push_back(rmw->createTypedSubscriber(participant, caseTopic(case_index, ""), ts, depth));
+    }
+    void* pong_publisher = nullptr;
+    void* pong_subscriber = nullptr;
+    if (pingpong) {
+        pong_publisher = rmw->createTypedPublisher(participant, caseTopic(case_index, "/pong"), ts);
+        pong_subscriber = rmw->createTypedSubscriber(participant, caseTopic(case_index, "/pong"), ts, depth);
+    }
+    bool ok = publisher && (!pingpong || (pong_publisher && pong_subscriber));
+    for (void* subscriber : subscribers) ok = ok && subscriber;
+
+    std_msgs__msg__String sent, received;
+    rosidl_runtime_c__String__init(&sent.data);
+    rosidl_runtime_c__String__init(&received.data);
+    std::vector<char> filler(payload, 0x5A);
+    ok = ok && rosidl_runtime_c__String__assignn(&sent.data, filler.data(), payload);
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(sent.data.data);
+
+    double start = emscripten_get_now();
+    if (ok && pingpong) {
+        for (size_t i = 0; i < messages; i++) {
+            stampPayload(bytes, payload, i);
+            rmw->publishMessage(publisher, &sent);
+            if (rmw->takeMessage(subscribers[0], &received)) {
+                rmw->publishMessage(pong_publisher, &received);
+            }
+            if (rmw->takeMessage(pong_subscriber, &received)) {
+                checkPayload(&readers[0], reinterpret_cast<const uint8_t*>(received.data.data), received.data.size);
+            }
+        }
+    } else if (ok) {
+        for (size_t i = 0; i < messages; i += depth) {
+            for (int b = 0; b < depth; b++) {
+                stampPayload(bytes, payload, i + b);
+                rmw->publishMessage(publisher, &sent);
+            }
+            for (int s = 0; s < subscriber_count; s++) {
+                while (rmw->takeMessage(subscribers[s], &received)) {
+                    checkPayload(&readers[s], reinterpret_cast<const uint8_t*>(received.data.data),
+                                 received.data.size);
+                }
+            }
+        }
+    }
+    double elapsed_ms = emscripten_get_now() - start;
+
+    rosidl_runtime_c__String__fini(&sent.data);
+    rosidl_runtime_c__String__fini(&received.data);
+    summarize(result, readers, latencies, elapsed_ms);
+    return result;
+}
+
+static void writeCSV(FILE* out, const std::vector<CaseResult>& results) {
+    fprintf(out, "mode,path,depth,payload_bytes,subscribers,messages,delivered,p50_us,p99_us,msgs_per_s,mb_per_s\n");
+    for (const CaseResult& r : results) {
+        if (r.unsupported) continue;
+        fprintf(out, "%s,%s,%d,%zu,%d,%zu,%zu,%.3f,%.3f,%.1f,%.3f\n", r.mode.c_str(), r.path.c_str(), r.depth,
+                r.payload, r.subscribers, r.messages, r.delivered, r.p50_us, r.p99_us, r.msgs_per_s, r.mb_per_s);
+    }
+}
+
+static void writeJSON(FILE* out, const std::vector<CaseResult>& results) {
+    fprintf(out, "[\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const CaseResult& r = results[i];
+        fprintf(out,
+                "  {\"mode\":\"%s\",\"path\":\"%s\",\"depth\":%d,\"payload_bytes\":%zu,\"subscribers\":%d,"
+                "\"messages\":%zu,\"delivered\":%zu,\"p50_us\":%.3f,\"p99_us\":%.3f,\"msgs_per_s\":%.1f,"
+                "\"mb_per_s\":%.3f,\"unsupported\":%s}%s\n",
+                r.mode.c_str(), r.path.c_str(), r.depth, r.payload, r.subscribers, r.messages, r.delivered,
+                r.p50_us, r.p99_us, r.msgs_per_s, r.mb_per_s, r.unsupported ? "true" : "false",
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "]\n");
+}
+
+static std::string caseKey(const std::string& mode, const std::string& path, int depth, size_t payload,
+                           int subscribers) {
+    return mode + "," + path + "," + std::to_string(depth) + "," + std::to_string(payload) + "," +
+           std::to_string(subscribers);
+}
+
+struct BaselineEntry {
+    double p50_us;
+    double msgs_per_s;
+};
+
+// Rows of an earlier --csv run, keyed by case; false if the file cannot be read
+static bool readBaseline(const char* path, std::map<std::string, BaselineEntry>& baseline) {
+    FILE* in = fopen(path, "r");
+    if (!in) return false;
+    char line[512];
+    while (fgets(line, sizeof(line), in)) {
+        char mode[32], data_path[32];
+        int depth, subscribers;
+        size_t payload, messages, delivered;
+        double p50, p99, msgs_per_s, mb_per_s;
+        if (sscanf(line, "%31[^,],%31[^,],%d,%zu,%d,%zu,%zu,%lf,%lf,%lf,%lf", mode, data_path, &depth, &payload,
+                   &subscribers, &messages, &delivered, &p50, &p99, &msgs_per_s, &mb_per_s) == 11) {
+            baseline[caseKey(mode, data_path, depth, payload, subscribers)] = {p50, msgs_per_s};
+        }
+    }
+    fclose(in);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool full = false;
+    const char* csv_path = nullptr;
+    const char* json_path = nullptr;
+    const char* baseline_path = nullptr;
+    double tolerance_pct = 25.0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--full") {
+            full = true;
+        } else if (arg == "--csv" && has_value) {
+            csv_path = argv[++i];
+        } else if (arg == "--json" && has_value) {
+            json_path = argv[++i];
+        } else if (arg == "--baseline" && has_value) {
+            baseline_path = argv[++i];
+        } else if (arg == "--tolerance" && has_value) {
+            tolerance_pct = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--full] [--csv FILE] [--json FILE] [--baseline FILE.csv] [--tolerance PCT]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    Sweep sweep;
+    if (full) {
+        sweep = {{16, 256, 4096, 65536, 1u << 20, 4u << 20}, {1, 4, 16}, {0, 1, 10, 100}, 64u << 20, 20000};
+    } else {
+        sweep = {{16, 4096, 1u << 20}, {1, 4}, {0, 10}, 4u << 20, 5000};
+    }
+
+    std::map<std::string, BaselineEntry> baseline;
+    if (baseline_path && !readBaseline(baseline_path, baseline)) {
+        fprintf(stderr, "FAIL: cannot read baseline %s\n", baseline_path);
+        return 1;
+    }
+
+    DDSParticipantWASM participant("pubsub_e2e_dds", E2E_DOMAIN);
+    DDSParticipantWASM remote("pubsub_e2e_remote", E2E_DOMAIN);
+    RMWCustomWASM rmw;
+    void* rmw_participant = nullptr;
+    if (!participant.init() || !rmw.init() || !(rmw_participant = rmw.createParticipant("pubsub_e2e_rmw", E2E_DOMAIN))) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+#ifdef __EMSCRIPTEN__
+    bool udp = false;  // No host sockets: one participant only
+#else
+    bool udp = remote.init();
+    if (!udp) {
+        fprintf(stderr, "FAIL: second participant\n");
+        return 1;
+    }
+#endif
+    // Both directions of a pingpong cross one of the two sockets; 0 = unknown (no check)
+    size_t udp_receive_buffer = 0;
+    if (udp) {
+        udp_receive_buffer = std::min(participant.getNetworkManager()->getUnicastReceiveBuffer(),
+                                      remote.getNetworkManager()->getUnicastReceiveBuffer());
+    }
+
+    // Depth 0 is the raw callback path, on one participant and between two; other depths are the rmw path
+    std::vector<std::pair<std::string, int>> routes;
+    for (int depth : sweep.depths) {
+        if (depth > 0) {
+            routes.push_back({"rmw", depth});
+            continue;
+        }
+        routes.push_back({"dds", 0});
+        if (udp) routes.push_back({"udp", 0});
+    }
+
+    std::vector<CaseResult> results;
+    int case_index = 0;
+    for (bool pingpong : {false, true}) {
+        for (const auto& route : routes) {
+            const std::string& path = route.first;
+            int depth = route.second;
+            for (size_t payload : sweep.payloads) {
+                for (int subscribers : sweep.subscribers) {
+                    if (pingpong && subscribers > 1) continue;
+                    size_t queued = static_cast<size_t>(subscribers) * std::max(depth, 1) * payload;
+                    if (queued > E2E_MAX_QUEUED_BYTES) continue;
+                    size_t messages = messageCount(sweep, payload, pingpong ? 0 : depth);
+                    if (path == "udp" && udp_receive_buffer > 0 && udpBurstBuffer(payload, pingpong) > udp_receive_buffer) {
+                        CaseResult skipped = newCase(pingpong, "udp", 0, payload, subscribers, messages);
+                        skipped.unsupported = true;
+                        results.push_back(skipped);
+                        continue;
+                    }
+                    // Best of E2E_REPEATS: a case lasts milliseconds, one stall would decide it
+                    CaseResult best;
+                    for (int repeat = 0; repeat < E2E_REPEATS; repeat++) {
+                        case_index++;
+                        CaseResult run;
+                        if (path == "dds") {
+                            run = runDDS(&participant, case_index, pingpong, payload, subscribers, messages);
+                        } else if (path == "udp") {
+                            run = runUDP(&participant, &remote, case_index, pingpong, payload, subscribers, messages);
+                        } else {
+                            run = runRMW(&rmw, rmw_participant, case_index, pingpong, payload, subscribers, depth,
+                                         messages);
+                        }
+                        if (repeat == 0) {
+                            best = run;
+                            continue;
+                        }
+                        best.intact = best.intact && run.intact && run.delivered == best.delivered;
+                        if (run.msgs_per_s > best.msgs_per_s) {
+                            best.msgs_per_s = run.msgs_per_s;
+                            best.mb_per_s = run.mb_per_s;
+                        }
+                        if (run.p50_us < best.p50_us) {
+                            best.p50_us = run.p50_us;
+                            best.p99_us = run.p99_us;
+                        }
+                    }
+                    results.push_back(best);
+                }
+            }
+        }
+    }
+
+    bool ok = true;
+    int regressions = 0;
+    fprintf(stderr, "%-10s %-4s %5s %9s %4s %7s %10s %10s %12s %10s\n", "mode", "path", "depth", "payload", "subs",
+            "msgs", "p50 us", "p99 us", "msgs/s", "MB/s");
+    for (const CaseResult& r : results) {
+        if (r.unsupported) {
+            fprintf(stderr, "%-10s %-4s %5d %9zu %4d %7s  unsupported (burst needs %zu KiB of socket buffer, %zu "
+                    "granted)\n", r.mode.c_str(), r.path.c_str(), r.depth, r.payload, r.subscribers, "-",
+                    udpBurstBuffer(r.payload, r.mode == "pingpong") / 1024, udp_receive_buffer / 1024);
+            continue;
+        }
+        size_t expected = r.mode == "pingpong" ? r.messages : r.messages * r.subscribers;
+        bool complete = r.delivered == expected && r.intact;
+        const char* note = complete ? "" : "  (lost or corrupted)";
+        auto base = baseline.find(caseKey(r.mode, r.path, r.depth, r.payload, r.subscribers));
+        if (complete && base != baseline.end()) {
+            // Below a microsecond the clock resolution dominates p50
+            bool slower = r.msgs_per_s < base->second.msgs_per_s * (1.0 - tolerance_pct / 100.0);
+            bool later = r.p50_us > base->second.p50_us * (1.0 + tolerance_pct / 100.0) &&
+                         r.p50_us - base->second.p50_us > 1.0;
+            if (slower || later) {
+                note = "  (regressed)";
+                regressions++;
+            }
+        }
+        fprintf(stderr, "%-10s %-4s %5d %9zu %4d %7zu %10.2f %10.2f %12.0f %10.1f%s\n", r.mode.c_str(),
+                r.path.c_str(), r.depth, r.payload, r.subscribers, r.messages, r.p50_us, r.p99_us, r.msgs_per_s,
+                r.mb_per_s, note);
+        ok = ok && complete;
+    }
+    if (baseline_path) {
+        fprintf(stderr, "%d of %zu cases regressed by more than %.0f%% against %s\n", regressions, results.size(),
+                tolerance_pct, baseline_path);
+    }
+
+    const char* paths[2] = {csv_path, json_path};
+    for (int f = 0; f < 2; f++) {
+        if (!paths[f]) continue;
+        FILE* out = fopen(paths[f], "w");
+        if (!out) {
+            fprintf(stderr, "FAIL: cannot write %s\n", paths[f]);
+            return 1;
+        }
+        if (f == 0) {
+            writeCSV(out, results);
+        } else {
+            writeJSON(out, results);
+        }
+        fclose(out);
+    }
+
+    if (!ok || regressions > 0) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
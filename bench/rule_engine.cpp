@@ -0,0 +1,353 @@
+/*
+ * Rule engine check and throughput
+ *
+ * 1. RuleEngineWASM against a per-channel reference (one struct per channel,
+ *    rules checked one at a time, the way the subscriber checked its single
+ *    threshold per message): CHANNELS channels (not a multiple of the lane
+ *    count), random rules of every kind with hysteresis, EVALUATIONS rounds
+ *    of random-walk values. Values are multiples of 0.25 so window sums are
+ *    exact and both sides must raise and clear the same alarms with the same
+ *    values and levels. Also: a bad rule line leaves the rules unchanged,
+ *    and '*' rules cover channels added later.
+ * 2. Throughput over LARGE_CHANNELS channels with all four rule kinds on
+ *    every channel: the engine must evaluate more channels per second than
+ *    the reference.
+ * 3. ROSSubscriberNodeWASM: the default rule, then a loaded rule set over
+ *    batches with one reading per sensor channel (raised, held between the
+ *    levels, cleared) and, under Node.js, values written from JS through
+ *    getChannelValuesView().
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -msimd128 -Isrc --bind bench/rule_engine.cpp -o rule_engine.js
+ * Run:            node rule_engine.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "ros_subscriber_wasm.cpp"
+#include "rule_engine_wasm.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#define CHANNELS 1003
+#define EVALUATIONS 600
+#define WINDOW 8
+#define PERIOD_MS 100.0
+#define LARGE_CHANNELS 10000
+#define TIMED_EVALUATIONS 2000
+
+static uint64_t rng_state = 88172645463325252ull;
+
+static uint32_t nextRandom() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return static_cast<uint32_t>(rng_state >> 32);
+}
+
+// Multiple of 0.25 in [0, 40]
+static float walk(float value) {
+    float next = value + 0.25f * (static_cast<int>(nextRandom() % 9) - 4);
+    return next < 0 ? 0 : next > 40 ? 40 : next;
+}
+
+// One channel, evaluated rule by rule
+struct ReferenceChannel {
+    float value;
+    float previous;
+    float ring[RULE_ENGINE_WASM_MAX_WINDOW];
+    bool active[RULE_KIND_COUNT];
+    float set[RULE_KIND_COUNT];
+    float clear[RULE_KIND_COUNT];
+};
+
+struct Reference {
+    std::vector<ReferenceChannel> channels;
+    size_t window;
+    uint64_t evaluations;
+    double last_ms;
+
+    Reference(size_t count, size_t window) : channels(count), window(window), evaluations(0), last_ms(0) {
+        for (ReferenceChannel& channel : channels) {
+            channel = ReferenceChannel();
+            for (int kind = 0; kind < RULE_KIND_COUNT; kind++) {
+                channel.set[kind] = channel.clear[kind] = kind == RULE_BELOW ? -INFINITY : INFINITY;
+            }
+        }
+    }
+
+    void evaluate(double now_ms, std::vector<RuleEventWASM>& events) {
+        events.clear();
+        float inv_dt = evaluations > 0 ? static_cast<float>(1000.0 / (now_ms - last_ms)) : 0.0f;
+        size_t slot = evaluations % window;
+        evaluations++;
+        last_ms = now_ms;
+        size_t count = evaluations < window ? evaluations : window;
+        for (size_t c = 0; c < channels.size(); c++) {
+            ReferenceChannel& channel = channels[c];
+            float rate = std::fabs(channel.value - channel.previous) * inv_dt;
+            channel.previous = channel.value;
+            channel.ring[slot] = channel.value;
+            float sum = 0;
+            for (size_t i = 0; i < count; i++) sum += channel.ring[i];
+            float mean = sum * (1.0f / count);
+            float metric[RULE_KIND_COUNT] = {channel.value, channel.value, rate, mean};
+            for (int kind = 0; kind < RULE_KIND_COUNT; kind++) {
+                bool now;
+                if (kind == RULE_BELOW) {
+                    now = metric[kind] < channel.set[kind] || (channel.active[kind] && metric[kind] < channel.clear[kind]);
+                } else {
+                    now = metric[kind] > channel.set[kind] || (channel.active[kind] && metric[kind] > channel.clear[kind]);
+                }
+                if (now != channel.active[kind]) {
+                    channel.active[kind] = now;
+                    RuleEventWASM event = {static_cast<uint32_t>(c), static_cast<RuleKindWASM>(kind), now,
+                                           metric[kind], now ? channel.set[kind] : channel.clear[kind]};
+                    events.push_back(event);
+                }
+            }
+        }
+    }
+};
+
+static std::tuple<uint32_t, int, bool, float, float> key(const RuleEventWASM& e) {
+    return std::make_tuple(e.channel, static_cast<int>(e.kind), e.raised, e.value, e.level);
+}
+
+static bool sameEvents(std::vector<RuleEventWASM> a, std::vector<RuleEventWASM> b) {
+    auto less = [](const RuleEventWASM& x, const RuleEventWASM& y) { return key(x) < key(y); };
+    std::sort(a.begin(), a.end(), less);
+    std::sort(b.begin(), b.end(), less);
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (key(a[i]) != key(b[i])) return false;
+    }
+    return true;
+}
+
+// Random rules in the text format, applied to the reference as well
+static std::string randomRules(Reference& reference) {
+    std::string text = "# generated\nwindow " + std::to_string(WINDOW) + "\n";
+    char line[128];
+    for (int r = 0; r < 60; r++) {
+        int kind = static_cast<int>(nextRandom() % RULE_KIND_COUNT);
+        size_t first = nextRandom() % CHANNELS;
+        size_t last = std::min<size_t>(CHANNELS - 1, first + nextRandom() % 200);
+        float set = kind == RULE_RATE ? 5.0f + 5.0f * (nextRandom() % 4) : 10.0f + 2.0f * (nextRandom() % 10);
+        float hysteresis = 0.5f * (nextRandom() % 4);
+        float clear = kind == RULE_BELOW ? set + hysteresis : set - hysteresis;
+        snprintf(line, sizeof(line), "%s %zu-%zu %.2f %.2f   # rule %d\n", ruleKindName(kind), first, last, set, clear,
+                 r);
+        text += line;
+        for (size_t c = first; c <= last; c++) {
+            reference.channels[c].set[kind] = set;
+            reference.channels[c].clear[kind] = clear;
+        }
+    }
+    return text;
+}
+
+static bool checkAgainstReference() {
+    RuleEngineWASM engine(CHANNELS);
+    Reference reference(CHANNELS, WINDOW);
+    std::string rules = randomRules(reference);
+    bool ok = engine.loadRules(rules.data(), rules.size()) == 60 && engine.getWindow() == WINDOW;
+
+    std::vector<RuleEventWASM> expected;
+    uint64_t raised = 0, cleared = 0;
+    int mismatches = 0;
+    for (int e = 0; e < EVALUATIONS; e++) {
+        for (size_t c = 0; c < CHANNELS; c++) {
+            float value = walk(reference.channels[c].value);
+            if (e == 0) value = 0.25f * (nextRandom() % 161);
+            reference.channels[c].value = value;
+            engine.setValue(c, value);
+        }
+        engine.evaluate(e * PERIOD_MS);
+        reference.evaluate(e * PERIOD_MS, expected);
+        for (const RuleEventWASM& event : expected) (event.raised ? raised : cleared)++;
+        if (!sameEvents(engine.getEvents(), expected) && mismatches++ == 0) {
+            fprintf(stderr, "evaluation %d: %zu events, reference %zu\n", e, engine.getEvents().size(),
+                    expected.size());
+        }
+    }
+    ok = ok && mismatches == 0 && engine.getRaisedTotal() == raised && engine.getClearedTotal() == cleared &&
+         engine.getActiveAlarms() == static_cast<int>(raised - cleared);
+    fprintf(stderr, "reference  %d channels x %d evaluations: %llu raised, %llu cleared  %s\n", CHANNELS,
+            EVALUATIONS, static_cast<unsigned long long>(raised), static_cast<unsigned long long>(cleared),
+            ok ? "ok" : "wrong");
+
+    // A bad line rejects the whole text
+    bool rejected = engine.loadRules("above 0 30\nabove 1-0 30\n", 24) == -1 &&
+                    engine.loadRules("below 3 10 9\n", 13) == -1 &&  // clear below a low set level
+                    engine.loadRules("sideways * 1\n", 13) == -1 && engine.getRuleCount() == 60;
+
+    // '*' covers channels added later; explicit ranges do not
+    RuleEngineWASM growing(4);
+    growing.loadRules("above * 10\nbelow 0-3 -5", 23);
+    growing.setValue(100, 20.0f);
+    growing.setValue(101, -10.0f);
+    bool grown = growing.evaluate(0) == 1 && growing.isActive(100, RULE_ABOVE) && !growing.isActive(101, RULE_BELOW) &&
+                 growing.getChannelCount() == 102;
+    fprintf(stderr, "rule text  bad lines rejected %s, '*' on new channels %s\n", rejected ? "ok" : "wrong",
+            grown ? "ok" : "wrong");
+    return ok && rejected && grown;
+}
+
+static double timeEngine(std::vector<float>& values) {
+    RuleEngineWASM engine(LARGE_CHANNELS, WINDOW);
+    const char* rules = "above * 30 29\nbelow * 5 6\nrate * 30 20\nmean_above * 28 27";
+    engine.loadRules(rules, strlen(rules));
+    double start = emscripten_get_now();
+    uint64_t events = 0;
+    for (int e = 0; e < TIMED_EVALUATIONS; e++) {
+        for (size_t c = e % 7; c < LARGE_CHANNELS; c += 7) values[c] = walk(values[c]);
+        memcpy(engine.getValues(), values.data(), LARGE_CHANNELS * sizeof(float));
+        events += engine.evaluate(e * PERIOD_MS);
+    }
+    double elapsed = emscripten_get_now() - start;
+    fprintf(stderr, "engine     %d lanes: %6.2f ns/channel, %.0f M channels/s (in evaluate(): %.0f M), %llu events\n",
+            RULE_ENGINE_WASM_LANES, elapsed * 1e6 / (static_cast<double>(TIMED_EVALUATIONS) * LARGE_CHANNELS),
+            TIMED_EVALUATIONS * static_cast<double>(LARGE_CHANNELS) / elapsed / 1000.0,
+            engine.getChannelsPerSecond() / 1e6, static_cast<unsigned long long>(events));
+    return elapsed;
+}
+
+static double timeReference(std::vector<float>& values) {
+    Reference reference(LARGE_CHANNELS, WINDOW);
+    for (ReferenceChannel& channel : reference.channels) {
+        float set[RULE_KIND_COUNT] = {30, 5, 30, 28};
+        float clear[RULE_KIND_COUNT] = {29, 6, 20, 27};
+        std::copy(set, set + RULE_KIND_COUNT, channel.set);
+        std::copy(clear, clear + RULE_KIND_COUNT, channel.clear);
+    }
+    std::vector<RuleEventWASM> events;
+    uint64_t total = 0;
+    double start = emscripten_get_now();
+    for (int e = 0; e < TIMED_EVALUATIONS; e++) {
+        for (size_t c = e % 7; c < LARGE_CHANNELS; c += 7) values[c] = walk(values[c]);
+        for (size_t c = 0; c < LARGE_CHANNELS; c++) reference.channels[c].value = values[c];
+        reference.evaluate(e * PERIOD_MS, events);
+        total += events.size();
+    }
+    double elapsed = emscripten_get_now() - start;
+    fprintf(stderr, "reference  1 channel at a time: %6.2f ns/channel, %.0f M channels/s, %llu events\n",
+            elapsed * 1e6 / (static_cast<double>(TIMED_EVALUATIONS) * LARGE_CHANNELS),
+            TIMED_EVALUATIONS * static_cast<double>(LARGE_CHANNELS) / elapsed / 1000.0,
+            static_cast<unsigned long long>(total));
+    return elapsed;
+}
+
+// A typed reading frame, as published by the sensor nodes
+static std::string readingFrame(int sensor, float value) {
+    wasm_msgs__msg__SensorReading msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.sensor = static_cast<uint16_t>(sensor);
+    msg.value = value;
+    DDSFrameHeader header = {};
+    header.magic = DDS_FRAME_MAGIC;
+    header.topic_hash = ddsTopicHash("/sensor_data");
+    header.sequence_number = static_cast<uint32_t>(sensor);
+    header.payload_length = sizeof(msg);
+    std::string frame(sizeof(header) + sizeof(msg), '\0');
+    memcpy(&frame[0], &header, sizeof(header));
+    memcpy(&frame[sizeof(header)], &msg, sizeof(msg));
+    return frame;
+}
+
+// One frame per sensor, length-prefixed as processBatch() takes them; 20.0
+// unless overridden
+static std::vector<uint8_t> readingBatch(int sensors, const std::vector<std::pair<int, float>>& overrides) {
+    std::vector<uint8_t> batch;
+    for (int sensor = 0; sensor < sensors; sensor++) {
+        float value = 20.0f;
+        for (const std::pair<int, float>& o : overrides) {
+            if (o.first == sensor) value = o.second;
+        }
+        std::string frame = readingFrame(sensor, value);
+        uint32_t length = static_cast<uint32_t>(frame.size());
+        batch.insert(batch.end(), reinterpret_cast<const uint8_t*>(&length),
+                     reinterpret_cast<const uint8_t*>(&length) + sizeof(length));
+        batch.insert(batch.end(), frame.begin(), frame.end());
+    }
+    return batch;
+}
+
+static int processBatch(ROSSubscriberNodeWASM& node, const std::vector<uint8_t>& batch) {
+    uintptr_t address = node.reserveBatchBuffer(static_cast<int>(batch.size()));
+    memcpy(reinterpret_cast<void*>(address), batch.data(), batch.size());
+    return node.processBatch(address, static_cast<int>(batch.size()));
+}
+
+#ifdef __EMSCRIPTEN__
+// Values written through getChannelValuesView(), then evaluateRules(); returns the events
+EM_JS(int, jsBulkUpdate, (int channels), {
+    const node = new Module['ROSSubscriberNodeWASM']('rule_engine_js', '/sensor_data');
+    if (!node.init() || !node.setChannelCount(channels)) return -1;
+    const values = node.getChannelValuesView();
+    values.fill(20);
+    values[channels - 1] = 35;
+    const events = node.evaluateRules();
+    const ok = node.getActiveAlarms() == 1 && JSON.parse(node.getLastAlarm()).channel == channels - 1;
+    node.delete();
+    return ok ? events : -1;
+});
+#endif
+
+static bool checkNode() {
+    ROSSubscriberNodeWASM node("rule_engine_node", "/sensor_data");
+    if (!node.init()) return false;
+
+    // Default rule: any channel above 25, raised and cleared once
+    node.processMessage(readingFrame(1, 26.0f));
+    node.processMessage(readingFrame(1, 27.0f));
+    node.processMessage(readingFrame(1, 20.0f));
+    bool defaults = node.getAlarmsRaised() == 1 && node.getAlarmsCleared() == 1 && node.getActiveAlarms() == 0 &&
+                    node.getLastAlarm().find("\"raised\": false") != std::string::npos &&
+                    node.getAlarmTopicName() == "/sensor_data/alarms";
+
+    // Loaded rules over a gateway batch: one frame per sensor channel, rules evaluated once per batch
+    bool loaded = node.loadRules("window 4\nabove 0-2047 30 28\nbelow 5 2 3\n") == 2 && node.getChannelCount() == 2048;
+    int frames = processBatch(node, readingBatch(2048, {{7, 31.0f}, {700, 33.0f}, {2047, 30.5f}, {5, 1.0f}}));
+    bool raised = frames == 2048 && node.getActiveAlarms() == 4 && node.getAlarmsRaised() == 5;
+    processBatch(node, readingBatch(2048, {{700, 29.0f}}));  // Between the levels: stays raised
+    bool held = node.getActiveAlarms() == 1;
+    processBatch(node, readingBatch(2048, {}));
+    bool cleared = node.getActiveAlarms() == 0 && node.getAlarmsCleared() == 5;
+    fprintf(stderr, "node       default rule %s, batch of 2048 channels: raised %s, hysteresis %s, cleared %s "
+                    "(%.0f M channels/s)\n",
+            defaults ? "ok" : "wrong", raised ? "ok" : "wrong", held ? "ok" : "wrong", cleared ? "ok" : "wrong",
+            node.getRuleChannelsPerSecond() / 1e6);
+    bool ok = defaults && loaded && raised && held && cleared;
+
+#ifdef __EMSCRIPTEN__
+    int bulk = jsBulkUpdate(4096);
+    fprintf(stderr, "node       values written through the JS view: %s\n", bulk == 1 ? "ok" : "wrong");
+    ok = ok && bulk == 1;
+#else
+    fprintf(stderr, "node       JS view update skipped (needs Node.js: the view is a Float32Array over WASM memory)\n");
+#endif
+    return ok;
+}
+
+int main() {
+    bool ok = checkAgainstReference();
+
+    std::vector<float> values(LARGE_CHANNELS);
+    for (float& value : values) value = 0.25f * (nextRandom() % 161);
+    std::vector<float> engine_values = values;
+    double engine_ms = timeEngine(engine_values);
+    double reference_ms = timeReference(values);
+    ok = ok && engine_ms < reference_ms;
+
+    ok = checkNode() && ok;
+
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * Binary sensor record benchmark
+ *
+ * Compares the publisher/subscriber nodes' old sensor message path with the
+ * typed SensorReading record, per message, send and receive side:
+ * - json:   snprintf the sensor JSON, wrap it in the DDS JSON envelope
+ *           (serializeMessage's format), then on receipt cut "data" out of
+ *           the envelope and extract "value"
+ * - binary: fill the 20-byte record, serialize it with the rosidl type
+ *           support behind a DDSFrameHeader, then on receipt check the header
+ *           and deserialize (one memcpy)
+ * Checks first that the record round-trips through the type support and that
+ * its JSON rendering (the JS edge) carries the same fields. Reports bytes on
+ * the wire and ns per message; the binary path must be smaller and faster.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc bench/sensor_record.cpp -o sensor_record.js
+ * Run:            node sensor_record.js   (exit code 0 = pass)
+ */
+
+#include "dds_minimal_wasm.cpp"
+#include "json_extract_wasm.h"
+#include "rosidl_typesupport_wasm.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#define MESSAGES 200000
+#define TOPIC "/sensor_data"
+
+static const rosidl_message_type_support_t* ts = ROSIDL_GET_MSG_TYPE_SUPPORT(wasm_msgs, msg, SensorReading);
+
+static void fillReading(wasm_msgs__msg__SensorReading* reading, uint32_t i) {
+    double now_ms = emscripten_get_now();
+    reading->stamp.sec = static_cast<int32_t>(now_ms / 1000.0);
+    reading->stamp.nanosec = static_cast<uint32_t>((now_ms - reading->stamp.sec * 1000.0) * 1000000.0);
+    reading->id = i;
+    reading->sensor = WASM_MSGS__MSG__SENSOR_READING__SENSOR_TEMPERATURE;
+    reading->unit = WASM_MSGS__MSG__SENSOR_READING__UNIT_CELSIUS;
+    reading->value = 20.0f + (i % 10);
+}
+
+static bool checkRecord() {
+    wasm_msgs__msg__SensorReading reading, copy;
+    fillReading(&reading, 42);
+    reading.value = -12.5f;
+    uint8_t buffer[64];
+    size_t length = ts->serialize(&reading, buffer, sizeof(buffer));
+    bool ok = length == sizeof(reading) && ts->fixed_size == sizeof(reading) &&
+              ts->deserialize(buffer, length, &copy) && memcmp(&reading, &copy, sizeof(reading)) == 0 &&
+              !ts->deserialize(buffer, length - 1, &copy);
+
+    char json[256];
+    int json_length = wasm_msgs__msg__SensorReading__to_json(&reading, json, sizeof(json));
+    JsonExtractorWASM fields({"id", "sensor", "value", "unit", "stamp"});
+    JsonFieldWASM out[5];
+    ok = ok && fields.extract(json, json_length, out) == 5 && out[0].number == 42 &&
+         std::string(out[1].text, out[1].length) == "temperature" && out[2].number == -12.5 &&
+         std::string(out[3].text, out[3].length) == "celsius" &&
+         std::fabs(out[4].number - (reading.stamp.sec + reading.stamp.nanosec * 1e-9)) < 1e-6;
+    fprintf(stderr, "%zu-byte record, type support round trip + JSON edge: %s\n  %s\n", length,
+            ok ? "ok" : "wrong", json);
+    return ok;
+}
+
+int main() {
+    bool ok = checkRecord();
+
+    JsonExtractorWASM value_field({"value"});
+    double sum_json = 0, sum_binary = 0;
+    size_t bytes_json = 0, bytes_binary = 0;
+
+    // Old path: ros_publisher_wasm.cpp's payload in DDSPublisherWASM's envelope
+    double start = emscripten_get_now();
+    for (uint32_t i = 0; i < MESSAGES; i++) {
+        char payload[256];
+        snprintf(payload, sizeof(payload),
+                 "{\"id\": %u, \"sensor\": \"temperature\", \"value\": %.2f, \"unit\": \"celsius\"}",
+                 i, 20.0 + (i % 10));
+        char envelope[1024];
+        int length = snprintf(envelope, sizeof(envelope),
+                              "{\"topic\":\"%s\",\"type\":\"%s\",\"data\":\"%s\",\"seq\":%u,\"ts\":%llu}",
+                              TOPIC, "std_msgs::msg::String", payload, i,
+                              static_cast<unsigned long long>(emscripten_get_now()));
+        bytes_json += length;
+
+        // The payload is not escaped in the envelope; take everything up to ","seq"
+        std::string serialized(envelope, length);
+        size_t data_pos = serialized.find("\"data\":\"") + 8;
+        std::string data = serialized.substr(data_pos, serialized.rfind("\",\"seq\"") - data_pos);
+        JsonFieldWASM value;
+        if (value_field.extract(data.data(), data.size(), &value)) sum_json += value.number;
+    }
+    double json_ns = (emscripten_get_now() - start) * 1e6 / MESSAGES;
+
+    // New path: typed frame, as ros_publisher_wasm.cpp and ros_subscriber_wasm.cpp do it
+    uint32_t topic_hash = ddsTopicHash(TOPIC);
+    uint8_t frame[sizeof(DDSFrameHeader) + sizeof(wasm_msgs__msg__SensorReading)];
+    start = emscripten_get_now();
+    for (uint32_t i = 0; i < MESSAGES; i++) {
+        wasm_msgs__msg__SensorReading reading;
+        fillReading(&reading, i);
+        size_t length = ts->serialize(&reading, frame + sizeof(DDSFrameHeader), sizeof(frame) - sizeof(DDSFrameHeader));
+        DDSFrameHeader header;
+        header.magic = DDS_FRAME_MAGIC;
+        header.topic_hash = topic_hash;
+        header.sequence_number = i;
+        header.payload_length = static_cast<uint32_t>(length);
+        header.timestamp = static_cast<uint64_t>(emscripten_get_now());
+        memcpy(frame, &header, sizeof(header));
+        bytes_binary += sizeof(header) + length;
+
+        DDSFrameHeader received;
+        memcpy(&received, frame, sizeof(received));
+        wasm_msgs__msg__SensorReading taken;
+        if (received.magic == DDS_FRAME_MAGIC && received.topic_hash == topic_hash &&
+            ts->deserialize(frame + sizeof(received), received.payload_length, &taken)) {
+            sum_binary += taken.value;
+        }
+    }
+    double binary_ns = (emscripten_get_now() - start) * 1e6 / MESSAGES;
+
+    double json_bytes = static_cast<double>(bytes_json) / MESSAGES;
+    double binary_bytes = static_cast<double>(bytes_binary) / MESSAGES;
+    fprintf(stderr, "json:   %6.1f bytes/msg  %7.1f ns/msg\n", json_bytes, json_ns);
+    fprintf(stderr, "binary: %6.1f bytes/msg  %7.1f ns/msg  (%.1fx smaller, %.1fx faster)\n", binary_bytes,
+            binary_ns, json_bytes / binary_bytes, json_ns / binary_ns);
+
+    bool same = std::fabs(sum_json - sum_binary) < 1e-6 * std::fabs(sum_json);
+    if (!same) fprintf(stderr, "values differ: %f vs %f\n", sum_json, sum_binary);
+    ok = ok && same && binary_bytes < json_bytes && binary_ns < json_ns;
+
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
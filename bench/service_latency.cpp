@@ -0,0 +1,137 @@
+/*
+ * Service round-trip latency benchmark
+ *
+ * AddTwoInts client and server on one node (same-participant delivery, no
+ * network peer needed), through rcl -> RMW -> DDS request/reply topics:
+ * - sequential: one request in flight
+ * - pipelined:  PIPELINE_DEPTH requests in flight, answered in batches
+ * - timeout:    requests to a service nobody serves must be reported as timed out
+ * Every response is checked against its request via the sequence number.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/service_latency.cpp -o service_latency.js
+ * Run:            node service_latency.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "rcl_port_wasm.cpp"
+#include "rclc_port_wasm.cpp"
+#include "rosidl_typesupport_wasm.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#define ROUND_TRIPS 2000
+#define PIPELINE_DEPTH 8
+#define TIMEOUT_MS 5
+
+struct LatencyRun {
+    std::vector<double> samples;  // ms, indexed by sequence number - first sequence of the run
+    int matched;
+    double elapsed_ms;
+};
+
+static int64_t operand(int64_t sequence_number) {
+    return sequence_number * 3;
+}
+
+// Answer every queued request
+static void serve(rcl_service_t* service) {
+    rmw_request_id_t header;
+    example_interfaces__srv__AddTwoInts_Request request;
+    example_interfaces__srv__AddTwoInts_Response response;
+    while (rcl_take_request(service, &header, &request) == RCL_RET_OK) {
+        response.sum = request.a + request.b;
+        rcl_send_response(service, &header, &response);
+    }
+}
+
+static LatencyRun measure(rcl_service_t* service, rcl_client_t* client, int64_t first_sequence, int depth) {
+    LatencyRun run;
+    run.samples.assign(ROUND_TRIPS, 0.0);
+    run.matched = 0;
+    std::vector<double> send_times(ROUND_TRIPS, 0.0);
+
+    int sent = 0, received = 0, in_flight = 0;
+    double start = emscripten_get_now();
+    while (received < ROUND_TRIPS) {
+        while (in_flight < depth && sent < ROUND_TRIPS) {
+            int64_t sequence_number = 0;
+            example_interfaces__srv__AddTwoInts_Request request;
+            request.a = operand(first_sequence + sent);
+            request.b = 1;
+            send_times[sent] = emscripten_get_now();
+            if (rcl_send_request(client, &request, &sequence_number) != RCL_RET_OK) break;
+            sent++;
+            in_flight++;
+        }
+        serve(service);
+
+        // Sequence numbers continue across runs; rebase them for indexing
+        rmw_request_id_t header;
+        example_interfaces__srv__AddTwoInts_Response response;
+        while (rcl_take_response(client, &header, &response) == RCL_RET_OK) {
+            size_t index = static_cast<size_t>(header.sequence_number - first_sequence);
+            if (index < send_times.size()) {
+                run.samples[index] = emscripten_get_now() - send_times[index];
+                if (response.sum == operand(header.sequence_number) + 1) run.matched++;
+            }
+            received++;
+            in_flight--;
+        }
+    }
+    run.elapsed_ms = emscripten_get_now() - start;
+    return run;
+}
+
+static void report(const char* name, LatencyRun run) {
+    std::sort(run.samples.begin(), run.samples.end());
+    size_t n = run.samples.size();
+    fprintf(stderr, "%-10s %d/%d matched  p50 %.4f ms  p99 %.4f ms  max %.4f ms  %.0f req/s\n",
+            name, run.matched, static_cast<int>(n), run.samples[n / 2], run.samples[(n * 99) / 100],
+            run.samples[n - 1], n * 1000.0 / run.elapsed_ms);
+}
+
+int main() {
+    rclc_support_t support;
+    rcl_node_t node;
+    rcl_service_t service;
+    rcl_client_t client, orphan_client;
+    const rosidl_service_type_support_t* type_support = ROSIDL_GET_SRV_TYPE_SUPPORT(example_interfaces, srv, AddTwoInts);
+    rcl_client_options_t timeout_options;
+    timeout_options.request_timeout_ms = TIMEOUT_MS;
+
+    if (rclc_support_init(&support, 0, NULL, NULL) != RCL_RET_OK ||
+        rclc_node_init_default(&node, "service_latency", "", &support) != RCL_RET_OK ||
+        rclc_service_init_default(&service, &node, type_support, "/add_two_ints") != RCL_RET_OK ||
+        rclc_client_init_default(&client, &node, type_support, "/add_two_ints") != RCL_RET_OK ||
+        rcl_client_init(&orphan_client, &node, type_support, "/nobody_serves_this", &timeout_options) != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+
+    LatencyRun sequential = measure(&service, &client, 1, 1);
+    LatencyRun pipelined = measure(&service, &client, 1 + ROUND_TRIPS, PIPELINE_DEPTH);
+    report("sequential", sequential);
+    report("pipelined", pipelined);
+
+    // Unanswered requests must each be reported as timed out
+    int64_t expected_timeouts[3];
+    example_interfaces__srv__AddTwoInts_Request request = {1, 2};
+    for (int i = 0; i < 3; i++) {
+        rcl_send_request(&orphan_client, &request, &expected_timeouts[i]);
+    }
+    double deadline = emscripten_get_now() + 2 * TIMEOUT_MS;
+    while (emscripten_get_now() < deadline) {}
+    int timeouts = 0;
+    rmw_request_id_t header;
+    while (rcl_client_take_timeout(&orphan_client, &header) == RCL_RET_OK) {
+        if (std::find(expected_timeouts, expected_timeouts + 3, header.sequence_number) != expected_timeouts + 3) timeouts++;
+    }
+    fprintf(stderr, "timeout    %d/3 requests reported after %d ms\n", timeouts, TIMEOUT_MS);
+
+    if (sequential.matched != ROUND_TRIPS || pipelined.matched != ROUND_TRIPS || timeouts != 3) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
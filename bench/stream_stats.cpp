@@ -0,0 +1,155 @@
+/*
+ * Streaming statistics check
+ *
+ * Feeds SAMPLES pseudo-random values (a noisy sine, like the temperature
+ * topic) into StreamStatsWASM and, after every sample, compares the window
+ * mean, standard deviation, min and max with a brute-force pass over the
+ * same window, for a count window and a time window. The P² percentiles are
+ * compared with exact ones at the end. Then times add() plus every getter
+ * for windows of 10 up to LARGE_WINDOW samples: the cost per sample must
+ * not grow with the window.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc bench/stream_stats.cpp -o stream_stats.js
+ * Run:            node stream_stats.js   (exit code 0 = pass)
+ */
+
+#include "stream_stats_wasm.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+#define SAMPLES 20000
+#define WINDOW 100
+#define TIME_WINDOW_MS 50.0
+#define LARGE_WINDOW 100000
+#define TIMED_SAMPLES 1000000
+#define TOLERANCE 1e-6
+#define PERCENTILE_TOLERANCE 0.02  // Of the value range
+
+static uint64_t rng_state = 88172645463325252ull;
+
+static double uniform() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (rng_state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double sample(int i) {
+    return 22.0 + 3.0 * std::sin(i * 0.01) + 2.0 * (uniform() - 0.5);
+}
+
+struct Sample {
+    double value;
+    double time_ms;
+};
+
+static bool near(double a, double b) {
+    return std::fabs(a - b) <= TOLERANCE * (1.0 + std::fabs(b));
+}
+
+// Window statistics against a recomputation over `window` after every sample
+static bool checkWindow(const char* name, size_t capacity, double window_ms) {
+    StreamStatsWASM stats(capacity, window_ms);
+    std::deque<Sample> window;
+    int mismatches = 0;
+    double now = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        now += uniform();  // 0.5 ms apart on average
+        double x = sample(i);
+        stats.add(x, now);
+        window.push_back({x, now});
+        if (window.size() > capacity) window.pop_front();
+        while (window_ms > 0 && window.front().time_ms < now - window_ms) window.pop_front();
+
+        double sum = 0, lo = window.front().value, hi = lo;
+        for (const Sample& s : window) {
+            sum += s.value;
+            lo = std::min(lo, s.value);
+            hi = std::max(hi, s.value);
+        }
+        double mean = sum / window.size();
+        double m2 = 0;
+        for (const Sample& s : window) m2 += (s.value - mean) * (s.value - mean);
+        double stddev = window.size() > 1 ? std::sqrt(m2 / (window.size() - 1)) : 0.0;
+
+        if (stats.size() != window.size() || !near(stats.getMean(), mean) || !near(stats.getStdDev(), stddev) ||
+            stats.getMin() != lo || stats.getMax() != hi) {
+            if (mismatches++ == 0) {
+                fprintf(stderr, "%s: sample %d: size %zu/%zu mean %.9f/%.9f stddev %.9f/%.9f min %f/%f max %f/%f\n",
+                        name, i, stats.size(), window.size(), stats.getMean(), mean, stats.getStdDev(), stddev,
+                        stats.getMin(), lo, stats.getMax(), hi);
+            }
+        }
+    }
+    fprintf(stderr, "%-12s %d samples  %d mismatches  final window %zu\n", name, SAMPLES, mismatches, stats.size());
+    return mismatches == 0;
+}
+
+static bool checkPercentiles() {
+    StreamStatsWASM stats(WINDOW);
+    std::vector<double> all;
+    for (int i = 0; i < SAMPLES; i++) {
+        double x = sample(i);
+        stats.add(x, 0);
+        all.push_back(x);
+    }
+    std::sort(all.begin(), all.end());
+    double range = all.back() - all.front();
+    double exact[3] = {all[all.size() / 2], all[static_cast<size_t>(all.size() * 0.95)],
+                       all[static_cast<size_t>(all.size() * 0.99)]};
+    double estimated[3] = {stats.getMedian(), stats.getP95(), stats.getP99()};
+    const char* names[3] = {"median", "p95", "p99"};
+    bool ok = true;
+    for (int i = 0; i < 3; i++) {
+        double error = std::fabs(estimated[i] - exact[i]) / range;
+        fprintf(stderr, "%-12s exact %.4f  P² %.4f  error %.2f%% of range\n", names[i], exact[i], estimated[i],
+                error * 100);
+        ok = ok && error <= PERCENTILE_TOLERANCE;
+    }
+    double total_mean = 0;
+    for (double x : all) total_mean += x;
+    total_mean /= all.size();
+    ok = ok && near(stats.getTotalMean(), total_mean) && stats.getTotalCount() == SAMPLES;
+    return ok;
+}
+
+// ns per add() plus one read of every statistic
+static double timePerSample(size_t capacity) {
+    StreamStatsWASM stats(capacity);
+    double sink = 0;
+    double start = emscripten_get_now();
+    for (int i = 0; i < TIMED_SAMPLES; i++) {
+        stats.add(sample(i), 0);
+        sink += stats.getMean() + stats.getStdDev() + stats.getMin() + stats.getMax() + stats.getMedian() +
+                stats.getP95() + stats.getP99();
+    }
+    double elapsed = emscripten_get_now() - start;
+    if (sink == 0) fprintf(stderr, " ");
+    return elapsed * 1e6 / TIMED_SAMPLES;
+}
+
+int main() {
+    bool ok = checkWindow("count window", WINDOW, 0);
+    ok = checkWindow("time window", SAMPLES, TIME_WINDOW_MS) && ok;
+    ok = checkPercentiles() && ok;
+
+    double small = timePerSample(10);
+    double large = timePerSample(LARGE_WINDOW);
+    fprintf(stderr, "window %6d: %.1f ns/sample\nwindow %6d: %.1f ns/sample\n", 10, small, LARGE_WINDOW, large);
+    // Allow for cache effects of the larger ring, not for O(window) work
+    if (large > small * 4) {
+        fprintf(stderr, "cost grows with the window\n");
+        ok = false;
+    }
+
+    if (!ok) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,267 @@
+/*
+ * Timer jitter benchmark
+ *
+ * Checks the timer wheel and rcl timers against a fake clock
+ * (rcl_set_steady_clock), so the results do not depend on the host:
+ * - wheel cost: with BACKGROUND_TIMERS timers of 1 ms .. 1 s periods, every
+ *   timer is visited at most once per wheel level before it expires
+ * - drift correction: a 1 kHz timer spun at irregular steps shorter than its
+ *   period (next to BACKGROUND_TIMERS more on the same executor) is called
+ *   once per period, stays on its phase and is never later than one step;
+ *   every background timer gets all its calls
+ * - missed-period compensation: a call 5.5 periods late skips (and counts)
+ *   5 periods and keeps the phase instead of firing back to back
+ * Then the same 1 kHz timer runs on the real clock, alone and with the
+ * background timers, and its lateness (p50/p99/max) and missed periods are
+ * reported; these depend on the host and are not checked.
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/timer_jitter.cpp -o timer_jitter.js
+ * Run:            node timer_jitter.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "rcl_port_wasm.cpp"
+#include "rclc_port_wasm.cpp"
+#include "rosidl_typesupport_wasm.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#define PERIOD_NS 1000000        // 1 kHz
+#define DURATION_MS 2000
+#define BACKGROUND_TIMERS 1000
+#define MIN_STEP_NS 100000       // Fake clock steps: 0.1 .. 0.9 ms, all shorter than any period
+#define MAX_STEP_NS 900000
+#define LATE_PERIODS 5           // Plus half a period
+
+static int failures = 0;
+
+static void expect(const char* what, int64_t value, int64_t expected) {
+    bool ok = value == expected;
+    fprintf(stderr, "%-56s %8lld  (expected %lld)%s\n", what, static_cast<long long>(value),
+            static_cast<long long>(expected), ok ? "" : "  FAIL");
+    if (!ok) failures++;
+}
+
+static void expectAtMost(const char* what, int64_t value, int64_t limit) {
+    bool ok = value <= limit;
+    fprintf(stderr, "%-56s %8lld  (at most %lld)%s\n", what, static_cast<long long>(value),
+            static_cast<long long>(limit), ok ? "" : "  FAIL");
+    if (!ok) failures++;
+}
+
+static int64_t fake_now_ns = 0;
+
+static int64_t fakeClock() {
+    return fake_now_ns;
+}
+
+// Deterministic irregular steps
+static uint32_t step_state = 12345;
+
+static int64_t nextStep() {
+    step_state = step_state * 1664525u + 1013904223u;
+    return MIN_STEP_NS + static_cast<int64_t>((step_state >> 8) % (MAX_STEP_NS - MIN_STEP_NS + 1));
+}
+
+// Periods spread over 1 ms .. 1 s
+static int64_t backgroundPeriod(int i) {
+    return static_cast<int64_t>(1 + i % 1000) * 1000000;
+}
+
+static rcl_publisher_t publisher;
+static std::vector<double> lateness_ms;
+static double next_expected_ms = 0;
+static int64_t phase_origin_ns = 0;
+static int off_phase = 0;
+static int background_calls = 0;
+
+// Fake clock: the next call must stay on the phase set at init
+static void onFakeTick(rcl_timer_t* timer, int64_t last_call_time) {
+    (void)last_call_time;
+    int64_t until_next = 0;
+    rcl_timer_get_time_until_next_call(timer, &until_next);
+    int64_t next = fake_now_ns + until_next - phase_origin_ns;
+    if (until_next <= 0 || until_next > PERIOD_NS || next % PERIOD_NS != 0) off_phase++;
+}
+
+static void onTick(rcl_timer_t* timer, int64_t last_call_time) {
+    (void)last_call_time;
+    double now = emscripten_get_now();
+    lateness_ms.push_back(now - next_expected_ms);
+    int64_t until_next = 0;
+    rcl_timer_get_time_until_next_call(timer, &until_next);
+    next_expected_ms = now + until_next / 1000000.0;
+
+    std_msgs__msg__Float64 msg;
+    msg.data = now;
+    rcl_publish(&publisher, &msg, NULL);
+}
+
+static void onBackground(rcl_timer_t*, int64_t) {
+    background_calls++;
+}
+
+// The wheel alone, on ticks of fake time; expired timers are rescheduled a period on
+static void checkWheel() {
+    TimerWheelWASM wheel(0);
+    std::vector<TimerWheelNodeWASM> nodes(BACKGROUND_TIMERS);
+    std::vector<int64_t> deadlines(BACKGROUND_TIMERS);
+    for (int i = 0; i < BACKGROUND_TIMERS; i++) {
+        deadlines[i] = backgroundPeriod(i);
+        wheel.schedule(&nodes[i], deadlines[i]);
+    }
+    int64_t expiries = 0;
+    for (int64_t now = wheel.getTickNs(); now <= DURATION_MS * 1000000ll; now += wheel.getTickNs()) {
+        wheel.advance(now);
+        for (int i = 0; i < BACKGROUND_TIMERS; i++) {
+            if (nodes[i].expired) {
+                expiries++;
+                deadlines[i] += backgroundPeriod(i);
+                wheel.schedule(&nodes[i], deadlines[i]);
+            }
+        }
+    }
+    fprintf(stderr, "wheel     %d timers, %lld expiries, %llu visits over %d ms of %lld ns ticks\n",
+            BACKGROUND_TIMERS, static_cast<long long>(expiries), static_cast<unsigned long long>(wheel.getVisits()),
+            DURATION_MS, static_cast<long long>(wheel.getTickNs()));
+    expect("wheel: timers still scheduled", static_cast<int64_t>(wheel.getScheduled()), BACKGROUND_TIMERS);
+    // Timers still waiting may have been re-filed without expiring yet
+    expectAtMost("wheel: visits", static_cast<int64_t>(wheel.getVisits()),
+                 TimerWheelWASM::getLevels() * (expiries + BACKGROUND_TIMERS));
+}
+
+static void checkFakeClock(rclc_support_t* support, rcl_allocator_t* allocator) {
+    rclc_executor_t executor;
+    rcl_timer_t timer;
+    std::vector<rcl_timer_t> others(BACKGROUND_TIMERS);
+
+    fake_now_ns = 1000000000;
+    phase_origin_ns = fake_now_ns;
+    rclc_executor_init(&executor, support->context, 1 + BACKGROUND_TIMERS, allocator);
+    rclc_timer_init_default(&timer, support, PERIOD_NS, onFakeTick);
+    rclc_executor_add_timer(&executor, &timer);
+    for (int i = 0; i < BACKGROUND_TIMERS; i++) {
+        rclc_timer_init_default(&others[i], support, backgroundPeriod(i), onBackground);
+        rclc_executor_add_timer(&executor, &others[i]);
+    }
+
+    off_phase = 0;
+    background_calls = 0;
+    int64_t end = phase_origin_ns + DURATION_MS * 1000000ll;
+    while (fake_now_ns + MAX_STEP_NS <= end) {
+        fake_now_ns += nextStep();
+        rclc_executor_spin_some(&executor, 0);
+    }
+    int64_t elapsed = fake_now_ns - phase_origin_ns;
+    int64_t expected_background = 0;
+    for (int i = 0; i < BACKGROUND_TIMERS; i++) {
+        expected_background += elapsed / backgroundPeriod(i);
+    }
+
+    rcl_timer_statistics_t stats;
+    rcl_timer_get_statistics(&timer, &stats);
+    expect("irregular steps: 1 kHz calls", static_cast<int64_t>(stats.calls), elapsed / PERIOD_NS);
+    expect("irregular steps: calls off phase", off_phase, 0);
+    expect("irregular steps: missed periods", static_cast<int64_t>(stats.missed_periods), 0);
+    expectAtMost("irregular steps: max lateness (ns)", stats.max_lateness_ns, MAX_STEP_NS - 1);
+    expect("irregular steps: background calls", background_calls, expected_background);
+
+    int64_t until_next = 0;
+    rcl_timer_get_time_until_next_call(&timer, &until_next);
+    uint64_t calls = stats.calls;
+    fake_now_ns += until_next + LATE_PERIODS * PERIOD_NS + PERIOD_NS / 2;
+    rclc_executor_spin_some(&executor, 0);
+    rcl_timer_get_statistics(&timer, &stats);
+    rcl_timer_get_time_until_next_call(&timer, &until_next);
+    expect("5.5 periods late: calls", static_cast<int64_t>(stats.calls - calls), 1);
+    expect("5.5 periods late: missed periods", static_cast<int64_t>(stats.missed_periods), LATE_PERIODS);
+    expect("5.5 periods late: time to next call (ns)", until_next, PERIOD_NS / 2);
+    expect("5.5 periods late: calls off phase", off_phase, 0);
+
+    for (int i = 0; i < BACKGROUND_TIMERS; i++) {
+        rcl_timer_fini(&others[i]);
+    }
+    rcl_timer_fini(&timer);
+    rclc_executor_fini(&executor);
+}
+
+// Real clock: lateness is reported, not checked
+static void run(const char* name, rclc_support_t* support, rcl_allocator_t* allocator, int background) {
+    rclc_executor_t executor;
+    rcl_timer_t timer;
+    std::vector<rcl_timer_t> others(background);
+
+    rclc_executor_init(&executor, support->context, 1 + background, allocator);
+    rclc_timer_init_default(&timer, support, PERIOD_NS, onTick);
+    rclc_executor_add_timer(&executor, &timer);
+    for (int i = 0; i < background; i++) {
+        rclc_timer_init_default(&others[i], support, backgroundPeriod(i), onBackground);
+        rclc_executor_add_timer(&executor, &others[i]);
+    }
+
+    lateness_ms.clear();
+    lateness_ms.reserve(DURATION_MS * 2);
+    background_calls = 0;
+    int64_t first = 0;
+    rcl_timer_get_time_until_next_call(&timer, &first);
+    next_expected_ms = emscripten_get_now() + first / 1000000.0;
+
+    double start = emscripten_get_now();
+    long spins = 0;
+    while (emscripten_get_now() - start < DURATION_MS) {
+        rclc_executor_spin_some(&executor, 0);
+        spins++;
+    }
+    double elapsed = emscripten_get_now() - start;
+
+    rcl_timer_statistics_t stats;
+    rcl_timer_get_statistics(&timer, &stats);
+    std::vector<double> sorted = lateness_ms;
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    double expected_calls = elapsed * 1000000.0 / PERIOD_NS;
+    fprintf(stderr, "%-12s %zu calls (%.0f expected), missed %llu, lateness p50 %.4f ms  p99 %.4f ms  max %.4f ms, "
+            "%.2f us/spin, %d background calls\n",
+            name, n, expected_calls, static_cast<unsigned long long>(stats.missed_periods),
+            n ? sorted[n / 2] : 0.0, n ? sorted[(n * 99) / 100] : 0.0, stats.max_lateness_ns / 1000000.0,
+            elapsed * 1000.0 / spins, background_calls);
+
+    for (int i = 0; i < background; i++) {
+        rcl_timer_fini(&others[i]);
+    }
+    rcl_timer_fini(&timer);
+    rclc_executor_fini(&executor);
+}
+
+int main() {
+    rclc_support_t support;
+    rcl_node_t node;
+    rcl_allocator_t allocator = rcl_get_default_allocator();
+    if (rclc_support_init(&support, 0, NULL, &allocator) != RCL_RET_OK ||
+        rclc_node_init_default(&node, "timer_jitter", "", &support) != RCL_RET_OK ||
+        rclc_publisher_init_default(&publisher, &node, ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, Float64),
+                                    "/timer_jitter") != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+
+    checkWheel();
+    if (rcl_set_steady_clock(fakeClock) != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: fake clock\n");
+        return 1;
+    }
+    checkFakeClock(&support, &allocator);
+    if (rcl_set_steady_clock(NULL) != RCL_RET_OK) {
+        fprintf(stderr, "FAIL: real clock\n");
+        return 1;
+    }
+
+    run("1kHz alone", &support, &allocator, 0);
+    run("1kHz +1000", &support, &allocator, BACKGROUND_TIMERS);
+    if (failures > 0) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * Remote type match check
+ *
+ * Two participants discover each other's endpoints over multicast. Types
+ * are compared once, when a remote endpoint is matched:
+ * - same type name and hash: matched on both sides
+ * - same name, different hash: refused by the publisher and the subscriber
+ * - different name (no hashes): refused
+ * - a refused writer's frames are dropped by the subscriber
+ * - endpoints configured by hand (addSubscriberEndpoint) go through the
+ *   same check, on the type name
+ * - repeated announcements keep the verdicts; a removed endpoint is unmatched
+ *
+ * Build (WASM):   emcc -O2 -std=c++17 -Isrc --bind bench/type_match.cpp -o type_match.js
+ * Run:            node type_match.js >/dev/null   (results go to stderr; exit code 0 = pass)
+ */
+
+#include "dds_minimal_wasm.cpp"
+#include <cstdio>
+
+#define TYPE_DOMAIN 24
+#define TYPE_NAME "type_check::msg::Blob"
+#define TYPE_HASH 0x1111222233334444ull
+#define OTHER_HASH 0x5555666677778888ull
+#define ROUNDS 5
+#define POLLS_PER_ROUND 50
+#define PAYLOAD 16
+
+static int failures = 0;
+
+static void expect(const char* what, uint64_t value, uint64_t expected) {
+    bool ok = value == expected;
+    fprintf(stderr, "%-52s %4llu  (expected %llu)%s\n", what, static_cast<unsigned long long>(value),
+            static_cast<unsigned long long>(expected), ok ? "" : "  FAIL");
+    if (!ok) failures++;
+}
+
+static void discoveryRounds(DDSParticipantWASM& first, DDSParticipantWASM& second) {
+    for (int round = 0; round < ROUNDS; round++) {
+        first.discoverParticipants();
+        second.discoverParticipants();
+        for (int poll = 0; poll < POLLS_PER_ROUND; poll++) {
+            first.getNetworkManager()->poll();
+            second.getNetworkManager()->poll();
+        }
+    }
+}
+
+int main() {
+    DDSParticipantWASM writers("type_check_writers", TYPE_DOMAIN);
+    DDSParticipantWASM readers("type_check_readers", TYPE_DOMAIN);
+    if (!writers.init() || !readers.init()) {
+        fprintf(stderr, "FAIL: setup\n");
+        return 1;
+    }
+
+    DDSPublisherWASM same(&writers, "/type_check/same", TYPE_NAME, TYPE_HASH);
+    DDSPublisherWASM hash(&writers, "/type_check/hash", TYPE_NAME, TYPE_HASH);
+    DDSPublisherWASM name(&writers, "/type_check/name", TYPE_NAME);
+    DDSSubscriberWASM* same_reader = new DDSSubscriberWASM(&readers, "/type_check/same", TYPE_NAME, TYPE_HASH);
+    DDSSubscriberWASM hash_reader(&readers, "/type_check/hash", TYPE_NAME, OTHER_HASH);
+    DDSSubscriberWASM name_reader(&readers, "/type_check/name", "type_check::msg::Other");
+    if (!same.init() || !hash.init() || !name.init() || !same_reader->init() || !hash_reader.init() ||
+        !name_reader.init()) {
+        fprintf(stderr, "FAIL: endpoints\n");
+        return 1;
+    }
+
+    discoveryRounds(writers, readers);
+    expect("same type: publisher matched_remote", same.getMetric(PUBLISHER_MATCHED_REMOTE), 1);
+    expect("same type: subscriber matched_remote", same_reader->getMetric(SUBSCRIBER_MATCHED_REMOTE), 1);
+    expect("other hash: publisher refused_remote", hash.getMetric(PUBLISHER_REFUSED_REMOTE), 1);
+    expect("other hash: publisher matched_remote", hash.getMetric(PUBLISHER_MATCHED_REMOTE), 0);
+    expect("other hash: subscriber refused_remote", hash_reader.getMetric(SUBSCRIBER_REFUSED_REMOTE), 1);
+    expect("other hash: subscriber matched_remote", hash_reader.getMetric(SUBSCRIBER_MATCHED_REMOTE), 0);
+    expect("other name: publisher refused_remote", name.getMetric(PUBLISHER_REFUSED_REMOTE), 1);
+    expect("other name: subscriber refused_remote", name_reader.getMetric(SUBSCRIBER_REFUSED_REMOTE), 1);
+
+    // The refused writer's frame, as it would arrive from the network
+    uint8_t* payload = hash.loanPayload(PAYLOAD);
+    memset(payload, 0, PAYLOAD);
+    hash.publishLoaned(PAYLOAD);
+    hash_reader.receiveBytes(payload - sizeof(DDSFrameHeader), sizeof(DDSFrameHeader) + PAYLOAD);
+    expect("refused writer's frame: delivered", hash_reader.getMessagesReceived(), 0);
+    expect("refused writer's frame: rejected", hash_reader.getMetric(SUBSCRIBER_REJECTED), 1);
+
+    int port = readers.getUnicastPort();
+    expect("by hand, other type name: added", same.addSubscriberEndpoint("127.0.0.1", port, "type_check::msg::Other"),
+           0);
+    expect("by hand, same type name: added", same.addSubscriberEndpoint("127.0.0.1", port + 1, TYPE_NAME), 1);
+    expect("... publisher matched_remote", same.getMetric(PUBLISHER_MATCHED_REMOTE), 2);
+
+    discoveryRounds(writers, readers);
+    expect("after announcement rounds: matched_remote", same.getMetric(PUBLISHER_MATCHED_REMOTE), 2);
+    expect("after announcement rounds: refused_remote", hash.getMetric(PUBLISHER_REFUSED_REMOTE), 1);
+
+    delete same_reader;
+    discoveryRounds(writers, readers);
+    expect("remote subscriber destroyed: matched_remote", same.getMetric(PUBLISHER_MATCHED_REMOTE), 1);
+
+    if (failures > 0) {
+        fprintf(stderr, "FAIL\n");
+        return 1;
+    }
+    fprintf(stderr, "PASS\n");
+    return 0;
+}
@@ -76,14 +76,32 @@ emcc src/ros_subscriber_wasm.cpp \
     -s MODULARIZE=1 \
     -s EXPORT_NAME="createROSSubscriberModule" \
     -s EXPORTED_FUNCTIONS='["_malloc","_free"]' \
-    -s EXPORTED_RUNTIME_METHODS='["ccall","cwrap","UTF8ToString","addOnPostRun"]' \
+    -s EXPORTED_RUNTIME_METHODS='["ccall","cwrap","UTF8ToString","addOnPostRun","HEAPU8"]' \
     -s ALLOW_MEMORY_GROWTH=1 \
     -s MAXIMUM_MEMORY=128MB \
     -s ENVIRONMENT=web,worker \
     -O2 \
+    -msimd128 \
     --bind \
     -o wasm_output/ros_subscriber.js
 
+# Build multi-topic ROS node (publishers and subscriptions on one participant)
+echo "Building multi-topic ROS node (WASM) - Minimal DDS..."
+echo "----------------------------------------"
+emcc src/multi_topic_node_wasm.cpp \
+    -I. \
+    -s WASM=1 \
+    -s MODULARIZE=1 \
+    -s EXPORT_NAME="createROSMultiTopicModule" \
+    -s EXPORTED_FUNCTIONS='["_malloc","_free"]' \
+    -s EXPORTED_RUNTIME_METHODS='["ccall","cwrap","UTF8ToString","addOnPostRun"]' \
+    -s ALLOW_MEMORY_GROWTH=1 \
+    -s MAXIMUM_MEMORY=128MB \
+    -s ENVIRONMENT=web,worker \
+    -O2 \
+    --bind \
+    -o wasm_output/multi_topic_node.js
+
 # Build microROS Subscriber node (using microROS API)
 echo "Building microROS Subscriber node (WASM)..."
 echo "----------------------------------------"
@@ -111,6 +129,22 @@ else
 fi
 echo ""
 
+# Build the end-to-end pub/sub benchmark for Node.js (bench/pubsub_e2e.cpp)
+# Run: node wasm_output/pubsub_e2e.js [--full] [--csv FILE] [--baseline FILE]
+echo "Building end-to-end pub/sub benchmark (Node.js)..."
+echo "----------------------------------------"
+emcc bench/pubsub_e2e.cpp \
+    -Isrc \
+    -s WASM=1 \
+    -s NODERAWFS=1 \
+    -s ALLOW_MEMORY_GROWTH=1 \
+    -s MAXIMUM_MEMORY=1GB \
+    -s ENVIRONMENT=node \
+    -O2 \
+    --bind \
+    -o wasm_output/pubsub_e2e.js
+echo ""
+
 echo "=========================================="
 echo "Build complete!"
 echo "=========================================="
@@ -118,8 +152,10 @@ echo ""
 echo "WASM modules:"
 echo "  • Minimal DDS Publisher:  wasm_output/ros_publisher.{js,wasm}"
 echo "  • Minimal DDS Subscriber: wasm_output/ros_subscriber.{js,wasm}"
+echo "  • Minimal DDS multi-topic: wasm_output/multi_topic_node.{js,wasm}"
 echo "  • microROS Publisher:     wasm_output/microros_publisher.{js,wasm}"
 echo "  • microROS Subscriber:     wasm_output/microros_subscriber.{js,wasm}"
+echo "  • Pub/sub benchmark (Node): wasm_output/pubsub_e2e.{js,wasm}"
 echo ""
 echo "Note: microROS modules use microROS API (rcl/rclc) but need full porting"
 echo "      Currently using placeholder implementations"
@@ -0,0 +1,71 @@
+/*
+ * JS Binding Layer for WASM and Native Builds
+ *
+ * Every class exposed to JS is registered in an EMSCRIPTEN_BINDINGS block
+ * next to its implementation. Sources include this instead of
+ * <emscripten/bind.h>:
+ * - Emscripten: embind as is.
+ * - Native: the part of the embind API the blocks use (class_, constructor,
+ *   function, allow_raw_pointers, val, typed_memory_view) as no-ops, so the
+ *   blocks are still type-checked but register nothing and are never run.
+ *   View getters return an empty val; native hosts read the underlying
+ *   arrays through the C++ accessors instead.
+ */
+
+#ifndef BINDINGS_WASM_H
+#define BINDINGS_WASM_H
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/bind.h>
+#include <emscripten/val.h>
+#else
+#include <cstddef>
+
+namespace emscripten {
+
+struct allow_raw_pointers {};
+
+template <typename... Args>
+struct constructor {};
+
+template <typename T>
+struct memory_view {
+    size_t size;
+    const T* data;
+};
+
+template <typename T>
+memory_view<T> typed_memory_view(size_t size, const T* data) {
+    return memory_view<T>{size, data};
+}
+
+// A JS value; there is no JS side natively, so it holds nothing
+class val {
+public:
+    val() {}
+    template <typename T>
+    explicit val(const T&) {}
+};
+
+template <typename T>
+class class_ {
+public:
+    explicit class_(const char*) {}
+
+    template <typename... Args>
+    class_& constructor() {
+        return *this;
+    }
+
+    template <typename F, typename... Policies>
+    class_& function(const char*, F, Policies...) {
+        return *this;
+    }
+};
+
+} // namespace emscripten
+
+#define EMSCRIPTEN_BINDINGS(name) [[maybe_unused]] static void embind_native_##name()
+#endif
+
+#endif // BINDINGS_WASM_H
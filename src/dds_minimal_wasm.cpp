@@ -7,20 +7,32 @@
  * Features:
  * - DDS Participant discovery (UDP-based)
  * - Publisher/Subscriber with topic matching
+ * - Remote endpoints matched on type name and rosidl type hash; mismatches
+ *   refused (counted as refused_remote) and their frames dropped
  * - Message serialization/deserialization
+ * - RTPS port mapping: up to DDS_MAX_PARTICIPANT_ID + 1 participants per
+ *   domain and host share the discovery port; each gets an ID and its own
+ *   unicast port, where typed frames for its subscribers arrive
+ * - Frames larger than one UDP datagram fragmented and reassembled
  * - WASI networking support
  */
 
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
+#include <algorithm>
 #include <string>
 #include <cstdio>
 #include <vector>
 #include <map>
 #include <functional>
 #include <cstring>
+#include <cstddef>
 #include <cstdint>
 #include "wasi_networking.cpp"
+#include "rcl_allocator_wasm.h"
+#include "log_wasm.h"
+#include "metrics_wasm.h"
+#include "trace_wasm.h"
 
 // DDS Message structure
 struct DDSMessage {
@@ -31,18 +43,367 @@ struct DDSMessage {
     uint32_t sequence_number;
 };
 
+// Binary frame header for typed payloads (serialized by rosidl type support).
+// The payload follows the header directly; type compatibility is checked at
+// endpoint match, so frames only carry the topic hash. Writer GUID and
+// sequence number identify the sample in every process (traces correlate on them).
+#define DDS_FRAME_MAGIC 0x42534444u  // "DDSB"
+
+struct DDSFrameHeader {
+    uint32_t magic;
+    uint32_t topic_hash;
+    uint32_t sequence_number;
+    uint32_t payload_length;
+    uint64_t timestamp;
+    uint8_t writer_guid[16];  // Participant GUID (last 12 bytes) + writer ID
+};
+
+// Trace key of a received frame, for the network I/O thread
+inline bool ddsFrameTraceKey(const uint8_t* data, size_t length, TraceKeyWASM* key) {
+    DDSFrameHeader header;
+    if (length < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != DDS_FRAME_MAGIC) return false;
+    memcpy(key->writer_guid, header.writer_guid, sizeof(key->writer_guid));
+    key->sequence = header.sequence_number;
+    key->topic_hash = header.topic_hash;
+    return true;
+}
+
+// Frames longer than one datagram (NET_MAX_DATAGRAM) go to remote
+// participants as fragments, each a DDSFragmentHeader and the next
+// DDS_FRAGMENT_BYTES of the frame; the receiving participant puts the frame
+// back together before any subscriber sees it. A frame missing a fragment is
+// dropped when the writer's next frame starts (best effort, as UDP).
+#define DDS_FRAGMENT_MAGIC 0x46534444u  // "DDSF"
+#define DDS_MAX_FRAME_BYTES (8u << 20)  // Header + payload; larger publishes fail
+
+struct DDSFragmentHeader {
+    uint32_t magic;
+    uint32_t topic_hash;
+    uint32_t sequence_number;
+    uint32_t frame_length;     // Whole frame, DDSFrameHeader included
+    uint32_t fragment_offset;  // Of this fragment's bytes in the frame
+    uint32_t reserved;
+    uint8_t writer_guid[16];
+};
+
+#define DDS_FRAGMENT_BYTES (NET_MAX_DATAGRAM - sizeof(DDSFragmentHeader))
+
+// Untyped messages are JSON envelopes (DDSPublisherWASM::serializeMessage)
+// that start with their topic
+#define DDS_ENVELOPE_PREFIX "{\"topic\":\""
+
+// Batches written into WASM memory by JS: frames (typed or JSON envelopes)
+// back to back, each after its length as a uint32 (little-endian, as wasm32)
+#define DDS_BATCH_LENGTH_PREFIX 4
+
+// FNV-1a, stable across wasm32 and native builds (unlike std::hash)
+inline uint32_t ddsTopicHash(const std::string& topic) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : topic) {
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+}
+
+// An endpoint's GUID, as frame headers carry it: participant GUID words 1..3,
+// then the endpoint's entity ID
+inline void ddsEndpointGuid(const uint32_t participant_guid[4], uint32_t entity_id, uint8_t guid[16]) {
+    memcpy(guid, participant_guid + 1, 12);
+    memcpy(guid + 12, &entity_id, sizeof(entity_id));
+}
+
+// Same GUID as text (discovery events, graph cache keys)
+inline std::string ddsEndpointGuidString(const uint8_t guid[16]) {
+    uint32_t words[4];
+    memcpy(words, guid, sizeof(words));
+    char text[40];
+    snprintf(text, sizeof(text), "%08X-%08X-%08X-%08X", words[0], words[1], words[2], words[3]);
+    return std::string(text);
+}
+
+// Types are compatible when names agree and, if both sides know it, hashes agree
+inline bool ddsTypesMatch(const std::string& type_a, uint64_t hash_a, const std::string& type_b, uint64_t hash_b) {
+    return type_a == type_b && (!hash_a || !hash_b || hash_a == hash_b);
+}
+
+// A remote endpoint, announced by discovery or configured by hand, and
+// whether its type matched ours (refused ones are kept so that repeated
+// announcements are not checked again)
+struct DDSRemoteEndpointWASM {
+    std::string guid;              // Endpoint GUID; "address:port" for hand-configured ones
+    std::string participant_guid;  // Empty for hand-configured ones
+    NetworkEndpoint locator;       // Its participant's unicast port
+    bool matched;
+};
+
+// Index of a remote endpoint by GUID; -1 if unknown
+inline int ddsFindRemote(const std::vector<DDSRemoteEndpointWASM>& remotes, const std::string& guid) {
+    for (size_t i = 0; i < remotes.size(); i++) {
+        if (remotes[i].guid == guid) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// Typed payload callback: plain function pointer + context, no std::function
+typedef void (*DDSPayloadCallback)(void* context, const uint8_t* payload, size_t length);
+
+// Discovery events, raised for local endpoints and for remote announcements
+struct DDSDiscoveryEvent {
+    enum Kind { ENDPOINT_ADDED, ENDPOINT_REMOVED, PARTICIPANT_REMOVED };
+    Kind kind;
+    std::string participant_guid;
+    std::string endpoint_guid;  // Empty for PARTICIPANT_REMOVED
+    bool is_writer;
+    std::string topic_name;
+    std::string type_name;
+};
+
+typedef void (*DDSDiscoveryListener)(void* context, const DDSDiscoveryEvent& event);
+
+// RTPS well-known ports (DDSI-RTPS 2.x, 9.6.1.1):
+//   PB + DG * domain + offset              (multicast, shared by the domain on a host)
+//   PB + DG * domain + offset + PG * id    (unicast, one participant)
+// A participant takes the first ID whose unicast port is free on the host.
+#define DDS_PORT_BASE 7400
+#define DDS_DOMAIN_ID_GAIN 250
+#define DDS_PARTICIPANT_ID_GAIN 2
+#define DDS_OFFSET_METATRAFFIC_MULTICAST 0
+#define DDS_OFFSET_METATRAFFIC_UNICAST 10
+#define DDS_OFFSET_USER_MULTICAST 1
+#define DDS_OFFSET_USER_UNICAST 11
+// Highest ID whose ports stay inside the domain's range (119: 120 participants per host)
+#define DDS_MAX_PARTICIPANT_ID ((DDS_DOMAIN_ID_GAIN - 1 - DDS_OFFSET_USER_UNICAST) / DDS_PARTICIPANT_ID_GAIN)
+#define DDS_PARTICIPANT_ID_AUTO -1
+#define DDS_DISCOVERY_MULTICAST_ADDRESS "239.255.0.1"
+
+struct DDSPortsWASM {
+    int metatraffic_multicast;  // Discovery announcements
+    int metatraffic_unicast;
+    int user_multicast;
+    int user_unicast;           // Bound by the participant; fixes its ID
+};
+
+inline DDSPortsWASM ddsPorts(int domain_id, int participant_id) {
+    int base = DDS_PORT_BASE + DDS_DOMAIN_ID_GAIN * domain_id;
+    DDSPortsWASM ports;
+    ports.metatraffic_multicast = base + DDS_OFFSET_METATRAFFIC_MULTICAST;
+    ports.metatraffic_unicast = base + DDS_OFFSET_METATRAFFIC_UNICAST + DDS_PARTICIPANT_ID_GAIN * participant_id;
+    ports.user_multicast = base + DDS_OFFSET_USER_MULTICAST;
+    ports.user_unicast = base + DDS_OFFSET_USER_UNICAST + DDS_PARTICIPANT_ID_GAIN * participant_id;
+    return ports;
+}
+
+// Discovery wire format (UDP, text):
+//   DDS_PARTICIPANT:<name>:<guid>
+//   DDS_PARTICIPANT_BYE:<guid>
+//   DDS_ENDPOINT:<+|->:<W|R>:<guid>:<entity ID>:<port>:<type hash>:<topic>:<type>
+//     (port: the participant's unicast port, where its frames go; type last: it contains "::")
+#define DDS_ENDPOINT_PREFIX "DDS_ENDPOINT:"
+#define DDS_PARTICIPANT_BYE_PREFIX "DDS_PARTICIPANT_BYE:"
+
+// Participants publish their getStats() JSON here (std_msgs::msg::String)
+// once enableMetricsTopic() is called
+#define DDS_METRICS_TOPIC "/dds/metrics"
+
+enum DDSParticipantMetricWASM {
+    PARTICIPANT_DISCOVERY_RECEIVED,  // Discovery datagrams handled
+    PARTICIPANT_FRAMES_RECEIVED,     // Typed frames and JSON envelopes from the network
+    PARTICIPANT_FRAMES_UNMATCHED,    // ... for a topic no local subscriber has
+    PARTICIPANT_FRAGMENTS_RECEIVED,  // Pieces of frames longer than a datagram
+    PARTICIPANT_FRAMES_INCOMPLETE,   // Fragmented frames dropped for a lost or malformed fragment
+    PARTICIPANT_LOCAL_ENDPOINTS,
+    PARTICIPANT_METRICS_PUBLISHED,
+    PARTICIPANT_METRIC_COUNT
+};
+
+static const MetricInfoWASM DDS_PARTICIPANT_METRICS[PARTICIPANT_METRIC_COUNT] = {
+    {"discovery_received", METRIC_COUNTER},
+    {"frames_received", METRIC_COUNTER},
+    {"frames_unmatched", METRIC_COUNTER},
+    {"fragments_received", METRIC_COUNTER},
+    {"frames_incomplete", METRIC_COUNTER},
+    {"local_endpoints", METRIC_GAUGE},
+    {"metrics_published", METRIC_COUNTER},
+};
+
+enum DDSPublisherMetricWASM {
+    PUBLISHER_MESSAGES,
+    PUBLISHER_BYTES,            // Payload bytes (JSON envelope for untyped messages)
+    PUBLISHER_LOCAL_DELIVERIES, // Same-participant subscribers called
+    PUBLISHER_REMOTE_SENDS,     // Frames handed to a subscriber's socket
+    PUBLISHER_SEND_FAILURES,
+    PUBLISHER_MATCHED_LOCAL,
+    PUBLISHER_MATCHED_REMOTE,
+    PUBLISHER_REFUSED_REMOTE,   // Remote subscribers whose type does not match
+    PUBLISHER_METRIC_COUNT
+};
+
+static const MetricInfoWASM DDS_PUBLISHER_METRICS[PUBLISHER_METRIC_COUNT] = {
+    {"messages_published", METRIC_COUNTER},
+    {"bytes_published", METRIC_COUNTER},
+    {"local_deliveries", METRIC_COUNTER},
+    {"remote_sends", METRIC_COUNTER},
+    {"send_failures", METRIC_COUNTER},
+    {"matched_local", METRIC_GAUGE},
+    {"matched_remote", METRIC_GAUGE},
+    {"refused_remote", METRIC_GAUGE},
+};
+
+enum DDSSubscriberMetricWASM {
+    SUBSCRIBER_MESSAGES,
+    SUBSCRIBER_BYTES,     // Payload bytes delivered to the callback
+    SUBSCRIBER_REJECTED,  // Truncated frames, other topics' envelopes, refused writers' frames
+    SUBSCRIBER_MATCHED_REMOTE,
+    SUBSCRIBER_REFUSED_REMOTE,  // Remote publishers whose type does not match
+    SUBSCRIBER_METRIC_COUNT
+};
+
+static const MetricInfoWASM DDS_SUBSCRIBER_METRICS[SUBSCRIBER_METRIC_COUNT] = {
+    {"messages_received", METRIC_COUNTER},
+    {"bytes_received", METRIC_COUNTER},
+    {"rejected", METRIC_COUNTER},
+    {"matched_remote", METRIC_GAUGE},
+    {"refused_remote", METRIC_GAUGE},
+};
+
+class DDSSubscriberWASM;
+class DDSPublisherWASM;
+
 // DDS Participant - represents a ROS node
 class DDSParticipantWASM {
 private:
     std::string participant_name;
     int domain_id;
+    int participant_id;  // Requested (or DDS_PARTICIPANT_ID_AUTO) until init()
     bool initialized;
     uint32_t participant_guid[4];  // GUID for DDS discovery
     NetworkManagerWASM* network_manager;
+    std::vector<DDSSubscriberWASM*> local_subscribers;  // Delivered to without the network
+    std::vector<DDSPublisherWASM*> local_publishers;    // Matched with remote subscribers
+    uint32_t local_version;  // Bumped when local_subscribers changes
+    uint32_t next_entity_id;  // Last 4 bytes of endpoint GUIDs
+    
+    struct LocalEndpoint {
+        uint32_t entity_id;
+        bool is_writer;
+        std::string topic_name;
+        std::string type_name;
+        uint64_t type_hash;
+    };
+    std::vector<LocalEndpoint> local_endpoints;  // Re-announced by discoverParticipants()
+    
+    // Fragmented frame being put together, one per remote writer
+    struct Reassembly {
+        uint32_t sequence_number;
+        uint32_t received;  // Bytes so far
+        std::vector<uint8_t> frame;
+        Reassembly() : sequence_number(0), received(0) {}
+    };
+    std::map<std::string, Reassembly> reassemblies;  // By writer GUID (16 bytes)
+    DDSDiscoveryListener discovery_listener;
+    void* discovery_context;
+    MetricsRegistryWASM metrics_registry;  // This participant, its endpoints and sockets
+    MetricGroupWASM<PARTICIPANT_METRIC_COUNT> metrics;
+    DDSPublisherWASM* metrics_publisher;   // DDS_METRICS_TOPIC, nullptr until enabled
+    double metrics_period_ms;
+    double next_metrics_ms;
+    
+    void notify(DDSDiscoveryEvent::Kind kind, const std::string& guid, const std::string& endpoint_guid,
+                bool is_writer, const std::string& topic, const std::string& type) {
+        if (!discovery_listener) return;
+        DDSDiscoveryEvent event;
+        event.kind = kind;
+        event.participant_guid = guid;
+        event.endpoint_guid = endpoint_guid;
+        event.is_writer = is_writer;
+        event.topic_name = topic;
+        event.type_name = type;
+        discovery_listener(discovery_context, event);
+    }
+    
+    void sendEndpointAnnouncement(bool alive, const LocalEndpoint& endpoint) {
+        if (!network_manager) return;
+        char announcement[512];
+        snprintf(announcement, sizeof(announcement), DDS_ENDPOINT_PREFIX "%c:%c:%s:%08X:%d:%016llX:%s:%s",
+                 alive ? '+' : '-', endpoint.is_writer ? 'W' : 'R', getGuidString().c_str(), endpoint.entity_id,
+                 getUnicastPort(), static_cast<unsigned long long>(endpoint.type_hash),
+                 endpoint.topic_name.c_str(), endpoint.type_name.c_str());
+        network_manager->sendDiscoveryMessage(announcement, discoveryEndpoint());
+    }
+    
+    NetworkEndpoint discoveryEndpoint() const {
+        return NetworkEndpoint(DDS_DISCOVERY_MULTICAST_ADDRESS, ddsPorts(domain_id, 0).metatraffic_multicast);
+    }
+    
+    // Typed frames from remote publishers go to local subscribers, text to discovery
+    void handleDatagram(const std::string& data, const NetworkEndpoint& from);
+    void handleFragment(const std::string& data);
+    void deliverFrame(const uint8_t* data, size_t length);
+    void dropReassemblies(const std::string& participant);
+    
+    // Local endpoints on the topic of a remote one (un)match it
+    void matchRemote(bool alive, bool is_writer, const std::string& participant, const std::string& endpoint_guid,
+                     const NetworkEndpoint& locator, const std::string& topic, const std::string& type,
+                     uint64_t type_hash);
+    void unmatchRemoteParticipant(const std::string& participant);
+    
+    void handleDiscovery(const std::string& data, const NetworkEndpoint& from) {
+        if (data.compare(0, sizeof(DDS_PARTICIPANT_BYE_PREFIX) - 1, DDS_PARTICIPANT_BYE_PREFIX) == 0) {
+            std::string guid = data.substr(sizeof(DDS_PARTICIPANT_BYE_PREFIX) - 1);
+            if (guid != getGuidString()) {
+                notify(DDSDiscoveryEvent::PARTICIPANT_REMOVED, guid, "", false, "", "");
+                unmatchRemoteParticipant(guid);
+                dropReassemblies(guid);
+            }
+            return;
+        }
+        if (data.compare(0, sizeof(DDS_ENDPOINT_PREFIX) - 1, DDS_ENDPOINT_PREFIX) != 0) {
+            return;
+        }
+        
+        // <+|->:<W|R>:<guid>:<entity ID>:<port>:<type hash>:<topic>:<type>
+        size_t pos = sizeof(DDS_ENDPOINT_PREFIX) - 1;
+        if (data.size() < pos + 4 || data[pos + 1] != ':' || data[pos + 3] != ':') return;
+        bool alive = data[pos] == '+';
+        bool is_writer = data[pos + 2] == 'W';
+        size_t ends[5];  // Of the GUID, entity ID, port, type hash and topic
+        size_t start = pos + 4;
+        for (size_t& end : ends) {
+            end = data.find(':', start);
+            if (end == std::string::npos) return;
+            start = end + 1;
+        }
+        
+        std::string guid = data.substr(pos + 4, ends[0] - pos - 4);
+        if (guid == getGuidString()) return;  // Own multicast loopback; local events are raised directly
+        uint32_t remote_guid[4];
+        unsigned int entity_id;
+        int port;
+        unsigned long long type_hash;
+        if (sscanf(guid.c_str(), "%08X-%08X-%08X-%08X", &remote_guid[0], &remote_guid[1], &remote_guid[2],
+                   &remote_guid[3]) != 4 ||
+            sscanf(data.c_str() + ends[0] + 1, "%X:%d:%llX:", &entity_id, &port, &type_hash) != 3) {
+            return;
+        }
+        uint8_t endpoint_guid[16];
+        ddsEndpointGuid(remote_guid, entity_id, endpoint_guid);
+        std::string endpoint = ddsEndpointGuidString(endpoint_guid);
+        std::string topic = data.substr(ends[3] + 1, ends[4] - ends[3] - 1);
+        std::string type = data.substr(ends[4] + 1);
+        notify(alive ? DDSDiscoveryEvent::ENDPOINT_ADDED : DDSDiscoveryEvent::ENDPOINT_REMOVED, guid, endpoint,
+               is_writer, topic, type);
+        matchRemote(alive, is_writer, guid, endpoint, NetworkEndpoint(from.address, port), topic, type, type_hash);
+    }
     
 public:
-    DDSParticipantWASM(const std::string& name, int domain_id = 0)
-        : participant_name(name), domain_id(domain_id), initialized(false), network_manager(nullptr) {
+    // participant_id: DDS_PARTICIPANT_ID_AUTO picks the first free one at init()
+    DDSParticipantWASM(const std::string& name, int domain_id = 0, int participant_id = DDS_PARTICIPANT_ID_AUTO)
+        : participant_name(name), domain_id(domain_id), participant_id(participant_id), initialized(false),
+          network_manager(nullptr),
+          local_version(0), next_entity_id(0), discovery_listener(nullptr), discovery_context(nullptr), metrics(DDS_PARTICIPANT_METRICS),
+          metrics_publisher(nullptr), metrics_period_ms(0), next_metrics_ms(0) {
         // Generate simple GUID (in real DDS this would be more complex)
         participant_guid[0] = 0x01010101;
         participant_guid[1] = 0x02020202;
@@ -51,6 +412,11 @@ public:
     }
     
     ~DDSParticipantWASM() {
+        enableMetricsTopic(0);
+        if (initialized && network_manager) {
+            std::string bye = DDS_PARTICIPANT_BYE_PREFIX + getGuidString();
+            network_manager->sendDiscoveryMessage(bye, discoveryEndpoint());
+        }
         if (network_manager) {
             network_manager->cleanup();
             delete network_manager;
@@ -63,16 +429,47 @@ public:
         printf("WASM: Initializing DDS Participant '%s' (domain: %d)\n", 
                participant_name.c_str(), domain_id);
         
-        // Initialize network manager for DDS discovery
+        if (domain_id < 0 || ddsPorts(domain_id, DDS_MAX_PARTICIPANT_ID).user_unicast > 65535 ||
+            participant_id > DDS_MAX_PARTICIPANT_ID) {
+            printf("WASM: Domain %d / participant ID %d out of range\n", domain_id, participant_id);
+            return false;
+        }
+        
+        // Initialize network manager for DDS discovery (port shared by the domain)
         network_manager = new NetworkManagerWASM();
-        if (!network_manager->init(7400 + domain_id)) {
+        if (!network_manager->init(ddsPorts(domain_id, 0).metatraffic_multicast)) {
             printf("WASM: Failed to initialize network manager\n");
             return false;
         }
+        metrics.attach(&metrics_registry, "participant", participant_name);
+        network_manager->attachMetrics(&metrics_registry, participant_name);
+        network_manager->setTraceKeyReader(&ddsFrameTraceKey);
+        network_manager->joinMulticastGroup(DDS_DISCOVERY_MULTICAST_ADDRESS);
+        
+        // Own unicast port: the first free participant ID, unless one was requested
+        int first_id = participant_id >= 0 ? participant_id : 0;
+        int last_id = participant_id >= 0 ? participant_id : DDS_MAX_PARTICIPANT_ID;
+        participant_id = DDS_PARTICIPANT_ID_AUTO;
+        for (int id = first_id; id <= last_id; id++) {
+            if (network_manager->bindUnicast(ddsPorts(domain_id, id).user_unicast)) {
+                participant_id = id;
+                break;
+            }
+        }
+        if (participant_id < 0) {
+            printf("WASM: No free participant ID %d..%d in domain %d\n", first_id, last_id, domain_id);
+            return false;
+        }
+        participant_guid[2] = 0x03030000u | static_cast<uint32_t>(participant_id);
+        
+        network_manager->setDiscoveryCallback([this](const std::string& data, const NetworkEndpoint& from) {
+            this->handleDatagram(data, from);
+        });
         
         initialized = true;
-        printf("WASM: DDS Participant initialized (GUID: %08X-%08X-%08X-%08X)\n",
-               participant_guid[0], participant_guid[1], participant_guid[2], participant_guid[3]);
+        printf("WASM: DDS Participant initialized (GUID: %08X-%08X-%08X-%08X, participant ID %d, port %d)\n",
+               participant_guid[0], participant_guid[1], participant_guid[2], participant_guid[3],
+               participant_id, network_manager->getUnicastPort());
         return true;
     }
     
@@ -87,17 +484,138 @@ public:
                  participant_guid[0], participant_guid[1], participant_guid[2], participant_guid[3]);
         
         // Send to DDS discovery multicast address (239.255.0.1) or broadcast
-        NetworkEndpoint discovery_endpoint("239.255.0.1", 7400 + domain_id);
-        network_manager->sendDiscoveryMessage(announcement, discovery_endpoint);
+        network_manager->sendDiscoveryMessage(announcement, discoveryEndpoint());
+        for (const LocalEndpoint& endpoint : local_endpoints) {
+            sendEndpointAnnouncement(true, endpoint);
+        }
         
         // Poll for incoming discovery messages
         network_manager->poll();
+        
+        publishMetricsIfDue();
+    }
+    
+    // Every metric of this participant, its network manager, sockets and
+    // endpoints: {"participant":..,"guid":..,"time_ms":..,"entities":[{"kind":..,"name":..,<metric>:<value>..}]}
+    std::string getStats() const {
+        std::string json = "{\"participant\":";
+        metricsAppendJSONString(json, participant_name);
+        char fields[96];
+        snprintf(fields, sizeof(fields), ",\"guid\":\"%s\",\"time_ms\":%.3f,\"entities\":", getGuidString().c_str(),
+                 emscripten_get_now());
+        json += fields;
+        metrics_registry.appendJSON(json);
+        json += '}';
+        return json;
+    }
+    
+    // Publish getStats() on DDS_METRICS_TOPIC every period_ms, checked by
+    // discoverParticipants() (so no finer than the announcements); 0 stops
+    bool enableMetricsTopic(double period_ms);
+    
+    // One getStats() message on DDS_METRICS_TOPIC now; needs enableMetricsTopic()
+    bool publishMetrics();
+    
+    // For hosts that poll without announcing (RMW)
+    void publishMetricsIfDue() {
+        if (metrics_publisher && emscripten_get_now() >= next_metrics_ms) {
+            publishMetrics();
+        }
+    }
+    
+    MetricsRegistryWASM* getMetrics() { return &metrics_registry; }
+    uint64_t getMetric(DDSParticipantMetricWASM metric) const { return metrics[metric].get(); }
+    
+    // Pipeline tracing (trace_wasm.h) is per process: these start, stop and
+    // export the spans of every participant, under this one's name
+    void startTrace(int events_per_thread) {
+        traceWASMStart(events_per_thread > 0 ? static_cast<size_t>(events_per_thread) : TRACE_WASM_DEFAULT_EVENTS);
+    }
+    void stopTrace() { traceWASMStop(); }
+    std::string getTrace() const { return traceWASMExportJSON(participant_name); }
+    
+    // Socket reads on a dedicated thread; spinOnce()/rcl_wait deliver on the caller's thread
+    bool startIOThread() {
+        return initialized && network_manager && network_manager->startIOThread();
     }
     
     bool isInitialized() const { return initialized; }
     std::string getName() const { return participant_name; }
     int getDomainId() const { return domain_id; }
+    // Chosen at init(); -1 before
+    int getParticipantId() const { return initialized ? participant_id : DDS_PARTICIPANT_ID_AUTO; }
+    int getUnicastPort() const { return network_manager ? network_manager->getUnicastPort() : -1; }
     NetworkManagerWASM* getNetworkManager() const { return network_manager; }
+    
+    void addLocalSubscriber(DDSSubscriberWASM* subscriber) {
+        local_subscribers.push_back(subscriber);
+        local_version++;
+    }
+    
+    void removeLocalSubscriber(DDSSubscriberWASM* subscriber) {
+        for (size_t i = 0; i < local_subscribers.size(); i++) {
+            if (local_subscribers[i] == subscriber) {
+                local_subscribers.erase(local_subscribers.begin() + i);
+                local_version++;
+                return;
+            }
+        }
+    }
+    
+    void addLocalPublisher(DDSPublisherWASM* publisher) {
+        local_publishers.push_back(publisher);
+    }
+    
+    void removeLocalPublisher(DDSPublisherWASM* publisher) {
+        for (size_t i = 0; i < local_publishers.size(); i++) {
+            if (local_publishers[i] == publisher) {
+                local_publishers.erase(local_publishers.begin() + i);
+                return;
+            }
+        }
+    }
+    
+    const std::vector<DDSSubscriberWASM*>& getLocalSubscribers() const { return local_subscribers; }
+    uint32_t getLocalVersion() const { return local_version; }
+    
+    const uint32_t* getGuid() const { return participant_guid; }
+    uint32_t nextEntityId() { return ++next_entity_id; }
+    
+    std::string getGuidString() const {
+        char guid[40];
+        snprintf(guid, sizeof(guid), "%08X-%08X-%08X-%08X",
+                 participant_guid[0], participant_guid[1], participant_guid[2], participant_guid[3]);
+        return std::string(guid);
+    }
+    
+    // Receives local and remote endpoint changes (the RMW graph cache listens here)
+    void setDiscoveryListener(DDSDiscoveryListener listener, void* context) {
+        discovery_listener = listener;
+        discovery_context = context;
+    }
+    
+    // Called by publishers/subscribers on init (alive) and destruction (!alive);
+    // entity_id is the one they got from nextEntityId()
+    void announceEndpoint(bool alive, bool is_writer, uint32_t entity_id, const std::string& topic,
+                          const std::string& type, uint64_t type_hash) {
+        LocalEndpoint endpoint{entity_id, is_writer, topic, type, type_hash};
+        if (alive) {
+            local_endpoints.push_back(endpoint);
+        } else {
+            for (size_t i = 0; i < local_endpoints.size(); i++) {
+                if (local_endpoints[i].entity_id == entity_id) {
+                    local_endpoints.erase(local_endpoints.begin() + i);
+                    break;
+                }
+            }
+        }
+        metrics[PARTICIPANT_LOCAL_ENDPOINTS].set(local_endpoints.size());
+        uint8_t endpoint_guid[16];
+        ddsEndpointGuid(participant_guid, entity_id, endpoint_guid);
+        notify(alive ? DDSDiscoveryEvent::ENDPOINT_ADDED : DDSDiscoveryEvent::ENDPOINT_REMOVED,
+               getGuidString(), ddsEndpointGuidString(endpoint_guid), is_writer, topic, type);
+        sendEndpointAnnouncement(alive, endpoint);
+    }
 };
 
 // DDS Publisher
@@ -106,13 +624,148 @@ private:
     DDSParticipantWASM* participant;
     std::string topic_name;
     std::string type_name;
+    uint64_t type_hash;  // 0 = untyped (JSON envelope)
+    uint32_t topic_hash;
     bool initialized;
     uint32_t sequence_number;
-    std::vector<NetworkEndpoint> subscriber_endpoints;  // Discovered subscribers
+    uint32_t entity_id;       // From the participant at init()
+    uint8_t writer_guid[16];  // Set at init(); in every frame header
+    std::vector<DDSRemoteEndpointWASM> remote_subscribers;  // Matched and refused
+    std::vector<NetworkEndpoint> subscriber_endpoints;  // Matched subscribers' locators, each once
+    std::vector<DDSSubscriberWASM*> local_matches;      // Same-participant subscribers on this topic
+    uint32_t local_version;
+    
+    // Frame buffer (header + payload), owned through the rcl allocator
+    rcl_allocator_t allocator;
+    uint8_t* frame_buffer;
+    size_t frame_capacity;
+    std::vector<char> fragment_buffer;  // One datagram; sized by the first fragmented send
+    MetricGroupWASM<PUBLISHER_METRIC_COUNT> metrics;
+    
+    void deliverLocal(const char* data, size_t length);
+    
+    // One frame per locator: the participant there hands it to all of its
+    // subscribers on the topic
+    void updateSubscriberEndpoints() {
+        subscriber_endpoints.clear();
+        size_t matched = 0;
+        for (const DDSRemoteEndpointWASM& remote : remote_subscribers) {
+            if (!remote.matched) continue;
+            matched++;
+            bool known = false;
+            for (const NetworkEndpoint& endpoint : subscriber_endpoints) {
+                known = known || (endpoint.address == remote.locator.address && endpoint.port == remote.locator.port);
+            }
+            if (!known) subscriber_endpoints.push_back(remote.locator);
+        }
+        metrics[PUBLISHER_MATCHED_REMOTE].set(matched);
+        metrics[PUBLISHER_REFUSED_REMOTE].set(remote_subscribers.size() - matched);
+    }
+    
+    // One datagram if the frame fits, else DDS_FRAGMENT_BYTES pieces of it
+    bool sendFrame(NetworkManagerWASM* net_mgr, const char* data, size_t length, const NetworkEndpoint& endpoint) {
+        if (length <= NET_MAX_DATAGRAM) {
+            return net_mgr->sendDatagram(data, length, endpoint);
+        }
+        DDSFrameHeader frame;
+        memcpy(&frame, data, sizeof(frame));
+        DDSFragmentHeader header;
+        header.magic = DDS_FRAGMENT_MAGIC;
+        header.topic_hash = frame.topic_hash;
+        header.sequence_number = frame.sequence_number;
+        header.frame_length = static_cast<uint32_t>(length);
+        header.reserved = 0;
+        memcpy(header.writer_guid, frame.writer_guid, sizeof(header.writer_guid));
+        fragment_buffer.resize(NET_MAX_DATAGRAM);
+        for (size_t offset = 0; offset < length; offset += DDS_FRAGMENT_BYTES) {
+            size_t piece = std::min(DDS_FRAGMENT_BYTES, length - offset);
+            header.fragment_offset = static_cast<uint32_t>(offset);
+            memcpy(fragment_buffer.data(), &header, sizeof(header));
+            memcpy(fragment_buffer.data() + sizeof(header), data + offset, piece);
+            if (!net_mgr->sendDatagram(fragment_buffer.data(), sizeof(header) + piece, endpoint)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Local subscribers directly; remote ones get the frame once per
+    // participant, on its unicast port, where handleDatagram() routes it
+    void sendToSubscribers(const char* data, size_t length) {
+        deliverLocal(data, length);
+        metrics[PUBLISHER_LOCAL_DELIVERIES].add(local_matches.size());
+        
+        NetworkManagerWASM* net_mgr = participant ? participant->getNetworkManager() : nullptr;
+        if (net_mgr) {
+            bool sent = false;
+            for (const NetworkEndpoint& endpoint : subscriber_endpoints) {
+                TraceSpanWASM span(TRACE_SEND);
+                if (sendFrame(net_mgr, data, length, endpoint)) {
+                    sent = true;
+                    metrics[PUBLISHER_REMOTE_SENDS].add();
+                    WASM_LOG_DEBUG("WASM: Message sent to subscriber %s:%d\n", endpoint.address.c_str(), endpoint.port);
+                } else {
+                    metrics[PUBLISHER_SEND_FAILURES].add();
+                }
+            }
+            
+            if (subscriber_endpoints.empty()) {
+                if (local_matches.empty()) {
+                    WASM_LOG_DEBUG("WASM: No subscribers discovered yet (message queued)\n");
+                }
+            } else if (!sent) {
+                WASM_LOG_WARN("WASM: Failed to send to any subscriber\n");
+            }
+        } else {
+            WASM_LOG_DEBUG("WASM: Network manager not available (simulated send)\n");
+        }
+    }
     
 public:
-    DDSPublisherWASM(DDSParticipantWASM* part, const std::string& topic, const std::string& type = "std_msgs::msg::String")
-        : participant(part), topic_name(topic), type_name(type), initialized(false), sequence_number(0) {}
+    DDSPublisherWASM(DDSParticipantWASM* part, const std::string& topic, const std::string& type = "std_msgs::msg::String",
+                     uint64_t type_hash = 0)
+        : participant(part), topic_name(topic), type_name(type), type_hash(type_hash),
+          topic_hash(ddsTopicHash(topic)), initialized(false), sequence_number(0), entity_id(0), local_version(~0u),
+          allocator(rcl_get_default_allocator()), frame_buffer(nullptr), frame_capacity(0),
+          metrics(DDS_PUBLISHER_METRICS) {
+        memset(writer_guid, 0, sizeof(writer_guid));
+    }
+    
+    ~DDSPublisherWASM() {
+        if (initialized && participant) {
+            participant->removeLocalPublisher(this);
+            participant->announceEndpoint(false, true, entity_id, topic_name, type_name, type_hash);
+        }
+        if (frame_buffer) {
+            allocator.deallocate(frame_buffer, allocator.state);
+        }
+    }
+    
+    // Must be called before the first publish; the frame buffer is allocated from it
+    void setAllocator(const rcl_allocator_t& alloc) {
+        if (!frame_buffer && rcl_allocator_is_valid(&alloc)) {
+            allocator = alloc;
+        }
+    }
+    
+    // Size the frame buffer up front so steady-state publishing never reallocates
+    bool reserveFrame(size_t payload_capacity) {
+        if (payload_capacity > DDS_MAX_FRAME_BYTES - sizeof(DDSFrameHeader)) {
+            WASM_LOG_WARN("WASM: %zu byte payload on topic '%s' is over the %u byte frame limit\n", payload_capacity,
+                          topic_name.c_str(), DDS_MAX_FRAME_BYTES);
+            return false;
+        }
+        size_t needed = sizeof(DDSFrameHeader) + payload_capacity;
+        if (needed <= frame_capacity) return true;
+        uint8_t* buffer = static_cast<uint8_t*>(allocator.reallocate(frame_buffer, needed, allocator.state));
+        if (!buffer) {
+            WASM_LOG_WARN("WASM: Failed to reserve %zu byte frame on topic '%s'\n", needed, topic_name.c_str());
+            return false;
+        }
+        frame_buffer = buffer;
+        frame_capacity = needed;
+        return true;
+    }
     
     bool init() {
         if (initialized) return true;
@@ -124,10 +777,13 @@ public:
         printf("WASM: Creating DDS Publisher on topic '%s' (type: %s)\n", 
                topic_name.c_str(), type_name.c_str());
         
-        // TODO: Register publisher with DDS
-        // - Announce publisher via discovery
-        // - Wait for subscriber discovery
-        // - Setup communication endpoints
+        // Announce publisher via discovery (feeds the graph cache)
+        entity_id = participant->nextEntityId();
+        ddsEndpointGuid(participant->getGuid(), entity_id, writer_guid);
+        participant->announceEndpoint(true, true, entity_id, topic_name, type_name, type_hash);
+        participant->addLocalPublisher(this);
+        metrics.attach(participant->getMetrics(), "publisher", topic_name);
+        traceWASMNameTopic(topic_hash, topic_name);
         
         initialized = true;
         printf("WASM: DDS Publisher initialized\n");
@@ -136,11 +792,13 @@ public:
     
     bool publish(const std::string& data) {
         if (!initialized) {
-            printf("WASM: Publisher not initialized\n");
+            WASM_LOG_WARN("WASM: Publisher not initialized\n");
             return false;
         }
         
         sequence_number++;
+        TraceContextWASM trace(writer_guid, sequence_number, topic_hash);
+        TraceSpanWASM span(TRACE_PUBLISH);
         
         // Create DDS message
         DDSMessage msg;
@@ -150,53 +808,137 @@ public:
         msg.timestamp = emscripten_get_now();  // Current time in milliseconds
         msg.sequence_number = sequence_number;
         
-        printf("WASM: Publishing message #%u to topic '%s' via DDS\n", 
-               sequence_number, topic_name.c_str());
+        WASM_LOG_DEBUG("WASM: Publishing message #%u to topic '%s' via DDS\n", 
+                       sequence_number, topic_name.c_str());
         
         // Serialize message
-        std::string serialized = serializeMessage(msg);
+        std::string serialized;
+        {
+            TraceSpanWASM serialize_span(TRACE_SERIALIZE);
+            serialized = serializeMessage(msg);
+        }
+        metrics[PUBLISHER_MESSAGES].add();
+        metrics[PUBLISHER_BYTES].add(serialized.size());
         
         // Send via DDS to all discovered subscribers
-        NetworkManagerWASM* net_mgr = participant ? participant->getNetworkManager() : nullptr;
-        if (net_mgr) {
-            bool sent = false;
-            for (const auto& endpoint : subscriber_endpoints) {
-                if (net_mgr->sendTCPMessage(endpoint.address, endpoint.port, serialized)) {
-                    sent = true;
-                    printf("WASM: Message sent to subscriber %s:%d\n", endpoint.address.c_str(), endpoint.port);
-                }
-            }
-            
-            if (subscriber_endpoints.empty()) {
-                printf("WASM: No subscribers discovered yet (message queued)\n");
-            } else if (!sent) {
-                printf("WASM: Failed to send to any subscriber\n");
-            }
-        } else {
-            printf("WASM: Network manager not available (simulated send)\n");
+        sendToSubscribers(serialized.data(), serialized.size());
+        
+        return true;
+    }
+    
+    // Returns space for a payload of `length` bytes inside the frame buffer.
+    // Serialize into it, then call publishLoaned() with the same length.
+    uint8_t* loanPayload(size_t length) {
+        if (!reserveFrame(length)) return nullptr;
+        return frame_buffer + sizeof(DDSFrameHeader);
+    }
+    
+    bool publishLoaned(size_t length) {
+        if (!initialized) {
+            WASM_LOG_WARN("WASM: Publisher not initialized\n");
+            return false;
+        }
+        if (!frame_buffer || sizeof(DDSFrameHeader) + length > frame_capacity) {
+            return false;
         }
         
+        sequence_number++;
+        TraceContextWASM trace(writer_guid, sequence_number, topic_hash);
+        TraceSpanWASM span(TRACE_PUBLISH);
+        
+        DDSFrameHeader header;
+        header.magic = DDS_FRAME_MAGIC;
+        header.topic_hash = topic_hash;
+        header.sequence_number = sequence_number;
+        header.payload_length = static_cast<uint32_t>(length);
+        header.timestamp = static_cast<uint64_t>(emscripten_get_now());
+        memcpy(header.writer_guid, writer_guid, sizeof(writer_guid));
+        memcpy(frame_buffer, &header, sizeof(header));
+        
+        WASM_LOG_DEBUG("WASM: Publishing typed message #%u to topic '%s' (%zu bytes)\n",
+                       sequence_number, topic_name.c_str(), length);
+        metrics[PUBLISHER_MESSAGES].add();
+        metrics[PUBLISHER_BYTES].add(length);
+        
+        sendToSubscribers(reinterpret_cast<const char*>(frame_buffer), sizeof(header) + length);
         return true;
     }
     
+    // Publish a payload already serialized by rosidl type support
+    bool publishSerialized(const uint8_t* payload, size_t length) {
+        uint8_t* loan = loanPayload(length);
+        if (!loan) return false;
+        if (length > 0) {
+            memcpy(loan, payload, length);
+        }
+        return publishLoaned(length);
+    }
+    
     std::string serializeMessage(const DDSMessage& msg) {
         // Simple JSON-like serialization (in real DDS would use CDR)
         char buffer[1024];
         snprintf(buffer, sizeof(buffer),
                  "{\"topic\":\"%s\",\"type\":\"%s\",\"data\":\"%s\",\"seq\":%u,\"ts\":%llu}",
                  msg.topic_name.c_str(), msg.type_name.c_str(), 
-                 msg.data.c_str(), msg.sequence_number, msg.timestamp);
+                 msg.data.c_str(), msg.sequence_number, static_cast<unsigned long long>(msg.timestamp));
         return std::string(buffer);
     }
     
-    void addSubscriberEndpoint(const std::string& address, int port) {
-        subscriber_endpoints.push_back(NetworkEndpoint(address, port));
-        printf("WASM: Added subscriber endpoint: %s:%d\n", address.c_str(), port);
+    // Remote subscriber from discovery: its type is checked once, here, and
+    // never per message. False if it is refused; a known subscriber keeps
+    // its first verdict, so repeated announcements cost a lookup.
+    bool matchSubscriber(const std::string& guid, const std::string& participant_guid, const NetworkEndpoint& locator,
+                         const std::string& remote_type, uint64_t remote_hash) {
+        int known = ddsFindRemote(remote_subscribers, guid);
+        if (known >= 0) return remote_subscribers[known].matched;
+        bool matched = ddsTypesMatch(type_name, type_hash, remote_type, remote_hash);
+        remote_subscribers.push_back(DDSRemoteEndpointWASM{guid, participant_guid, locator, matched});
+        updateSubscriberEndpoints();
+        if (!matched) {
+            printf("WASM: Refused subscriber %s on '%s': type '%s' (%016llX) does not match '%s' (%016llX)\n",
+                   guid.c_str(), topic_name.c_str(), remote_type.c_str(), static_cast<unsigned long long>(remote_hash),
+                   type_name.c_str(), static_cast<unsigned long long>(type_hash));
+            return false;
+        }
+        printf("WASM: Matched subscriber %s at %s on '%s'\n", guid.c_str(), locator.toString().c_str(),
+               topic_name.c_str());
+        return true;
+    }
+    
+    void unmatchSubscriber(const std::string& guid) {
+        int known = ddsFindRemote(remote_subscribers, guid);
+        if (known < 0) return;
+        remote_subscribers.erase(remote_subscribers.begin() + known);
+        updateSubscriberEndpoints();
+    }
+    
+    // Every subscriber of a participant that left
+    void unmatchParticipant(const std::string& participant_guid) {
+        size_t kept = 0;
+        for (size_t i = 0; i < remote_subscribers.size(); i++) {
+            if (remote_subscribers[i].participant_guid != participant_guid) {
+                remote_subscribers[kept++] = remote_subscribers[i];
+            }
+        }
+        if (kept == remote_subscribers.size()) return;
+        remote_subscribers.resize(kept);
+        updateSubscriberEndpoints();
+    }
+    
+    // Subscriber configured by hand (bridges, JS): the same match, on the type name only
+    bool addSubscriberEndpoint(const std::string& address, int port, const std::string& remote_type) {
+        NetworkEndpoint locator(address, port);
+        return matchSubscriber(locator.toString(), "", locator, remote_type, 0);
     }
     
     bool isInitialized() const { return initialized; }
     std::string getTopicName() const { return topic_name; }
+    std::string getTypeName() const { return type_name; }
+    uint64_t getTypeHash() const { return type_hash; }
+    uint32_t getTopicHash() const { return topic_hash; }
     int getSequenceNumber() const { return sequence_number; }
+    const uint8_t* getWriterGuid() const { return writer_guid; }
+    uint64_t getMetric(DDSPublisherMetricWASM metric) const { return metrics[metric].get(); }
 };
 
 // DDS Subscriber
@@ -205,14 +947,89 @@ private:
     DDSParticipantWASM* participant;
     std::string topic_name;
     std::string type_name;
+    uint64_t type_hash;  // 0 = untyped (JSON envelope)
+    uint32_t topic_hash;
     bool initialized;
+    uint32_t entity_id;  // From the participant at init()
     std::function<void(const std::string&)> callback;
-    std::vector<NetworkEndpoint> publisher_endpoints;  // Discovered publishers
-    int messages_received;
+    DDSPayloadCallback raw_callback;
+    void* raw_context;
+    std::vector<DDSRemoteEndpointWASM> remote_publishers;  // Matched and refused
+    size_t refused_publishers;  // Their frames are dropped
+    MetricGroupWASM<SUBSCRIBER_METRIC_COUNT> metrics;
+    bool batching;  // One log line per receiveBatch() instead of per message
+    
+    static bool isFrame(const char* data, size_t length) {
+        if (length < sizeof(DDSFrameHeader)) return false;
+        uint32_t magic;
+        memcpy(&magic, data, sizeof(magic));
+        return magic == DDS_FRAME_MAGIC;
+    }
+    
+    bool isRefused(const uint8_t writer_guid[16]) const {
+        int known = ddsFindRemote(remote_publishers, ddsEndpointGuidString(writer_guid));
+        return known >= 0 && !remote_publishers[known].matched;
+    }
+    
+    void updateRemoteMetrics() {
+        refused_publishers = 0;
+        for (const DDSRemoteEndpointWASM& remote : remote_publishers) {
+            if (!remote.matched) refused_publishers++;
+        }
+        metrics[SUBSCRIBER_MATCHED_REMOTE].set(remote_publishers.size() - refused_publishers);
+        metrics[SUBSCRIBER_REFUSED_REMOTE].set(refused_publishers);
+    }
+    
+    void receiveFrame(const char* frame, size_t length) {
+        DDSFrameHeader header;
+        memcpy(&header, frame, sizeof(header));
+        if (header.topic_hash != topic_hash) {
+            WASM_LOG_WARN("WASM: Topic mismatch on typed frame for '%s'\n", topic_name.c_str());
+            metrics[SUBSCRIBER_REJECTED].add();
+            return;
+        }
+        // Another subscriber of this participant may have matched the writer
+        if (refused_publishers > 0 && isRefused(header.writer_guid)) {
+            metrics[SUBSCRIBER_REJECTED].add();
+            return;
+        }
+        if (header.payload_length > length - sizeof(header)) {
+            WASM_LOG_WARN("WASM: Truncated frame on topic '%s'\n", topic_name.c_str());
+            metrics[SUBSCRIBER_REJECTED].add();
+            return;
+        }
+        
+        TraceContextWASM trace(header.writer_guid, header.sequence_number, header.topic_hash);
+        TraceSpanWASM span(TRACE_RECV);
+        metrics[SUBSCRIBER_MESSAGES].add();
+        metrics[SUBSCRIBER_BYTES].add(header.payload_length);
+        if (!batching) {
+            WASM_LOG_DEBUG("WASM: Typed message received #%d on topic '%s' (%u bytes)\n",
+                           getMessagesReceived(), topic_name.c_str(), header.payload_length);
+        }
+        
+        const uint8_t* payload = reinterpret_cast<const uint8_t*>(frame) + sizeof(header);
+        if (raw_callback) {
+            raw_callback(raw_context, payload, header.payload_length);
+        } else if (callback) {
+            TraceSpanWASM callback_span(TRACE_CALLBACK);
+            callback(std::string(reinterpret_cast<const char*>(payload), header.payload_length));
+        }
+    }
     
 public:
-    DDSSubscriberWASM(DDSParticipantWASM* part, const std::string& topic, const std::string& type = "std_msgs::msg::String")
-        : participant(part), topic_name(topic), type_name(type), initialized(false), messages_received(0) {}
+    DDSSubscriberWASM(DDSParticipantWASM* part, const std::string& topic, const std::string& type = "std_msgs::msg::String",
+                      uint64_t type_hash = 0)
+        : participant(part), topic_name(topic), type_name(type), type_hash(type_hash),
+          topic_hash(ddsTopicHash(topic)), initialized(false), entity_id(0), raw_callback(nullptr), raw_context(nullptr),
+          refused_publishers(0), metrics(DDS_SUBSCRIBER_METRICS), batching(false) {}
+    
+    ~DDSSubscriberWASM() {
+        if (initialized && participant) {
+            participant->removeLocalSubscriber(this);
+            participant->announceEndpoint(false, false, entity_id, topic_name, type_name, type_hash);
+        }
+    }
     
     bool init() {
         if (initialized) return true;
@@ -224,12 +1041,12 @@ public:
         printf("WASM: Creating DDS Subscriber on topic '%s' (type: %s)\n", 
                topic_name.c_str(), type_name.c_str());
         
-        // TODO: Register subscriber with DDS
-        // - Announce subscriber via discovery
-        // - Wait for publisher discovery
-        // - Setup communication endpoints
-        // - Start listening for messages
-        
+        // Announce subscriber via discovery (feeds the graph cache)
+        entity_id = participant->nextEntityId();
+        participant->announceEndpoint(true, false, entity_id, topic_name, type_name, type_hash);
+        participant->addLocalSubscriber(this);
+        metrics.attach(participant->getMetrics(), "subscriber", topic_name);
+        traceWASMNameTopic(topic_hash, topic_name);
         initialized = true;
         printf("WASM: DDS Subscriber initialized\n");
         return true;
@@ -239,25 +1056,92 @@ public:
         callback = cb;
     }
     
+    // Receives typed payloads without copying them out of the frame
+    void setRawCallback(DDSPayloadCallback cb, void* context) {
+        raw_callback = cb;
+        raw_context = context;
+    }
+    
     void receiveMessage(const std::string& serialized) {
         if (!initialized) return;
         
+        if (isFrame(serialized.data(), serialized.size())) {
+            receiveFrame(serialized.data(), serialized.size());
+            return;
+        }
+        receiveEnvelope(serialized);
+    }
+    
+    // Same as receiveMessage, for bytes that are not held in a std::string
+    void receiveBytes(const uint8_t* data, size_t length) {
+        if (!initialized) return;
+        
+        const char* bytes = reinterpret_cast<const char*>(data);
+        if (isFrame(bytes, length)) {
+            receiveFrame(bytes, length);
+            return;
+        }
+        receiveEnvelope(std::string(bytes, length));
+    }
+    
+    // Many length-prefixed frames in one call (see DDS_BATCH_LENGTH_PREFIX).
+    // Returns the frames delivered; a truncated last frame is ignored.
+    size_t receiveBatch(const uint8_t* data, size_t length) {
+        if (!initialized) return 0;
+        
+        size_t frames = 0;
+        size_t offset = 0;
+        batching = true;
+        while (length - offset >= DDS_BATCH_LENGTH_PREFIX) {
+            uint32_t frame_length;
+            memcpy(&frame_length, data + offset, sizeof(frame_length));
+            offset += DDS_BATCH_LENGTH_PREFIX;
+            if (frame_length > length - offset) break;
+            receiveBytes(data + offset, frame_length);
+            offset += frame_length;
+            frames++;
+        }
+        batching = false;
+        
+        WASM_LOG_DEBUG("WASM: Batch of %zu frames received on topic '%s'\n", frames, topic_name.c_str());
+        return frames;
+    }
+    
+    // receiveBatch() for JS: `address` is where the batch was copied into HEAPU8
+    int receiveBatchAt(uintptr_t address, int length) {
+        if (length <= 0) return 0;
+        return static_cast<int>(receiveBatch(reinterpret_cast<const uint8_t*>(address), static_cast<size_t>(length)));
+    }
+    
+    // Untyped JSON envelope
+    void receiveEnvelope(const std::string& serialized) {
+        TraceSpanWASM span(TRACE_RECV);
+        
         // Deserialize message
-        DDSMessage msg = deserializeMessage(serialized);
+        DDSMessage msg;
+        {
+            TraceSpanWASM decode_span(TRACE_DECODE);
+            msg = deserializeMessage(serialized);
+        }
         
         if (msg.topic_name != topic_name) {
-            printf("WASM: Topic mismatch: expected '%s', got '%s'\n", 
-                   topic_name.c_str(), msg.topic_name.c_str());
+            WASM_LOG_WARN("WASM: Topic mismatch: expected '%s', got '%s'\n", 
+                          topic_name.c_str(), msg.topic_name.c_str());
+            metrics[SUBSCRIBER_REJECTED].add();
             return;
         }
         
-        messages_received++;
-        printf("WASM: Message received #%d on topic '%s' via DDS\n", 
-               messages_received, topic_name.c_str());
-        printf("WASM: Data: %s\n", msg.data.c_str());
+        metrics[SUBSCRIBER_MESSAGES].add();
+        metrics[SUBSCRIBER_BYTES].add(msg.data.size());
+        if (!batching) {
+            WASM_LOG_DEBUG("WASM: Message received #%d on topic '%s' via DDS\n", 
+                           getMessagesReceived(), topic_name.c_str());
+            WASM_LOG_DEBUG("WASM: Data: %s\n", msg.data.c_str());
+        }
         
         // Call callback
         if (callback) {
+            TraceSpanWASM callback_span(TRACE_CALLBACK);
             callback(msg.data);
         }
     }
@@ -279,9 +1163,49 @@ public:
         return msg;
     }
     
-    void addPublisherEndpoint(const std::string& address, int port) {
-        publisher_endpoints.push_back(NetworkEndpoint(address, port));
-        printf("WASM: Added publisher endpoint: %s:%d\n", address.c_str(), port);
+    // Remote publisher from discovery: its type is checked once, here, and
+    // frames of a refused one are dropped (see matchSubscriber)
+    bool matchPublisher(const std::string& guid, const std::string& participant_guid, const NetworkEndpoint& locator,
+                        const std::string& remote_type, uint64_t remote_hash) {
+        int known = ddsFindRemote(remote_publishers, guid);
+        if (known >= 0) return remote_publishers[known].matched;
+        bool matched = ddsTypesMatch(type_name, type_hash, remote_type, remote_hash);
+        remote_publishers.push_back(DDSRemoteEndpointWASM{guid, participant_guid, locator, matched});
+        updateRemoteMetrics();
+        if (!matched) {
+            printf("WASM: Refused publisher %s on '%s': type '%s' (%016llX) does not match '%s' (%016llX)\n",
+                   guid.c_str(), topic_name.c_str(), remote_type.c_str(), static_cast<unsigned long long>(remote_hash),
+                   type_name.c_str(), static_cast<unsigned long long>(type_hash));
+            return false;
+        }
+        printf("WASM: Matched publisher %s at %s on '%s'\n", guid.c_str(), locator.toString().c_str(),
+               topic_name.c_str());
+        return true;
+    }
+    
+    void unmatchPublisher(const std::string& guid) {
+        int known = ddsFindRemote(remote_publishers, guid);
+        if (known < 0) return;
+        remote_publishers.erase(remote_publishers.begin() + known);
+        updateRemoteMetrics();
+    }
+    
+    void unmatchParticipant(const std::string& participant_guid) {
+        size_t kept = 0;
+        for (size_t i = 0; i < remote_publishers.size(); i++) {
+            if (remote_publishers[i].participant_guid != participant_guid) {
+                remote_publishers[kept++] = remote_publishers[i];
+            }
+        }
+        if (kept == remote_publishers.size()) return;
+        remote_publishers.resize(kept);
+        updateRemoteMetrics();
+    }
+    
+    // Publisher configured by hand (bridges, JS): the same match, on the type name only
+    bool addPublisherEndpoint(const std::string& address, int port, const std::string& remote_type) {
+        NetworkEndpoint locator(address, port);
+        return matchPublisher(locator.toString(), "", locator, remote_type, 0);
     }
     
     void spinOnce() {
@@ -293,14 +1217,345 @@ public:
             net_mgr->poll();
         }
         
-        // Check for messages from discovered publishers
-        // In real implementation, messages would arrive via TCP socket
-        // and be processed here
+        // Frames from remote publishers arrive on the participant's unicast
+        // port and were delivered by the poll
     }
     
     bool isInitialized() const { return initialized; }
     std::string getTopicName() const { return topic_name; }
-    int getMessagesReceived() const { return messages_received; }
+    std::string getTypeName() const { return type_name; }
+    uint64_t getTypeHash() const { return type_hash; }
+    uint32_t getTopicHash() const { return topic_hash; }
+    int getMessagesReceived() const { return static_cast<int>(metrics[SUBSCRIBER_MESSAGES].get()); }
+    uint64_t getMetric(DDSSubscriberMetricWASM metric) const { return metrics[metric].get(); }
+    DDSParticipantWASM* getParticipant() const { return participant; }
+};
+
+inline void DDSParticipantWASM::matchRemote(bool alive, bool is_writer, const std::string& participant,
+                                            const std::string& endpoint_guid, const NetworkEndpoint& locator,
+                                            const std::string& topic, const std::string& type, uint64_t type_hash) {
+    if (is_writer) {
+        for (DDSSubscriberWASM* subscriber : local_subscribers) {
+            if (subscriber->getTopicName() != topic) continue;
+            if (alive) {
+                subscriber->matchPublisher(endpoint_guid, participant, locator, type, type_hash);
+            } else {
+                subscriber->unmatchPublisher(endpoint_guid);
+            }
+        }
+    } else {
+        for (DDSPublisherWASM* publisher : local_publishers) {
+            if (publisher->getTopicName() != topic) continue;
+            if (alive) {
+                publisher->matchSubscriber(endpoint_guid, participant, locator, type, type_hash);
+            } else {
+                publisher->unmatchSubscriber(endpoint_guid);
+            }
+        }
+    }
+}
+
+inline void DDSParticipantWASM::unmatchRemoteParticipant(const std::string& participant) {
+    for (DDSSubscriberWASM* subscriber : local_subscribers) subscriber->unmatchParticipant(participant);
+    for (DDSPublisherWASM* publisher : local_publishers) publisher->unmatchParticipant(participant);
+}
+
+inline void DDSParticipantWASM::handleDatagram(const std::string& data, const NetworkEndpoint& from) {
+    uint32_t magic = 0;
+    if (data.size() >= sizeof(DDSFrameHeader)) {
+        memcpy(&magic, data.data(), sizeof(magic));
+    }
+    if (magic == DDS_FRAGMENT_MAGIC) {
+        handleFragment(data);
+        return;
+    }
+    if (magic != DDS_FRAME_MAGIC && data.compare(0, sizeof(DDS_ENVELOPE_PREFIX) - 1, DDS_ENVELOPE_PREFIX) == 0) {
+        // Untyped JSON envelope: routed by its topic name
+        metrics[PARTICIPANT_FRAMES_RECEIVED].add();
+        size_t topic_end = data.find('"', sizeof(DDS_ENVELOPE_PREFIX) - 1);
+        std::string topic = data.substr(sizeof(DDS_ENVELOPE_PREFIX) - 1,
+                                        topic_end == std::string::npos ? 0 : topic_end - sizeof(DDS_ENVELOPE_PREFIX) + 1);
+        bool matched = false;
+        for (DDSSubscriberWASM* subscriber : local_subscribers) {
+            if (subscriber->getTopicName() == topic) {
+                subscriber->receiveEnvelope(data);
+                matched = true;
+            }
+        }
+        if (!matched) {
+            metrics[PARTICIPANT_FRAMES_UNMATCHED].add();
+        }
+        return;
+    }
+    if (magic != DDS_FRAME_MAGIC) {
+        metrics[PARTICIPANT_DISCOVERY_RECEIVED].add();
+        handleDiscovery(data, from);
+        return;
+    }
+    deliverFrame(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+// A typed frame, whole: to every local subscriber on its topic
+inline void DDSParticipantWASM::deliverFrame(const uint8_t* data, size_t length) {
+    metrics[PARTICIPANT_FRAMES_RECEIVED].add();
+    TraceSpanWASM span(TRACE_DISPATCH);
+    TraceKeyWASM key;
+    if (span.isActive() && ddsFrameTraceKey(data, length, &key)) {
+        span.setKey(key);
+    }
+    uint32_t topic_hash;
+    memcpy(&topic_hash, data + offsetof(DDSFrameHeader, topic_hash), sizeof(topic_hash));
+    bool matched = false;
+    for (DDSSubscriberWASM* subscriber : local_subscribers) {
+        if (subscriber->getTopicHash() == topic_hash) {
+            subscriber->receiveBytes(data, length);
+            matched = true;
+        }
+    }
+    if (!matched) {
+        metrics[PARTICIPANT_FRAMES_UNMATCHED].add();
+    }
+}
+
+// Fragments arrive in order on one host, but any order is accepted; the frame
+// is delivered when all of its bytes are in
+inline void DDSParticipantWASM::handleFragment(const std::string& data) {
+    DDSFragmentHeader header;
+    if (data.size() <= sizeof(header)) return;
+    memcpy(&header, data.data(), sizeof(header));
+    size_t length = data.size() - sizeof(header);
+    metrics[PARTICIPANT_FRAGMENTS_RECEIVED].add();
+    if (header.frame_length < sizeof(DDSFrameHeader) || header.frame_length > DDS_MAX_FRAME_BYTES ||
+        header.fragment_offset > header.frame_length || length > header.frame_length - header.fragment_offset) {
+        metrics[PARTICIPANT_FRAMES_INCOMPLETE].add();
+        return;
+    }
+    
+    Reassembly& reassembly =
+        reassemblies[std::string(reinterpret_cast<const char*>(header.writer_guid), sizeof(header.writer_guid))];
+    if (reassembly.sequence_number != header.sequence_number || reassembly.frame.size() != header.frame_length) {
+        if (reassembly.received > 0) {
+            metrics[PARTICIPANT_FRAMES_INCOMPLETE].add();  // The previous frame lost a fragment
+        }
+        reassembly.sequence_number = header.sequence_number;
+        reassembly.frame.resize(header.frame_length);  // Keeps the capacity of earlier frames
+        reassembly.received = 0;
+    }
+    memcpy(reassembly.frame.data() + header.fragment_offset, data.data() + sizeof(header), length);
+    reassembly.received += static_cast<uint32_t>(length);
+    if (reassembly.received < header.frame_length) return;
+    reassembly.received = 0;
+    deliverFrame(reassembly.frame.data(), reassembly.frame.size());
+}
+
+// A participant that left: its writers' partial frames will not complete
+inline void DDSParticipantWASM::dropReassemblies(const std::string& participant) {
+    uint32_t guid[4];
+    if (sscanf(participant.c_str(), "%08X-%08X-%08X-%08X", &guid[0], &guid[1], &guid[2], &guid[3]) != 4) return;
+    uint8_t prefix[16];
+    ddsEndpointGuid(guid, 0, prefix);
+    for (auto it = reassemblies.begin(); it != reassemblies.end();) {
+        if (memcmp(it->first.data(), prefix, 12) == 0) {
+            it = reassemblies.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+inline bool DDSParticipantWASM::enableMetricsTopic(double period_ms) {
+    if (period_ms <= 0) {
+        delete metrics_publisher;
+        metrics_publisher = nullptr;
+        metrics_period_ms = 0;
+        return true;
+    }
+    if (!initialized) return false;
+    if (!metrics_publisher) {
+        metrics_publisher = new DDSPublisherWASM(this, DDS_METRICS_TOPIC, "std_msgs::msg::String");
+        if (!metrics_publisher->init()) {
+            delete metrics_publisher;
+            metrics_publisher = nullptr;
+            return false;
+        }
+    }
+    metrics_period_ms = period_ms;
+    next_metrics_ms = emscripten_get_now();  // First snapshot with the next announcement
+    return true;
+}
+
+// Serialized as std_msgs::msg::String: uint32 length, then the JSON
+inline bool DDSParticipantWASM::publishMetrics() {
+    if (!metrics_publisher) return false;
+    next_metrics_ms = emscripten_get_now() + metrics_period_ms;
+    std::string stats = getStats();
+    uint32_t length = static_cast<uint32_t>(stats.size());
+    uint8_t* payload = metrics_publisher->loanPayload(sizeof(length) + stats.size());
+    if (!payload) return false;
+    memcpy(payload, &length, sizeof(length));
+    memcpy(payload + sizeof(length), stats.data(), stats.size());
+    if (!metrics_publisher->publishLoaned(sizeof(length) + stats.size())) return false;
+    metrics[PARTICIPANT_METRICS_PUBLISHED].add();
+    return true;
+}
+
+// Deliver to subscribers of the same participant; matches are recomputed
+// (including the type check) only when the participant's subscriber set changes
+inline void DDSPublisherWASM::deliverLocal(const char* data, size_t length) {
+    if (!participant) return;
+    
+    if (local_version != participant->getLocalVersion()) {
+        local_matches.clear();
+        for (DDSSubscriberWASM* subscriber : participant->getLocalSubscribers()) {
+            if (subscriber->getTopicHash() == topic_hash && subscriber->getTopicName() == topic_name &&
+                ddsTypesMatch(type_name, type_hash, subscriber->getTypeName(), subscriber->getTypeHash())) {
+                local_matches.push_back(subscriber);
+            }
+        }
+        local_version = participant->getLocalVersion();
+        metrics[PUBLISHER_MATCHED_LOCAL].set(local_matches.size());
+    }
+    
+    for (DDSSubscriberWASM* subscriber : local_matches) {
+        subscriber->receiveBytes(reinterpret_cast<const uint8_t*>(data), length);
+    }
+}
+
+// Request/reply header prepended to service payloads (same layout as rmw_request_id_t)
+struct DDSRequestHeader {
+    uint8_t writer_guid[16];  // Client that sent the request
+    int64_t sequence_number;  // Per-client, correlates a reply with its request
+};
+
+// ROS 2 topic mangling: "/add" -> "rq/addRequest" / "rr/addReply"
+inline std::string ddsServiceTopic(const std::string& service_name, bool request) {
+    std::string name = (!service_name.empty() && service_name[0] == '/') ? service_name.substr(1) : service_name;
+    return (request ? "rq/" : "rr/") + name + (request ? "Request" : "Reply");
+}
+
+// Service server: request reader + reply writer. Replies go to every client
+// of the service; each client keeps only those carrying its own GUID.
+class DDSServiceServerWASM {
+private:
+    DDSParticipantWASM* participant;
+    std::string service_name;
+    DDSSubscriberWASM request_reader;
+    DDSPublisherWASM reply_writer;
+    
+public:
+    DDSServiceServerWASM(DDSParticipantWASM* part, const std::string& service,
+                         const std::string& request_type, uint64_t request_hash,
+                         const std::string& response_type, uint64_t response_hash)
+        : participant(part), service_name(service),
+          request_reader(part, ddsServiceTopic(service, true), request_type, request_hash),
+          reply_writer(part, ddsServiceTopic(service, false), response_type, response_hash) {}
+    
+    // Reply frames are sized once for max_response bytes
+    bool init(const rcl_allocator_t& allocator, size_t max_response) {
+        printf("WASM: Creating DDS Service '%s'\n", service_name.c_str());
+        reply_writer.setAllocator(allocator);
+        return request_reader.init() && reply_writer.init() &&
+               reply_writer.reserveFrame(sizeof(DDSRequestHeader) + max_response);
+    }
+    
+    // Requests arrive as DDSRequestHeader + serialized request
+    void setRequestCallback(DDSPayloadCallback cb, void* context) {
+        request_reader.setRawCallback(cb, context);
+    }
+    
+    // Reply payload space after the header; fill it, then call sendReply()
+    uint8_t* loanReply(size_t length) {
+        uint8_t* loan = reply_writer.loanPayload(sizeof(DDSRequestHeader) + length);
+        return loan ? loan + sizeof(DDSRequestHeader) : nullptr;
+    }
+    
+    bool sendReply(const DDSRequestHeader& request, size_t length) {
+        uint8_t* loan = reply_writer.loanPayload(sizeof(DDSRequestHeader) + length);
+        if (!loan) return false;
+        memcpy(loan, &request, sizeof(request));
+        return reply_writer.publishLoaned(sizeof(DDSRequestHeader) + length);
+    }
+    
+    std::string getServiceName() const { return service_name; }
+    DDSParticipantWASM* getParticipant() const { return participant; }
+};
+
+// Service client: request writer + reply reader, filtered by this client's GUID.
+// Requests are pipelined: sendRequest() never waits for earlier replies.
+class DDSServiceClientWASM {
+private:
+    DDSParticipantWASM* participant;
+    std::string service_name;
+    DDSPublisherWASM request_writer;
+    DDSSubscriberWASM reply_reader;
+    uint8_t client_guid[16];
+    int64_t sequence_number;
+    DDSPayloadCallback reply_callback;
+    void* reply_context;
+    
+    static void onReply(void* context, const uint8_t* payload, size_t length) {
+        DDSServiceClientWASM* client = static_cast<DDSServiceClientWASM*>(context);
+        if (length < sizeof(DDSRequestHeader) || memcmp(payload, client->client_guid, sizeof(client->client_guid)) != 0) {
+            return;  // Reply for another client
+        }
+        if (client->reply_callback) {
+            client->reply_callback(client->reply_context, payload, length);
+        }
+    }
+    
+public:
+    DDSServiceClientWASM(DDSParticipantWASM* part, const std::string& service,
+                         const std::string& request_type, uint64_t request_hash,
+                         const std::string& response_type, uint64_t response_hash, uint32_t client_index)
+        : participant(part), service_name(service),
+          request_writer(part, ddsServiceTopic(service, true), request_type, request_hash),
+          reply_reader(part, ddsServiceTopic(service, false), response_type, response_hash),
+          sequence_number(0), reply_callback(nullptr), reply_context(nullptr) {
+        // Participant-unique GUID words + client index as entity id
+        memcpy(client_guid, part->getGuid() + 1, 12);
+        memcpy(client_guid + 12, &client_index, sizeof(client_index));
+    }
+    
+    // Request frames are sized once for max_request bytes
+    bool init(const rcl_allocator_t& allocator, size_t max_request) {
+        printf("WASM: Creating DDS Client for service '%s'\n", service_name.c_str());
+        request_writer.setAllocator(allocator);
+        if (!request_writer.init() || !reply_reader.init() ||
+            !request_writer.reserveFrame(sizeof(DDSRequestHeader) + max_request)) {
+            return false;
+        }
+        reply_reader.setRawCallback(&DDSServiceClientWASM::onReply, this);
+        return true;
+    }
+    
+    // Replies arrive as DDSRequestHeader + serialized response
+    void setReplyCallback(DDSPayloadCallback cb, void* context) {
+        reply_callback = cb;
+        reply_context = context;
+    }
+    
+    uint8_t* loanRequest(size_t length) {
+        uint8_t* loan = request_writer.loanPayload(sizeof(DDSRequestHeader) + length);
+        return loan ? loan + sizeof(DDSRequestHeader) : nullptr;
+    }
+    
+    // Sends the loaned request; returns its sequence number (0 on failure)
+    int64_t sendRequest(size_t length) {
+        uint8_t* loan = request_writer.loanPayload(sizeof(DDSRequestHeader) + length);
+        if (!loan) return 0;
+        DDSRequestHeader header;
+        memcpy(header.writer_guid, client_guid, sizeof(client_guid));
+        header.sequence_number = ++sequence_number;
+        memcpy(loan, &header, sizeof(header));
+        if (!request_writer.publishLoaned(sizeof(DDSRequestHeader) + length)) {
+            return 0;
+        }
+        return header.sequence_number;
+    }
+    
+    int64_t getNextSequenceNumber() const { return sequence_number + 1; }
+    const uint8_t* getGuid() const { return client_guid; }
+    std::string getServiceName() const { return service_name; }
     DDSParticipantWASM* getParticipant() const { return participant; }
 };
 
@@ -311,7 +1566,15 @@ EMSCRIPTEN_BINDINGS(dds_minimal_wasm) {
         .function("discoverParticipants", &DDSParticipantWASM::discoverParticipants)
         .function("isInitialized", &DDSParticipantWASM::isInitialized)
         .function("getName", &DDSParticipantWASM::getName)
-        .function("getDomainId", &DDSParticipantWASM::getDomainId);
+        .function("getDomainId", &DDSParticipantWASM::getDomainId)
+        .function("getParticipantId", &DDSParticipantWASM::getParticipantId)
+        .function("getUnicastPort", &DDSParticipantWASM::getUnicastPort)
+        .function("getStats", &DDSParticipantWASM::getStats)
+        .function("enableMetricsTopic", &DDSParticipantWASM::enableMetricsTopic)
+        .function("publishMetrics", &DDSParticipantWASM::publishMetrics)
+        .function("startTrace", &DDSParticipantWASM::startTrace)
+        .function("stopTrace", &DDSParticipantWASM::stopTrace)
+        .function("getTrace", &DDSParticipantWASM::getTrace);
     
     class_<DDSPublisherWASM>("DDSPublisherWASM")
         .constructor<DDSParticipantWASM*, const std::string&, const std::string&>()
@@ -327,6 +1590,7 @@ EMSCRIPTEN_BINDINGS(dds_minimal_wasm) {
         .function("init", &DDSSubscriberWASM::init)
         .function("setCallback", &DDSSubscriberWASM::setCallback)
         .function("receiveMessage", &DDSSubscriberWASM::receiveMessage)
+        .function("receiveBatch", &DDSSubscriberWASM::receiveBatchAt)
         .function("addPublisherEndpoint", &DDSSubscriberWASM::addPublisherEndpoint)
         .function("spinOnce", &DDSSubscriberWASM::spinOnce)
         .function("isInitialized", &DDSSubscriberWASM::isInitialized)
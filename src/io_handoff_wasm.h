@@ -0,0 +1,356 @@
+/*
+ * I/O Hand-off for WASM
+ *
+ * Moves receive work off the executor thread. An I/O thread reads datagrams
+ * straight into pooled, fixed-size buffers and queues them on a bounded
+ * lock-free MPSC queue; the executor thread drains the queue and runs the
+ * callbacks. A slow callback then delays delivery, not socket reads, so the
+ * kernel buffer keeps draining.
+ *
+ * - Buffers: allocated once; free buffers sit on a lock-free stack, so a
+ *   receive never allocates. When the pool or the queue is full the frame
+ *   is dropped and counted, never blocked on.
+ * - Wakeups are batched: a producer signals the consumer only for the first
+ *   frame after a drain started, however many follow.
+ * - Stats: queue depth (current and peak) and hand-off latency (time from
+ *   commit on the I/O thread to delivery on the executor thread).
+ *
+ * Producers may be any number of threads; drain() must stay on one thread.
+ * Without pthreads (plain Emscripten) startThread() fails and a receiver
+ * falls back to reading on the caller's thread.
+ */
+
+#ifndef IO_HANDOFF_WASM_H
+#define IO_HANDOFF_WASM_H
+
+#include "platform_wasm.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define IO_HANDOFF_WASM_HAS_THREADS 0
+#else
+#define IO_HANDOFF_WASM_HAS_THREADS 1
+#endif
+
+#ifndef __EMSCRIPTEN__
+#include <poll.h>
+#endif
+
+#define IO_HANDOFF_WASM_DEFAULT_FRAMES 256
+#define IO_HANDOFF_WASM_DEFAULT_FRAME_SIZE 4096  // Largest datagram read by the UDP socket
+#define IO_HANDOFF_WASM_IDLE_MS 1                // I/O thread wait when nothing was read
+
+struct IOHandoffStatsWASM {
+    uint64_t committed;        // Frames queued by producers
+    uint64_t delivered;        // Frames drained by the consumer
+    uint64_t dropped;          // Pool or queue full
+    uint64_t wakeups;          // Wake callbacks (one per batch)
+    size_t depth;              // Frames queued right now
+    size_t max_depth;
+    double last_latency_ms;    // Commit -> delivery
+    double max_latency_ms;
+    double mean_latency_ms;
+};
+
+// Bounded MPSC ring of frame indices (Vyukov's sequence-numbered cells):
+// producers claim a slot with one CAS, the single consumer needs none
+class MPSCQueueWASM {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        uint32_t value;
+    };
+
+    Cell* cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> tail;  // Producers
+    alignas(64) size_t head;               // Consumer only
+
+public:
+    // capacity is rounded up to a power of two
+    explicit MPSCQueueWASM(size_t capacity) : tail(0), head(0) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        cells = new Cell[size];
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MPSCQueueWASM() {
+        delete[] cells;
+    }
+
+    MPSCQueueWASM(const MPSCQueueWASM&) = delete;
+    MPSCQueueWASM& operator=(const MPSCQueueWASM&) = delete;
+
+    bool push(uint32_t value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // Full
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(uint32_t& value) {
+        Cell& cell = cells[head & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != head + 1) {
+            return false;  // Empty, or the producer has not finished writing
+        }
+        value = cell.value;
+        cell.sequence.store(head + mask + 1, std::memory_order_release);
+        head++;
+        return true;
+    }
+
+    // Consumer side; producers may be mid-push
+    size_t size() const {
+        size_t claimed = tail.load(std::memory_order_acquire);
+        return claimed > head ? claimed - head : 0;
+    }
+};
+
+// Fixed pool of receive buffers with a lock-free free list. The head packs
+// the top index with a generation tag so a stale CAS cannot succeed (ABA).
+class IOFramePoolWASM {
+private:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    std::vector<uint8_t> storage;
+    size_t frame_size;
+    std::atomic<uint32_t>* next;
+    alignas(64) std::atomic<uint64_t> free_head;  // tag << 32 | index
+
+public:
+    IOFramePoolWASM(size_t frame_count, size_t frame_size)
+        : storage(frame_count * frame_size), frame_size(frame_size), free_head(NONE) {
+        next = new std::atomic<uint32_t>[frame_count];
+        for (size_t i = frame_count; i-- > 0;) {
+            release(static_cast<uint32_t>(i));
+        }
+    }
+
+    ~IOFramePoolWASM() {
+        delete[] next;
+    }
+
+    IOFramePoolWASM(const IOFramePoolWASM&) = delete;
+    IOFramePoolWASM& operator=(const IOFramePoolWASM&) = delete;
+
+    bool acquire(uint32_t& index) {
+        uint64_t head = free_head.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t top = static_cast<uint32_t>(head);
+            if (top == NONE) return false;
+            uint64_t tag = (head >> 32) + 1;
+            uint64_t replacement = (tag << 32) | next[top].load(std::memory_order_relaxed);
+            if (free_head.compare_exchange_weak(head, replacement, std::memory_order_acq_rel)) {
+                index = top;
+                return true;
+            }
+        }
+    }
+
+    void release(uint32_t index) {
+        uint64_t head = free_head.load(std::memory_order_relaxed);
+        for (;;) {
+            next[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            uint64_t tag = (head >> 32) + 1;
+            if (free_head.compare_exchange_weak(head, (tag << 32) | index, std::memory_order_acq_rel)) {
+                return;
+            }
+        }
+    }
+
+    uint8_t* data(uint32_t index) { return storage.data() + index * frame_size; }
+    size_t getFrameSize() const { return frame_size; }
+};
+
+// Delivered on the consumer thread; source is whatever the producer passed to commit()
+typedef void (*IOHandoffDeliverWASM)(void* context, uint64_t source, const uint8_t* data, size_t length);
+typedef void (*IOHandoffWakeWASM)(void* context);
+// One non-blocking read on the I/O thread; false when nothing was available
+typedef bool (*IOHandoffReadWASM)(void* context);
+
+class IOHandoffWASM {
+private:
+    struct FrameInfo {
+        uint64_t source;
+        uint32_t length;
+        double committed_ms;
+    };
+
+    IOFramePoolWASM pool;
+    std::vector<FrameInfo> info;
+    MPSCQueueWASM queue;
+    std::atomic<bool> wake_armed;  // Consumer wants a wake for the next frame
+    IOHandoffWakeWASM wake;
+    void* wake_context;
+    std::atomic<uint64_t> committed;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> wakeups;
+    IOHandoffStatsWASM stats;  // Consumer-side fields
+
+    std::thread io_thread;
+    std::atomic<bool> io_running;
+    IOHandoffReadWASM io_read;
+    void* io_context;
+    int io_fds[2];  // Polled when idle; -1 = unused
+
+    void ioLoop() {
+        while (io_running.load(std::memory_order_relaxed)) {
+            if (io_read(io_context)) continue;
+#ifndef __EMSCRIPTEN__
+            if (io_fds[0] >= 0) {
+                struct pollfd pfds[2] = {{io_fds[0], POLLIN, 0}, {io_fds[1], POLLIN, 0}};
+                ::poll(pfds, io_fds[1] >= 0 ? 2 : 1, IO_HANDOFF_WASM_IDLE_MS);
+                continue;
+            }
+#endif
+            std::this_thread::sleep_for(std::chrono::milliseconds(IO_HANDOFF_WASM_IDLE_MS));
+        }
+    }
+
+public:
+    IOHandoffWASM(size_t frame_count = IO_HANDOFF_WASM_DEFAULT_FRAMES,
+                  size_t frame_size = IO_HANDOFF_WASM_DEFAULT_FRAME_SIZE)
+        : pool(frame_count, frame_size), info(frame_count), queue(frame_count), wake_armed(true),
+          wake(nullptr), wake_context(nullptr), committed(0), dropped(0), wakeups(0), stats(),
+          io_running(false), io_read(nullptr), io_context(nullptr), io_fds{-1, -1} {}
+
+    ~IOHandoffWASM() {
+        stopThread();
+    }
+
+    IOHandoffWASM(const IOHandoffWASM&) = delete;
+    IOHandoffWASM& operator=(const IOHandoffWASM&) = delete;
+
+    // Called (from a producer thread) once per batch of frames. Set before
+    // startThread() or any producer runs
+    void setWakeCallback(IOHandoffWakeWASM callback, void* context) {
+        wake = callback;
+        wake_context = context;
+    }
+
+    // Producer: a buffer to read into, getFrameSize() bytes; then commit() or
+    // abandon(). nullptr when every buffer is queued: leave the data where it is.
+    uint8_t* acquire(uint32_t* index) {
+        return pool.acquire(*index) ? pool.data(*index) : nullptr;
+    }
+
+    void abandon(uint32_t index) {
+        pool.release(index);
+    }
+
+    bool commit(uint32_t index, size_t length, uint64_t source) {
+        FrameInfo& frame = info[index];
+        frame.source = source;
+        frame.length = static_cast<uint32_t>(length);
+        frame.committed_ms = emscripten_get_now();
+        if (!queue.push(index)) {
+            pool.release(index);
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        committed.fetch_add(1, std::memory_order_relaxed);
+        if (wake_armed.exchange(false, std::memory_order_acq_rel)) {
+            wakeups.fetch_add(1, std::memory_order_relaxed);
+            if (wake) wake(wake_context);
+        }
+        return true;
+    }
+
+    // Producer: copy bytes that are already in memory
+    bool push(const uint8_t* data, size_t length, uint64_t source) {
+        uint32_t index;
+        if (length > pool.getFrameSize()) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        uint8_t* buffer = acquire(&index);
+        if (!buffer) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (length > 0) memcpy(buffer, data, length);
+        return commit(index, length, source);
+    }
+
+    // Consumer: deliver up to max_frames (0 = all queued); returns how many
+    size_t drain(IOHandoffDeliverWASM deliver, void* context, size_t max_frames = 0) {
+        // Re-armed first: a frame queued after the last pop below must wake us
+        wake_armed.store(true, std::memory_order_release);
+        size_t depth = queue.size();
+        if (depth > stats.max_depth) stats.max_depth = depth;
+
+        size_t delivered = 0;
+        uint32_t index;
+        while ((max_frames == 0 || delivered < max_frames) && queue.pop(index)) {
+            const FrameInfo& frame = info[index];
+            double latency = emscripten_get_now() - frame.committed_ms;
+            stats.delivered++;
+            stats.last_latency_ms = latency;
+            stats.mean_latency_ms += (latency - stats.mean_latency_ms) / static_cast<double>(stats.delivered);
+            if (latency > stats.max_latency_ms) stats.max_latency_ms = latency;
+            deliver(context, frame.source, pool.data(index), frame.length);
+            pool.release(index);
+            delivered++;
+        }
+        return delivered;
+    }
+
+    // Runs read(context) in a loop on a dedicated thread. With fd >= 0 the
+    // thread sleeps in poll(2) on it (and fd2, if >= 0) when idle, otherwise
+    // it naps IO_HANDOFF_WASM_IDLE_MS.
+    bool startThread(IOHandoffReadWASM read, void* context, int fd, int fd2 = -1) {
+        if (!IO_HANDOFF_WASM_HAS_THREADS || !read || io_running) return false;
+        io_read = read;
+        io_context = context;
+        io_fds[0] = fd;
+        io_fds[1] = fd >= 0 ? fd2 : -1;
+        io_running = true;
+        io_thread = std::thread(&IOHandoffWASM::ioLoop, this);
+        return true;
+    }
+
+    void stopThread() {
+        if (!io_running) return;
+        io_running = false;
+        io_thread.join();
+    }
+
+    bool isThreadRunning() const { return io_running; }
+    size_t getFrameSize() const { return pool.getFrameSize(); }
+    size_t getDepth() const { return queue.size(); }
+
+    // Consumer thread
+    IOHandoffStatsWASM getStats() const {
+        IOHandoffStatsWASM snapshot = stats;
+        snapshot.committed = committed.load(std::memory_order_relaxed);
+        snapshot.dropped = dropped.load(std::memory_order_relaxed);
+        snapshot.wakeups = wakeups.load(std::memory_order_relaxed);
+        snapshot.depth = queue.size();
+        return snapshot;
+    }
+};
+
+#endif // IO_HANDOFF_WASM_H
@@ -0,0 +1,324 @@
+/*
+ * JSON Field Extractor for WASM
+ *
+ * Pulls a fixed set of top-level fields out of a flat JSON object (sensor
+ * payloads) in one pass, without building a document:
+ * - Keys are compiled once (JsonExtractorWASM constructor); the pass stops
+ *   as soon as every key was seen.
+ * - Strings and skipped nested values are scanned a block at a time for
+ *   structural characters: WASM SIMD128 (-msimd128), AVX2 or SSE2 natively,
+ *   a byte loop otherwise.
+ * - Numbers are parsed with std::from_chars where the standard library has
+ *   the floating-point overloads, strtod on a bounded copy otherwise.
+ * Nested objects/arrays are skipped, not searched, so a nested "value" never
+ * shadows the top-level one. String fields are returned as raw slices of the
+ * input (escapes left as they are).
+ */
+
+#ifndef JSON_EXTRACT_WASM_H
+#define JSON_EXTRACT_WASM_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define JSON_EXTRACT_WASM_BLOCK 16
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define JSON_EXTRACT_WASM_BLOCK 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define JSON_EXTRACT_WASM_BLOCK 16
+#else
+#define JSON_EXTRACT_WASM_BLOCK 0
+#endif
+
+#ifndef JSON_EXTRACT_WASM_FROM_CHARS
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define JSON_EXTRACT_WASM_FROM_CHARS 1
+#else
+#define JSON_EXTRACT_WASM_FROM_CHARS 0
+#endif
+#endif
+
+#define JSON_EXTRACT_WASM_MAX_KEYS 16
+#define JSON_EXTRACT_WASM_MAX_KEY_LENGTH 31
+
+enum JsonFieldTypeWASM {
+    JSON_FIELD_MISSING = 0,
+    JSON_FIELD_NUMBER,
+    JSON_FIELD_STRING,
+    JSON_FIELD_BOOL,
+    JSON_FIELD_NULL,
+    JSON_FIELD_OTHER  // Object or array; text is the raw slice
+};
+
+struct JsonFieldWASM {
+    JsonFieldTypeWASM type;
+    double number;     // NUMBER; BOOL as 0/1
+    const char* text;  // STRING: contents without quotes; OTHER: the whole value
+    size_t length;
+};
+
+namespace json_extract_wasm {
+
+#if JSON_EXTRACT_WASM_BLOCK == 32
+inline uint32_t matchMask(const char* p, char a, char b) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(a)),
+                                   _mm256_cmpeq_epi8(block, _mm256_set1_epi8(b)));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+}
+
+// '"', '[', ']', '{', '}'; brackets and braces differ only in bit 5
+inline uint32_t structuralMask(const char* p) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i folded = _mm256_or_si256(block, _mm256_set1_epi8(0x20));
+    __m256i hits = _mm256_or_si256(
+        _mm256_cmpeq_epi8(block, _mm256_set1_epi8('"')),
+        _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                        _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+}
+#elif JSON_EXTRACT_WASM_BLOCK == 16 && defined(__wasm_simd128__)
+inline uint32_t matchMask(const char* p, char a, char b) {
+    v128_t block = wasm_v128_load(p);
+    v128_t hits = wasm_v128_or(wasm_i8x16_eq(block, wasm_i8x16_splat(a)), wasm_i8x16_eq(block, wasm_i8x16_splat(b)));
+    return wasm_i8x16_bitmask(hits);
+}
+
+inline uint32_t structuralMask(const char* p) {
+    v128_t block = wasm_v128_load(p);
+    v128_t folded = wasm_v128_or(block, wasm_i8x16_splat(0x20));
+    v128_t hits = wasm_v128_or(wasm_i8x16_eq(block, wasm_i8x16_splat('"')),
+                               wasm_v128_or(wasm_i8x16_eq(folded, wasm_i8x16_splat('{')),
+                                            wasm_i8x16_eq(folded, wasm_i8x16_splat('}'))));
+    return wasm_i8x16_bitmask(hits);
+}
+#elif JSON_EXTRACT_WASM_BLOCK == 16
+inline uint32_t matchMask(const char* p, char a, char b) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(a)), _mm_cmpeq_epi8(block, _mm_set1_epi8(b)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(hits));
+}
+
+inline uint32_t structuralMask(const char* p) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i folded = _mm_or_si128(block, _mm_set1_epi8(0x20));
+    __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('"')),
+                                _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                                             _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))));
+    return static_cast<uint32_t>(_mm_movemask_epi8(hits));
+}
+#endif
+
+inline bool isStructural(char c) {
+    return c == '"' || (c | 0x20) == '{' || (c | 0x20) == '}';
+}
+
+// First '"' or '\\' at or after p; end when there is none
+inline const char* findQuoteOrEscape(const char* p, const char* end) {
+#if JSON_EXTRACT_WASM_BLOCK > 0
+    while (end - p >= JSON_EXTRACT_WASM_BLOCK) {
+        uint32_t mask = matchMask(p, '"', '\\');
+        if (mask) return p + __builtin_ctz(mask);
+        p += JSON_EXTRACT_WASM_BLOCK;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\') p++;
+    return p;
+}
+
+// First quote, bracket or brace at or after p
+inline const char* findStructural(const char* p, const char* end) {
+#if JSON_EXTRACT_WASM_BLOCK > 0
+    while (end - p >= JSON_EXTRACT_WASM_BLOCK) {
+        uint32_t mask = structuralMask(p);
+        if (mask) return p + __builtin_ctz(mask);
+        p += JSON_EXTRACT_WASM_BLOCK;
+    }
+#endif
+    while (p < end && !isStructural(*p)) p++;
+    return p;
+}
+
+inline const char* skipSpace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    return p;
+}
+
+// p is just past the opening quote; returns the closing quote, or nullptr
+inline const char* endOfString(const char* p, const char* end) {
+    for (;;) {
+        p = findQuoteOrEscape(p, end);
+        if (p >= end) return nullptr;
+        if (*p == '"') return p;
+        p += 2;  // Escaped character
+    }
+}
+
+// p is on '{' or '['; returns just past the matching close, or nullptr
+inline const char* endOfContainer(const char* p, const char* end) {
+    int depth = 0;
+    for (;;) {
+        p = findStructural(p, end);
+        if (p >= end) return nullptr;
+        char c = *p++;
+        if (c == '"') {
+            p = endOfString(p, end);
+            if (!p) return nullptr;
+            p++;
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if (--depth == 0) {
+            return p;
+        }
+    }
+}
+
+// Returns just past the number, or nullptr
+inline const char* parseNumber(const char* p, const char* end, double* value) {
+#if JSON_EXTRACT_WASM_FROM_CHARS
+    std::from_chars_result result = std::from_chars(p, end, *value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+#else
+    char buffer[64];
+    size_t length = 0;
+    while (p + length < end && length < sizeof(buffer) - 1 &&
+           (static_cast<unsigned char>(p[length] - '0') < 10 || p[length] == '-' || p[length] == '+' ||
+            p[length] == '.' || p[length] == 'e' || p[length] == 'E')) {
+        length++;
+    }
+    memcpy(buffer, p, length);
+    buffer[length] = '\0';
+    char* parsed_end;
+    *value = strtod(buffer, &parsed_end);
+    return parsed_end == buffer ? nullptr : p + (parsed_end - buffer);
+#endif
+}
+
+} // namespace json_extract_wasm
+
+class JsonExtractorWASM {
+private:
+    struct Key {
+        char text[JSON_EXTRACT_WASM_MAX_KEY_LENGTH + 1];
+        size_t length;
+    };
+    Key keys[JSON_EXTRACT_WASM_MAX_KEYS];
+    size_t key_count;
+
+    int lookup(const char* name, size_t length) const {
+        for (size_t i = 0; i < key_count; i++) {
+            if (keys[i].length == length && keys[i].text[0] == name[0] && memcmp(keys[i].text, name, length) == 0) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+public:
+    // Keys beyond JSON_EXTRACT_WASM_MAX_KEYS, or longer than
+    // JSON_EXTRACT_WASM_MAX_KEY_LENGTH, are ignored
+    JsonExtractorWASM(std::initializer_list<const char*> names) : key_count(0) {
+        for (const char* name : names) {
+            size_t length = strlen(name);
+            if (key_count == JSON_EXTRACT_WASM_MAX_KEYS || length == 0 || length > JSON_EXTRACT_WASM_MAX_KEY_LENGTH) {
+                continue;
+            }
+            memcpy(keys[key_count].text, name, length + 1);
+            keys[key_count].length = length;
+            key_count++;
+        }
+    }
+
+    size_t size() const { return key_count; }
+
+    // Fills fields[i] for the i-th key (size() entries); returns how many were
+    // found. Stops at the first malformed token, keeping what it found.
+    size_t extract(const char* json, size_t length, JsonFieldWASM* fields) const {
+        using namespace json_extract_wasm;
+        for (size_t i = 0; i < key_count; i++) {
+            fields[i].type = JSON_FIELD_MISSING;
+            fields[i].number = 0;
+            fields[i].text = nullptr;
+            fields[i].length = 0;
+        }
+        const char* end = json + length;
+        const char* p = skipSpace(json, end);
+        if (p >= end || *p != '{') return 0;
+        p++;
+
+        size_t found = 0;
+        uint32_t seen = 0;
+        while (found < key_count) {
+            p = skipSpace(p, end);
+            if (p >= end || *p != '"') break;  // '}' or malformed
+            const char* name = p + 1;
+            const char* name_end = endOfString(name, end);
+            if (!name_end) break;
+            int index = lookup(name, static_cast<size_t>(name_end - name));
+
+            p = skipSpace(name_end + 1, end);
+            if (p >= end || *p != ':') break;
+            p = skipSpace(p + 1, end);
+            if (p >= end) break;
+
+            JsonFieldWASM* field = index >= 0 ? &fields[index] : nullptr;
+            const char* value = p;
+            char c = *p;
+            if (c == '"') {
+                const char* close = endOfString(p + 1, end);
+                if (!close) break;
+                if (field) {
+                    field->type = JSON_FIELD_STRING;
+                    field->text = p + 1;
+                    field->length = static_cast<size_t>(close - p - 1);
+                }
+                p = close + 1;
+            } else if (c == '{' || c == '[') {
+                p = endOfContainer(p, end);
+                if (!p) break;
+                if (field) {
+                    field->type = JSON_FIELD_OTHER;
+                    field->text = value;
+                    field->length = static_cast<size_t>(p - value);
+                }
+            } else if (c == 't' || c == 'f' || c == 'n') {
+                size_t word = c == 'f' ? 5 : 4;
+                if (static_cast<size_t>(end - p) < word) break;
+                if (field) {
+                    field->type = c == 'n' ? JSON_FIELD_NULL : JSON_FIELD_BOOL;
+                    field->number = c == 't' ? 1.0 : 0.0;
+                }
+                p += word;
+            } else {
+                double number;
+                const char* number_end = parseNumber(p, end, &number);
+                if (!number_end) break;
+                if (field) {
+                    field->type = JSON_FIELD_NUMBER;
+                    field->number = number;
+                }
+                p = number_end;
+            }
+            // A repeated key keeps its last value, counted once
+            if (field && !(seen & (1u << index))) {
+                seen |= 1u << index;
+                found++;
+            }
+
+            p = skipSpace(p, end);
+            if (p >= end || *p != ',') break;
+            p++;
+        }
+        return found;
+    }
+};
+
+#endif // JSON_EXTRACT_WASM_H
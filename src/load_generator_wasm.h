@@ -0,0 +1,321 @@
+/*
+ * Load Generator for WASM
+ *
+ * Schedules synthetic publications from a profile so production load can be
+ * reproduced, and records how closely the sends follow the schedule:
+ * - The schedule is fixed by the profile: message k is due at a time derived
+ *   from the rate (times the burst factor inside bursts), whatever the host
+ *   timer does. The driver calls step() whenever it wakes; every message
+ *   already due is sent then, so a coarse timer shows up as lag, not as a
+ *   lower rate.
+ * - Lag is send time minus due time (StreamStatsWASM: mean and p99 since
+ *   start, max), per message.
+ * - Payload sizes are drawn from a fixed, uniform or exponential (capped)
+ *   distribution with a seeded generator; topics are used round robin.
+ * Profile text, space-separated key=value (all optional):
+ *     rate=1000              messages per second outside bursts, all topics
+ *     topics=4               round robin over this many topics
+ *     duration=5000          ms; 0 runs until stop()
+ *     payload=fixed:80       or uniform:MIN-MAX, exp:MEAN-MAX (bytes)
+ *     burst=1000:100:5       every 1000 ms, for 100 ms, 5x the rate
+ *     seed=1
+ */
+
+#ifndef LOAD_GENERATOR_WASM_H
+#define LOAD_GENERATOR_WASM_H
+
+#include "platform_wasm.h"
+#include "stream_stats_wasm.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#define LOAD_GENERATOR_WASM_MAX_TOPICS 256
+#define LOAD_GENERATOR_WASM_MAX_PAYLOAD 65536
+#define LOAD_GENERATOR_WASM_MAX_RATE 1000000.0
+#define LOAD_GENERATOR_WASM_DEFAULT_PROFILE "rate=100 topics=1 duration=0 payload=fixed:80"
+
+enum LoadPayloadDistributionWASM {
+    LOAD_PAYLOAD_FIXED = 0,
+    LOAD_PAYLOAD_UNIFORM,
+    LOAD_PAYLOAD_EXPONENTIAL
+};
+
+struct LoadProfileWASM {
+    double rate_hz;
+    int topics;
+    double duration_ms;
+    LoadPayloadDistributionWASM payload;
+    size_t payload_min;  // Fixed size, uniform minimum or exponential mean
+    size_t payload_max;
+    double burst_period_ms;  // 0 = no bursts
+    double burst_length_ms;
+    double burst_factor;
+    uint64_t seed;
+};
+
+// Written at the start of every payload so receivers can measure latency and loss
+struct LoadStampWASM {
+    uint64_t sequence;
+    double due_ms;
+};
+
+class LoadGeneratorWASM {
+private:
+    LoadProfileWASM profile;
+    size_t min_payload;  // Smallest payload the sender can encode (stamp included)
+    bool running;
+    double start_ms;
+    double next_due_ms;
+    double end_ms;
+    double last_send_ms;
+    uint64_t sequence;
+    uint64_t rng_state;
+
+    uint64_t sent;
+    uint64_t burst_sent;
+    uint64_t bytes_sent;
+    double max_lag_ms;
+    StreamStatsWASM lag_stats;
+
+    uint32_t nextRandom() {
+        rng_state ^= rng_state << 13;
+        rng_state ^= rng_state >> 7;
+        rng_state ^= rng_state << 17;
+        return static_cast<uint32_t>(rng_state >> 32);
+    }
+
+    bool inBurst(double due_ms) const {
+        return profile.burst_period_ms > 0 && std::fmod(due_ms - start_ms, profile.burst_period_ms) < profile.burst_length_ms;
+    }
+
+    size_t samplePayload() {
+        size_t size = profile.payload_min;
+        if (profile.payload == LOAD_PAYLOAD_UNIFORM) {
+            size = profile.payload_min + nextRandom() % (profile.payload_max - profile.payload_min + 1);
+        } else if (profile.payload == LOAD_PAYLOAD_EXPONENTIAL) {
+            double u = (nextRandom() + 1.0) / 4294967297.0;
+            double drawn = -std::log(u) * static_cast<double>(profile.payload_min);
+            size = drawn >= profile.payload_max ? profile.payload_max : static_cast<size_t>(drawn);
+        }
+        return size < min_payload ? min_payload : size;
+    }
+
+    static bool parseSize(const char* text, size_t* size) {
+        char* end = nullptr;
+        unsigned long n = strtoul(text, &end, 10);
+        if (end == text || n == 0 || n > LOAD_GENERATOR_WASM_MAX_PAYLOAD) return false;
+        *size = n;
+        return true;
+    }
+
+    static bool parsePayload(const std::string& value, LoadProfileWASM* p) {
+        size_t colon = value.find(':');
+        if (colon == std::string::npos) return false;
+        std::string kind = value.substr(0, colon);
+        std::string range = value.substr(colon + 1);
+        if (kind == "fixed") {
+            p->payload = LOAD_PAYLOAD_FIXED;
+            if (!parseSize(range.c_str(), &p->payload_min)) return false;
+            p->payload_max = p->payload_min;
+            return true;
+        }
+        size_t dash = range.find('-');
+        if (dash == std::string::npos || !parseSize(range.c_str(), &p->payload_min) ||
+            !parseSize(range.c_str() + dash + 1, &p->payload_max) || p->payload_max < p->payload_min) {
+            return false;
+        }
+        if (kind == "uniform") {
+            p->payload = LOAD_PAYLOAD_UNIFORM;
+        } else if (kind == "exp") {
+            p->payload = LOAD_PAYLOAD_EXPONENTIAL;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+public:
+    explicit LoadGeneratorWASM(size_t min_payload = sizeof(LoadStampWASM))
+        : min_payload(min_payload), running(false), lag_stats(1024) {
+        parseProfile(LOAD_GENERATOR_WASM_DEFAULT_PROFILE, &profile);
+        reset();
+    }
+
+    // Fills `out` from profile text (format above); false on an unknown key or
+    // a value out of range, in which case `out` is unspecified
+    static bool parseProfile(const std::string& text, LoadProfileWASM* out) {
+        LoadProfileWASM p = {100.0, 1, 0.0, LOAD_PAYLOAD_FIXED, 80, 80, 0.0, 0.0, 1.0, 1};
+        size_t pos = 0;
+        while (pos < text.size()) {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n')) pos++;
+            size_t end = pos;
+            while (end < text.size() && text[end] != ' ' && text[end] != '\t' && text[end] != '\n') end++;
+            if (end == pos) break;
+            std::string token = text.substr(pos, end - pos);
+            pos = end;
+            size_t eq = token.find('=');
+            if (eq == std::string::npos) return false;
+            std::string key = token.substr(0, eq);
+            std::string value = token.substr(eq + 1);
+            const char* v = value.c_str();
+            char* rest = nullptr;
+            if (key == "rate") {
+                p.rate_hz = strtod(v, &rest);
+                if (rest == v || !(p.rate_hz > 0) || p.rate_hz > LOAD_GENERATOR_WASM_MAX_RATE) return false;
+            } else if (key == "topics") {
+                long n = strtol(v, &rest, 10);
+                if (rest == v || n < 1 || n > LOAD_GENERATOR_WASM_MAX_TOPICS) return false;
+                p.topics = static_cast<int>(n);
+            } else if (key == "duration") {
+                p.duration_ms = strtod(v, &rest);
+                if (rest == v || p.duration_ms < 0) return false;
+            } else if (key == "payload") {
+                if (!parsePayload(value, &p)) return false;
+            } else if (key == "burst") {
+                if (sscanf(v, "%lf:%lf:%lf", &p.burst_period_ms, &p.burst_length_ms, &p.burst_factor) != 3 ||
+                    p.burst_period_ms <= 0 || p.burst_length_ms < 0 || p.burst_length_ms > p.burst_period_ms ||
+                    !(p.burst_factor > 0) || p.rate_hz * p.burst_factor > LOAD_GENERATOR_WASM_MAX_RATE) {
+                    return false;
+                }
+            } else if (key == "seed") {
+                p.seed = strtoull(v, &rest, 10);
+                if (rest == v) return false;
+            } else {
+                return false;
+            }
+        }
+        *out = p;
+        return true;
+    }
+
+    bool configure(const std::string& text) {
+        LoadProfileWASM parsed;
+        if (!parseProfile(text, &parsed)) {
+            printf("WASM: Load profile not understood: %s\n", text.c_str());
+            return false;
+        }
+        profile = parsed;
+        return true;
+    }
+
+    void reset() {
+        running = false;
+        start_ms = 0;
+        next_due_ms = 0;
+        end_ms = 0;
+        last_send_ms = 0;
+        sequence = 0;
+        rng_state = profile.seed ? profile.seed * 0x9E3779B97F4A7C15ull : 88172645463325252ull;
+        sent = 0;
+        burst_sent = 0;
+        bytes_sent = 0;
+        max_lag_ms = 0;
+        lag_stats.reset();
+    }
+
+    void start(double now_ms) {
+        reset();
+        running = true;
+        start_ms = now_ms;
+        next_due_ms = now_ms;
+        end_ms = profile.duration_ms > 0 ? now_ms + profile.duration_ms : INFINITY;
+        last_send_ms = now_ms;
+    }
+
+    void stop() {
+        running = false;
+    }
+
+    // Sends up to max_messages that are due by now through
+    // send(topic, stamp, payload_size); when send() returns false the
+    // message stays due and goes out (late) on the next step. Returns the
+    // messages sent.
+    template <typename Send>
+    int step(int max_messages, Send send) {
+        int count = 0;
+        while (running && count < max_messages) {
+            if (next_due_ms >= end_ms) {
+                running = false;
+                break;
+            }
+            double now = emscripten_get_now();
+            if (next_due_ms > now) break;
+
+            LoadStampWASM stamp = {sequence, next_due_ms};
+            int topic = static_cast<int>(sequence % static_cast<uint64_t>(profile.topics));
+            size_t size = samplePayload();
+            if (!send(topic, stamp, size)) break;
+
+            double lag = now - next_due_ms;
+            lag_stats.add(lag, 0.0);
+            if (lag > max_lag_ms) max_lag_ms = lag;
+            bool burst = inBurst(next_due_ms);
+            if (burst) burst_sent++;
+            sent++;
+            bytes_sent += size;
+            last_send_ms = now;
+            count++;
+
+            sequence++;
+            next_due_ms += 1000.0 / (profile.rate_hz * (burst ? profile.burst_factor : 1.0));
+        }
+        return count;
+    }
+
+    // ms until the next message is due (0 = now); < 0 when not running
+    double nextDueMs(double now_ms) const {
+        if (!running) return -1.0;
+        double delay = next_due_ms - now_ms;
+        return delay > 0 ? delay : 0.0;
+    }
+
+    // Messages per second the profile asks for on average (bursts included)
+    double getTargetRate() const {
+        if (profile.burst_period_ms <= 0) return profile.rate_hz;
+        double burst_share = profile.burst_length_ms / profile.burst_period_ms;
+        return profile.rate_hz * (1.0 - burst_share + burst_share * profile.burst_factor);
+    }
+
+    // Sends per second from start to the last send (or now while running)
+    double getActualRate(double now_ms) const {
+        double elapsed = (running ? now_ms : last_send_ms) - start_ms;
+        return elapsed > 0 ? sent * 1000.0 / elapsed : 0.0;
+    }
+
+    // Messages due by now that were not sent yet
+    uint64_t getBehind(double now_ms) const {
+        if (!running || next_due_ms > now_ms) return 0;
+        double rate = profile.rate_hz * (inBurst(next_due_ms) ? profile.burst_factor : 1.0);
+        return 1 + static_cast<uint64_t>((now_ms - next_due_ms) * rate / 1000.0);
+    }
+
+    const LoadProfileWASM& getProfile() const { return profile; }
+    bool isRunning() const { return running; }
+    uint64_t getSent() const { return sent; }
+    uint64_t getBurstSent() const { return burst_sent; }
+    uint64_t getBytesSent() const { return bytes_sent; }
+    double getMeanLagMs() const { return lag_stats.getTotalMean(); }
+    double getP99LagMs() const { return lag_stats.getP99(); }
+    double getMaxLagMs() const { return max_lag_ms; }
+
+    // One-line JSON summary, for the JS edge and the native tool
+    std::string getReport(double now_ms) const {
+        char buffer[512];
+        snprintf(buffer, sizeof(buffer),
+                 "{\"sent\": %llu, \"bytes\": %llu, \"topics\": %d, \"target_rate\": %.1f, \"actual_rate\": %.1f, "
+                 "\"behind\": %llu, \"lag_mean_ms\": %.3f, \"lag_p99_ms\": %.3f, \"lag_max_ms\": %.3f, "
+                 "\"burst_sent\": %llu, \"running\": %s}",
+                 static_cast<unsigned long long>(sent), static_cast<unsigned long long>(bytes_sent), profile.topics,
+                 getTargetRate(), getActualRate(now_ms), static_cast<unsigned long long>(getBehind(now_ms)),
+                 getMeanLagMs(), getP99LagMs(), max_lag_ms, static_cast<unsigned long long>(burst_sent),
+                 running ? "true" : "false");
+        return std::string(buffer);
+    }
+};
+
+#endif // LOAD_GENERATOR_WASM_H
@@ -0,0 +1,327 @@
+/*
+ * Logging for WASM hot paths
+ *
+ * Under Emscripten every printf goes through stdout into console.log, which
+ * costs more than the publish or receive it describes. WASM_LOG_* instead:
+ * - Compile-time levels: statements below LOG_WASM_LEVEL (default INFO)
+ *   expand to nothing, arguments included. Per-message logs are DEBUG;
+ *   build with -DLOG_WASM_LEVEL=LOG_WASM_LEVEL_DEBUG to see them.
+ * - Records, not text: a statement stores its call site (format string and
+ *   level: the format ID) and its arguments, strings copied and truncated,
+ *   in a fixed ring. Formatting and printf happen at flush.
+ * - Deferred flush: under Emscripten the first record after a flush
+ *   schedules one with a zero-delay timeout, so output is written after the
+ *   current JS task; native builds flush from a background thread. WARN and
+ *   ERROR flush at once. A full ring drops records (counted), it never
+ *   blocks the caller. Lines go to stdout unless setSink() routes them.
+ * The format string is still checked against the arguments at compile time.
+ */
+
+#ifndef LOG_WASM_H
+#define LOG_WASM_H
+
+#include "platform_wasm.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef __EMSCRIPTEN__
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#define LOG_WASM_LEVEL_DEBUG 0
+#define LOG_WASM_LEVEL_INFO 1
+#define LOG_WASM_LEVEL_WARN 2
+#define LOG_WASM_LEVEL_ERROR 3
+#define LOG_WASM_LEVEL_OFF 4
+
+#ifndef LOG_WASM_LEVEL
+#define LOG_WASM_LEVEL LOG_WASM_LEVEL_INFO
+#endif
+
+#define LOG_WASM_RING_ENTRIES 512   // Power of two
+#define LOG_WASM_MAX_ARGS 8
+#define LOG_WASM_TEXT_BYTES 96      // String arguments of one record, NUL included
+#define LOG_WASM_LINE_BYTES 512
+#define LOG_WASM_FLUSH_PERIOD_MS 50 // Native background flush
+
+struct LogEntryWASM;
+typedef int (*LogFormatWASM)(const LogEntryWASM& entry, char* buffer, size_t capacity);
+typedef void (*LogSinkWASM)(int level, const char* line);
+
+// One per statement, static: its address is the record's format ID
+struct LogSiteWASM {
+    int level;
+    const char* format;
+};
+
+struct LogEntryWASM {
+    std::atomic<size_t> sequence;  // Ring slot state (bounded MPMC queue)
+    const LogSiteWASM* site;
+    LogFormatWASM format;
+    uint64_t args[LOG_WASM_MAX_ARGS];
+    char text[LOG_WASM_TEXT_BYTES];
+};
+
+struct LogStatsWASM {
+    uint64_t recorded;
+    uint64_t dropped;
+    uint64_t flushed;
+    uint64_t flushes;
+};
+
+// Scalars are stored bit for bit; strings are copied into the record's text
+template <typename T>
+struct LogArgWASM {
+    static_assert(std::is_arithmetic<T>::value || std::is_pointer<T>::value || std::is_enum<T>::value,
+                  "log arguments must be scalars or C strings");
+    static_assert(sizeof(T) <= sizeof(uint64_t), "log argument too large");
+
+    static void store(uint64_t& slot, char*, size_t&, T value) {
+        slot = 0;
+        memcpy(&slot, &value, sizeof(T));
+    }
+
+    static T load(const uint64_t& slot, const char*) {
+        T value;
+        memcpy(&value, &slot, sizeof(T));
+        return value;
+    }
+};
+
+template <>
+struct LogArgWASM<const char*> {
+    static void store(uint64_t& slot, char* text, size_t& used, const char* value) {
+        if (!value) value = "(null)";
+        size_t room = LOG_WASM_TEXT_BYTES - used;
+        size_t length = strnlen(value, room > 0 ? room - 1 : 0);
+        if (room == 0) {
+            slot = LOG_WASM_TEXT_BYTES - 1;  // Shared empty string
+            return;
+        }
+        memcpy(text + used, value, length);
+        text[used + length] = '\0';
+        slot = used;
+        used += length + 1;
+    }
+
+    static const char* load(const uint64_t& slot, const char* text) { return text + slot; }
+};
+
+template <>
+struct LogArgWASM<char*> : LogArgWASM<const char*> {};
+
+class LogWASM {
+private:
+    std::vector<LogEntryWASM> ring;
+    std::atomic<size_t> head;      // Next slot to record
+    size_t tail;                   // Next slot to flush (flushing thread only)
+    std::atomic<int> level;        // Runtime threshold, at or above LOG_WASM_LEVEL
+    std::atomic<bool> flushing;
+    std::atomic<bool> flush_scheduled;
+    std::atomic<LogSinkWASM> sink;
+    std::atomic<uint64_t> recorded;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> flushed;
+    std::atomic<uint64_t> flushes;
+#ifndef __EMSCRIPTEN__
+    std::mutex thread_mutex;
+    std::condition_variable thread_wake;
+    std::thread flush_thread;
+    bool stopping;
+#endif
+
+    LogWASM()
+        : ring(LOG_WASM_RING_ENTRIES), head(0), tail(0), level(LOG_WASM_LEVEL), flushing(false),
+          flush_scheduled(false), sink(&LogWASM::writeStdout), recorded(0), dropped(0), flushed(0), flushes(0) {
+        for (size_t i = 0; i < ring.size(); i++) ring[i].sequence.store(i, std::memory_order_relaxed);
+#ifndef __EMSCRIPTEN__
+        stopping = false;
+#endif
+    }
+
+    ~LogWASM() {
+#ifndef __EMSCRIPTEN__
+        if (flush_thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(thread_mutex);
+                stopping = true;
+            }
+            thread_wake.notify_one();
+            flush_thread.join();
+        }
+#endif
+        flushRing();
+    }
+
+    template <typename... A, size_t... I>
+    static int formatArgs(const LogEntryWASM& entry, char* buffer, size_t capacity, std::index_sequence<I...>) {
+        return snprintf(buffer, capacity, entry.site->format, LogArgWASM<A>::load(entry.args[I], entry.text)...);
+    }
+
+    template <typename... A>
+    static int formatEntry(const LogEntryWASM& entry, char* buffer, size_t capacity) {
+        if constexpr (sizeof...(A) == 0) {
+            return snprintf(buffer, capacity, "%s", entry.site->format);
+        } else {
+            return formatArgs<A...>(entry, buffer, capacity, std::index_sequence_for<A...>());
+        }
+    }
+
+    static void writeStdout(int, const char* line) { fputs(line, stdout); }
+
+    static void onFlushTimeout(void*) {
+        instance().flush_scheduled.store(false, std::memory_order_release);
+        instance().flushRing();
+    }
+
+    void scheduleFlush() {
+        if (flush_scheduled.exchange(true, std::memory_order_acq_rel)) return;
+#ifdef __EMSCRIPTEN__
+        emscripten_set_timeout(&LogWASM::onFlushTimeout, 0, nullptr);
+#else
+        std::lock_guard<std::mutex> lock(thread_mutex);
+        if (!flush_thread.joinable() && !stopping) {
+            flush_thread = std::thread([this] { flushLoop(); });
+        }
+#endif
+    }
+
+#ifndef __EMSCRIPTEN__
+    void flushLoop() {
+        std::unique_lock<std::mutex> lock(thread_mutex);
+        while (!stopping) {
+            thread_wake.wait_for(lock, std::chrono::milliseconds(LOG_WASM_FLUSH_PERIOD_MS));
+            lock.unlock();
+            flush_scheduled.store(false, std::memory_order_release);
+            flushRing();
+            lock.lock();
+        }
+    }
+#endif
+
+    // Single consumer: a flush already running elsewhere picks up new records
+    void flushRing() {
+        if (flushing.exchange(true, std::memory_order_acquire)) return;
+        char line[LOG_WASM_LINE_BYTES];
+        LogSinkWASM write = sink.load(std::memory_order_acquire);
+        uint64_t count = 0;
+        for (;;) {
+            LogEntryWASM& entry = ring[tail & (ring.size() - 1)];
+            if (entry.sequence.load(std::memory_order_acquire) != tail + 1) break;
+            entry.format(entry, line, sizeof(line));
+            write(entry.site->level, line);
+            entry.sequence.store(tail + ring.size(), std::memory_order_release);
+            tail++;
+            count++;
+        }
+        if (count > 0) {
+            fflush(stdout);
+            flushed.fetch_add(count, std::memory_order_relaxed);
+            flushes.fetch_add(1, std::memory_order_relaxed);
+        }
+        flushing.store(false, std::memory_order_release);
+    }
+
+public:
+    static LogWASM& instance() {
+        static LogWASM log;
+        return log;
+    }
+
+    static bool enabled(int statement_level) {
+        return statement_level >= instance().level.load(std::memory_order_relaxed);
+    }
+
+    // Raise or lower the threshold at run time; nothing below LOG_WASM_LEVEL
+    // was compiled in, so lower values only reach LOG_WASM_LEVEL
+    static void setLevel(int new_level) { instance().level.store(new_level, std::memory_order_relaxed); }
+    static int getLevel() { return instance().level.load(std::memory_order_relaxed); }
+
+    // Where flushed lines go (stdout by default); nullptr restores stdout
+    static void setSink(LogSinkWASM new_sink) {
+        instance().sink.store(new_sink ? new_sink : &LogWASM::writeStdout, std::memory_order_release);
+    }
+
+    template <typename... A>
+    static void record(const LogSiteWASM* site, const char*, A... args) {
+        static_assert(sizeof...(A) <= LOG_WASM_MAX_ARGS, "too many log arguments");
+        LogWASM& log = instance();
+        size_t position = log.head.load(std::memory_order_relaxed);
+        LogEntryWASM* entry;
+        for (;;) {
+            entry = &log.ring[position & (log.ring.size() - 1)];
+            size_t sequence = entry->sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (log.head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (sequence < position) {
+                log.dropped.fetch_add(1, std::memory_order_relaxed);  // Full
+                log.scheduleFlush();
+                return;
+            } else {
+                position = log.head.load(std::memory_order_relaxed);
+            }
+        }
+
+        entry->site = site;
+        entry->format = &LogWASM::formatEntry<A...>;
+        size_t used = 0;
+        size_t i = 0;
+        entry->text[LOG_WASM_TEXT_BYTES - 1] = '\0';
+        ((LogArgWASM<A>::store(entry->args[i++], entry->text, used, args)), ...);
+        (void)i;
+        (void)used;
+        entry->sequence.store(position + 1, std::memory_order_release);
+        log.recorded.fetch_add(1, std::memory_order_relaxed);
+
+        if (site->level >= LOG_WASM_LEVEL_WARN) {
+            log.flushRing();
+        } else {
+            log.scheduleFlush();
+        }
+    }
+
+    // Writes out everything recorded so far (also done at exit)
+    static void flush() { instance().flushRing(); }
+
+    static LogStatsWASM getStats() {
+        LogWASM& log = instance();
+        LogStatsWASM stats;
+        stats.recorded = log.recorded.load(std::memory_order_relaxed);
+        stats.dropped = log.dropped.load(std::memory_order_relaxed);
+        stats.flushed = log.flushed.load(std::memory_order_relaxed);
+        stats.flushes = log.flushes.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+// Keeps printf's format checking for WASM_LOG_* (never called)
+inline void logWASMCheckFormat(const char*, ...) __attribute__((format(printf, 1, 2)));
+inline void logWASMCheckFormat(const char*, ...) {}
+
+#define LOG_WASM_FORMAT(format, ...) format
+
+#define WASM_LOG_AT(statement_level, ...)                                                      \
+    do {                                                                                       \
+        if ((statement_level) >= LOG_WASM_LEVEL && LogWASM::enabled(statement_level)) {        \
+            static const LogSiteWASM log_wasm_site = {(statement_level),                      \
+                                                      LOG_WASM_FORMAT(__VA_ARGS__, 0)};        \
+            if (false) logWASMCheckFormat(__VA_ARGS__);                                        \
+            LogWASM::record(&log_wasm_site, __VA_ARGS__);                                      \
+        }                                                                                      \
+    } while (0)
+
+#define WASM_LOG_DEBUG(...) WASM_LOG_AT(LOG_WASM_LEVEL_DEBUG, __VA_ARGS__)
+#define WASM_LOG_INFO(...) WASM_LOG_AT(LOG_WASM_LEVEL_INFO, __VA_ARGS__)
+#define WASM_LOG_WARN(...) WASM_LOG_AT(LOG_WASM_LEVEL_WARN, __VA_ARGS__)
+#define WASM_LOG_ERROR(...) WASM_LOG_AT(LOG_WASM_LEVEL_ERROR, __VA_ARGS__)
+
+#endif // LOG_WASM_H
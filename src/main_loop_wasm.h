@@ -0,0 +1,212 @@
+/*
+ * Browser Main Loop Driver for WASM
+ *
+ * Runs a node's spin from the browser event loop instead of a JS setInterval.
+ * Two modes:
+ * - ANIMATION_FRAME: checked once per requestAnimationFrame; spins only when
+ *   data was signalled or a timer is due, otherwise the frame costs a few
+ *   comparisons.
+ * - EVENT_DRIVEN: nothing runs until notify() (a receive callback, e.g. the
+ *   websocket onmessage path) or the next timer deadline, via setTimeout.
+ * Each frame spins in slices until the work runs out or the frame budget is
+ * spent; leftover work carries over to the next frame so the UI thread keeps
+ * rendering under heavy topic load. Time spent per frame is recorded.
+ */
+
+#ifndef MAIN_LOOP_WASM_H
+#define MAIN_LOOP_WASM_H
+
+#include "platform_wasm.h"
+#ifdef __EMSCRIPTEN__
+#include <emscripten/html5.h>
+#include <emscripten/eventloop.h>
+#endif
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include <emscripten/threading.h>
+#endif
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+// Default per-frame budget, well inside a 60 Hz frame (16.7 ms)
+#ifndef MAIN_LOOP_WASM_DEFAULT_BUDGET_MS
+#define MAIN_LOOP_WASM_DEFAULT_BUDGET_MS 4.0
+#endif
+
+enum MainLoopModeWASM {
+    MAIN_LOOP_ANIMATION_FRAME = 0,
+    MAIN_LOOP_EVENT_DRIVEN = 1
+};
+
+// What the driver runs; all three run on the main thread
+struct MainLoopWorkWASM {
+    bool (*spin)(void* context);            // One slice of work; false once nothing was left to do
+    double (*next_due_ms)(void* context);   // Time until the next timer is due; < 0 when there is none
+    void* context;
+};
+
+struct MainLoopFrameStatsWASM {
+    uint64_t frames;           // Callbacks from the browser
+    uint64_t busy_frames;      // Frames that spun
+    uint64_t deferred_frames;  // Busy frames that hit the budget with work left
+    uint64_t slices;           // Spin calls
+    double last_frame_ms;      // Time spent in the last busy frame
+    double max_frame_ms;
+    double total_frame_ms;     // Sum over busy frames
+};
+
+class MainLoopDriverWASM {
+private:
+    MainLoopWorkWASM work;
+    MainLoopModeWASM mode;
+    double budget_ms;
+    bool running;
+    std::atomic<bool> notified;  // Data signalled since the last spin; set from any thread
+    long frame_request;     // Pending requestAnimationFrame id, 0 = none
+    int timeout_id;         // Pending setTimeout id, 0 = none
+    double timeout_due_ms;  // When the pending timeout fires
+    MainLoopFrameStatsWASM stats;
+
+#ifdef __EMSCRIPTEN__
+    static EM_BOOL onAnimationFrame(double time, void* user_data) {
+        MainLoopDriverWASM* self = static_cast<MainLoopDriverWASM*>(user_data);
+        self->frame_request = 0;
+        self->pump();
+        if (self->running && self->mode == MAIN_LOOP_ANIMATION_FRAME) {
+            self->frame_request = emscripten_request_animation_frame(onAnimationFrame, self);
+        }
+        return EM_FALSE;
+    }
+
+    static void onTimeout(void* user_data) {
+        MainLoopDriverWASM* self = static_cast<MainLoopDriverWASM*>(user_data);
+        self->timeout_id = 0;
+        self->pump();
+        self->arm();
+    }
+#endif
+
+    // Event-driven mode: one timeout for the earliest of "data pending" and the next timer
+    void arm() {
+#ifdef __EMSCRIPTEN__
+        if (!running || mode != MAIN_LOOP_EVENT_DRIVEN) return;
+        double delay = notified ? 0.0 : work.next_due_ms(work.context);
+        if (delay < 0) return;  // Idle until notify()
+        double due = emscripten_get_now() + delay;
+        if (timeout_id != 0) {
+            if (timeout_due_ms <= due) return;
+            emscripten_clear_timeout(timeout_id);
+        }
+        timeout_due_ms = due;
+        timeout_id = emscripten_set_timeout(onTimeout, delay, this);
+#endif
+    }
+
+    void disarm() {
+#ifdef __EMSCRIPTEN__
+        if (frame_request != 0) {
+            emscripten_cancel_animation_frame(frame_request);
+        }
+        if (timeout_id != 0) {
+            emscripten_clear_timeout(timeout_id);
+        }
+#endif
+        frame_request = 0;
+        timeout_id = 0;
+    }
+
+public:
+    explicit MainLoopDriverWASM(const MainLoopWorkWASM& work)
+        : work(work), mode(MAIN_LOOP_ANIMATION_FRAME), budget_ms(MAIN_LOOP_WASM_DEFAULT_BUDGET_MS),
+          running(false), notified(false), frame_request(0), timeout_id(0), timeout_due_ms(0) {
+        resetStats();
+    }
+
+    ~MainLoopDriverWASM() {
+        stop();
+    }
+
+    MainLoopDriverWASM(const MainLoopDriverWASM&) = delete;
+    MainLoopDriverWASM& operator=(const MainLoopDriverWASM&) = delete;
+
+    // Outside a browser nothing is scheduled; the host loop calls pump() itself
+    bool start(MainLoopModeWASM new_mode, double frame_budget_ms) {
+        stop();
+        mode = new_mode;
+        budget_ms = frame_budget_ms > 0 ? frame_budget_ms : MAIN_LOOP_WASM_DEFAULT_BUDGET_MS;
+        running = true;
+        notified = true;  // Drain whatever queued up before the driver started
+#ifdef __EMSCRIPTEN__
+        if (mode == MAIN_LOOP_ANIMATION_FRAME) {
+            frame_request = emscripten_request_animation_frame(onAnimationFrame, this);
+        } else {
+            arm();
+        }
+#endif
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        disarm();
+    }
+
+    // New data is waiting (receive callback); coalesces into one spin
+    void notify() {
+        notified = true;
+#ifdef __EMSCRIPTEN_PTHREADS__
+        // Callbacks on executor workers: the main thread re-arms after its frame
+        if (!emscripten_is_main_browser_thread()) return;
+#endif
+        arm();
+    }
+
+    // Plain callback form of notify(), e.g. for rcl_context_add_activity_listener
+    static void onActivity(void* driver) {
+        static_cast<MainLoopDriverWASM*>(driver)->notify();
+    }
+
+    // One frame: skip cheaply when idle, otherwise spin until done or over budget
+    void pump() {
+        stats.frames++;
+        if (!notified && work.next_due_ms(work.context) != 0) {
+            return;  // No data and no timer due
+        }
+        notified = false;
+
+        double start = emscripten_get_now();
+        double elapsed = 0;
+        bool more;
+        do {
+            more = work.spin(work.context);
+            stats.slices++;
+            elapsed = emscripten_get_now() - start;
+        } while (more && elapsed < budget_ms);
+
+        if (more) {
+            notified = true;  // Resume next frame
+            stats.deferred_frames++;
+        }
+        stats.busy_frames++;
+        stats.last_frame_ms = elapsed;
+        stats.total_frame_ms += elapsed;
+        if (elapsed > stats.max_frame_ms) {
+            stats.max_frame_ms = elapsed;
+        }
+    }
+
+    void resetStats() {
+        stats = MainLoopFrameStatsWASM();
+    }
+
+    bool isRunning() const { return running; }
+    MainLoopModeWASM getMode() const { return mode; }
+    double getBudgetMs() const { return budget_ms; }
+    const MainLoopFrameStatsWASM& getStats() const { return stats; }
+
+    double getMeanFrameMs() const {
+        return stats.busy_frames ? stats.total_frame_ms / stats.busy_frames : 0.0;
+    }
+};
+
+#endif // MAIN_LOOP_WASM_H
@@ -0,0 +1,184 @@
+/*
+ * Runtime Metrics for WASM
+ *
+ * Counters and gauges kept by the DDS entities themselves: participants,
+ * their network managers, sockets, publishers and subscribers.
+ * - Each value is an atomic on its own cache line. The I/O thread counts
+ *   received datagrams while the executor counts sends, and neither
+ *   invalidates the other's line. Updates are relaxed; a snapshot is exact
+ *   per value, not across values.
+ * - An entity holds a MetricGroupWASM<N> (its values and a static table of
+ *   names and kinds) and attaches it to its participant's registry while it
+ *   exists. The registry renders every attached group as JSON.
+ * Groups are attached, detached and rendered on the participant's thread;
+ * values may change from any thread.
+ */
+
+#ifndef METRICS_WASM_H
+#define METRICS_WASM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define METRICS_WASM_CACHE_LINE 64
+
+enum MetricKindWASM {
+    METRIC_COUNTER = 0,  // Only goes up
+    METRIC_GAUGE = 1     // Current level (queue depth, matched endpoints, a maximum)
+};
+
+struct MetricInfoWASM {
+    const char* name;
+    MetricKindWASM kind;
+};
+
+struct alignas(METRICS_WASM_CACHE_LINE) MetricWASM {
+    std::atomic<uint64_t> value;
+
+    MetricWASM() : value(0) {}
+
+    void add(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    void sub(uint64_t n = 1) { value.fetch_sub(n, std::memory_order_relaxed); }
+    void set(uint64_t v) { value.store(v, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+    // Gauge of a maximum: keeps the larger of the current value and v
+    void raise(uint64_t v) {
+        uint64_t current = value.load(std::memory_order_relaxed);
+        while (v > current && !value.compare_exchange_weak(current, v, std::memory_order_relaxed)) {}
+    }
+};
+
+static_assert(sizeof(MetricWASM) == METRICS_WASM_CACHE_LINE, "One metric per cache line");
+
+// What the registry reads of a group
+struct MetricSourceWASM {
+    const char* kind;  // "publisher", "udp_socket", ...
+    std::string name;  // Topic, endpoint or participant name
+    const MetricInfoWASM* info;
+    const MetricWASM* values;
+    size_t count;
+};
+
+// JSON string literal; names come from topics and user-chosen node names
+inline void metricsAppendJSONString(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+class MetricsRegistryWASM {
+private:
+    std::vector<const MetricSourceWASM*> sources;
+
+public:
+    void add(const MetricSourceWASM* source) {
+        sources.push_back(source);
+    }
+
+    void remove(const MetricSourceWASM* source) {
+        for (size_t i = 0; i < sources.size(); i++) {
+            if (sources[i] == source) {
+                sources.erase(sources.begin() + i);
+                return;
+            }
+        }
+    }
+
+    size_t getGroupCount() const { return sources.size(); }
+
+    // First group of a kind and name; nullptr if none is attached
+    const MetricSourceWASM* find(const char* kind, const std::string& name) const {
+        for (const MetricSourceWASM* source : sources) {
+            if (std::string(source->kind) == kind && source->name == name) return source;
+        }
+        return nullptr;
+    }
+
+    // Value of one metric of a group; 0 if there is no such group or metric
+    uint64_t get(const char* kind, const std::string& name, const char* metric) const {
+        const MetricSourceWASM* source = find(kind, name);
+        for (size_t i = 0; source && i < source->count; i++) {
+            if (std::string(source->info[i].name) == metric) return source->values[i].get();
+        }
+        return 0;
+    }
+
+    // [{"kind":"publisher","name":"/chatter","messages_published":12,...},...]
+    void appendJSON(std::string& out) const {
+        out += '[';
+        for (size_t s = 0; s < sources.size(); s++) {
+            const MetricSourceWASM* source = sources[s];
+            if (s > 0) out += ',';
+            out += "{\"kind\":";
+            metricsAppendJSONString(out, source->kind);
+            out += ",\"name\":";
+            metricsAppendJSONString(out, source->name);
+            for (size_t i = 0; i < source->count; i++) {
+                char field[96];
+                snprintf(field, sizeof(field), ",\"%s\":%llu", source->info[i].name,
+                         static_cast<unsigned long long>(source->values[i].get()));
+                out += field;
+            }
+            out += '}';
+        }
+        out += ']';
+    }
+};
+
+// An entity's values, indexed by its metric enum; detaches itself on destruction
+template <size_t N>
+class MetricGroupWASM {
+private:
+    MetricWASM values[N];
+    MetricSourceWASM source;
+    MetricsRegistryWASM* registry;
+
+public:
+    explicit MetricGroupWASM(const MetricInfoWASM (&info)[N]) : registry(nullptr) {
+        source.kind = "";
+        source.info = info;
+        source.values = values;
+        source.count = N;
+    }
+
+    ~MetricGroupWASM() {
+        detach();
+    }
+
+    MetricGroupWASM(const MetricGroupWASM&) = delete;
+    MetricGroupWASM& operator=(const MetricGroupWASM&) = delete;
+
+    void attach(MetricsRegistryWASM* target, const char* kind, const std::string& name) {
+        detach();
+        source.kind = kind;
+        source.name = name;
+        registry = target;
+        if (registry) registry->add(&source);
+    }
+
+    void detach() {
+        if (registry) registry->remove(&source);
+        registry = nullptr;
+    }
+
+    MetricWASM& operator[](size_t index) { return values[index]; }
+    const MetricWASM& operator[](size_t index) const { return values[index]; }
+};
+
+#endif // METRICS_WASM_H
@@ -5,8 +5,9 @@
  * Uses minimal ROS2 DDS implementation for WASM.
  */
 
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
+#include "log_wasm.h"
 #include <string>
 #include <cstdio>
 #include <vector>
@@ -58,13 +59,13 @@ public:
     // Publish message via ROS2 DDS - ALL IN WASM
     bool publish(const std::string& data) {
         if (!initialized) {
-            printf("WASM: ROS node not initialized\n");
+            WASM_LOG_WARN("WASM: ROS node not initialized\n");
             return false;
         }
         
         message_count++;
-        printf("WASM: Publishing message #%d to topic '%s' via ROS2 DDS (in WASM)\n", 
-               message_count, topic_name.c_str());
+        WASM_LOG_DEBUG("WASM: Publishing message #%d to topic '%s' via ROS2 DDS (in WASM)\n", 
+                       message_count, topic_name.c_str());
         
         // TODO: Publish via microROS DDS in WASM
         // std_msgs__msg__String msg;
@@ -74,7 +75,7 @@ public:
         
         // For now, simulate DDS publish
         // In real implementation, this would use ROS2 DDS transport in WASM
-        printf("WASM: Message published via ROS2 DDS: %s\n", data.c_str());
+        WASM_LOG_DEBUG("WASM: Message published via ROS2 DDS: %s\n", data.c_str());
         
         return true;
     }
@@ -91,7 +92,7 @@ private:
     std::string topic_name;
     bool initialized;
     int messages_received;
-    std::vector<std::string> received_messages;
+    std::string last_message;
     std::function<void(const std::string&)> callback;
     
 public:
@@ -125,19 +126,16 @@ public:
     // Process incoming message - ALL IN WASM
     void processMessage(const std::string& data) {
         if (!initialized) {
-            printf("WASM: ROS node not initialized\n");
+            WASM_LOG_WARN("WASM: ROS node not initialized\n");
             return;
         }
         
         messages_received++;
-        received_messages.push_back(data);
-        if (received_messages.size() > 10) {
-            received_messages.erase(received_messages.begin());
-        }
+        last_message = data;
         
-        printf("WASM: Message received #%d on topic '%s' via ROS2 DDS (in WASM)\n", 
-               messages_received, topic_name.c_str());
-        printf("WASM: Processing message in WASM: %s\n", data.c_str());
+        WASM_LOG_DEBUG("WASM: Message received #%d on topic '%s' via ROS2 DDS (in WASM)\n", 
+                       messages_received, topic_name.c_str());
+        WASM_LOG_DEBUG("WASM: Processing message in WASM: %s\n", data.c_str());
         
         // Call callback if set
         if (callback) {
@@ -165,8 +163,10 @@ public:
     int getMessagesReceived() const { return messages_received; }
     bool isInitialized() const { return initialized; }
     std::string getTopicName() const { return topic_name; }
-    std::string getLastMessage() const { 
-        return received_messages.empty() ? "" : received_messages.back();
+    std::string getLastMessage() const { return last_message; }
+    // Same bytes without a copy; valid until the next call into the module
+    val getLastMessageView() const {
+        return val(typed_memory_view(last_message.size(), reinterpret_cast<const uint8_t*>(last_message.data())));
     }
 };
 
@@ -187,6 +187,7 @@ EMSCRIPTEN_BINDINGS(microros_wasm) {
         .function("getMessagesReceived", &ROSSubscriberWASM::getMessagesReceived)
         .function("isInitialized", &ROSSubscriberWASM::isInitialized)
         .function("getTopicName", &ROSSubscriberWASM::getTopicName)
-        .function("getLastMessage", &ROSSubscriberWASM::getLastMessage);
+        .function("getLastMessage", &ROSSubscriberWASM::getLastMessage)
+        .function("getLastMessageView", &ROSSubscriberWASM::getLastMessageView);
 }
 
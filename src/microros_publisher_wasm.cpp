@@ -13,15 +13,25 @@
 
 // For now, use our ported rcl/rclc
 #include "rcl_types_wasm.h"
+#include "rosidl_typesupport_wasm.h"
+#include "rcl_allocator_wasm.h"
 #include "rcl_port_wasm.cpp"
 #include "rclc_port_wasm.cpp"
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
 #include <string>
 #include <cstdio>
 
 using namespace emscripten;
 
+class MicroROSPublisherNodeWASM;
+
+// rcl timer callbacks only get the timer; the owning node is stored next to it
+struct PublishTimerWASM {
+    rcl_timer_t timer;  // First member: rcl_timer_t* converts back to PublishTimerWASM*
+    MicroROSPublisherNodeWASM* owner;
+};
+
 // microROS Publisher Node using official API
 class MicroROSPublisherNodeWASM {
 private:
@@ -29,23 +39,82 @@ private:
     rcl_node_t node;
     rcl_publisher_t publisher;
     rclc_support_t support;
+    rcl_allocator_t allocator;
+    PublishTimerWASM publish_timer;
+    rclc_executor_t executor;
     
     std::string node_name;
     std::string topic_name;
     bool initialized;
+    bool timer_running;
     int message_count;
     double sensor_value;
+    wasm_msgs__msg__SensorReading reading;  // Last reading, as sent on the wire
+    MainLoopDriverWASM main_loop;
+    
+    static void timerCallback(rcl_timer_t* timer, int64_t last_call_time) {
+        reinterpret_cast<PublishTimerWASM*>(timer)->owner->publishMessage();
+    }
+    
+    // Main loop hooks: only the publish timer creates work
+    static bool mainLoopSpin(void* context) {
+        MicroROSPublisherNodeWASM* self = static_cast<MicroROSPublisherNodeWASM*>(context);
+        return self->timer_running && rclc_executor_spin_some(&self->executor, 0) == RCL_RET_OK;
+    }
+    
+    static double mainLoopNextDueMs(void* context) {
+        MicroROSPublisherNodeWASM* self = static_cast<MicroROSPublisherNodeWASM*>(context);
+        return self->timer_running ? rclc_executor_main_loop_next_due_ms(&self->executor) : -1.0;
+    }
+    
+    static MainLoopWorkWASM mainLoopWork(MicroROSPublisherNodeWASM* self) {
+        MainLoopWorkWASM work;
+        work.spin = mainLoopSpin;
+        work.next_due_ms = mainLoopNextDueMs;
+        work.context = self;
+        return work;
+    }
+    
+    // Sensor simulation (business logic)
+    void nextReading() {
+        message_count++;
+        sensor_value = 20.0 + (message_count % 10);
+        
+        double now_ms = emscripten_get_now();
+        reading.stamp.sec = static_cast<int32_t>(now_ms / 1000.0);
+        reading.stamp.nanosec = static_cast<uint32_t>((now_ms - reading.stamp.sec * 1000.0) * 1000000.0);
+        reading.id = static_cast<uint32_t>(message_count);
+        reading.sensor = WASM_MSGS__MSG__SENSOR_READING__SENSOR_TEMPERATURE;
+        reading.unit = WASM_MSGS__MSG__SENSOR_READING__UNIT_CELSIUS;
+        reading.value = static_cast<float>(sensor_value);
+    }
+    
+    rcl_timer_statistics_t getTimerStatistics() const {
+        rcl_timer_statistics_t stats = {0, 0, 0, 0.0};
+        if (timer_running) {
+            rcl_timer_get_statistics(&publish_timer.timer, &stats);
+        }
+        return stats;
+    }
     
 public:
     MicroROSPublisherNodeWASM(const std::string& name, const std::string& topic)
-        : node_name(name), topic_name(topic), initialized(false), 
-          message_count(0), sensor_value(0.0) {}
+        : node_name(name), topic_name(topic), initialized(false), timer_running(false),
+          message_count(0), sensor_value(0.0), main_loop(mainLoopWork(this)) {
+        memset(&reading, 0, sizeof(reading));
+    }
+    
+    ~MicroROSPublisherNodeWASM() {
+        main_loop.stop();
+        stopTimer();
+    }
     
     bool init() {
         printf("WASM: Initializing microROS publisher node '%s'\n", node_name.c_str());
         
         // Initialize rclc support (this also initializes rcl)
-        rcl_ret_t ret = rclc_support_init(&support, 0, NULL, NULL);
+        allocator = rcl_get_default_allocator();
+        rcl_ret_t ret = rclc_support_init(&support, 0, NULL, &allocator);
         if (ret != RCL_RET_OK) {
             printf("WASM: Failed to initialize rclc support\n");
             return false;
@@ -58,9 +127,10 @@ public:
             return false;
         }
         
-        // Create publisher using microROS API
-        // TODO: Use actual std_msgs type support when available
-        ret = rclc_publisher_init_default(&publisher, &node, NULL, topic_name.c_str());
+        // Create publisher using microROS API (fixed-size binary readings)
+        ret = rclc_publisher_init_default(&publisher, &node,
+                                          ROSIDL_GET_MSG_TYPE_SUPPORT(wasm_msgs, msg, SensorReading),
+                                          topic_name.c_str());
         if (ret != RCL_RET_OK) {
             printf("WASM: Failed to create microROS publisher\n");
             return false;
@@ -71,44 +141,119 @@ public:
         return true;
     }
     
+    // Next reading rendered as JSON, for JS callers that forward it themselves
     std::string generateSensorData() {
-        message_count++;
-        sensor_value = 20.0 + (message_count % 10);
-        
+        nextReading();
+        return getReadingJson();
+    }
+    
+    // JSON view of the last reading (dashboard edge; never on the wire)
+    std::string getReadingJson() const {
         char buffer[256];
-        snprintf(buffer, sizeof(buffer),
-                 "{\"id\": %d, \"sensor\": \"temperature\", \"value\": %.2f, \"unit\": \"celsius\"}",
-                 message_count, sensor_value);
-        
+        wasm_msgs__msg__SensorReading__to_json(&reading, buffer, sizeof(buffer));
         return std::string(buffer);
     }
     
+    // The last reading as sent (the 20-byte record) without copying it;
+    // valid until the next call into the module
+    val getReadingView() const {
+        return val(typed_memory_view(sizeof(reading), reinterpret_cast<const uint8_t*>(&reading)));
+    }
+    
     bool publishMessage() {
         if (!initialized) {
-            printf("WASM: Node not initialized\n");
+            WASM_LOG_WARN("WASM: Node not initialized\n");
             return false;
         }
         
-        std::string data = generateSensorData();
-        
-        printf("WASM: Publishing via microROS API: %s\n", data.c_str());
+        nextReading();
         
-        // TODO: Create std_msgs message and publish
-        // std_msgs__msg__String msg;
-        // msg.data.data = (char*)data.c_str();
-        // msg.data.size = data.length();
-        // rcl_ret_t ret = rcl_publish(&publisher, &msg, NULL);
+        WASM_LOG_DEBUG("WASM: Publishing reading #%u via microROS API: %.2f\n", reading.id, reading.value);
         
-        // For now, simulate
-        rcl_ret_t ret = rcl_publish(&publisher, data.c_str(), NULL);
+        rcl_ret_t ret = rcl_publish(&publisher, &reading, NULL);
         
         if (ret == RCL_RET_OK) {
-            printf("WASM: Message published successfully via microROS\n");
+            WASM_LOG_DEBUG("WASM: Message published successfully via microROS\n");
             return true;
         } else {
-            printf("WASM: Failed to publish message\n");
+            WASM_LOG_WARN("WASM: Failed to publish message\n");
+            return false;
+        }
+    }
+    
+    // Publish from an rcl timer inside WASM instead of a JS setInterval.
+    // spinOnce() must be called at least as often as the period.
+    bool startTimer(double period_ms) {
+        if (!initialized || period_ms <= 0) {
+            return false;
+        }
+        stopTimer();
+        publish_timer.owner = this;
+        if (rclc_timer_init_default(&publish_timer.timer, &support, static_cast<uint64_t>(period_ms * 1000000.0),
+                                    timerCallback) != RCL_RET_OK) {
+            printf("WASM: Failed to create publish timer\n");
             return false;
         }
+        if (rclc_executor_init(&executor, support.context, 1, &allocator) != RCL_RET_OK ||
+            rclc_executor_add_timer(&executor, &publish_timer.timer) != RCL_RET_OK) {
+            printf("WASM: Failed to set up timer executor\n");
+            rcl_timer_fini(&publish_timer.timer);
+            return false;
+        }
+        timer_running = true;
+        main_loop.notify();  // Re-arm an event-driven main loop for the new deadline
+        printf("WASM: Publishing every %.3f ms from WASM timer\n", period_ms);
+        return true;
+    }
+    
+    void stopTimer() {
+        if (!timer_running) return;
+        rclc_executor_fini(&executor);
+        rcl_timer_fini(&publish_timer.timer);
+        timer_running = false;
+    }
+    
+    // Runs the publish timer if it is due
+    void spinOnce() {
+        if (timer_running) {
+            rclc_executor_spin_some(&executor, 0);
+        }
+    }
+    
+    // Run the publish timer from the browser instead of calling spinOnce() from JS:
+    // mode 0 checks every requestAnimationFrame, mode 1 sleeps until the timer is due
+    bool startMainLoop(int mode, double frame_budget_ms) {
+        if (!initialized) return false;
+        return main_loop.start(mode == MAIN_LOOP_EVENT_DRIVEN ? MAIN_LOOP_EVENT_DRIVEN : MAIN_LOOP_ANIMATION_FRAME,
+                               frame_budget_ms);
+    }
+    
+    void stopMainLoop() {
+        main_loop.stop();
+    }
+    
+    // Time spent per main loop frame
+    double getFrameCount() const { return static_cast<double>(main_loop.getStats().frames); }
+    double getBusyFrames() const { return static_cast<double>(main_loop.getStats().busy_frames); }
+    double getDeferredFrames() const { return static_cast<double>(main_loop.getStats().deferred_frames); }
+    double getLastFrameMs() const { return main_loop.getStats().last_frame_ms; }
+    double getMaxFrameMs() const { return main_loop.getStats().max_frame_ms; }
+    double getMeanFrameMs() const { return main_loop.getMeanFrameMs(); }
+    
+    // Timer accuracy since startTimer()
+    int getTimerCalls() const { return static_cast<int>(getTimerStatistics().calls); }
+    int getMissedPeriods() const { return static_cast<int>(getTimerStatistics().missed_periods); }
+    double getMaxJitterMs() const { return getTimerStatistics().max_lateness_ns / 1000000.0; }
+    double getMeanJitterMs() const { return getTimerStatistics().mean_lateness_ns / 1000000.0; }
+    
+    // Subscribers currently matched on the topic (graph cache, no network round trip).
+    // Lets callers skip generating data nobody will receive.
+    int getSubscriberCount() const {
+        size_t count = 0;
+        if (!initialized || rcl_count_subscribers(&node, topic_name.c_str(), &count) != RCL_RET_OK) {
+            return 0;
+        }
+        return static_cast<int>(count);
     }
     
     int getMessageCount() const { return message_count; }
@@ -123,7 +268,25 @@ EMSCRIPTEN_BINDINGS(microros_publisher_wasm) {
         .constructor<const std::string&, const std::string&>()
         .function("init", &MicroROSPublisherNodeWASM::init)
         .function("generateSensorData", &MicroROSPublisherNodeWASM::generateSensorData)
+        .function("getReadingJson", &MicroROSPublisherNodeWASM::getReadingJson)
+        .function("getReadingView", &MicroROSPublisherNodeWASM::getReadingView)
         .function("publishMessage", &MicroROSPublisherNodeWASM::publishMessage)
+        .function("startTimer", &MicroROSPublisherNodeWASM::startTimer)
+        .function("stopTimer", &MicroROSPublisherNodeWASM::stopTimer)
+        .function("spinOnce", &MicroROSPublisherNodeWASM::spinOnce)
+        .function("startMainLoop", &MicroROSPublisherNodeWASM::startMainLoop)
+        .function("stopMainLoop", &MicroROSPublisherNodeWASM::stopMainLoop)
+        .function("getFrameCount", &MicroROSPublisherNodeWASM::getFrameCount)
+        .function("getBusyFrames", &MicroROSPublisherNodeWASM::getBusyFrames)
+        .function("getDeferredFrames", &MicroROSPublisherNodeWASM::getDeferredFrames)
+        .function("getLastFrameMs", &MicroROSPublisherNodeWASM::getLastFrameMs)
+        .function("getMaxFrameMs", &MicroROSPublisherNodeWASM::getMaxFrameMs)
+        .function("getMeanFrameMs", &MicroROSPublisherNodeWASM::getMeanFrameMs)
+        .function("getTimerCalls", &MicroROSPublisherNodeWASM::getTimerCalls)
+        .function("getMissedPeriods", &MicroROSPublisherNodeWASM::getMissedPeriods)
+        .function("getMaxJitterMs", &MicroROSPublisherNodeWASM::getMaxJitterMs)
+        .function("getMeanJitterMs", &MicroROSPublisherNodeWASM::getMeanJitterMs)
+        .function("getSubscriberCount", &MicroROSPublisherNodeWASM::getSubscriberCount)
         .function("getMessageCount", &MicroROSPublisherNodeWASM::getMessageCount)
         .function("getSensorValue", &MicroROSPublisherNodeWASM::getSensorValue)
         .function("isInitialized", &MicroROSPublisherNodeWASM::isInitialized)
@@ -13,10 +13,15 @@
 
 // For now, use our ported rcl/rclc
 #include "rcl_types_wasm.h"
+#include "rosidl_typesupport_wasm.h"
+#include "rcl_allocator_wasm.h"
 #include "rcl_port_wasm.cpp"
 #include "rclc_port_wasm.cpp"
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "stream_stats_wasm.h"
+#include "receive_history_wasm.h"
+#include "json_extract_wasm.h"
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
 #include <string>
 #include <cstdio>
 #include <vector>
@@ -30,34 +35,57 @@ private:
     rcl_node_t node;
     rcl_subscription_t subscription;
     rclc_support_t support;
+    rcl_allocator_t allocator;
     rclc_executor_t executor;
+    wasm_msgs__msg__SensorReading msg;  // Taken in place by the executor
     
     std::string node_name;
     std::string topic_name;
     bool initialized;
     int messages_received;
-    std::vector<double> received_values;
+    StreamStatsWASM value_stats;
+    ReceiveHistoryWASM history;
+    JsonExtractorWASM value_field;
     double last_value;
     std::string last_message;
+    bool last_was_reading;  // getLastMessage() renders msg
+    MainLoopDriverWASM main_loop;
     
-    // Message callback
-    static void messageCallback(const void* msg) {
-        // TODO: Cast to std_msgs__msg__String and process
-        // const std_msgs__msg__String* string_msg = (const std_msgs__msg__String*)msg;
-        // Process message...
-        printf("WASM: Message received via microROS callback\n");
+    // Message callback (context is the node that registered it)
+    static void messageCallback(const void* msg, void* context) {
+        const wasm_msgs__msg__SensorReading* reading = static_cast<const wasm_msgs__msg__SensorReading*>(msg);
+        MicroROSSubscriberNodeWASM* self = static_cast<MicroROSSubscriberNodeWASM*>(context);
+        if (!reading || !self) return;
+        
+        WASM_LOG_DEBUG("WASM: Reading #%u received via microROS callback\n", reading->id);
+        self->messages_received++;
+        self->last_was_reading = true;
+        self->last_value = reading->value;
+        self->value_stats.add(self->last_value);
+        self->history.add(self->last_value, emscripten_get_now());
+        WASM_LOG_DEBUG("WASM: Message processed via microROS: value=%.2f\n", self->last_value);
     }
     
 public:
     MicroROSSubscriberNodeWASM(const std::string& name, const std::string& topic)
-        : node_name(name), topic_name(topic), initialized(false), 
-          messages_received(0), last_value(0.0) {}
+        : node_name(name), topic_name(topic), initialized(false), messages_received(0), value_field({"value"}),
+          last_value(0.0), last_was_reading(false), main_loop(rclc_executor_main_loop_work(&executor)) {
+        memset(&msg, 0, sizeof(msg));
+    }
+    
+    ~MicroROSSubscriberNodeWASM() {
+        if (initialized) {
+            stopMainLoop();
+            rclc_executor_fini(&executor);
+        }
+    }
     
     bool init() {
         printf("WASM: Initializing microROS subscriber node '%s'\n", node_name.c_str());
         
         // Initialize rclc support (this also initializes rcl)
-        rcl_ret_t ret = rclc_support_init(&support, 0, NULL, NULL);
+        allocator = rcl_get_default_allocator();
+        rcl_ret_t ret = rclc_support_init(&support, 0, NULL, &allocator);
         if (ret != RCL_RET_OK) {
             printf("WASM: Failed to initialize rclc support\n");
             return false;
@@ -70,26 +98,25 @@ public:
             return false;
         }
         
-        // Create subscriber using microROS API
-        // TODO: Use actual std_msgs type support when available
-        ret = rclc_subscription_init_default(&subscription, &node, NULL, topic_name.c_str());
+        // Create subscriber using microROS API (fixed-size binary readings)
+        ret = rclc_subscription_init_default(&subscription, &node,
+                                             ROSIDL_GET_MSG_TYPE_SUPPORT(wasm_msgs, msg, SensorReading),
+                                             topic_name.c_str());
         if (ret != RCL_RET_OK) {
             printf("WASM: Failed to create microROS subscriber\n");
             return false;
         }
         
         // Initialize executor
-        ret = rclc_executor_init(&executor, support.context, 1, NULL);
+        ret = rclc_executor_init(&executor, support.context, 1, &allocator);
         if (ret != RCL_RET_OK) {
             printf("WASM: Failed to initialize executor\n");
             return false;
         }
         
         // Add subscription to executor
-        // TODO: Use actual message type when available
-        ret = rclc_executor_add_subscription(&executor, &subscription, NULL, 
-                                             messageCallback, 
-                                             RCLC_EXECUTOR_HANDLE_TYPE_SUBSCRIPTION);
+        ret = rclc_executor_add_subscription_with_context(&executor, &subscription, &msg,
+                                                          messageCallback, this, ON_NEW_DATA);
         if (ret != RCL_RET_OK) {
             printf("WASM: Failed to add subscription to executor\n");
             return false;
@@ -106,39 +133,101 @@ public:
         // Spin executor - this processes incoming messages
         rcl_ret_t ret = rclc_executor_spin_some(&executor, 100000000); // 100ms timeout
         if (ret != RCL_RET_OK && ret != RCL_RET_TIMEOUT) {
-            printf("WASM: Error in executor spin\n");
+            WASM_LOG_WARN("WASM: Error in executor spin\n");
+        }
+        value_stats.expire(emscripten_get_now());
+    }
+    
+    // Spin from the browser instead of a JS setInterval: mode 0 checks every
+    // requestAnimationFrame, mode 1 wakes only when a message is queued.
+    // Each frame spends at most frame_budget_ms in callbacks.
+    bool startMainLoop(int mode, double frame_budget_ms) {
+        if (!initialized) return false;
+        if (!main_loop.isRunning() &&
+            rcl_context_add_activity_listener(support.context, &MainLoopDriverWASM::onActivity,
+                                              &main_loop) != RCL_RET_OK) {
+            printf("WASM: Failed to attach main loop\n");
+            return false;
         }
+        return main_loop.start(mode == MAIN_LOOP_EVENT_DRIVEN ? MAIN_LOOP_EVENT_DRIVEN : MAIN_LOOP_ANIMATION_FRAME,
+                               frame_budget_ms);
     }
     
+    void stopMainLoop() {
+        if (!main_loop.isRunning()) return;
+        rcl_context_remove_activity_listener(support.context, &MainLoopDriverWASM::onActivity, &main_loop);
+        main_loop.stop();
+    }
+    
+    // Time spent per main loop frame
+    double getFrameCount() const { return static_cast<double>(main_loop.getStats().frames); }
+    double getBusyFrames() const { return static_cast<double>(main_loop.getStats().busy_frames); }
+    double getDeferredFrames() const { return static_cast<double>(main_loop.getStats().deferred_frames); }
+    double getLastFrameMs() const { return main_loop.getStats().last_frame_ms; }
+    double getMaxFrameMs() const { return main_loop.getStats().max_frame_ms; }
+    double getMeanFrameMs() const { return main_loop.getMeanFrameMs(); }
+    
+    // JSON payload handed in from JS (the binary path is messageCallback)
     void processMessage(const std::string& data) {
         messages_received++;
         last_message = data;
+        last_was_reading = false;
         
-        // Parse JSON to extract value
-        size_t pos = data.find("\"value\":");
-        if (pos != std::string::npos) {
-            sscanf(data.c_str() + pos + 8, "%lf", &last_value);
-            received_values.push_back(last_value);
-            
-            if (received_values.size() > 10) {
-                received_values.erase(received_values.begin());
-            }
+        // Extract the value field (compact or spaced JSON)
+        JsonFieldWASM value;
+        if (value_field.extract(data.data(), data.size(), &value) && value.type == JSON_FIELD_NUMBER) {
+            last_value = value.number;
+            value_stats.add(last_value);
+            history.add(last_value, emscripten_get_now());
+        } else {
+            history.touch();
         }
         
-        printf("WASM: Message processed via microROS: value=%.2f\n", last_value);
+        WASM_LOG_DEBUG("WASM: Message processed via microROS: value=%.2f\n", last_value);
     }
     
     int getMessagesReceived() const { return messages_received; }
     double getLastValue() const { return last_value; }
-    std::string getLastMessage() const { return last_message; }
+    // JSON only here, at the JS edge
+    std::string getLastMessage() const {
+        if (!last_was_reading) return last_message;
+        char buffer[256];
+        wasm_msgs__msg__SensorReading__to_json(&msg, buffer, sizeof(buffer));
+        return std::string(buffer);
+    }
+    
+    // Received values: window of the last N (and optionally last window_ms),
+    // percentiles since the window was set; all O(1)
+    double getAverageValue() const { return value_stats.getMean(); }
+    double getMinValue() const { return value_stats.getMin(); }
+    double getMaxValue() const { return value_stats.getMax(); }
+    double getStdDevValue() const { return value_stats.getStdDev(); }
+    double getMedianValue() const { return value_stats.getMedian(); }
+    double getP95Value() const { return value_stats.getP95(); }
+    double getP99Value() const { return value_stats.getP99(); }
+    double getWindowCount() const { return static_cast<double>(value_stats.size()); }
     
-    double getAverageValue() const {
-        if (received_values.empty()) return 0.0;
-        double sum = 0.0;
-        for (double val : received_values) {
-            sum += val;
+    void setValueWindow(int count, double window_ms) {
+        value_stats.configure(count > 0 ? static_cast<size_t>(count) : STREAM_STATS_WASM_DEFAULT_WINDOW, window_ms);
+    }
+    
+    // Zero-copy reads for dashboards (receive_history_wasm.h): views into
+    // WASM memory, valid until the next call into the module
+    val getValueHistory() const { return val(typed_memory_view(history.size(), history.getValues())); }
+    val getTimeHistory() const { return val(typed_memory_view(history.size(), history.getTimes())); }
+    // Last message as received: the 20-byte SensorReading record (read it
+    // with a DataView) or, when isLastMessageReading() is false, JSON text
+    val getLastMessageView() const {
+        if (last_was_reading) {
+            return val(typed_memory_view(sizeof(msg), reinterpret_cast<const uint8_t*>(&msg)));
         }
-        return sum / received_values.size();
+        return val(typed_memory_view(last_message.size(), reinterpret_cast<const uint8_t*>(last_message.data())));
+    }
+    bool isLastMessageReading() const { return last_was_reading; }
+    double getChangeSequence() const { return static_cast<double>(history.getSequence()); }
+    
+    void setHistoryCapacity(int samples) {
+        history.configure(samples > 0 ? static_cast<size_t>(samples) : RECEIVE_HISTORY_WASM_DEFAULT_CAPACITY);
     }
     
     bool isInitialized() const { return initialized; }
@@ -151,11 +240,33 @@ EMSCRIPTEN_BINDINGS(microros_subscriber_wasm) {
         .constructor<const std::string&, const std::string&>()
         .function("init", &MicroROSSubscriberNodeWASM::init)
         .function("spinOnce", &MicroROSSubscriberNodeWASM::spinOnce)
+        .function("startMainLoop", &MicroROSSubscriberNodeWASM::startMainLoop)
+        .function("stopMainLoop", &MicroROSSubscriberNodeWASM::stopMainLoop)
+        .function("getFrameCount", &MicroROSSubscriberNodeWASM::getFrameCount)
+        .function("getBusyFrames", &MicroROSSubscriberNodeWASM::getBusyFrames)
+        .function("getDeferredFrames", &MicroROSSubscriberNodeWASM::getDeferredFrames)
+        .function("getLastFrameMs", &MicroROSSubscriberNodeWASM::getLastFrameMs)
+        .function("getMaxFrameMs", &MicroROSSubscriberNodeWASM::getMaxFrameMs)
+        .function("getMeanFrameMs", &MicroROSSubscriberNodeWASM::getMeanFrameMs)
         .function("processMessage", &MicroROSSubscriberNodeWASM::processMessage)
         .function("getMessagesReceived", &MicroROSSubscriberNodeWASM::getMessagesReceived)
         .function("getLastValue", &MicroROSSubscriberNodeWASM::getLastValue)
         .function("getLastMessage", &MicroROSSubscriberNodeWASM::getLastMessage)
         .function("getAverageValue", &MicroROSSubscriberNodeWASM::getAverageValue)
+        .function("getMinValue", &MicroROSSubscriberNodeWASM::getMinValue)
+        .function("getMaxValue", &MicroROSSubscriberNodeWASM::getMaxValue)
+        .function("getStdDevValue", &MicroROSSubscriberNodeWASM::getStdDevValue)
+        .function("getMedianValue", &MicroROSSubscriberNodeWASM::getMedianValue)
+        .function("getP95Value", &MicroROSSubscriberNodeWASM::getP95Value)
+        .function("getP99Value", &MicroROSSubscriberNodeWASM::getP99Value)
+        .function("getWindowCount", &MicroROSSubscriberNodeWASM::getWindowCount)
+        .function("setValueWindow", &MicroROSSubscriberNodeWASM::setValueWindow)
+        .function("getValueHistory", &MicroROSSubscriberNodeWASM::getValueHistory)
+        .function("getTimeHistory", &MicroROSSubscriberNodeWASM::getTimeHistory)
+        .function("getLastMessageView", &MicroROSSubscriberNodeWASM::getLastMessageView)
+        .function("getChangeSequence", &MicroROSSubscriberNodeWASM::getChangeSequence)
+        .function("setHistoryCapacity", &MicroROSSubscriberNodeWASM::setHistoryCapacity)
+        .function("isLastMessageReading", &MicroROSSubscriberNodeWASM::isLastMessageReading)
         .function("isInitialized", &MicroROSSubscriberNodeWASM::isInitialized)
         .function("getNodeName", &MicroROSSubscriberNodeWASM::getNodeName)
         .function("getTopicName", &MicroROSSubscriberNodeWASM::getTopicName);
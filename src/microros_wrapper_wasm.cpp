@@ -5,10 +5,11 @@
  * It bridges microROS API with our DDS layer.
  */
 
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
 #include <string>
 #include <cstdio>
+#include <functional>
 
 // TODO: Include microROS headers when ported
 // #include <rcl/rcl.h>
@@ -0,0 +1,12 @@
+/*
+ * Native Linux entry point of the ROS publisher node
+ *
+ * The node and its command line live in ros_publisher_wasm.cpp, built into
+ * the wasm_ros_publisher static library.
+ */
+
+int rosPublisherNodeMain(int argc, char** argv);
+
+int main(int argc, char** argv) {
+    return rosPublisherNodeMain(argc, argv);
+}
@@ -0,0 +1,12 @@
+/*
+ * Native Linux entry point of the ROS subscriber node
+ *
+ * The node and its command line live in ros_subscriber_wasm.cpp, built into
+ * the wasm_ros_subscriber static library.
+ */
+
+int rosSubscriberNodeMain(int argc, char** argv);
+
+int main(int argc, char** argv) {
+    return rosSubscriberNodeMain(argc, argv);
+}
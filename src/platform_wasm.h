@@ -0,0 +1,30 @@
+/*
+ * Platform Layer for WASM and Native Builds
+ *
+ * The stack is written against the Emscripten runtime; this header is the
+ * only place that knows whether that runtime exists:
+ * - Emscripten: <emscripten.h> as is (performance.now() clock, timers,
+ *   EM_ASM/EM_JS).
+ * - Native (Linux, for perf, sanitizers and bridge nodes): the monotonic
+ *   clock is std::chrono::steady_clock, in ms as a double like
+ *   emscripten_get_now(). Browser-only calls (timers, animation frames,
+ *   JS snippets) stay behind #ifdef __EMSCRIPTEN__ at their call sites.
+ * Sources include this instead of <emscripten.h>; JS bindings go through
+ * bindings_wasm.h.
+ */
+
+#ifndef PLATFORM_WASM_H
+#define PLATFORM_WASM_H
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#else
+#include <chrono>
+
+// Milliseconds on the monotonic clock; the origin is arbitrary, as in the browser
+inline double emscripten_get_now() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+#endif // PLATFORM_WASM_H
@@ -12,8 +12,9 @@
 // #include <rclc/rclc.h>
 // #include <std_msgs/msg/string.h>
 
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
+#include "log_wasm.h"
 #include <string>
 #include <cstdio>
 
@@ -90,11 +91,11 @@ public:
      */
     bool publishToROSTopic(const std::string& data) {
         if (!ros_initialized) {
-            printf("WASM: ROS not initialized\n");
+            WASM_LOG_WARN("WASM: ROS not initialized\n");
             return false;
         }
         
-        printf("WASM: Publishing to ROS topic (via microROS in WASM)...\n");
+        WASM_LOG_DEBUG("WASM: Publishing to ROS topic (via microROS in WASM)...\n");
         
         // TODO: Publish via microROS in WASM
         // msg.data.data = (char*)data.c_str();
@@ -105,7 +106,7 @@ public:
         //     return false;
         // }
         
-        printf("WASM: Message published (placeholder): %s\n", data.c_str());
+        WASM_LOG_DEBUG("WASM: Message published (placeholder): %s\n", data.c_str());
         return true;
     }
 
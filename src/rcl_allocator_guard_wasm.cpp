@@ -0,0 +1,63 @@
+/*
+ * Global operator new/delete for the heap allocation guard
+ *
+ * Replacements of every replaceable allocation function (plain, array,
+ * nothrow, aligned; sized deletes included) that count each allocation
+ * through allocationGuardCount() from rcl_allocator_wasm.h. They may only
+ * be defined once per program: compile this file into exactly one
+ * translation unit of a -DRMW_WASM_ALLOC_GUARD build, e.g. by #including
+ * it from the test's main file (bench/alloc_free_check.cpp).
+ */
+
+#ifndef RMW_WASM_ALLOC_GUARD
+#define RMW_WASM_ALLOC_GUARD
+#endif
+
+#include "rcl_allocator_wasm.h"
+#include <cstdlib>
+#include <new>
+
+static void* allocationGuardMalloc(size_t size, size_t alignment) {
+    allocationGuardCount(size);
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return malloc(size);
+    // aligned_alloc wants a multiple of the alignment
+    return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+}
+
+static void* allocationGuardNew(size_t size, size_t alignment) {
+    void* pointer = allocationGuardMalloc(size, alignment);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(size_t size) { return allocationGuardNew(size, 0); }
+void* operator new[](size_t size) { return allocationGuardNew(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment) {
+    return allocationGuardNew(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return allocationGuardNew(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocationGuardMalloc(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocationGuardMalloc(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocationGuardMalloc(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocationGuardMalloc(size, static_cast<size_t>(alignment));
+}
+
+// malloc and aligned_alloc blocks are both released with free()
+void operator delete(void* pointer) noexcept { free(pointer); }
+void operator delete[](void* pointer) noexcept { free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { free(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { free(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { free(pointer); }
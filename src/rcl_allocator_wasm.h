@@ -0,0 +1,312 @@
+/*
+ * rcl Allocators for WASM
+ *
+ * rcl_allocator_t plus two preallocated implementations:
+ * - ArenaAllocatorWASM: bump allocator over one block, freed all at once
+ * - PoolAllocatorWASM: fixed-size blocks on a free list
+ * Both are sized at init so the publish/take path does not touch the heap
+ * (and does not trigger ALLOW_MEMORY_GROWTH) once warmed up.
+ *
+ * Build with -DRMW_WASM_ALLOC_GUARD to count heap allocations: every
+ * global operator new and every allocate/reallocate/zero_allocate of
+ * rcl_get_default_allocator(). AllocationGuardWASM aborts if one happens
+ * while it is armed. The operator new/delete replacements are in
+ * rcl_allocator_guard_wasm.cpp, which exactly one translation unit of a
+ * guard build compiles (or #includes); without it only the default
+ * allocator is counted.
+ */
+
+#ifndef RCL_ALLOCATOR_WASM_H
+#define RCL_ALLOCATOR_WASM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+typedef struct {
+    void* (*allocate)(size_t size, void* state);
+    void (*deallocate)(void* pointer, void* state);
+    void* (*reallocate)(void* pointer, size_t size, void* state);
+    void* (*zero_allocate)(size_t number_of_elements, size_t size_of_element, void* state);
+    void* state;
+} rcl_allocator_t;
+
+// Heap allocation guard (test mode)
+#ifdef RMW_WASM_ALLOC_GUARD
+struct AllocationGuardState {
+    size_t allocations = 0;
+    bool armed = false;
+    const char* scope = "";
+};
+
+inline AllocationGuardState& allocationGuardState() {
+    static AllocationGuardState state;
+    return state;
+}
+
+// Counts one heap allocation; aborts on a guarded path
+inline void allocationGuardCount(size_t size) {
+    AllocationGuardState& state = allocationGuardState();
+    state.allocations++;
+    if (state.armed) {
+        fprintf(stderr, "WASM: heap allocation of %zu bytes on guarded path '%s'\n", size, state.scope);
+        abort();
+    }
+}
+#else
+inline void allocationGuardCount(size_t) {}
+#endif
+
+inline void* rcl_wasm_default_allocate(size_t size, void*) {
+    allocationGuardCount(size);
+    return malloc(size);
+}
+inline void rcl_wasm_default_deallocate(void* pointer, void*) { free(pointer); }
+inline void* rcl_wasm_default_reallocate(void* pointer, size_t size, void*) {
+    allocationGuardCount(size);
+    return realloc(pointer, size);
+}
+inline void* rcl_wasm_default_zero_allocate(size_t n, size_t size, void*) {
+    allocationGuardCount(n * size);
+    return calloc(n, size);
+}
+
+inline rcl_allocator_t rcl_get_default_allocator() {
+    rcl_allocator_t allocator = {
+        rcl_wasm_default_allocate,
+        rcl_wasm_default_deallocate,
+        rcl_wasm_default_reallocate,
+        rcl_wasm_default_zero_allocate,
+        nullptr,
+    };
+    return allocator;
+}
+
+inline bool rcl_allocator_is_valid(const rcl_allocator_t* allocator) {
+    return allocator && allocator->allocate && allocator->deallocate && allocator->reallocate;
+}
+
+// Bump allocator. deallocate() is a no-op; reset() releases everything.
+class ArenaAllocatorWASM {
+private:
+    uint8_t* base;
+    size_t capacity;
+    size_t offset;
+    size_t high_water;
+
+    static size_t alignUp(size_t value) {
+        const size_t align = alignof(std::max_align_t);
+        return (value + align - 1) & ~(align - 1);
+    }
+
+    static void* allocateCb(size_t size, void* state) {
+        return static_cast<ArenaAllocatorWASM*>(state)->allocate(size);
+    }
+    static void deallocateCb(void*, void*) {}
+    static void* reallocateCb(void* pointer, size_t size, void* state) {
+        return static_cast<ArenaAllocatorWASM*>(state)->reallocate(pointer, size);
+    }
+    static void* zeroAllocateCb(size_t n, size_t size, void* state) {
+        void* pointer = static_cast<ArenaAllocatorWASM*>(state)->allocate(n * size);
+        if (pointer) memset(pointer, 0, n * size);
+        return pointer;
+    }
+
+    // Size of a previous allocation is stored just before it for reallocate()
+    struct BlockHeader {
+        size_t size;
+        size_t padding;
+    };
+
+public:
+    explicit ArenaAllocatorWASM(size_t bytes)
+        : base(static_cast<uint8_t*>(malloc(bytes))), capacity(base ? bytes : 0), offset(0), high_water(0) {}
+
+    ~ArenaAllocatorWASM() {
+        free(base);
+    }
+
+    ArenaAllocatorWASM(const ArenaAllocatorWASM&) = delete;
+    ArenaAllocatorWASM& operator=(const ArenaAllocatorWASM&) = delete;
+
+    void* allocate(size_t size) {
+        size_t start = alignUp(offset);
+        size_t end = start + sizeof(BlockHeader) + alignUp(size);
+        if (end > capacity) {
+            printf("WASM: Arena exhausted (%zu of %zu bytes used, %zu requested)\n", offset, capacity, size);
+            return nullptr;
+        }
+        BlockHeader* header = reinterpret_cast<BlockHeader*>(base + start);
+        header->size = size;
+        offset = end;
+        if (offset > high_water) high_water = offset;
+        return header + 1;
+    }
+
+    void* reallocate(void* pointer, size_t size) {
+        if (!pointer) return allocate(size);
+        BlockHeader* header = static_cast<BlockHeader*>(pointer) - 1;
+        if (size <= header->size) return pointer;
+
+        // Grow in place when this is the most recent allocation
+        uint8_t* block_end = static_cast<uint8_t*>(pointer) + alignUp(header->size);
+        size_t growth = alignUp(size) - alignUp(header->size);
+        if (block_end == base + offset && offset + growth <= capacity) {
+            offset += growth;
+            if (offset > high_water) high_water = offset;
+            header->size = size;
+            return pointer;
+        }
+
+        void* moved = allocate(size);
+        if (moved) memcpy(moved, pointer, header->size);
+        return moved;
+    }
+
+    void reset() { offset = 0; }
+
+    size_t getUsed() const { return offset; }
+    size_t getCapacity() const { return capacity; }
+    size_t getHighWater() const { return high_water; }
+
+    rcl_allocator_t asRclAllocator() {
+        rcl_allocator_t allocator = { allocateCb, deallocateCb, reallocateCb, zeroAllocateCb, this };
+        return allocator;
+    }
+};
+
+// Fixed-size block pool. Storage comes from an upstream rcl allocator once.
+class PoolAllocatorWASM {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    rcl_allocator_t upstream;
+    uint8_t* storage;
+    size_t block_size;
+    size_t block_count;
+    FreeBlock* free_list;
+    size_t in_use;
+
+    static void* allocateCb(size_t size, void* state) {
+        PoolAllocatorWASM* pool = static_cast<PoolAllocatorWASM*>(state);
+        return size <= pool->block_size ? pool->acquire() : nullptr;
+    }
+    static void deallocateCb(void* pointer, void* state) {
+        static_cast<PoolAllocatorWASM*>(state)->release(pointer);
+    }
+    static void* reallocateCb(void* pointer, size_t size, void* state) {
+        PoolAllocatorWASM* pool = static_cast<PoolAllocatorWASM*>(state);
+        if (size > pool->block_size) return nullptr;
+        return pointer ? pointer : pool->acquire();
+    }
+    static void* zeroAllocateCb(size_t n, size_t size, void* state) {
+        void* pointer = allocateCb(n * size, state);
+        if (pointer) memset(pointer, 0, n * size);
+        return pointer;
+    }
+
+public:
+    PoolAllocatorWASM()
+        : upstream(rcl_get_default_allocator()), storage(nullptr), block_size(0), block_count(0),
+          free_list(nullptr), in_use(0) {}
+
+    ~PoolAllocatorWASM() {
+        fini();
+    }
+
+    PoolAllocatorWASM(const PoolAllocatorWASM&) = delete;
+    PoolAllocatorWASM& operator=(const PoolAllocatorWASM&) = delete;
+
+    bool init(size_t size, size_t count, const rcl_allocator_t& allocator) {
+        fini();
+        upstream = allocator;
+        const size_t align = alignof(std::max_align_t);
+        size_t minimum = size < sizeof(FreeBlock) ? sizeof(FreeBlock) : size;
+        block_size = (minimum + align - 1) & ~(align - 1);
+        block_count = count;
+        storage = static_cast<uint8_t*>(upstream.allocate(block_size * block_count, upstream.state));
+        if (!storage) {
+            block_count = 0;
+            return false;
+        }
+        for (size_t i = 0; i < block_count; i++) {
+            release(storage + i * block_size);
+        }
+        in_use = 0;
+        return true;
+    }
+
+    void fini() {
+        if (storage) {
+            upstream.deallocate(storage, upstream.state);
+            storage = nullptr;
+        }
+        free_list = nullptr;
+        block_count = 0;
+        in_use = 0;
+    }
+
+    void* acquire() {
+        FreeBlock* block = free_list;
+        if (!block) return nullptr;
+        free_list = block->next;
+        in_use++;
+        return block;
+    }
+
+    void release(void* pointer) {
+        if (!pointer) return;
+        FreeBlock* block = static_cast<FreeBlock*>(pointer);
+        block->next = free_list;
+        free_list = block;
+        if (in_use > 0) in_use--;
+    }
+
+    size_t getBlockSize() const { return block_size; }
+    size_t getBlockCount() const { return block_count; }
+    size_t getInUse() const { return in_use; }
+
+    rcl_allocator_t asRclAllocator() {
+        rcl_allocator_t allocator = { allocateCb, deallocateCb, reallocateCb, zeroAllocateCb, this };
+        return allocator;
+    }
+};
+
+#ifdef RMW_WASM_ALLOC_GUARD
+// Arms the guard for its lifetime: any counted allocation aborts the process
+class AllocationGuardWASM {
+private:
+    bool previous;
+    const char* previous_scope;
+
+public:
+    explicit AllocationGuardWASM(const char* scope) {
+        AllocationGuardState& state = allocationGuardState();
+        previous = state.armed;
+        previous_scope = state.scope;
+        state.armed = true;
+        state.scope = scope;
+    }
+
+    ~AllocationGuardWASM() {
+        AllocationGuardState& state = allocationGuardState();
+        state.armed = previous;
+        state.scope = previous_scope;
+    }
+
+    static size_t allocations() { return allocationGuardState().allocations; }
+};
+#else
+class AllocationGuardWASM {
+public:
+    explicit AllocationGuardWASM(const char*) {}
+    static size_t allocations() { return 0; }
+};
+#endif
+
+#endif // RCL_ALLOCATOR_WASM_H
@@ -5,13 +5,16 @@
  * It bridges rcl API with our custom RMW implementation.
  */
 
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
 #include <string>
 #include <cstdio>
 #include <cstdint>
 #include <cstring>
+#include <map>
+#include <mutex>
 #include "rcl_types_wasm.h"
+#include "rcl_timer_wasm.h"
 #include "rmw_custom_wasm.cpp"
 
 // TODO: Include actual rcl headers when ported
@@ -21,6 +24,13 @@ class DDSParticipantWASM;
 // Global RMW instance (in real implementation, would be per-context)
 static RMWCustomWASM* g_rmw_instance = nullptr;
 
+// Serializes every rcl call that touches the RMW, DDS or timer wheel, which are
+// single-threaded; the multi-threaded executor runs callbacks (that publish,
+// take or send responses) on worker threads. Recursive because callbacks may
+// call back into rcl while a caller up the stack holds it.
+static std::recursive_mutex g_rcl_mutex;
+#define RCL_WASM_LOCK() std::lock_guard<std::recursive_mutex> rcl_wasm_lock(g_rcl_mutex)
+
 // rcl_init - Initialize ROS Client Library
 extern "C" rcl_ret_t rcl_init(
     int argc,
@@ -28,11 +38,19 @@ extern "C" rcl_ret_t rcl_init(
     const rcl_init_options_t* options,
     rcl_context_t* context)
 {
+    (void)argc;
+    (void)argv;
+    RCL_WASM_LOCK();
     printf("WASM: rcl_init called\n");
     
     // Initialize our RMW (which uses our DDS layer)
     if (!g_rmw_instance) {
         g_rmw_instance = new RMWCustomWASM();
+        
+        // options->allocator points to an rcl_allocator_t (NULL = default)
+        if (options && options->allocator) {
+            g_rmw_instance->configureAllocator(*static_cast<const rcl_allocator_t*>(options->allocator));
+        }
         if (!g_rmw_instance->init()) {
             printf("WASM: Failed to initialize RMW\n");
             return RCL_RET_ERROR;
@@ -55,6 +73,8 @@ extern "C" rcl_ret_t rcl_node_init(
     rcl_context_t* context,
     const rcl_node_options_t* options)
 {
+    (void)options;
+    RCL_WASM_LOCK();
     printf("WASM: rcl_node_init called: %s\n", name);
     
     if (!node || !context || !g_rmw_instance) {
@@ -88,14 +108,18 @@ extern "C" rcl_ret_t rcl_publisher_init(
     const char* topic_name,
     const rcl_publisher_options_t* options)
 {
+    (void)options;
+    RCL_WASM_LOCK();
     printf("WASM: rcl_publisher_init called: %s\n", topic_name);
     
     if (!publisher || !node || !node->impl || !g_rmw_instance) {
         return RCL_RET_INVALID_ARGUMENT;
     }
     
-    // Create publisher via RMW
-    void* pub_handle = g_rmw_instance->createPublisher(node->impl, topic_name, "std_msgs::msg::String");
+    // Create publisher via RMW (untyped publishers carry raw C strings)
+    void* pub_handle = type_support
+        ? g_rmw_instance->createTypedPublisher(node->impl, topic_name, type_support)
+        : g_rmw_instance->createPublisher(node->impl, topic_name, "std_msgs::msg::String");
     if (!pub_handle) {
         printf("WASM: Failed to create publisher\n");
         return RCL_RET_ERROR;
@@ -108,18 +132,37 @@ extern "C" rcl_ret_t rcl_publisher_init(
     return RCL_RET_OK;
 }
 
+// rcl_publisher_fini - Destroy publisher
+extern "C" rcl_ret_t rcl_publisher_fini(rcl_publisher_t* publisher, rcl_node_t* node)
+{
+    RCL_WASM_LOCK();
+    if (!publisher || !publisher->impl || !node || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    if (!g_rmw_instance->destroyPublisher(publisher->impl)) {
+        return RCL_RET_ERROR;
+    }
+    publisher->impl = nullptr;
+    return RCL_RET_OK;
+}
+
 // rcl_publish - Publish message
 extern "C" rcl_ret_t rcl_publish(
     const rcl_publisher_t* publisher,
     const void* ros_message,
     rmw_publisher_allocation_t* allocation)
 {
+    (void)allocation;
+    RCL_WASM_LOCK();
     if (!publisher || !publisher->impl || !g_rmw_instance) {
         return RCL_RET_INVALID_ARGUMENT;
     }
     
-    // TODO: Extract message data from ros_message
-    // For now, assume ros_message is a string pointer
+    if (g_rmw_instance->isTypedPublisher(publisher->impl)) {
+        return g_rmw_instance->publishMessage(publisher->impl, ros_message) ? RCL_RET_OK : RCL_RET_ERROR;
+    }
+    
+    // Untyped publisher: ros_message is a C string
     const char* data = static_cast<const char*>(ros_message);
     std::string message_data = data ? std::string(data) : "";
     
@@ -139,14 +182,19 @@ extern "C" rcl_ret_t rcl_subscription_init(
     const char* topic_name,
     const rcl_subscription_options_t* options)
 {
+    RCL_WASM_LOCK();
     printf("WASM: rcl_subscription_init called: %s\n", topic_name);
     
     if (!subscription || !node || !node->impl || !g_rmw_instance) {
         return RCL_RET_INVALID_ARGUMENT;
     }
     
-    // Create subscriber via RMW
-    void* sub_handle = g_rmw_instance->createSubscriber(node->impl, topic_name, "std_msgs::msg::String");
+    // Create subscriber via RMW (untyped subscribers deliver raw C strings)
+    size_t depth = options ? options->depth : 0;
+    void* sub_handle = type_support
+        ? g_rmw_instance->createTypedSubscriber(node->impl, topic_name, type_support, depth)
+        : g_rmw_instance->createSubscriberWithDepth(node->impl, topic_name, "std_msgs::msg::String",
+                                                    static_cast<int>(depth));
     if (!sub_handle) {
         printf("WASM: Failed to create subscriber\n");
         return RCL_RET_ERROR;
@@ -159,22 +207,42 @@ extern "C" rcl_ret_t rcl_subscription_init(
     return RCL_RET_OK;
 }
 
+// rcl_subscription_fini - Destroy subscriber
+extern "C" rcl_ret_t rcl_subscription_fini(rcl_subscription_t* subscription, rcl_node_t* node)
+{
+    RCL_WASM_LOCK();
+    if (!subscription || !subscription->impl || !node || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    if (!g_rmw_instance->destroySubscriber(subscription->impl)) {
+        return RCL_RET_ERROR;
+    }
+    subscription->impl = nullptr;
+    return RCL_RET_OK;
+}
+
 // rcl_take - Take message from subscription
+// (network input is received by rcl_wait; take only reads what is queued)
 extern "C" rcl_ret_t rcl_take(
     const rcl_subscription_t* subscription,
     void* ros_message,
     rmw_message_info_t* message_info,
     rmw_subscription_allocation_t* allocation)
 {
+    (void)message_info;
+    (void)allocation;
+    RCL_WASM_LOCK();
     if (!subscription || !subscription->impl || !g_rmw_instance) {
         return RCL_RET_INVALID_ARGUMENT;
     }
     
-    // Take message via our RMW
+    if (g_rmw_instance->isTypedSubscriber(subscription->impl)) {
+        return g_rmw_instance->takeMessage(subscription->impl, ros_message) ? RCL_RET_OK : RCL_RET_TIMEOUT;
+    }
+    
+    // Untyped subscriber: ros_message is a char[1024] buffer
     std::string data;
     if (g_rmw_instance->take(subscription->impl, data)) {
-        // TODO: Copy to ros_message (std_msgs__msg__String)
-        // For now, assume ros_message is a char* buffer
         if (ros_message) {
             char* msg_buffer = static_cast<char*>(ros_message);
             strncpy(msg_buffer, data.c_str(), 1024); // Assume buffer size
@@ -187,5 +255,760 @@ extern "C" rcl_ret_t rcl_take(
     return RCL_RET_TIMEOUT;
 }
 
+// rcl_service_init - Initialize service server
+extern "C" rcl_ret_t rcl_service_init(
+    rcl_service_t* service,
+    const rcl_node_t* node,
+    const rosidl_service_type_support_t* type_support,
+    const char* service_name,
+    const rcl_service_options_t* options)
+{
+    (void)options;
+    RCL_WASM_LOCK();
+    printf("WASM: rcl_service_init called: %s\n", service_name);
+    
+    if (!service || !node || !node->impl || !type_support || !service_name || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    
+    void* service_handle = g_rmw_instance->createService(node->impl, service_name, type_support);
+    if (!service_handle) {
+        printf("WASM: Failed to create service\n");
+        return RCL_RET_ERROR;
+    }
+    
+    service->impl = service_handle;
+    return RCL_RET_OK;
+}
+
+// rcl_take_request - Take the oldest pending request; request_header identifies it for the response
+extern "C" rcl_ret_t rcl_take_request(
+    const rcl_service_t* service,
+    rmw_request_id_t* request_header,
+    void* ros_request)
+{
+    RCL_WASM_LOCK();
+    if (!service || !service->impl || !request_header || !ros_request || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    return g_rmw_instance->takeRequest(service->impl, request_header, ros_request) ? RCL_RET_OK : RCL_RET_TIMEOUT;
+}
+
+// rcl_send_response - Answer a request taken with rcl_take_request
+extern "C" rcl_ret_t rcl_send_response(
+    const rcl_service_t* service,
+    rmw_request_id_t* response_header,
+    void* ros_response)
+{
+    RCL_WASM_LOCK();
+    if (!service || !service->impl || !response_header || !ros_response || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    return g_rmw_instance->sendResponse(service->impl, response_header, ros_response) ? RCL_RET_OK : RCL_RET_ERROR;
+}
+
+// rcl_client_init - Initialize service client (options may be NULL: no request timeout)
+extern "C" rcl_ret_t rcl_client_init(
+    rcl_client_t* client,
+    const rcl_node_t* node,
+    const rosidl_service_type_support_t* type_support,
+    const char* service_name,
+    const rcl_client_options_t* options)
+{
+    RCL_WASM_LOCK();
+    printf("WASM: rcl_client_init called: %s\n", service_name);
+    
+    if (!client || !node || !node->impl || !type_support || !service_name || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    
+    double timeout_ms = options ? options->request_timeout_ms : 0;
+    void* client_handle = g_rmw_instance->createClient(node->impl, service_name, type_support, timeout_ms);
+    if (!client_handle) {
+        printf("WASM: Failed to create client\n");
+        return RCL_RET_ERROR;
+    }
+    
+    client->impl = client_handle;
+    return RCL_RET_OK;
+}
+
+// rcl_send_request - Send a request without waiting for earlier ones to be answered
+extern "C" rcl_ret_t rcl_send_request(
+    const rcl_client_t* client,
+    const void* ros_request,
+    int64_t* sequence_number)
+{
+    RCL_WASM_LOCK();
+    if (!client || !client->impl || !ros_request || !sequence_number || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    return g_rmw_instance->sendRequest(client->impl, ros_request, sequence_number) ? RCL_RET_OK : RCL_RET_ERROR;
+}
+
+// rcl_take_response - Take a response; request_header->sequence_number says which request it answers
+extern "C" rcl_ret_t rcl_take_response(
+    const rcl_client_t* client,
+    rmw_request_id_t* request_header,
+    void* ros_response)
+{
+    RCL_WASM_LOCK();
+    if (!client || !client->impl || !request_header || !ros_response || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    return g_rmw_instance->takeResponse(client->impl, request_header, ros_response) ? RCL_RET_OK : RCL_RET_TIMEOUT;
+}
+
+// rcl_client_take_timeout - Report a request that got no response within request_timeout_ms
+// (WASM extension; a response arriving later is dropped)
+extern "C" rcl_ret_t rcl_client_take_timeout(
+    const rcl_client_t* client,
+    rmw_request_id_t* request_header)
+{
+    RCL_WASM_LOCK();
+    if (!client || !client->impl || !request_header || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    return g_rmw_instance->takeTimedOut(client->impl, request_header) ? RCL_RET_OK : RCL_RET_TIMEOUT;
+}
+
+// Replaces the steady clock while set (rcl_set_steady_clock)
+static rcl_steady_clock_t g_steady_clock = nullptr;
+
+// Steady clock in nanoseconds
+static int64_t rcl_wasm_steady_now_ns() {
+    if (g_steady_clock) {
+        return g_steady_clock();
+    }
+    return static_cast<int64_t>(emscripten_get_now() * 1000000.0);
+}
+
+// All timers share one wheel; rcl_wait advances it
+static TimerWheelWASM* g_timer_wheel = nullptr;
+
+struct rcl_timer_impl_wasm_t {
+    TimerWheelNodeWASM node;
+    rcl_timer_callback_t callback;
+    int64_t period_ns;
+    int64_t next_call_ns;       // Stays on the phase set at init/reset, so calls do not drift
+    int64_t last_call_ns;
+    bool canceled;
+    rcl_timer_statistics_t statistics;
+    rcl_allocator_t allocator;
+};
+
+// rcl_clock_init - Only RCL_STEADY_TIME is backed by a real clock
+extern "C" rcl_ret_t rcl_clock_init(rcl_clock_type_t clock_type, rcl_clock_t* clock, rcl_allocator_t* allocator)
+{
+    (void)allocator;
+    if (!clock) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    clock->type = clock_type;
+    return RCL_RET_OK;
+}
+
+// rcl_timer_init - Periodic timer; first call one period from now
+extern "C" rcl_ret_t rcl_timer_init(
+    rcl_timer_t* timer,
+    rcl_clock_t* clock,
+    rcl_context_t* context,
+    int64_t period,
+    const rcl_timer_callback_t callback,
+    rcl_allocator_t allocator)
+{
+    (void)clock;
+    (void)context;
+    RCL_WASM_LOCK();
+    if (!timer || period <= 0 || !rcl_allocator_is_valid(&allocator)) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    
+    void* storage = allocator.allocate(sizeof(rcl_timer_impl_wasm_t), allocator.state);
+    if (!storage) {
+        return RCL_RET_BAD_ALLOC;
+    }
+    rcl_timer_impl_wasm_t* impl = new (storage) rcl_timer_impl_wasm_t();
+    impl->callback = callback;
+    impl->period_ns = period;
+    impl->allocator = allocator;
+    
+    int64_t now = rcl_wasm_steady_now_ns();
+    if (!g_timer_wheel) {
+        g_timer_wheel = new TimerWheelWASM(now);
+    }
+    impl->last_call_ns = now;
+    impl->next_call_ns = now + period;
+    g_timer_wheel->schedule(&impl->node, impl->next_call_ns);
+    
+    timer->impl = impl;
+    printf("WASM: Timer initialized (period %.3f ms)\n", period / 1000000.0);
+    return RCL_RET_OK;
+}
+
+extern "C" rcl_ret_t rcl_timer_fini(rcl_timer_t* timer)
+{
+    RCL_WASM_LOCK();
+    if (!timer || !timer->impl) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rcl_timer_impl_wasm_t* impl = static_cast<rcl_timer_impl_wasm_t*>(timer->impl);
+    g_timer_wheel->cancel(&impl->node);
+    rcl_allocator_t allocator = impl->allocator;
+    impl->~rcl_timer_impl_wasm_t();
+    allocator.deallocate(impl, allocator.state);
+    timer->impl = nullptr;
+    return RCL_RET_OK;
+}
+
+// rcl_timer_call - Run the callback and schedule the next period.
+// The next call stays on the original phase; if the call was more than a
+// period late, the missed periods are skipped (and counted) instead of
+// being fired back to back.
+extern "C" rcl_ret_t rcl_timer_call(rcl_timer_t* timer)
+{
+    if (!timer || !timer->impl) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rcl_timer_impl_wasm_t* impl = static_cast<rcl_timer_impl_wasm_t*>(timer->impl);
+    int64_t since_last_call;
+    {
+        // Bookkeeping only; the callback runs unlocked so timers on worker threads overlap
+        RCL_WASM_LOCK();
+        if (impl->canceled) {
+            return RCL_RET_TIMER_CANCELED;
+        }
+        
+        int64_t now = rcl_wasm_steady_now_ns();
+        int64_t lateness = now - impl->next_call_ns;
+        if (lateness < 0) lateness = 0;
+        
+        rcl_timer_statistics_t& stats = impl->statistics;
+        stats.calls++;
+        stats.mean_lateness_ns += (lateness - stats.mean_lateness_ns) / static_cast<double>(stats.calls);
+        if (lateness > stats.max_lateness_ns) stats.max_lateness_ns = lateness;
+        
+        impl->next_call_ns += impl->period_ns;
+        if (impl->next_call_ns <= now) {
+            int64_t missed = (now - impl->next_call_ns) / impl->period_ns + 1;
+            impl->next_call_ns += missed * impl->period_ns;
+            stats.missed_periods += static_cast<uint64_t>(missed);
+        }
+        g_timer_wheel->schedule(&impl->node, impl->next_call_ns);
+        
+        since_last_call = now - impl->last_call_ns;
+        impl->last_call_ns = now;
+    }
+    if (impl->callback) {
+        impl->callback(timer, since_last_call);
+    }
+    return RCL_RET_OK;
+}
+
+extern "C" rcl_ret_t rcl_timer_is_ready(const rcl_timer_t* timer, bool* is_ready)
+{
+    RCL_WASM_LOCK();
+    if (!timer || !timer->impl || !is_ready) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    const rcl_timer_impl_wasm_t* impl = static_cast<const rcl_timer_impl_wasm_t*>(timer->impl);
+    *is_ready = !impl->canceled && rcl_wasm_steady_now_ns() >= impl->next_call_ns;
+    return RCL_RET_OK;
+}
+
+extern "C" rcl_ret_t rcl_timer_cancel(rcl_timer_t* timer)
+{
+    RCL_WASM_LOCK();
+    if (!timer || !timer->impl) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rcl_timer_impl_wasm_t* impl = static_cast<rcl_timer_impl_wasm_t*>(timer->impl);
+    impl->canceled = true;
+    g_timer_wheel->cancel(&impl->node);
+    return RCL_RET_OK;
+}
+
+// rcl_timer_reset - Restart the period from now (also un-cancels)
+extern "C" rcl_ret_t rcl_timer_reset(rcl_timer_t* timer)
+{
+    RCL_WASM_LOCK();
+    if (!timer || !timer->impl) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rcl_timer_impl_wasm_t* impl = static_cast<rcl_timer_impl_wasm_t*>(timer->impl);
+    impl->canceled = false;
+    impl->next_call_ns = rcl_wasm_steady_now_ns() + impl->period_ns;
+    g_timer_wheel->schedule(&impl->node, impl->next_call_ns);
+    return RCL_RET_OK;
+}
+
+extern "C" rcl_ret_t rcl_timer_get_time_until_next_call(const rcl_timer_t* timer, int64_t* time_until_next_call)
+{
+    RCL_WASM_LOCK();
+    if (!timer || !timer->impl || !time_until_next_call) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    const rcl_timer_impl_wasm_t* impl = static_cast<const rcl_timer_impl_wasm_t*>(timer->impl);
+    if (impl->canceled) {
+        return RCL_RET_TIMER_CANCELED;
+    }
+    *time_until_next_call = impl->next_call_ns - rcl_wasm_steady_now_ns();
+    return RCL_RET_OK;
+}
+
+// rcl_set_steady_clock - Drive rcl timers from another clock; NULL restores the
+// real one. Only while no timer is scheduled: the wheel restarts on the new
+// clock (WASM extension)
+extern "C" rcl_ret_t rcl_set_steady_clock(rcl_steady_clock_t clock)
+{
+    RCL_WASM_LOCK();
+    if (g_timer_wheel && g_timer_wheel->getScheduled() > 0) {
+        return RCL_RET_ERROR;
+    }
+    g_steady_clock = clock;
+    if (g_timer_wheel) {
+        delete g_timer_wheel;
+        g_timer_wheel = new TimerWheelWASM(rcl_wasm_steady_now_ns());
+    }
+    return RCL_RET_OK;
+}
+
+// rcl_timer_get_statistics - Call count, missed periods and lateness (WASM extension)
+extern "C" rcl_ret_t rcl_timer_get_statistics(const rcl_timer_t* timer, rcl_timer_statistics_t* statistics)
+{
+    RCL_WASM_LOCK();
+    if (!timer || !timer->impl || !statistics) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    *statistics = static_cast<const rcl_timer_impl_wasm_t*>(timer->impl)->statistics;
+    return RCL_RET_OK;
+}
+
+// Wait set bookkeeping: next free slot per entity array
+struct rcl_wait_set_impl_wasm_t {
+    size_t subscription_index;
+    size_t guard_condition_index;
+    size_t timer_index;
+    size_t client_index;
+    size_t service_index;
+    rcl_allocator_t allocator;
+};
+
+// rcl_wait_set_init - Allocate the entity arrays once; clear/add/wait do not allocate
+// (events are not supported)
+extern "C" rcl_ret_t rcl_wait_set_init(
+    rcl_wait_set_t* wait_set,
+    size_t number_of_subscriptions,
+    size_t number_of_guard_conditions,
+    size_t number_of_timers,
+    size_t number_of_clients,
+    size_t number_of_services,
+    size_t number_of_events,
+    rcl_context_t* context,
+    rcl_allocator_t allocator)
+{
+    (void)number_of_events;
+    (void)context;
+    if (!wait_set || !rcl_allocator_is_valid(&allocator)) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    
+    memset(wait_set, 0, sizeof(*wait_set));
+    rcl_wait_set_impl_wasm_t* impl = static_cast<rcl_wait_set_impl_wasm_t*>(
+        allocator.zero_allocate(1, sizeof(rcl_wait_set_impl_wasm_t), allocator.state));
+    if (!impl) {
+        return RCL_RET_BAD_ALLOC;
+    }
+    impl->allocator = allocator;
+    wait_set->impl = impl;
+    
+    wait_set->size_of_subscriptions = number_of_subscriptions;
+    wait_set->size_of_guard_conditions = number_of_guard_conditions;
+    wait_set->size_of_timers = number_of_timers;
+    wait_set->size_of_clients = number_of_clients;
+    wait_set->size_of_services = number_of_services;
+    wait_set->subscriptions = static_cast<const rcl_subscription_t**>(
+        allocator.zero_allocate(number_of_subscriptions + 1, sizeof(void*), allocator.state));
+    wait_set->guard_conditions = static_cast<const rcl_guard_condition_t**>(
+        allocator.zero_allocate(number_of_guard_conditions + 1, sizeof(void*), allocator.state));
+    wait_set->timers = static_cast<const rcl_timer_t**>(
+        allocator.zero_allocate(number_of_timers + 1, sizeof(void*), allocator.state));
+    wait_set->clients = static_cast<const rcl_client_t**>(
+        allocator.zero_allocate(number_of_clients + 1, sizeof(void*), allocator.state));
+    wait_set->services = static_cast<const rcl_service_t**>(
+        allocator.zero_allocate(number_of_services + 1, sizeof(void*), allocator.state));
+    if (!wait_set->subscriptions || !wait_set->guard_conditions || !wait_set->timers ||
+        !wait_set->clients || !wait_set->services) {
+        rcl_wait_set_fini(wait_set);
+        return RCL_RET_BAD_ALLOC;
+    }
+    return RCL_RET_OK;
+}
+
+// rcl_wait_set_fini - Release the entity arrays
+extern "C" rcl_ret_t rcl_wait_set_fini(rcl_wait_set_t* wait_set)
+{
+    if (!wait_set) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rcl_wait_set_impl_wasm_t* impl = static_cast<rcl_wait_set_impl_wasm_t*>(wait_set->impl);
+    if (impl) {
+        rcl_allocator_t allocator = impl->allocator;
+        allocator.deallocate(wait_set->subscriptions, allocator.state);
+        allocator.deallocate(wait_set->guard_conditions, allocator.state);
+        allocator.deallocate(wait_set->timers, allocator.state);
+        allocator.deallocate(wait_set->clients, allocator.state);
+        allocator.deallocate(wait_set->services, allocator.state);
+        allocator.deallocate(impl, allocator.state);
+    }
+    memset(wait_set, 0, sizeof(*wait_set));
+    return RCL_RET_OK;
+}
+
+// rcl_wait_set_clear - Remove all entities (keeps the arrays)
+extern "C" rcl_ret_t rcl_wait_set_clear(rcl_wait_set_t* wait_set)
+{
+    if (!wait_set || !wait_set->impl) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rcl_wait_set_impl_wasm_t* impl = static_cast<rcl_wait_set_impl_wasm_t*>(wait_set->impl);
+    memset(wait_set->subscriptions, 0, wait_set->size_of_subscriptions * sizeof(void*));
+    memset(wait_set->guard_conditions, 0, wait_set->size_of_guard_conditions * sizeof(void*));
+    memset(wait_set->timers, 0, wait_set->size_of_timers * sizeof(void*));
+    memset(wait_set->clients, 0, wait_set->size_of_clients * sizeof(void*));
+    memset(wait_set->services, 0, wait_set->size_of_services * sizeof(void*));
+    impl->subscription_index = 0;
+    impl->guard_condition_index = 0;
+    impl->timer_index = 0;
+    impl->client_index = 0;
+    impl->service_index = 0;
+    return RCL_RET_OK;
+}
+
+template <typename T>
+static rcl_ret_t rcl_wasm_wait_set_add(const T** array, size_t size, size_t& next, const T* entity, size_t* index) {
+    if (!array || !entity) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    if (next >= size) {
+        WASM_LOG_WARN("WASM: Wait set full (%zu entities)\n", size);
+        return RCL_RET_ERROR;
+    }
+    if (index) {
+        *index = next;
+    }
+    array[next++] = entity;
+    return RCL_RET_OK;
+}
+
+extern "C" rcl_ret_t rcl_wait_set_add_subscription(
+    rcl_wait_set_t* wait_set,
+    const rcl_subscription_t* subscription,
+    size_t* index)
+{
+    if (!wait_set || !wait_set->impl) return RCL_RET_INVALID_ARGUMENT;
+    rcl_wait_set_impl_wasm_t* impl = static_cast<rcl_wait_set_impl_wasm_t*>(wait_set->impl);
+    return rcl_wasm_wait_set_add(wait_set->subscriptions, wait_set->size_of_subscriptions,
+                                 impl->subscription_index, subscription, index);
+}
+
+extern "C" rcl_ret_t rcl_wait_set_add_guard_condition(
+    rcl_wait_set_t* wait_set,
+    const rcl_guard_condition_t* guard_condition,
+    size_t* index)
+{
+    if (!wait_set || !wait_set->impl) return RCL_RET_INVALID_ARGUMENT;
+    rcl_wait_set_impl_wasm_t* impl = static_cast<rcl_wait_set_impl_wasm_t*>(wait_set->impl);
+    return rcl_wasm_wait_set_add(wait_set->guard_conditions, wait_set->size_of_guard_conditions,
+                                 impl->guard_condition_index, guard_condition, index);
+}
+
+extern "C" rcl_ret_t rcl_wait_set_add_timer(
+    rcl_wait_set_t* wait_set,
+    const rcl_timer_t* timer,
+    size_t* index)
+{
+    if (!wait_set || !wait_set->impl) return RCL_RET_INVALID_ARGUMENT;
+    rcl_wait_set_impl_wasm_t* impl = static_cast<rcl_wait_set_impl_wasm_t*>(wait_set->impl);
+    return rcl_wasm_wait_set_add(wait_set->timers, wait_set->size_of_timers,
+                                 impl->timer_index, timer, index);
+}
+
+extern "C" rcl_ret_t rcl_wait_set_add_client(
+    rcl_wait_set_t* wait_set,
+    const rcl_client_t* client,
+    size_t* index)
+{
+    if (!wait_set || !wait_set->impl) return RCL_RET_INVALID_ARGUMENT;
+    rcl_wait_set_impl_wasm_t* impl = static_cast<rcl_wait_set_impl_wasm_t*>(wait_set->impl);
+    return rcl_wasm_wait_set_add(wait_set->clients, wait_set->size_of_clients,
+                                 impl->client_index, client, index);
+}
+
+extern "C" rcl_ret_t rcl_wait_set_add_service(
+    rcl_wait_set_t* wait_set,
+    const rcl_service_t* service,
+    size_t* index)
+{
+    if (!wait_set || !wait_set->impl) return RCL_RET_INVALID_ARGUMENT;
+    rcl_wait_set_impl_wasm_t* impl = static_cast<rcl_wait_set_impl_wasm_t*>(wait_set->impl);
+    return rcl_wasm_wait_set_add(wait_set->services, wait_set->size_of_services,
+                                 impl->service_index, service, index);
+}
+
+// rcl_wait - Poll network input once, then mark which entities are ready.
+// Never blocks (the browser event loop cannot): if nothing is ready it returns
+// RCL_RET_TIMEOUT right away and the caller spins again on its next tick.
+extern "C" rcl_ret_t rcl_wait(rcl_wait_set_t* wait_set, int64_t timeout)
+{
+    (void)timeout;
+    RCL_WASM_LOCK();
+    if (!wait_set || !wait_set->impl || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    
+    g_rmw_instance->pollAll();
+    if (g_timer_wheel) {
+        g_timer_wheel->advance(rcl_wasm_steady_now_ns());
+    }
+    
+    bool any_ready = false;
+    for (size_t i = 0; i < wait_set->size_of_subscriptions; i++) {
+        const rcl_subscription_t* subscription = wait_set->subscriptions[i];
+        if (subscription && !g_rmw_instance->hasData(subscription->impl)) {
+            wait_set->subscriptions[i] = nullptr;
+        }
+        any_ready |= wait_set->subscriptions[i] != nullptr;
+    }
+    for (size_t i = 0; i < wait_set->size_of_guard_conditions; i++) {
+        const rcl_guard_condition_t* guard_condition = wait_set->guard_conditions[i];
+        if (guard_condition &&
+            !static_cast<RMWGuardConditionWASM*>(guard_condition->impl)->takeTriggered()) {
+            wait_set->guard_conditions[i] = nullptr;
+        }
+        any_ready |= wait_set->guard_conditions[i] != nullptr;
+    }
+    for (size_t i = 0; i < wait_set->size_of_timers; i++) {
+        const rcl_timer_t* timer = wait_set->timers[i];
+        if (timer && !static_cast<rcl_timer_impl_wasm_t*>(timer->impl)->node.expired) {
+            wait_set->timers[i] = nullptr;
+        }
+        any_ready |= wait_set->timers[i] != nullptr;
+    }
+    for (size_t i = 0; i < wait_set->size_of_clients; i++) {
+        const rcl_client_t* client = wait_set->clients[i];
+        if (client && !g_rmw_instance->hasResponse(client->impl)) {
+            wait_set->clients[i] = nullptr;
+        }
+        any_ready |= wait_set->clients[i] != nullptr;
+    }
+    for (size_t i = 0; i < wait_set->size_of_services; i++) {
+        const rcl_service_t* service = wait_set->services[i];
+        if (service && !g_rmw_instance->hasRequest(service->impl)) {
+            wait_set->services[i] = nullptr;
+        }
+        any_ready |= wait_set->services[i] != nullptr;
+    }
+    return any_ready ? RCL_RET_OK : RCL_RET_TIMEOUT;
+}
+
+// rcl_count_publishers - Number of publishers on a topic (from the graph cache)
+extern "C" rcl_ret_t rcl_count_publishers(
+    const rcl_node_t* node,
+    const char* topic_name,
+    size_t* count)
+{
+    RCL_WASM_LOCK();
+    if (!node || !node->impl || !topic_name || !count || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    *count = g_rmw_instance->getGraph().countPublishers(topic_name);
+    return RCL_RET_OK;
+}
+
+// rcl_count_subscribers - Number of subscribers on a topic (from the graph cache)
+extern "C" rcl_ret_t rcl_count_subscribers(
+    const rcl_node_t* node,
+    const char* topic_name,
+    size_t* count)
+{
+    RCL_WASM_LOCK();
+    if (!node || !node->impl || !topic_name || !count || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    *count = g_rmw_instance->getGraph().countSubscribers(topic_name);
+    return RCL_RET_OK;
+}
+
+static char* rcl_wasm_strdup(const char* value, rcl_allocator_t* allocator) {
+    size_t length = strlen(value);
+    char* copy = static_cast<char*>(allocator->allocate(length + 1, allocator->state));
+    if (copy) {
+        memcpy(copy, value, length + 1);
+    }
+    return copy;
+}
+
+// rcl_names_and_types_fini - Release a result of rcl_get_topic_names_and_types
+extern "C" rcl_ret_t rcl_names_and_types_fini(rcl_names_and_types_t* names_and_types)
+{
+    if (!names_and_types) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rcl_allocator_t allocator = names_and_types->names.allocator;
+    for (size_t i = 0; i < names_and_types->names.size; i++) {
+        if (names_and_types->names.data) {
+            allocator.deallocate(names_and_types->names.data[i], allocator.state);
+        }
+        if (names_and_types->types && names_and_types->types[i].data) {
+            if (names_and_types->types[i].size > 0) {
+                allocator.deallocate(names_and_types->types[i].data[0], allocator.state);
+            }
+            allocator.deallocate(names_and_types->types[i].data, allocator.state);
+        }
+    }
+    allocator.deallocate(names_and_types->names.data, allocator.state);
+    allocator.deallocate(names_and_types->types, allocator.state);
+    names_and_types->names.size = 0;
+    names_and_types->names.data = nullptr;
+    names_and_types->types = nullptr;
+    return RCL_RET_OK;
+}
+
+// rcl_get_topic_names_and_types - List known topics (from the graph cache, O(topics))
+extern "C" rcl_ret_t rcl_get_topic_names_and_types(
+    const rcl_node_t* node,
+    rcl_allocator_t* allocator,
+    bool no_demangle,
+    rcl_names_and_types_t* topic_names_and_types)
+{
+    (void)no_demangle;
+    RCL_WASM_LOCK();
+    if (!node || !node->impl || !rcl_allocator_is_valid(allocator) || !topic_names_and_types || !g_rmw_instance) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    
+    const auto& topics = g_rmw_instance->getGraph().getTopics();
+    size_t count = topics.size();
+    rcl_names_and_types_t& out = *topic_names_and_types;
+    out.names.size = 0;
+    out.names.allocator = *allocator;
+    out.names.data = static_cast<char**>(allocator->zero_allocate(count ? count : 1, sizeof(char*), allocator->state));
+    out.types = static_cast<rcutils_string_array_t*>(
+        allocator->zero_allocate(count ? count : 1, sizeof(rcutils_string_array_t), allocator->state));
+    if (!out.names.data || !out.types) {
+        rcl_names_and_types_fini(&out);
+        return RCL_RET_BAD_ALLOC;
+    }
+    
+    for (const auto& topic : topics) {
+        size_t i = out.names.size++;
+        out.types[i].allocator = *allocator;
+        out.names.data[i] = rcl_wasm_strdup(topic.first.c_str(), allocator);
+        out.types[i].data = static_cast<char**>(allocator->allocate(sizeof(char*), allocator->state));
+        if (!out.names.data[i] || !out.types[i].data) {
+            rcl_names_and_types_fini(&out);
+            return RCL_RET_BAD_ALLOC;
+        }
+        out.types[i].data[0] = rcl_wasm_strdup(topic.second.type_name.c_str(), allocator);
+        out.types[i].size = 1;
+    }
+    return RCL_RET_OK;
+}
+
+// rcl_node_get_graph_guard_condition - Triggered whenever the graph cache changes
+static std::map<const void*, rcl_guard_condition_t> g_graph_guard_conditions;
+
+extern "C" const rcl_guard_condition_t* rcl_node_get_graph_guard_condition(const rcl_node_t* node)
+{
+    RCL_WASM_LOCK();
+    if (!node || !node->impl || !g_rmw_instance) {
+        return nullptr;
+    }
+    
+    auto it = g_graph_guard_conditions.find(node->impl);
+    if (it == g_graph_guard_conditions.end()) {
+        RMWGuardConditionWASM* guard = g_rmw_instance->getGraphGuardCondition(node->impl);
+        if (!guard) {
+            return nullptr;
+        }
+        rcl_guard_condition_t handle;
+        handle.impl = guard;
+        it = g_graph_guard_conditions.insert(std::make_pair(node->impl, handle)).first;
+    }
+    return &it->second;
+}
+
+// rcl_trigger_guard_condition - Wake any executor waiting on this guard condition
+extern "C" rcl_ret_t rcl_trigger_guard_condition(rcl_guard_condition_t* guard_condition)
+{
+    RCL_WASM_LOCK();
+    if (!guard_condition || !guard_condition->impl) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    static_cast<RMWGuardConditionWASM*>(guard_condition->impl)->trigger();
+    return RCL_RET_OK;
+}
+
+// rcl_context_add_activity_listener - `callback` runs whenever data is queued for a take,
+// so a main loop can sleep until there is work (WASM extension)
+extern "C" rcl_ret_t rcl_context_add_activity_listener(
+    rcl_context_t* context,
+    rcl_context_activity_callback_t callback,
+    void* callback_context)
+{
+    RCL_WASM_LOCK();
+    if (!context || !context->impl || !callback) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    RMWCustomWASM* rmw = static_cast<RMWCustomWASM*>(context->impl);
+    return rmw->addActivityListener(callback, callback_context) ? RCL_RET_OK : RCL_RET_ERROR;
+}
+
+extern "C" rcl_ret_t rcl_context_remove_activity_listener(
+    rcl_context_t* context,
+    rcl_context_activity_callback_t callback,
+    void* callback_context)
+{
+    RCL_WASM_LOCK();
+    if (!context || !context->impl || !callback) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    static_cast<RMWCustomWASM*>(context->impl)->removeActivityListener(callback, callback_context);
+    return RCL_RET_OK;
+}
+
+// rcl_context_start_io_thread - Socket reads move to one I/O thread per node; rcl_wait
+// delivers what they queued and activity listeners fire once per received batch.
+// Register listeners before calling this (WASM extension)
+extern "C" rcl_ret_t rcl_context_start_io_thread(rcl_context_t* context)
+{
+    RCL_WASM_LOCK();
+    if (!context || !context->impl) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    return static_cast<RMWCustomWASM*>(context->impl)->enableIOThreads() ? RCL_RET_OK : RCL_RET_ERROR;
+}
+
+// rcl_context_get_io_statistics - Receive queue depth and hand-off latency, all nodes (WASM extension)
+extern "C" rcl_ret_t rcl_context_get_io_statistics(
+    const rcl_context_t* context,
+    rcl_io_statistics_t* statistics)
+{
+    RCL_WASM_LOCK();
+    if (!context || !context->impl || !statistics) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    IOHandoffStatsWASM stats = static_cast<const RMWCustomWASM*>(context->impl)->getIOStats();
+    statistics->frames = stats.delivered;
+    statistics->dropped = stats.dropped;
+    statistics->wakeups = stats.wakeups;
+    statistics->queue_depth = stats.depth;
+    statistics->max_queue_depth = stats.max_depth;
+    statistics->mean_latency_ms = stats.mean_latency_ms;
+    statistics->max_latency_ms = stats.max_latency_ms;
+    return RCL_RET_OK;
+}
+
 // Types are now in rcl_types_wasm.h
 
@@ -0,0 +1,166 @@
+/*
+ * Hierarchical Timer Wheel for WASM
+ *
+ * Backs rcl timers. Four levels (256 + 3 x 64 slots) cover 2^26 ticks; each
+ * level's slots hold intrusive lists, so scheduling, cancelling and expiring a
+ * timer are O(1) and advancing costs O(1) per elapsed tick regardless of how
+ * many timers exist. Timers further out than the wheel's range are parked in
+ * the top level and re-filed each time it cascades.
+ */
+
+#ifndef RCL_TIMER_WASM_H
+#define RCL_TIMER_WASM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Default tick: 100us, fine enough for 1 kHz timers
+#ifndef RCL_WASM_TIMER_TICK_NS
+#define RCL_WASM_TIMER_TICK_NS 100000
+#endif
+
+// Embedded in each timer; the wheel never allocates
+struct TimerWheelNodeWASM {
+    TimerWheelNodeWASM* prev;
+    TimerWheelNodeWASM* next;
+    uint64_t expiry_tick;
+    bool expired;  // Deadline passed; cleared when the owner reschedules
+
+    TimerWheelNodeWASM() : prev(nullptr), next(nullptr), expiry_tick(0), expired(false) {}
+
+    bool isLinked() const { return next != nullptr; }
+};
+
+class TimerWheelWASM {
+private:
+    static const int LEVEL0_BITS = 8;
+    static const int LEVEL_BITS = 6;
+    static const int LEVELS = 4;
+    static const uint64_t LEVEL0_SIZE = 1u << LEVEL0_BITS;
+    static const uint64_t LEVEL_SIZE = 1u << LEVEL_BITS;
+    static const uint64_t MAX_DELTA = (1ull << (LEVEL0_BITS + (LEVELS - 1) * LEVEL_BITS)) - 1;
+
+    // Circular list heads (sentinels); level 0 uses all 256, levels 1-3 the first 64
+    TimerWheelNodeWASM slots[LEVELS][LEVEL0_SIZE];
+    int64_t origin_ns;
+    int64_t tick_ns;
+    uint64_t current_tick;
+    size_t scheduled;
+    uint64_t visits;  // Timers re-filed by a cascade or expired
+
+    static int shift(int level) {
+        return level == 0 ? 0 : LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+    }
+
+    static void link(TimerWheelNodeWASM* head, TimerWheelNodeWASM* node) {
+        node->prev = head->prev;
+        node->next = head;
+        head->prev->next = node;
+        head->prev = node;
+    }
+
+    static void unlink(TimerWheelNodeWASM* node) {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = nullptr;
+        node->next = nullptr;
+    }
+
+    void place(TimerWheelNodeWASM* node) {
+        uint64_t expiry = node->expiry_tick > current_tick ? node->expiry_tick : current_tick;
+        uint64_t delta = expiry - current_tick;
+        if (delta > MAX_DELTA) {
+            expiry = current_tick + MAX_DELTA;  // Parked; re-filed on cascade
+            delta = MAX_DELTA;
+        }
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= (1ull << shift(level + 1))) {
+            level++;
+        }
+        uint64_t mask = level == 0 ? LEVEL0_SIZE - 1 : LEVEL_SIZE - 1;
+        link(&slots[level][(expiry >> shift(level)) & mask], node);
+    }
+
+    // Re-file one slot of a higher level into the levels below it
+    void cascade(int level, uint64_t index) {
+        TimerWheelNodeWASM* head = &slots[level][index];
+        while (head->next != head) {
+            TimerWheelNodeWASM* node = head->next;
+            unlink(node);
+            place(node);
+            visits++;
+        }
+    }
+
+public:
+    explicit TimerWheelWASM(int64_t now_ns, int64_t tick = RCL_WASM_TIMER_TICK_NS)
+        : origin_ns(now_ns), tick_ns(tick > 0 ? tick : 1), current_tick(0), scheduled(0), visits(0) {
+        for (int level = 0; level < LEVELS; level++) {
+            for (uint64_t i = 0; i < LEVEL0_SIZE; i++) {
+                slots[level][i].prev = &slots[level][i];
+                slots[level][i].next = &slots[level][i];
+            }
+        }
+    }
+
+    TimerWheelWASM(const TimerWheelWASM&) = delete;
+    TimerWheelWASM& operator=(const TimerWheelWASM&) = delete;
+
+    // Expires at the first tick at or after deadline_ns (immediately if already due)
+    void schedule(TimerWheelNodeWASM* node, int64_t deadline_ns) {
+        cancel(node);
+        int64_t offset = deadline_ns - origin_ns;
+        node->expiry_tick = offset <= 0 ? 0 : static_cast<uint64_t>((offset + tick_ns - 1) / tick_ns);
+        node->expired = node->expiry_tick <= current_tick;
+        if (!node->expired) {
+            place(node);
+            scheduled++;
+        }
+    }
+
+    void cancel(TimerWheelNodeWASM* node) {
+        if (node->isLinked()) {
+            unlink(node);
+            scheduled--;
+        }
+        node->expired = false;
+    }
+
+    // Expire everything due by now_ns; O(1) per elapsed tick
+    void advance(int64_t now_ns) {
+        if (now_ns <= origin_ns) return;
+        uint64_t target = static_cast<uint64_t>((now_ns - origin_ns) / tick_ns);
+        while (current_tick < target) {
+            if (scheduled == 0) {
+                current_tick = target;  // Nothing to expire: jump
+                break;
+            }
+            current_tick++;
+            if ((current_tick & (LEVEL0_SIZE - 1)) == 0) {
+                for (int level = LEVELS - 1; level >= 1; level--) {
+                    // Cascade a level only when every level below it wrapped
+                    if ((current_tick & ((1ull << shift(level)) - 1)) == 0) {
+                        cascade(level, (current_tick >> shift(level)) & (LEVEL_SIZE - 1));
+                    }
+                }
+            }
+            TimerWheelNodeWASM* head = &slots[0][current_tick & (LEVEL0_SIZE - 1)];
+            while (head->next != head) {
+                TimerWheelNodeWASM* node = head->next;
+                unlink(node);
+                node->expired = true;
+                scheduled--;
+                visits++;
+            }
+        }
+    }
+
+    size_t getScheduled() const { return scheduled; }
+    int64_t getTickNs() const { return tick_ns; }
+    uint64_t getCurrentTick() const { return current_tick; }
+    // Every timer is visited at most once per level before it expires
+    uint64_t getVisits() const { return visits; }
+    static int getLevels() { return LEVELS; }
+};
+
+#endif // RCL_TIMER_WASM_H
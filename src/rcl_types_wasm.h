@@ -8,6 +8,10 @@
 #ifndef RCL_TYPES_WASM_H
 #define RCL_TYPES_WASM_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include "rcl_allocator_wasm.h"
+
 // rcl types (simplified for WASM)
 typedef struct {
     void* impl;
@@ -25,6 +29,21 @@ typedef struct {
     void* impl;
 } rcl_context_t;
 
+// Runs whenever a sample, request or response is queued (WASM extension)
+typedef void (*rcl_context_activity_callback_t)(void* callback_context);
+
+// Network receive hand-off (WASM extension, rcl_context_start_io_thread)
+typedef struct {
+    uint64_t frames;            // Datagrams delivered to rcl_wait
+    uint64_t dropped;           // Receive buffers or queue full
+    uint64_t wakeups;           // Activity signals from the I/O threads (one per batch)
+    size_t queue_depth;
+    size_t max_queue_depth;
+    double mean_latency_ms;     // I/O thread -> rcl_wait
+    double max_latency_ms;
+} rcl_io_statistics_t;
+
+// allocator fields point to an rcl_allocator_t (rcl_allocator_wasm.h), or NULL for the default
 typedef struct {
     rcl_context_t* context;
     void* allocator;
@@ -38,26 +57,109 @@ typedef struct {
     int dummy;
 } rcl_publisher_options_t;
 
+// depth: KEEP_LAST history, samples kept until taken (0 = RMW default)
 typedef struct {
-    int dummy;
+    size_t depth;
 } rcl_subscription_options_t;
 
+typedef struct {
+    void* impl;
+} rcl_service_t;
+
+typedef struct {
+    void* impl;
+} rcl_client_t;
+
+typedef struct {
+    int dummy;
+} rcl_service_options_t;
+
+// request_timeout_ms: requests without a response after this long are
+// dropped and reported by rcl_client_take_timeout (0 = never time out)
+typedef struct {
+    uint32_t request_timeout_ms;
+} rcl_client_options_t;
+
+typedef struct {
+    void* impl;
+} rcl_guard_condition_t;
+
+// Only steady time is supported (monotonic, emscripten_get_now)
+typedef enum {
+    RCL_CLOCK_UNINITIALIZED = 0,
+    RCL_ROS_TIME = 1,
+    RCL_SYSTEM_TIME = 2,
+    RCL_STEADY_TIME = 3,
+} rcl_clock_type_t;
+
+typedef struct {
+    rcl_clock_type_t type;
+} rcl_clock_t;
+
+typedef struct {
+    void* impl;
+} rcl_timer_t;
+
+// Called with the time since the previous call
+typedef void (*rcl_timer_callback_t)(rcl_timer_t* timer, int64_t last_call_time);
+
+// Timer accuracy (WASM extension). Lateness = call time - scheduled time.
+typedef struct {
+    uint64_t calls;
+    uint64_t missed_periods;    // Periods skipped because a call came more than a period late
+    int64_t max_lateness_ns;
+    double mean_lateness_ns;
+} rcl_timer_statistics_t;
+
+// Replacement steady clock in nanoseconds, for tests (WASM extension)
+typedef int64_t (*rcl_steady_clock_t)(void);
+
+// Graph query results (one type per topic; mismatched types are rejected at match)
+typedef struct {
+    size_t size;
+    char** data;
+    rcl_allocator_t allocator;
+} rcutils_string_array_t;
+
+typedef struct {
+    rcutils_string_array_t names;
+    rcutils_string_array_t* types;
+} rcl_names_and_types_t;
+
 // rclc types
 typedef struct {
     rcl_context_t* context;
     void* allocator;
 } rclc_support_t;
 
-typedef struct {
-    void* impl;
-} rclc_executor_t;
-
 // rosidl types
+// Filled in by rosidl_typesupport_wasm.h; one static instance per message type.
+// fixed_size is non-zero when the wire image is a single memcpy of the struct.
 typedef struct {
-    int dummy;
+    const char* typesupport_identifier;
+    const char* type_name;
+    uint64_t type_hash;
+    size_t fixed_size;
+    size_t (*get_serialized_size)(const void* ros_message);
+    size_t (*serialize)(const void* ros_message, uint8_t* buffer, size_t capacity);
+    bool (*deserialize)(const uint8_t* buffer, size_t length, void* ros_message);
 } rosidl_message_type_support_t;
 
+// Request and response type support of one service type
+typedef struct {
+    const char* typesupport_identifier;
+    const char* service_name;
+    const rosidl_message_type_support_t* request_typesupport;
+    const rosidl_message_type_support_t* response_typesupport;
+} rosidl_service_type_support_t;
+
 // rmw types
+// Identifies a request: the client's GUID plus its per-client sequence number
+typedef struct {
+    int8_t writer_guid[16];
+    int64_t sequence_number;
+} rmw_request_id_t;
+
 typedef struct {
     int dummy;
 } rmw_publisher_allocation_t;
@@ -77,6 +179,7 @@ typedef enum {
     RCL_RET_BAD_ALLOC = 2,
     RCL_RET_INVALID_ARGUMENT = 3,
     RCL_RET_TIMEOUT = 4,
+    RCL_RET_TIMER_CANCELED = 5,
 } rcl_ret_t;
 
 // rclc executor handle types
@@ -87,5 +190,171 @@ typedef enum {
     RCLC_EXECUTOR_HANDLE_TYPE_SERVICE = 3,
 } rclc_executor_handle_type_t;
 
+// ON_NEW_DATA: callback only after a successful take; ALWAYS: every spin (msg NULL if nothing was taken)
+typedef enum {
+    ON_NEW_DATA = 0,
+    ALWAYS = 1,
+} rclc_executor_handle_invocation_t;
+
+// Wait set: entities that are not ready are set to NULL by rcl_wait
+typedef struct {
+    const rcl_subscription_t** subscriptions;
+    size_t size_of_subscriptions;
+    const rcl_guard_condition_t** guard_conditions;
+    size_t size_of_guard_conditions;
+    const rcl_timer_t** timers;
+    size_t size_of_timers;
+    const rcl_client_t** clients;
+    size_t size_of_clients;
+    const rcl_service_t** services;
+    size_t size_of_services;
+    void* impl;
+} rcl_wait_set_t;
+
+// Callback groups (multi-threaded executor): callbacks of a mutually exclusive
+// group never overlap; reentrant ones may run in parallel with anything.
+// Handles without a group share the executor's default exclusive group.
+typedef enum {
+    RCLC_CALLBACK_GROUP_MUTUALLY_EXCLUSIVE = 0,
+    RCLC_CALLBACK_GROUP_REENTRANT = 1,
+} rclc_callback_group_type_t;
+
+typedef struct {
+    rclc_callback_group_type_t type;
+} rclc_callback_group_t;
+
+// Order in which one spin dispatches ready handles
+typedef enum {
+    RCLC_SCHED_IN_ORDER = 0,         // Order of addition (rclc default)
+    RCLC_SCHED_FIXED_PRIORITY = 1,   // Highest priority first
+    RCLC_SCHED_EDF = 2,              // Earliest absolute deadline (release + relative deadline) first
+} rclc_executor_sched_policy_t;
+
+// Per-handle timing, kept under every policy
+typedef struct {
+    uint64_t calls;
+    uint64_t overruns;               // Callbacks that ran longer than the handle's budget
+    uint64_t deadline_misses;        // Callbacks that finished after release + deadline
+    int64_t max_execution_ns;
+    int64_t max_response_ns;         // Release (first seen ready) to callback end
+} rclc_executor_handle_stats_t;
+
+typedef void (*rclc_subscription_callback_t)(const void* msg);
+typedef void (*rclc_subscription_callback_with_context_t)(const void* msg, void* context);
+typedef void (*rclc_service_callback_t)(const void* request, void* response);
+typedef void (*rclc_client_callback_t)(const void* response);
+
+typedef struct rclc_executor_handle_s {
+    rclc_executor_handle_type_t type;
+    rclc_executor_handle_invocation_t invocation;
+    void* handle;               // rcl_subscription_t* / rcl_timer_t* / rcl_client_t* / rcl_service_t*
+    void* data;                 // Message, request (service) or response (client)
+    void* response;             // Service response filled by the callback
+    rmw_request_id_t request_id;
+    rclc_subscription_callback_t subscription_callback;
+    rclc_subscription_callback_with_context_t subscription_callback_with_context;
+    rclc_service_callback_t service_callback;
+    rclc_client_callback_t client_callback;
+    void* callback_context;
+    size_t index;               // Position in the wait set array of its type
+    rclc_callback_group_t* callback_group;  // NULL = default group
+    struct rclc_executor_handle_s* group_next;  // Next handle of the same exclusive group
+    bool group_head;            // First handle of its exclusive group
+    int32_t priority;           // Higher runs first (RCLC_SCHED_FIXED_PRIORITY, EDF ties)
+    int64_t deadline_ns;        // Relative deadline; 0 = none (runs after all deadlines under EDF)
+    int64_t budget_ns;          // Execution-time budget; 0 = unlimited
+    int64_t release_ns;         // When a wait first saw it ready; 0 = not ready
+    bool dispatched;            // Already ran in the current spin
+    rclc_executor_handle_stats_t stats;
+    bool data_available;
+    bool initialized;
+} rclc_executor_handle_t;
+
+typedef bool (*rclc_executor_trigger_t)(rclc_executor_handle_t* handles, unsigned int size, void* obj);
+
+// Handle array is allocated once in rclc_executor_init (number_of_handles)
+typedef struct {
+    rcl_context_t* context;
+    rclc_executor_handle_t* handles;
+    size_t max_handles;
+    size_t index;               // Handles added so far
+    rcl_allocator_t allocator;
+    rcl_wait_set_t wait_set;
+    bool wait_set_valid;        // Rebuilt after handles are added
+    uint64_t timeout_ns;
+    rclc_executor_trigger_t trigger_function;
+    void* trigger_object;
+    void* thread_pool;          // WorkStealingPoolWASM; NULL = callbacks run on the spinning thread
+    void* work_items;           // One per handle, for the pool
+    rclc_executor_sched_policy_t sched_policy;
+} rclc_executor_t;
+
+// rcl API (implemented in rcl_port_wasm.cpp), used by the rclc port
+extern "C" {
+rcl_ret_t rcl_init(int argc, char const * const * argv, const rcl_init_options_t* options, rcl_context_t* context);
+rcl_ret_t rcl_node_init(rcl_node_t* node, const char* name, const char* namespace_,
+                        rcl_context_t* context, const rcl_node_options_t* options);
+rcl_ret_t rcl_publisher_init(rcl_publisher_t* publisher, const rcl_node_t* node,
+                             const rosidl_message_type_support_t* type_support, const char* topic_name,
+                             const rcl_publisher_options_t* options);
+rcl_ret_t rcl_publisher_fini(rcl_publisher_t* publisher, rcl_node_t* node);
+rcl_ret_t rcl_publish(const rcl_publisher_t* publisher, const void* ros_message,
+                      rmw_publisher_allocation_t* allocation);
+rcl_ret_t rcl_subscription_init(rcl_subscription_t* subscription, const rcl_node_t* node,
+                                const rosidl_message_type_support_t* type_support, const char* topic_name,
+                                const rcl_subscription_options_t* options);
+rcl_ret_t rcl_subscription_fini(rcl_subscription_t* subscription, rcl_node_t* node);
+rcl_ret_t rcl_take(const rcl_subscription_t* subscription, void* ros_message,
+                   rmw_message_info_t* message_info, rmw_subscription_allocation_t* allocation);
+rcl_ret_t rcl_service_init(rcl_service_t* service, const rcl_node_t* node,
+                           const rosidl_service_type_support_t* type_support, const char* service_name,
+                           const rcl_service_options_t* options);
+rcl_ret_t rcl_take_request(const rcl_service_t* service, rmw_request_id_t* request_header, void* ros_request);
+rcl_ret_t rcl_send_response(const rcl_service_t* service, rmw_request_id_t* response_header, void* ros_response);
+rcl_ret_t rcl_client_init(rcl_client_t* client, const rcl_node_t* node,
+                          const rosidl_service_type_support_t* type_support, const char* service_name,
+                          const rcl_client_options_t* options);
+rcl_ret_t rcl_send_request(const rcl_client_t* client, const void* ros_request, int64_t* sequence_number);
+rcl_ret_t rcl_take_response(const rcl_client_t* client, rmw_request_id_t* request_header, void* ros_response);
+rcl_ret_t rcl_client_take_timeout(const rcl_client_t* client, rmw_request_id_t* request_header);
+rcl_ret_t rcl_wait_set_init(rcl_wait_set_t* wait_set, size_t number_of_subscriptions,
+                            size_t number_of_guard_conditions, size_t number_of_timers,
+                            size_t number_of_clients, size_t number_of_services, size_t number_of_events,
+                            rcl_context_t* context, rcl_allocator_t allocator);
+rcl_ret_t rcl_wait_set_fini(rcl_wait_set_t* wait_set);
+rcl_ret_t rcl_wait_set_clear(rcl_wait_set_t* wait_set);
+rcl_ret_t rcl_wait_set_add_subscription(rcl_wait_set_t* wait_set, const rcl_subscription_t* subscription, size_t* index);
+rcl_ret_t rcl_wait_set_add_guard_condition(rcl_wait_set_t* wait_set, const rcl_guard_condition_t* guard_condition,
+                                           size_t* index);
+rcl_ret_t rcl_wait_set_add_timer(rcl_wait_set_t* wait_set, const rcl_timer_t* timer, size_t* index);
+rcl_ret_t rcl_wait_set_add_client(rcl_wait_set_t* wait_set, const rcl_client_t* client, size_t* index);
+rcl_ret_t rcl_wait_set_add_service(rcl_wait_set_t* wait_set, const rcl_service_t* service, size_t* index);
+rcl_ret_t rcl_wait(rcl_wait_set_t* wait_set, int64_t timeout);
+rcl_ret_t rcl_clock_init(rcl_clock_type_t clock_type, rcl_clock_t* clock, rcl_allocator_t* allocator);
+rcl_ret_t rcl_timer_init(rcl_timer_t* timer, rcl_clock_t* clock, rcl_context_t* context, int64_t period,
+                         const rcl_timer_callback_t callback, rcl_allocator_t allocator);
+rcl_ret_t rcl_timer_fini(rcl_timer_t* timer);
+rcl_ret_t rcl_timer_call(rcl_timer_t* timer);
+rcl_ret_t rcl_timer_is_ready(const rcl_timer_t* timer, bool* is_ready);
+rcl_ret_t rcl_timer_cancel(rcl_timer_t* timer);
+rcl_ret_t rcl_timer_reset(rcl_timer_t* timer);
+rcl_ret_t rcl_timer_get_time_until_next_call(const rcl_timer_t* timer, int64_t* time_until_next_call);
+rcl_ret_t rcl_timer_get_statistics(const rcl_timer_t* timer, rcl_timer_statistics_t* statistics);
+rcl_ret_t rcl_set_steady_clock(rcl_steady_clock_t clock);
+rcl_ret_t rcl_count_publishers(const rcl_node_t* node, const char* topic_name, size_t* count);
+rcl_ret_t rcl_count_subscribers(const rcl_node_t* node, const char* topic_name, size_t* count);
+rcl_ret_t rcl_get_topic_names_and_types(const rcl_node_t* node, rcl_allocator_t* allocator, bool no_demangle,
+                                        rcl_names_and_types_t* topic_names_and_types);
+rcl_ret_t rcl_names_and_types_fini(rcl_names_and_types_t* names_and_types);
+const rcl_guard_condition_t* rcl_node_get_graph_guard_condition(const rcl_node_t* node);
+rcl_ret_t rcl_trigger_guard_condition(rcl_guard_condition_t* guard_condition);
+rcl_ret_t rcl_context_add_activity_listener(rcl_context_t* context, rcl_context_activity_callback_t callback,
+                                            void* callback_context);
+rcl_ret_t rcl_context_remove_activity_listener(rcl_context_t* context, rcl_context_activity_callback_t callback,
+                                               void* callback_context);
+rcl_ret_t rcl_context_start_io_thread(rcl_context_t* context);
+rcl_ret_t rcl_context_get_io_statistics(const rcl_context_t* context, rcl_io_statistics_t* statistics);
+}
+
 #endif // RCL_TYPES_WASM_H
 
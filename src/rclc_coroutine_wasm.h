@@ -0,0 +1,792 @@
+/*
+ * Coroutine API for rclc in WASM (C++20)
+ *
+ * Lets a node be written as many small tasks instead of callbacks and
+ * polling:
+ *
+ *   CoroutineTaskWASM relay(CoroutineSubscriptionWASM<std_msgs__msg__Float64>& in,
+ *                           CoroutinePublisherWASM& out) {
+ *       for (;;) {
+ *           const std_msgs__msg__Float64& msg = co_await in.next();
+ *           co_await out.ready();
+ *           out.publish(&msg);
+ *       }
+ *   }
+ *   scheduler.spawn(relay(in, out));
+ *
+ * The scheduler is single-threaded and owns an rclc executor. Every pass it
+ * spins the executor once without blocking, then resumes the tasks that
+ * became runnable. Subscription and timer callbacks only queue data and
+ * tasks; they never resume a task from inside the executor. Two ways to run it:
+ * - browser: attachMainLoop() plus MainLoopDriverWASM(mainLoopWork()), so
+ *   passes run from requestAnimationFrame / setTimeout within the frame budget
+ * - native (and Node): run() blocks on a reactor (epoll + eventfd on Linux)
+ *   until data is signalled, a timer is due or a watched fd is readable
+ *
+ * Coroutine frames come from a per-thread pool of size classes, so spawning
+ * a task does not call malloc once the pool has warmed up.
+ *
+ * Subscriptions and timers are executor handles, so declare them after the
+ * scheduler: they must not be destroyed while it still spins.
+ *
+ * Include after rclc_port_wasm.cpp; needs -std=c++20.
+ */
+
+#ifndef RCLC_COROUTINE_WASM_H
+#define RCLC_COROUTINE_WASM_H
+
+#if __cplusplus < 202002L
+#error "rclc_coroutine_wasm.h needs C++20 (-std=c++20)"
+#endif
+
+#include "main_loop_wasm.h"
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <new>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#define RCLC_COROUTINE_WASM_HAS_EPOLL 1
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#else
+#define RCLC_COROUTINE_WASM_HAS_EPOLL 0
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#define COROUTINE_WASM_FRAME_CLASSES 6       // 64, 128 ... 2048 byte frames
+#define COROUTINE_WASM_FRAMES_PER_CHUNK 32
+
+struct CoroutineFramePoolStatsWASM {
+    uint64_t allocations;   // Frames handed out
+    uint64_t chunks;        // Pool refills (heap allocations)
+    uint64_t oversized;     // Frames above the largest class, taken from the heap
+    uint64_t in_use;
+    uint64_t peak_in_use;
+};
+
+// Free-list per size class; chunks are kept until the thread exits
+class CoroutineFramePoolWASM {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    FreeBlock* free_lists[COROUTINE_WASM_FRAME_CLASSES];
+    std::vector<void*> chunks;
+    CoroutineFramePoolStatsWASM stats;
+
+    static size_t blockSize(int size_class) { return static_cast<size_t>(64) << size_class; }
+
+    static int sizeClass(size_t size) {
+        for (int c = 0; c < COROUTINE_WASM_FRAME_CLASSES; c++) {
+            if (size <= blockSize(c)) return c;
+        }
+        return -1;
+    }
+
+    void refill(int size_class) {
+        size_t block = blockSize(size_class);
+        char* chunk = static_cast<char*>(::operator new(block * COROUTINE_WASM_FRAMES_PER_CHUNK));
+        chunks.push_back(chunk);
+        stats.chunks++;
+        for (size_t i = 0; i < COROUTINE_WASM_FRAMES_PER_CHUNK; i++) {
+            FreeBlock* free_block = reinterpret_cast<FreeBlock*>(chunk + i * block);
+            free_block->next = free_lists[size_class];
+            free_lists[size_class] = free_block;
+        }
+    }
+
+public:
+    CoroutineFramePoolWASM() : stats() {
+        for (int c = 0; c < COROUTINE_WASM_FRAME_CLASSES; c++) {
+            free_lists[c] = nullptr;
+        }
+    }
+
+    ~CoroutineFramePoolWASM() {
+        for (void* chunk : chunks) {
+            ::operator delete(chunk);
+        }
+    }
+
+    CoroutineFramePoolWASM(const CoroutineFramePoolWASM&) = delete;
+    CoroutineFramePoolWASM& operator=(const CoroutineFramePoolWASM&) = delete;
+
+    void* allocate(size_t size) {
+        stats.allocations++;
+        if (++stats.in_use > stats.peak_in_use) {
+            stats.peak_in_use = stats.in_use;
+        }
+        int size_class = sizeClass(size);
+        if (size_class < 0) {
+            stats.oversized++;
+            return ::operator new(size);
+        }
+        if (!free_lists[size_class]) {
+            refill(size_class);
+        }
+        FreeBlock* block = free_lists[size_class];
+        free_lists[size_class] = block->next;
+        return block;
+    }
+
+    // size must be the one passed to allocate()
+    void deallocate(void* frame, size_t size) {
+        stats.in_use--;
+        int size_class = sizeClass(size);
+        if (size_class < 0) {
+            ::operator delete(frame);
+            return;
+        }
+        FreeBlock* block = static_cast<FreeBlock*>(frame);
+        block->next = free_lists[size_class];
+        free_lists[size_class] = block;
+    }
+
+    const CoroutineFramePoolStatsWASM& getStats() const { return stats; }
+
+    // Frames are created and destroyed on the scheduler's thread
+    static CoroutineFramePoolWASM& local() {
+        thread_local CoroutineFramePoolWASM pool;
+        return pool;
+    }
+};
+
+class CoroutineSchedulerWASM;
+
+// A lazily started task. Either spawn() it on a scheduler, which then owns it,
+// or co_await it from another task.
+class CoroutineTaskWASM {
+public:
+    struct promise_type;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(handle_type handle) noexcept;
+        void await_resume() const noexcept {}
+    };
+
+    struct promise_type {
+        std::coroutine_handle<> continuation;  // Task awaiting this one, if any
+        CoroutineSchedulerWASM* scheduler;     // Set by spawn(); reaps the frame once done
+        promise_type* prev;                    // Scheduler's list of spawned tasks
+        promise_type* next;
+
+        promise_type() : scheduler(nullptr), prev(nullptr), next(nullptr) {}
+
+        static void* operator new(size_t size) {
+            return CoroutineFramePoolWASM::local().allocate(size);
+        }
+
+        static void operator delete(void* frame, size_t size) {
+            CoroutineFramePoolWASM::local().deallocate(frame, size);
+        }
+
+        CoroutineTaskWASM get_return_object() { return CoroutineTaskWASM(handle_type::from_promise(*this)); }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+private:
+    handle_type handle;
+
+    explicit CoroutineTaskWASM(handle_type handle) : handle(handle) {}
+
+public:
+    CoroutineTaskWASM(CoroutineTaskWASM&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    CoroutineTaskWASM& operator=(CoroutineTaskWASM&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    ~CoroutineTaskWASM() {
+        if (handle) handle.destroy();
+    }
+
+    CoroutineTaskWASM(const CoroutineTaskWASM&) = delete;
+    CoroutineTaskWASM& operator=(const CoroutineTaskWASM&) = delete;
+
+    handle_type release() { return std::exchange(handle, nullptr); }
+
+    // Runs the task to completion inside the awaiting one
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            handle_type handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+                handle.promise().continuation = caller;
+                return handle;
+            }
+
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{handle};
+    }
+};
+
+// Blocks run() until woken from any thread or the timeout expires
+class CoroutineReactorWASM {
+private:
+    std::atomic<bool> signalled;  // Coalesces wake() calls between two waits
+#if RCLC_COROUTINE_WASM_HAS_EPOLL
+    int epoll_fd;
+    int event_fd;
+#else
+    std::mutex mutex;
+    std::condition_variable woken;
+#endif
+
+public:
+    CoroutineReactorWASM() : signalled(false) {
+#if RCLC_COROUTINE_WASM_HAS_EPOLL
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epoll_fd < 0 || event_fd < 0) {
+            printf("WASM: coroutine reactor: epoll/eventfd setup failed\n");
+        }
+        watch(event_fd);
+#endif
+    }
+
+    ~CoroutineReactorWASM() {
+#if RCLC_COROUTINE_WASM_HAS_EPOLL
+        if (event_fd >= 0) close(event_fd);
+        if (epoll_fd >= 0) close(epoll_fd);
+#endif
+    }
+
+    CoroutineReactorWASM(const CoroutineReactorWASM&) = delete;
+    CoroutineReactorWASM& operator=(const CoroutineReactorWASM&) = delete;
+
+    // Wakes wait() whenever fd is readable, e.g. a native UDP socket
+    bool watch(int fd) {
+#if RCLC_COROUTINE_WASM_HAS_EPOLL
+        if (epoll_fd < 0 || fd < 0) return false;
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+#else
+        (void)fd;
+        return false;
+#endif
+    }
+
+    void wake() {
+        if (signalled.exchange(true)) return;
+#if RCLC_COROUTINE_WASM_HAS_EPOLL
+        uint64_t one = 1;
+        if (write(event_fd, &one, sizeof(one)) < 0) {
+            // Counter saturated: a wake-up is pending anyway
+        }
+#else
+        std::lock_guard<std::mutex> lock(mutex);
+        woken.notify_one();
+#endif
+    }
+
+    // timeout_ms < 0 waits for wake() or a watched fd
+    void wait(double timeout_ms) {
+#if RCLC_COROUTINE_WASM_HAS_EPOLL
+        if (!signalled.load()) {
+            int timeout = timeout_ms < 0 ? -1 : static_cast<int>(timeout_ms + 0.999);
+            struct epoll_event events[8];
+            epoll_wait(epoll_fd, events, 8, timeout);
+        }
+        uint64_t count;
+        if (read(event_fd, &count, sizeof(count)) < 0) {
+            // EAGAIN: woken by a timeout or a watched fd
+        }
+        signalled = false;
+#else
+        std::unique_lock<std::mutex> lock(mutex);
+        if (timeout_ms < 0) {
+            woken.wait(lock, [this] { return signalled.load(); });
+        } else {
+            woken.wait_for(lock, std::chrono::duration<double, std::milli>(timeout_ms),
+                           [this] { return signalled.load(); });
+        }
+        signalled = false;
+#endif
+    }
+};
+
+class CoroutineTimerWASM;
+
+class CoroutineSchedulerWASM {
+private:
+    rclc_executor_t executor;
+    rcl_context_t* context;
+    bool executor_ready;
+    std::vector<std::coroutine_handle<>> ready;  // Ring of runnable tasks
+    size_t ready_head;
+    size_t ready_count;
+    std::vector<std::coroutine_handle<>> retired;  // Spawned tasks that finished this pass
+    CoroutineTaskWASM::promise_type* tasks;         // Spawned tasks still alive
+    size_t live_tasks;
+    std::vector<CoroutineTimerWASM*> timers;
+    CoroutineReactorWASM reactor;
+    MainLoopDriverWASM* driver;
+    double poll_ms;
+    bool in_pass;
+    std::atomic<bool> stopping;
+    uint64_t passes;
+    uint64_t resumes;
+
+    static CoroutineSchedulerWASM*& active() {
+        thread_local CoroutineSchedulerWASM* scheduler = nullptr;
+        return scheduler;
+    }
+
+    void wake() {
+        reactor.wake();
+        if (driver) driver->notify();
+    }
+
+    static void onActivity(void* scheduler) {
+        static_cast<CoroutineSchedulerWASM*>(scheduler)->wake();
+    }
+
+    static bool mainLoopSpin(void* scheduler) {
+        return static_cast<CoroutineSchedulerWASM*>(scheduler)->runOnce();
+    }
+
+    static double mainLoopNextDueMs(void* scheduler) {
+        return static_cast<CoroutineSchedulerWASM*>(scheduler)->nextDueMs();
+    }
+
+    void timerFired(rcl_timer_t* timer);
+
+    friend class CoroutineTimerWASM;
+    friend struct CoroutineTaskWASM::FinalAwaiter;
+
+public:
+    // max_handles: subscriptions + timers the tasks will await
+    CoroutineSchedulerWASM(rclc_support_t* support, size_t max_handles, rcl_allocator_t* allocator)
+        : context(support ? support->context : nullptr), executor_ready(false), ready(64), ready_head(0),
+          ready_count(0), tasks(nullptr), live_tasks(0), driver(nullptr), poll_ms(-1.0), in_pass(false),
+          stopping(false), passes(0), resumes(0) {
+        executor_ready = context && max_handles > 0 &&
+                         rclc_executor_init(&executor, context, max_handles, allocator) == RCL_RET_OK;
+        if (!executor_ready) {
+            printf("WASM: coroutine scheduler: executor init failed\n");
+        }
+        if (context) {
+            rcl_context_add_activity_listener(context, &CoroutineSchedulerWASM::onActivity, this);
+        }
+    }
+
+    ~CoroutineSchedulerWASM() {
+        if (context) {
+            rcl_context_remove_activity_listener(context, &CoroutineSchedulerWASM::onActivity, this);
+        }
+        while (tasks) {
+            CoroutineTaskWASM::promise_type* promise = tasks;
+            tasks = promise->next;
+            CoroutineTaskWASM::handle_type::from_promise(*promise).destroy();
+        }
+        if (executor_ready) {
+            rclc_executor_fini(&executor);
+        }
+    }
+
+    CoroutineSchedulerWASM(const CoroutineSchedulerWASM&) = delete;
+    CoroutineSchedulerWASM& operator=(const CoroutineSchedulerWASM&) = delete;
+
+    rclc_executor_t* getExecutor() { return executor_ready ? &executor : nullptr; }
+
+    // Takes ownership; the task first runs on the next pass
+    void spawn(CoroutineTaskWASM task) {
+        CoroutineTaskWASM::handle_type handle = task.release();
+        if (!handle) return;
+        CoroutineTaskWASM::promise_type& promise = handle.promise();
+        promise.scheduler = this;
+        promise.next = tasks;
+        if (tasks) tasks->prev = &promise;
+        tasks = &promise;
+        live_tasks++;
+        schedule(handle);
+    }
+
+    // Resumes handle on the next pass (or later in the current one)
+    void schedule(std::coroutine_handle<> handle) {
+        if (ready_count == ready.size()) {
+            std::vector<std::coroutine_handle<>> grown(ready.size() * 2);
+            for (size_t i = 0; i < ready_count; i++) {
+                grown[i] = ready[(ready_head + i) % ready.size()];
+            }
+            ready.swap(grown);
+            ready_head = 0;
+        }
+        ready[(ready_head + ready_count) % ready.size()] = handle;
+        ready_count++;
+        if (!in_pass) wake();
+    }
+
+    // co_await scheduler.yield(): let every other runnable task go first
+    auto yield() {
+        struct Awaiter {
+            CoroutineSchedulerWASM* scheduler;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { scheduler->schedule(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{this};
+    }
+
+    // One pass: spin the executor without blocking, then resume what was
+    // runnable before the pass. Returns true while work is left.
+    bool runOnce() {
+        bool more = false;
+        in_pass = true;
+        if (executor_ready) {
+            CoroutineSchedulerWASM* previous = active();
+            active() = this;
+            more = rclc_executor_spin_some(&executor, 0) == RCL_RET_OK;
+            active() = previous;
+        }
+        // Tasks scheduled while these run go to the next pass
+        for (size_t n = ready_count; n > 0; n--) {
+            std::coroutine_handle<> handle = ready[ready_head];
+            ready_head = (ready_head + 1) % ready.size();
+            ready_count--;
+            handle.resume();
+            resumes++;
+        }
+        for (std::coroutine_handle<> handle : retired) {
+            CoroutineTaskWASM::promise_type& promise =
+                CoroutineTaskWASM::handle_type::from_address(handle.address()).promise();
+            if (promise.prev) promise.prev->next = promise.next;
+            else tasks = promise.next;
+            if (promise.next) promise.next->prev = promise.prev;
+            handle.destroy();
+            live_tasks--;
+        }
+        retired.clear();
+        in_pass = false;
+        passes++;
+        return more || ready_count > 0;
+    }
+
+    // 0 when tasks are runnable, time to the next timer, or < 0 when idle until data
+    double nextDueMs() {
+        if (ready_count > 0) return 0.0;
+        return executor_ready ? rclc_executor_main_loop_next_due_ms(&executor) : -1.0;
+    }
+
+    // Native / Node: pass after pass until every spawned task is done or stop()
+    void run() {
+        stopping = false;
+        while (live_tasks > 0 && !stopping) {
+            if (runOnce() || live_tasks == 0 || stopping) continue;
+            double due = nextDueMs();
+            if (poll_ms >= 0 && (due < 0 || due > poll_ms)) {
+                due = poll_ms;
+            }
+            if (due != 0) {
+                reactor.wait(due);
+            }
+        }
+    }
+
+    // Thread-safe
+    void stop() {
+        stopping = true;
+        reactor.wake();
+    }
+
+    // Network input is only read by rcl_wait; bound the idle wait when remote
+    // data does not arrive through a watched fd. < 0 disables.
+    void setPollIntervalMs(double interval_ms) { poll_ms = interval_ms; }
+
+    bool watchFd(int fd) { return reactor.watch(fd); }
+
+    // Browser: passes run from the driver, woken by data and by spawn()
+    void attachMainLoop(MainLoopDriverWASM* main_loop) { driver = main_loop; }
+
+    MainLoopWorkWASM mainLoopWork() {
+        MainLoopWorkWASM work;
+        work.spin = &CoroutineSchedulerWASM::mainLoopSpin;
+        work.next_due_ms = &CoroutineSchedulerWASM::mainLoopNextDueMs;
+        work.context = this;
+        return work;
+    }
+
+    size_t getLiveTasks() const { return live_tasks; }
+    uint64_t getPasses() const { return passes; }
+    uint64_t getResumes() const { return resumes; }
+};
+
+inline std::coroutine_handle<> CoroutineTaskWASM::FinalAwaiter::await_suspend(handle_type handle) noexcept {
+    promise_type& promise = handle.promise();
+    if (promise.scheduler) {
+        promise.scheduler->retired.push_back(handle);
+        return std::noop_coroutine();
+    }
+    if (promise.continuation) {
+        return promise.continuation;
+    }
+    return std::noop_coroutine();
+}
+
+// Buffers up to Depth messages (oldest dropped first, like the RMW queue) so a
+// task busy elsewhere loses nothing. Several tasks may await next(); each
+// message goes to one of them, in arrival order. The value returned by next()
+// stays valid until the next next() on this subscription.
+template <typename Msg, size_t Depth = RMW_WASM_SUBSCRIPTION_DEPTH>
+class CoroutineSubscriptionWASM {
+private:
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        Waiter* next;
+    };
+
+    CoroutineSchedulerWASM& scheduler;
+    void (*fini)(Msg*);
+    Msg incoming;  // Executor takes into this one
+    Msg current;   // Handed out by next()
+    Msg ring[Depth];
+    size_t head;
+    size_t count;
+    size_t reserved;  // Messages promised to waiters already scheduled
+    Waiter* waiters_head;
+    Waiter* waiters_tail;
+    uint64_t received;
+    uint64_t dropped;
+    bool added;
+
+    // Messages own their buffers through pointers (e.g. strings), so slots
+    // are swapped, never copied
+    static void onMessage(const void*, void* context) {
+        CoroutineSubscriptionWASM* self = static_cast<CoroutineSubscriptionWASM*>(context);
+        if (self->count == Depth) {
+            self->head = (self->head + 1) % Depth;
+            self->count--;
+            self->dropped++;
+        }
+        std::swap(self->ring[(self->head + self->count) % Depth], self->incoming);
+        self->count++;
+        self->received++;
+        if (self->waiters_head && self->count > self->reserved) {
+            Waiter* waiter = self->waiters_head;
+            self->waiters_head = waiter->next;
+            if (!self->waiters_head) self->waiters_tail = nullptr;
+            self->reserved++;
+            self->scheduler.schedule(waiter->handle);
+        }
+    }
+
+    const Msg& pop() {
+        std::swap(current, ring[head]);
+        head = (head + 1) % Depth;
+        count--;
+        return current;
+    }
+
+public:
+    // fini releases what the message owns (e.g. std_msgs__msg__String__fini); nullptr for plain data
+    CoroutineSubscriptionWASM(CoroutineSchedulerWASM& scheduler, rcl_subscription_t* subscription,
+                              void (*fini)(Msg*) = nullptr)
+        : scheduler(scheduler), fini(fini), incoming(), current(), ring(), head(0), count(0), reserved(0),
+          waiters_head(nullptr), waiters_tail(nullptr), received(0), dropped(0), added(false) {
+        rclc_executor_t* executor = scheduler.getExecutor();
+        added = executor && rclc_executor_add_subscription_with_context(
+                                executor, subscription, &incoming, &CoroutineSubscriptionWASM::onMessage, this,
+                                ON_NEW_DATA) == RCL_RET_OK;
+        if (!added) {
+            printf("WASM: coroutine subscription: no executor handle left\n");
+        }
+    }
+
+    ~CoroutineSubscriptionWASM() {
+        if (!fini) return;
+        fini(&incoming);
+        fini(&current);
+        for (size_t i = 0; i < Depth; i++) {
+            fini(&ring[i]);
+        }
+    }
+
+    CoroutineSubscriptionWASM(const CoroutineSubscriptionWASM&) = delete;
+    CoroutineSubscriptionWASM& operator=(const CoroutineSubscriptionWASM&) = delete;
+
+    // co_await subscription.next() -> const Msg&
+    auto next() {
+        struct Awaiter {
+            CoroutineSubscriptionWASM* self;
+            Waiter waiter;
+
+            bool await_ready() const noexcept { return self->count > self->reserved; }
+
+            void await_suspend(std::coroutine_handle<> handle) {
+                waiter.handle = handle;
+                waiter.next = nullptr;
+                if (self->waiters_tail) self->waiters_tail->next = &waiter;
+                else self->waiters_head = &waiter;
+                self->waiters_tail = &waiter;
+            }
+
+            const Msg& await_resume() {
+                if (waiter.handle) self->reserved--;
+                return self->pop();
+            }
+        };
+        return Awaiter{this, Waiter{nullptr, nullptr}};
+    }
+
+    bool isAdded() const { return added; }
+    size_t getQueued() const { return count; }
+    uint64_t getReceived() const { return received; }
+    uint64_t getDropped() const { return dropped; }
+};
+
+// publish() never blocks here (delivery is queued by the RMW); ready() is the
+// cooperative point that lets consumers run before the next message
+class CoroutinePublisherWASM {
+private:
+    CoroutineSchedulerWASM& scheduler;
+    const rcl_publisher_t* publisher;
+    uint64_t published;
+    uint64_t failed;
+
+public:
+    CoroutinePublisherWASM(CoroutineSchedulerWASM& scheduler, const rcl_publisher_t* publisher)
+        : scheduler(scheduler), publisher(publisher), published(0), failed(0) {}
+
+    // co_await publisher.ready(): resumes on the next pass
+    auto ready() { return scheduler.yield(); }
+
+    rcl_ret_t publish(const void* ros_message) {
+        rcl_ret_t ret = rcl_publish(publisher, ros_message, NULL);
+        if (ret == RCL_RET_OK) published++;
+        else failed++;
+        return ret;
+    }
+
+    uint64_t getPublished() const { return published; }
+    uint64_t getFailed() const { return failed; }
+};
+
+// Owns an rcl timer on the scheduler's executor. Every period wakes all tasks
+// awaiting tick(); periods nobody awaited are counted and returned by the
+// next tick() without suspending.
+class CoroutineTimerWASM {
+private:
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        Waiter* next;
+    };
+
+    CoroutineSchedulerWASM& scheduler;
+    rcl_timer_t timer;
+    uint64_t pending;
+    uint64_t ticks;
+    Waiter* waiters;
+    bool added;
+
+    static void onTimer(rcl_timer_t* timer, int64_t) {
+        CoroutineSchedulerWASM* scheduler = CoroutineSchedulerWASM::active();
+        if (scheduler) scheduler->timerFired(timer);
+    }
+
+    void fire() {
+        ticks++;
+        if (!waiters) {
+            pending++;
+            return;
+        }
+        while (waiters) {
+            Waiter* waiter = waiters;
+            waiters = waiter->next;
+            scheduler.schedule(waiter->handle);
+        }
+    }
+
+    friend class CoroutineSchedulerWASM;
+
+public:
+    CoroutineTimerWASM(CoroutineSchedulerWASM& scheduler, rclc_support_t* support, int64_t period_ns)
+        : scheduler(scheduler), timer(), pending(0), ticks(0), waiters(nullptr), added(false) {
+        rclc_executor_t* executor = scheduler.getExecutor();
+        added = executor &&
+                rclc_timer_init_default(&timer, support, period_ns, &CoroutineTimerWASM::onTimer) == RCL_RET_OK &&
+                rclc_executor_add_timer(executor, &timer) == RCL_RET_OK;
+        if (!added) {
+            printf("WASM: coroutine timer: init failed\n");
+            return;
+        }
+        scheduler.timers.push_back(this);
+    }
+
+    ~CoroutineTimerWASM() {
+        for (size_t i = 0; i < scheduler.timers.size(); i++) {
+            if (scheduler.timers[i] == this) {
+                scheduler.timers.erase(scheduler.timers.begin() + i);
+                break;
+            }
+        }
+        if (timer.impl) {
+            rcl_timer_fini(&timer);
+        }
+    }
+
+    CoroutineTimerWASM(const CoroutineTimerWASM&) = delete;
+    CoroutineTimerWASM& operator=(const CoroutineTimerWASM&) = delete;
+
+    // co_await timer.tick() -> periods elapsed since the caller last ticked (normally 1)
+    auto tick() {
+        struct Awaiter {
+            CoroutineTimerWASM* self;
+            Waiter waiter;
+            uint64_t periods;
+
+            bool await_ready() noexcept {
+                periods = self->pending;
+                self->pending = 0;
+                return periods > 0;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) {
+                waiter.handle = handle;
+                waiter.next = self->waiters;
+                self->waiters = &waiter;
+            }
+
+            uint64_t await_resume() const noexcept { return periods > 0 ? periods : 1; }
+        };
+        return Awaiter{this, Waiter{nullptr, nullptr}, 0};
+    }
+
+    rcl_timer_t* getTimer() { return &timer; }
+    bool isAdded() const { return added; }
+    uint64_t getTicks() const { return ticks; }
+};
+
+inline void CoroutineSchedulerWASM::timerFired(rcl_timer_t* timer) {
+    for (CoroutineTimerWASM* coroutine_timer : timers) {
+        if (&coroutine_timer->timer == timer) {
+            coroutine_timer->fire();
+            return;
+        }
+    }
+}
+
+#endif // RCLC_COROUTINE_WASM_H
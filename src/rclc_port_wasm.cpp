@@ -5,11 +5,17 @@
  * rclc provides a C convenience API on top of rcl.
  */
 
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
 #include <string>
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include "rcl_types_wasm.h"
+#include "rcl_allocator_wasm.h"
+#include "main_loop_wasm.h"
+#include "work_stealing_pool_wasm.h"
+#include "trace_wasm.h"
 
 // TODO: Include actual rclc headers when ported
 // #include <rclc/rclc.h>
@@ -23,10 +29,21 @@ extern "C" rcl_ret_t rclc_support_init(
     void* allocator)
 {
     printf("WASM: rclc_support_init called\n");
-    // TODO: Initialize rclc support
-    // - Call rcl_init
-    // - Setup context
-    return RCL_RET_OK;
+    if (!support) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    
+    support->allocator = allocator;
+    rcl_allocator_t alloc = allocator ? *static_cast<const rcl_allocator_t*>(allocator) : rcl_get_default_allocator();
+    support->context = static_cast<rcl_context_t*>(alloc.zero_allocate(1, sizeof(rcl_context_t), alloc.state));
+    if (!support->context) {
+        return RCL_RET_BAD_ALLOC;
+    }
+    
+    rcl_init_options_t options;
+    options.context = support->context;
+    options.allocator = allocator;
+    return rcl_init(argc, argv, &options, support->context);
 }
 
 // rclc_node_init_default - Initialize node with default options
@@ -37,9 +54,11 @@ extern "C" rcl_ret_t rclc_node_init_default(
     rclc_support_t* support)
 {
     printf("WASM: rclc_node_init_default called: %s\n", name);
-    // TODO: Initialize node with defaults
-    // - Call rcl_node_init with default options
-    return RCL_RET_OK;
+    if (!support) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rcl_node_options_t options = {0};
+    return rcl_node_init(node, name, namespace_, support->context, &options);
 }
 
 // rclc_publisher_init_default - Initialize publisher with defaults
@@ -50,9 +69,8 @@ extern "C" rcl_ret_t rclc_publisher_init_default(
     const char* topic_name)
 {
     printf("WASM: rclc_publisher_init_default called: %s\n", topic_name);
-    // TODO: Initialize publisher with defaults
-    // - Call rcl_publisher_init with default options
-    return RCL_RET_OK;
+    rcl_publisher_options_t options = {0};
+    return rcl_publisher_init(publisher, node, type_support, topic_name, &options);
 }
 
 // rclc_subscription_init_default - Initialize subscriber with defaults
@@ -63,51 +81,732 @@ extern "C" rcl_ret_t rclc_subscription_init_default(
     const char* topic_name)
 {
     printf("WASM: rclc_subscription_init_default called: %s\n", topic_name);
-    // TODO: Initialize subscriber with defaults
-    // - Call rcl_subscription_init with default options
-    return RCL_RET_OK;
+    rcl_subscription_options_t options = {0};
+    return rcl_subscription_init(subscription, node, type_support, topic_name, &options);
+}
+
+// rclc_service_init_default - Initialize service server with defaults
+extern "C" rcl_ret_t rclc_service_init_default(
+    rcl_service_t* service,
+    const rcl_node_t* node,
+    const rosidl_service_type_support_t* type_support,
+    const char* service_name)
+{
+    printf("WASM: rclc_service_init_default called: %s\n", service_name);
+    rcl_service_options_t options = {0};
+    return rcl_service_init(service, node, type_support, service_name, &options);
+}
+
+// rclc_client_init_default - Initialize service client with defaults (no request timeout)
+extern "C" rcl_ret_t rclc_client_init_default(
+    rcl_client_t* client,
+    const rcl_node_t* node,
+    const rosidl_service_type_support_t* type_support,
+    const char* service_name)
+{
+    printf("WASM: rclc_client_init_default called: %s\n", service_name);
+    rcl_client_options_t options = {0};
+    return rcl_client_init(client, node, type_support, service_name, &options);
 }
 
-// rclc_executor_init - Initialize executor
+// rclc_timer_init_default - Timer on the steady clock, using the support's allocator
+extern "C" rcl_ret_t rclc_timer_init_default(
+    rcl_timer_t* timer,
+    rclc_support_t* support,
+    const uint64_t timeout_ns,
+    const rcl_timer_callback_t callback)
+{
+    printf("WASM: rclc_timer_init_default called\n");
+    if (!support) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rcl_clock_t clock;
+    rcl_clock_init(RCL_STEADY_TIME, &clock, NULL);
+    rcl_allocator_t allocator = support->allocator ? *static_cast<const rcl_allocator_t*>(support->allocator)
+                                                   : rcl_get_default_allocator();
+    return rcl_timer_init(timer, &clock, support->context, static_cast<int64_t>(timeout_ns), callback, allocator);
+}
+
+// Trigger conditions: decide, after the wait, whether this spin dispatches at all
+extern "C" bool rclc_executor_trigger_any(rclc_executor_handle_t* handles, unsigned int size, void* /* obj */)
+{
+    for (unsigned int i = 0; i < size; i++) {
+        if (handles[i].data_available) return true;
+    }
+    return false;
+}
+
+extern "C" bool rclc_executor_trigger_all(rclc_executor_handle_t* handles, unsigned int size, void* /* obj */)
+{
+    for (unsigned int i = 0; i < size; i++) {
+        if (!handles[i].data_available) return false;
+    }
+    return size > 0;
+}
+
+// obj is the rcl handle (e.g. rcl_subscription_t*) that must be ready
+extern "C" bool rclc_executor_trigger_one(rclc_executor_handle_t* handles, unsigned int size, void* obj)
+{
+    for (unsigned int i = 0; i < size; i++) {
+        if (handles[i].handle == obj) return handles[i].data_available;
+    }
+    return false;
+}
+
+extern "C" bool rclc_executor_trigger_always(rclc_executor_handle_t* /* handles */, unsigned int /* size */,
+                                              void* /* obj */)
+{
+    return true;
+}
+
+// rclc_executor_init - Allocate the handle array (number_of_handles) once
 extern "C" rcl_ret_t rclc_executor_init(
     rclc_executor_t* executor,
     rcl_context_t* context,
     size_t number_of_handles,
     void* allocator)
 {
-    printf("WASM: rclc_executor_init called\n");
-    // TODO: Initialize executor
-    // - Setup callback handling
-    // - Allocate handle storage
+    printf("WASM: rclc_executor_init called (%zu handles)\n", number_of_handles);
+    if (!executor || number_of_handles == 0) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    
+    memset(executor, 0, sizeof(*executor));
+    executor->allocator = allocator ? *static_cast<const rcl_allocator_t*>(allocator) : rcl_get_default_allocator();
+    executor->handles = static_cast<rclc_executor_handle_t*>(executor->allocator.zero_allocate(
+        number_of_handles, sizeof(rclc_executor_handle_t), executor->allocator.state));
+    if (!executor->handles) {
+        return RCL_RET_BAD_ALLOC;
+    }
+    executor->context = context;
+    executor->max_handles = number_of_handles;
+    executor->timeout_ns = 100000000;  // 100ms, as in rclc
+    executor->trigger_function = rclc_executor_trigger_any;
+    return RCL_RET_OK;
+}
+
+// rclc_executor_fini - Release the handle array and wait set
+extern "C" rcl_ret_t rclc_executor_fini(rclc_executor_t* executor)
+{
+    if (!executor) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    if (executor->wait_set.impl) {
+        rcl_wait_set_fini(&executor->wait_set);
+    }
+    delete static_cast<WorkStealingPoolWASM*>(executor->thread_pool);
+    if (executor->work_items) {
+        executor->allocator.deallocate(executor->work_items, executor->allocator.state);
+    }
+    if (executor->handles) {
+        executor->allocator.deallocate(executor->handles, executor->allocator.state);
+    }
+    memset(executor, 0, sizeof(*executor));
+    return RCL_RET_OK;
+}
+
+extern "C" rcl_ret_t rclc_executor_set_trigger(
+    rclc_executor_t* executor,
+    rclc_executor_trigger_t trigger_function,
+    void* trigger_object)
+{
+    if (!executor || !trigger_function) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    executor->trigger_function = trigger_function;
+    executor->trigger_object = trigger_object;
+    return RCL_RET_OK;
+}
+
+extern "C" rcl_ret_t rclc_executor_set_timeout(rclc_executor_t* executor, uint64_t timeout_ns)
+{
+    if (!executor) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    executor->timeout_ns = timeout_ns;
+    return RCL_RET_OK;
+}
+
+// rclc_executor_set_num_threads - Run callbacks on a work-stealing pool of
+// number_of_threads (including the spinning thread); 1 = back to inline dispatch.
+// Callbacks only overlap across callback groups (WASM extension)
+extern "C" rcl_ret_t rclc_executor_set_num_threads(rclc_executor_t* executor, size_t number_of_threads)
+{
+    if (!executor || !executor->handles) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    delete static_cast<WorkStealingPoolWASM*>(executor->thread_pool);
+    executor->thread_pool = nullptr;
+    if (number_of_threads <= 1) {
+        return RCL_RET_OK;
+    }
+    
+    if (!executor->work_items) {
+        executor->work_items = executor->allocator.allocate(executor->max_handles * sizeof(WorkItemWASM),
+                                                            executor->allocator.state);
+        if (!executor->work_items) {
+            return RCL_RET_BAD_ALLOC;
+        }
+    }
+    WorkStealingPoolWASM* pool = new WorkStealingPoolWASM(number_of_threads, executor->max_handles);
+    executor->thread_pool = pool;
+    printf("WASM: Executor dispatching on %zu threads\n", pool->getThreadCount());
+    return RCL_RET_OK;
+}
+
+// rclc_callback_group_init - Group to pass to rclc_executor_set_callback_group (WASM extension)
+extern "C" rcl_ret_t rclc_callback_group_init(rclc_callback_group_t* group, rclc_callback_group_type_t type)
+{
+    if (!group) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    group->type = type;
+    return RCL_RET_OK;
+}
+
+// Same steady clock as rcl timers, in nanoseconds
+static int64_t rclc_wasm_now_ns()
+{
+    return static_cast<int64_t>(emscripten_get_now() * 1000000.0);
+}
+
+// Executor handle wrapping an rcl handle (rcl_subscription_t*, rcl_timer_t*, ...), or NULL
+static rclc_executor_handle_t* rclc_executor_find_handle(const rclc_executor_t* executor, const void* rcl_handle)
+{
+    if (!executor || !rcl_handle) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < executor->index; i++) {
+        if (executor->handles[i].handle == rcl_handle) {
+            return &executor->handles[i];
+        }
+    }
+    return nullptr;
+}
+
+// rclc_executor_set_callback_group - Move an added handle into `group`;
+// NULL puts it back into the default group (WASM extension)
+extern "C" rcl_ret_t rclc_executor_set_callback_group(
+    rclc_executor_t* executor,
+    const void* rcl_handle,
+    rclc_callback_group_t* group)
+{
+    rclc_executor_handle_t* handle = rclc_executor_find_handle(executor, rcl_handle);
+    if (!handle) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    handle->callback_group = group;
+    executor->wait_set_valid = false;  // Group chains are rebuilt with the wait set
+    return RCL_RET_OK;
+}
+
+// rclc_executor_set_scheduling - Dispatch order within a spin. Under FIXED_PRIORITY
+// and EDF the executor waits again after every callback, so work that arrived
+// meanwhile can overtake the rest of the spin (WASM extension)
+extern "C" rcl_ret_t rclc_executor_set_scheduling(rclc_executor_t* executor, rclc_executor_sched_policy_t policy)
+{
+    if (!executor) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    executor->sched_policy = policy;
+    return RCL_RET_OK;
+}
+
+// rclc_executor_set_handle_scheduling - Priority (higher first), relative deadline
+// and execution-time budget of an added handle; 0 disables deadline / budget (WASM extension)
+extern "C" rcl_ret_t rclc_executor_set_handle_scheduling(
+    rclc_executor_t* executor,
+    const void* rcl_handle,
+    int32_t priority,
+    int64_t deadline_ns,
+    int64_t budget_ns)
+{
+    rclc_executor_handle_t* handle = rclc_executor_find_handle(executor, rcl_handle);
+    if (!handle || deadline_ns < 0 || budget_ns < 0) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    handle->priority = priority;
+    handle->deadline_ns = deadline_ns;
+    handle->budget_ns = budget_ns;
+    return RCL_RET_OK;
+}
+
+// rclc_executor_get_handle_stats - Calls, budget overruns, deadline misses and
+// worst execution/response times of an added handle (WASM extension)
+extern "C" rcl_ret_t rclc_executor_get_handle_stats(
+    const rclc_executor_t* executor,
+    const void* rcl_handle,
+    rclc_executor_handle_stats_t* stats)
+{
+    const rclc_executor_handle_t* handle = rclc_executor_find_handle(executor, rcl_handle);
+    if (!handle || !stats) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    *stats = handle->stats;
     return RCL_RET_OK;
 }
 
+// Next free handle, or NULL when number_of_handles is used up
+static rclc_executor_handle_t* rclc_executor_next_handle(rclc_executor_t* executor, void* rcl_handle,
+                                                         rclc_executor_handle_type_t type,
+                                                         rclc_executor_handle_invocation_t invocation)
+{
+    if (!executor || !executor->handles || !rcl_handle) {
+        return nullptr;
+    }
+    if (executor->index >= executor->max_handles) {
+        printf("WASM: Executor is full (%zu handles)\n", executor->max_handles);
+        return nullptr;
+    }
+    rclc_executor_handle_t* handle = &executor->handles[executor->index++];
+    memset(handle, 0, sizeof(*handle));
+    handle->type = type;
+    handle->invocation = invocation;
+    handle->handle = rcl_handle;
+    handle->initialized = true;
+    executor->wait_set_valid = false;  // Sizes changed: rebuilt on next spin
+    return handle;
+}
+
 // rclc_executor_add_subscription - Add subscription to executor
 extern "C" rcl_ret_t rclc_executor_add_subscription(
     rclc_executor_t* executor,
     rcl_subscription_t* subscription,
     void* msg,
-    void (*callback)(const void*),
-    rclc_executor_handle_type_t type)
+    rclc_subscription_callback_t callback,
+    rclc_executor_handle_invocation_t invocation)
 {
     printf("WASM: rclc_executor_add_subscription called\n");
-    // TODO: Add subscription to executor
-    // - Register callback
-    // - Store subscription handle
+    if (!msg || !callback) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rclc_executor_handle_t* handle = rclc_executor_next_handle(executor, subscription,
+                                                               RCLC_EXECUTOR_HANDLE_TYPE_SUBSCRIPTION, invocation);
+    if (!handle) {
+        return RCL_RET_ERROR;
+    }
+    handle->data = msg;
+    handle->subscription_callback = callback;
+    return RCL_RET_OK;
+}
+
+// rclc_executor_add_subscription_with_context - Callback also receives `context` (e.g. the owning node)
+extern "C" rcl_ret_t rclc_executor_add_subscription_with_context(
+    rclc_executor_t* executor,
+    rcl_subscription_t* subscription,
+    void* msg,
+    rclc_subscription_callback_with_context_t callback,
+    void* context,
+    rclc_executor_handle_invocation_t invocation)
+{
+    printf("WASM: rclc_executor_add_subscription_with_context called\n");
+    if (!msg || !callback) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rclc_executor_handle_t* handle = rclc_executor_next_handle(executor, subscription,
+                                                               RCLC_EXECUTOR_HANDLE_TYPE_SUBSCRIPTION, invocation);
+    if (!handle) {
+        return RCL_RET_ERROR;
+    }
+    handle->data = msg;
+    handle->subscription_callback_with_context = callback;
+    handle->callback_context = context;
     return RCL_RET_OK;
 }
 
-// rclc_executor_spin_some - Spin executor (process some callbacks)
+// rclc_executor_add_timer - The timer's own callback runs when it is due
+extern "C" rcl_ret_t rclc_executor_add_timer(
+    rclc_executor_t* executor,
+    rcl_timer_t* timer)
+{
+    printf("WASM: rclc_executor_add_timer called\n");
+    rclc_executor_handle_t* handle = rclc_executor_next_handle(executor, timer,
+                                                               RCLC_EXECUTOR_HANDLE_TYPE_TIMER, ON_NEW_DATA);
+    return handle ? RCL_RET_OK : RCL_RET_ERROR;
+}
+
+// rclc_executor_add_service - The callback fills `response`, which is sent back after it returns
+extern "C" rcl_ret_t rclc_executor_add_service(
+    rclc_executor_t* executor,
+    rcl_service_t* service,
+    void* request_msg,
+    void* response_msg,
+    rclc_service_callback_t callback)
+{
+    printf("WASM: rclc_executor_add_service called\n");
+    if (!request_msg || !response_msg || !callback) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rclc_executor_handle_t* handle = rclc_executor_next_handle(executor, service,
+                                                               RCLC_EXECUTOR_HANDLE_TYPE_SERVICE, ON_NEW_DATA);
+    if (!handle) {
+        return RCL_RET_ERROR;
+    }
+    handle->data = request_msg;
+    handle->response = response_msg;
+    handle->service_callback = callback;
+    return RCL_RET_OK;
+}
+
+// rclc_executor_add_client - Called with each response taken for this client
+extern "C" rcl_ret_t rclc_executor_add_client(
+    rclc_executor_t* executor,
+    rcl_client_t* client,
+    void* response_msg,
+    rclc_client_callback_t callback)
+{
+    printf("WASM: rclc_executor_add_client called\n");
+    if (!response_msg || !callback) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rclc_executor_handle_t* handle = rclc_executor_next_handle(executor, client,
+                                                               RCLC_EXECUTOR_HANDLE_TYPE_CLIENT, ON_NEW_DATA);
+    if (!handle) {
+        return RCL_RET_ERROR;
+    }
+    handle->data = response_msg;
+    handle->client_callback = callback;
+    return RCL_RET_OK;
+}
+
+static bool rclc_executor_is_reentrant(const rclc_executor_handle_t* handle)
+{
+    return handle->callback_group && handle->callback_group->type == RCLC_CALLBACK_GROUP_REENTRANT;
+}
+
+// Wait set sized for the current handles; allocates only after handles were added
+static rcl_ret_t rclc_executor_prepare(rclc_executor_t* executor)
+{
+    if (executor->wait_set_valid) {
+        return RCL_RET_OK;
+    }
+    
+    size_t subscriptions = 0, timers = 0, clients = 0, services = 0;
+    for (size_t i = 0; i < executor->index; i++) {
+        switch (executor->handles[i].type) {
+            case RCLC_EXECUTOR_HANDLE_TYPE_SUBSCRIPTION: subscriptions++; break;
+            case RCLC_EXECUTOR_HANDLE_TYPE_TIMER: timers++; break;
+            case RCLC_EXECUTOR_HANDLE_TYPE_CLIENT: clients++; break;
+            case RCLC_EXECUTOR_HANDLE_TYPE_SERVICE: services++; break;
+            default: break;
+        }
+    }
+    if (executor->wait_set.impl) {
+        rcl_wait_set_fini(&executor->wait_set);
+    }
+    
+    // Chain the handles of each exclusive group in order; the chain is one unit of parallel work
+    for (size_t i = 0; i < executor->index; i++) {
+        rclc_executor_handle_t* handle = &executor->handles[i];
+        handle->group_next = NULL;
+        handle->group_head = !rclc_executor_is_reentrant(handle);
+        if (!handle->group_head) continue;
+        for (size_t j = i; j-- > 0;) {
+            if (executor->handles[j].callback_group == handle->callback_group) {
+                executor->handles[j].group_next = handle;
+                handle->group_head = false;
+                break;
+            }
+        }
+    }
+    
+    rcl_ret_t ret = rcl_wait_set_init(&executor->wait_set, subscriptions, 0, timers, clients, services, 0,
+                                      executor->context, executor->allocator);
+    executor->wait_set_valid = ret == RCL_RET_OK;
+    return ret;
+}
+
+static bool rclc_executor_is_runnable(const rclc_executor_handle_t* handle)
+{
+    return handle->data_available ||
+           (handle->type == RCLC_EXECUTOR_HANDLE_TYPE_SUBSCRIPTION && handle->invocation == ALWAYS);
+}
+
+// Take for one ready handle and run its callback; constant work per handle
+static void rclc_executor_dispatch(rclc_executor_handle_t* handle)
+{
+    switch (handle->type) {
+        case RCLC_EXECUTOR_HANDLE_TYPE_SUBSCRIPTION: {
+            TraceContextWASM trace((TraceKeyWASM()));  // The take sets the sample's key for both spans
+            TraceSpanWASM dispatch_span(TRACE_DISPATCH);
+            bool taken = handle->data_available &&
+                rcl_take(static_cast<rcl_subscription_t*>(handle->handle), handle->data, NULL, NULL) == RCL_RET_OK;
+            if (!taken && handle->invocation != ALWAYS) {
+                dispatch_span.cancel();
+                return;
+            }
+            const void* msg = taken ? handle->data : NULL;
+            TraceSpanWASM callback_span(TRACE_CALLBACK);
+            if (handle->subscription_callback_with_context) {
+                handle->subscription_callback_with_context(msg, handle->callback_context);
+            } else {
+                handle->subscription_callback(msg);
+            }
+            break;
+        }
+        case RCLC_EXECUTOR_HANDLE_TYPE_TIMER: {
+            if (handle->data_available) {
+                rcl_timer_call(static_cast<rcl_timer_t*>(handle->handle));
+            }
+            break;
+        }
+        case RCLC_EXECUTOR_HANDLE_TYPE_SERVICE: {
+            rcl_service_t* service = static_cast<rcl_service_t*>(handle->handle);
+            if (handle->data_available &&
+                rcl_take_request(service, &handle->request_id, handle->data) == RCL_RET_OK) {
+                handle->service_callback(handle->data, handle->response);
+                rcl_send_response(service, &handle->request_id, handle->response);
+            }
+            break;
+        }
+        case RCLC_EXECUTOR_HANDLE_TYPE_CLIENT: {
+            if (handle->data_available &&
+                rcl_take_response(static_cast<rcl_client_t*>(handle->handle), &handle->request_id,
+                                  handle->data) == RCL_RET_OK) {
+                handle->client_callback(handle->data);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Dispatch and account its execution and response time against budget and deadline
+static void rclc_executor_dispatch_timed(rclc_executor_handle_t* handle)
+{
+    if (!rclc_executor_is_runnable(handle)) {
+        return;
+    }
+    int64_t start = rclc_wasm_now_ns();
+    rclc_executor_dispatch(handle);
+    int64_t end = rclc_wasm_now_ns();
+    
+    int64_t release = handle->release_ns ? handle->release_ns : start;
+    int64_t execution = end - start;
+    int64_t response = end - release;
+    rclc_executor_handle_stats_t& stats = handle->stats;
+    stats.calls++;
+    if (handle->budget_ns && execution > handle->budget_ns) stats.overruns++;
+    if (handle->deadline_ns && response > handle->deadline_ns) stats.deadline_misses++;
+    if (execution > stats.max_execution_ns) stats.max_execution_ns = execution;
+    if (response > stats.max_response_ns) stats.max_response_ns = response;
+    handle->release_ns = 0;  // Restamped by the next wait if more data is queued
+}
+
+// Pool work item: a reentrant handle alone, or an exclusive group's chain in order
+static void rclc_executor_run_chain(void* arg)
+{
+    rclc_executor_handle_t* handle = static_cast<rclc_executor_handle_t*>(arg);
+    if (rclc_executor_is_reentrant(handle)) {
+        rclc_executor_dispatch_timed(handle);
+        return;
+    }
+    for (; handle; handle = handle->group_next) {
+        rclc_executor_dispatch_timed(handle);
+    }
+}
+
+// Hand the ready work of one spin to the pool and wait for it; O(handles)
+static void rclc_executor_dispatch_parallel(rclc_executor_t* executor)
+{
+    WorkItemWASM* items = static_cast<WorkItemWASM*>(executor->work_items);
+    size_t count = 0;
+    for (size_t i = 0; i < executor->index; i++) {
+        rclc_executor_handle_t* handle = &executor->handles[i];
+        bool runnable = false;
+        if (rclc_executor_is_reentrant(handle)) {
+            runnable = rclc_executor_is_runnable(handle);
+        } else if (handle->group_head) {
+            for (const rclc_executor_handle_t* member = handle; member && !runnable; member = member->group_next) {
+                runnable = rclc_executor_is_runnable(member);
+            }
+        }
+        if (runnable) {
+            items[count].run = rclc_executor_run_chain;
+            items[count].arg = handle;
+            count++;
+        }
+    }
+    static_cast<WorkStealingPoolWASM*>(executor->thread_pool)->run(items, count);
+}
+
+// Rebuild the wait set, wait once and mark which handles are ready; a
+// handle's release time is the first wait that saw it ready
+static rcl_ret_t rclc_executor_wait(rclc_executor_t* executor, int64_t timeout_ns)
+{
+    rcl_wait_set_t* wait_set = &executor->wait_set;
+    rcl_wait_set_clear(wait_set);
+    for (size_t i = 0; i < executor->index; i++) {
+        rclc_executor_handle_t* handle = &executor->handles[i];
+        switch (handle->type) {
+            case RCLC_EXECUTOR_HANDLE_TYPE_SUBSCRIPTION:
+                rcl_wait_set_add_subscription(wait_set, static_cast<rcl_subscription_t*>(handle->handle), &handle->index);
+                break;
+            case RCLC_EXECUTOR_HANDLE_TYPE_TIMER:
+                rcl_wait_set_add_timer(wait_set, static_cast<rcl_timer_t*>(handle->handle), &handle->index);
+                break;
+            case RCLC_EXECUTOR_HANDLE_TYPE_CLIENT:
+                rcl_wait_set_add_client(wait_set, static_cast<rcl_client_t*>(handle->handle), &handle->index);
+                break;
+            case RCLC_EXECUTOR_HANDLE_TYPE_SERVICE:
+                rcl_wait_set_add_service(wait_set, static_cast<rcl_service_t*>(handle->handle), &handle->index);
+                break;
+            default:
+                break;
+        }
+    }
+    
+    rcl_ret_t ret = rcl_wait(wait_set, timeout_ns);
+    
+    int64_t now = rclc_wasm_now_ns();
+    for (size_t i = 0; i < executor->index; i++) {
+        rclc_executor_handle_t* handle = &executor->handles[i];
+        switch (handle->type) {
+            case RCLC_EXECUTOR_HANDLE_TYPE_SUBSCRIPTION:
+                handle->data_available = wait_set->subscriptions[handle->index] != NULL;
+                break;
+            case RCLC_EXECUTOR_HANDLE_TYPE_TIMER:
+                handle->data_available = wait_set->timers[handle->index] != NULL;
+                break;
+            case RCLC_EXECUTOR_HANDLE_TYPE_CLIENT:
+                handle->data_available = wait_set->clients[handle->index] != NULL;
+                break;
+            case RCLC_EXECUTOR_HANDLE_TYPE_SERVICE:
+                handle->data_available = wait_set->services[handle->index] != NULL;
+                break;
+            default:
+                handle->data_available = false;
+                break;
+        }
+        if (handle->data_available && handle->release_ns == 0) {
+            handle->release_ns = now;
+        }
+    }
+    return ret;
+}
+
+// Most urgent runnable handle not yet dispatched in this spin; O(handles)
+static rclc_executor_handle_t* rclc_executor_pick(rclc_executor_t* executor)
+{
+    rclc_executor_handle_t* best = nullptr;
+    int64_t best_deadline = 0;
+    for (size_t i = 0; i < executor->index; i++) {
+        rclc_executor_handle_t* handle = &executor->handles[i];
+        if (handle->dispatched || !rclc_executor_is_runnable(handle)) continue;
+        
+        // Handles without a deadline sort after every deadline
+        int64_t deadline = handle->deadline_ns ? handle->release_ns + handle->deadline_ns : INT64_MAX;
+        bool better;
+        if (!best) {
+            better = true;
+        } else if (executor->sched_policy == RCLC_SCHED_EDF && deadline != best_deadline) {
+            better = deadline < best_deadline;
+        } else {
+            better = handle->priority > best->priority;  // Ties keep the order of addition
+        }
+        if (better) {
+            best = handle;
+            best_deadline = deadline;
+        }
+    }
+    return best;
+}
+
+// One callback at a time in policy order, waiting again after each so newly
+// ready urgent work is picked next; every handle runs at most once per spin
+static void rclc_executor_dispatch_scheduled(rclc_executor_t* executor)
+{
+    for (size_t i = 0; i < executor->index; i++) {
+        executor->handles[i].dispatched = false;
+    }
+    for (;;) {
+        rclc_executor_handle_t* handle = rclc_executor_pick(executor);
+        if (!handle) break;
+        handle->dispatched = true;
+        rclc_executor_dispatch_timed(handle);
+        rclc_executor_wait(executor, 0);
+    }
+}
+
+// rclc_executor_spin_some - One wait, then take and dispatch every ready handle
+// (in order, or as set by rclc_executor_set_scheduling)
 extern "C" rcl_ret_t rclc_executor_spin_some(
     rclc_executor_t* executor,
     int64_t timeout_ns)
 {
-    printf("WASM: rclc_executor_spin_some called\n");
-    // TODO: Spin executor
-    // - Check for incoming messages
-    // - Call registered callbacks
-    // - Use our DDS polling
-    return RCL_RET_OK;
+    if (!executor || !executor->handles) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    rcl_ret_t ret = rclc_executor_prepare(executor);
+    if (ret != RCL_RET_OK) {
+        return ret;
+    }
+    
+    ret = rclc_executor_wait(executor, timeout_ns);
+    if (!executor->trigger_function(executor->handles, static_cast<unsigned int>(executor->index),
+                                    executor->trigger_object)) {
+        return ret;
+    }
+    if (executor->thread_pool) {
+        rclc_executor_dispatch_parallel(executor);
+    } else if (executor->sched_policy != RCLC_SCHED_IN_ORDER) {
+        rclc_executor_dispatch_scheduled(executor);
+    } else {
+        for (size_t i = 0; i < executor->index; i++) {
+            rclc_executor_dispatch_timed(&executor->handles[i]);
+        }
+    }
+    return ret;
+}
+
+// rclc_executor_get_time_until_next_timer - Earliest deadline over the executor's timers;
+// RCL_RET_TIMEOUT when none is running, so a main loop can sleep until data arrives (WASM extension)
+extern "C" rcl_ret_t rclc_executor_get_time_until_next_timer(
+    const rclc_executor_t* executor,
+    int64_t* time_until_next_call)
+{
+    if (!executor || !time_until_next_call) {
+        return RCL_RET_INVALID_ARGUMENT;
+    }
+    bool found = false;
+    for (size_t i = 0; i < executor->index; i++) {
+        int64_t until = 0;
+        if (executor->handles[i].type != RCLC_EXECUTOR_HANDLE_TYPE_TIMER ||
+            rcl_timer_get_time_until_next_call(static_cast<const rcl_timer_t*>(executor->handles[i].handle),
+                                               &until) != RCL_RET_OK) {
+            continue;
+        }
+        if (!found || until < *time_until_next_call) {
+            *time_until_next_call = until;
+            found = true;
+        }
+    }
+    return found ? RCL_RET_OK : RCL_RET_TIMEOUT;
+}
+
+// Main loop hooks (main_loop_wasm.h): spin without blocking, sleep until the next timer
+static bool rclc_executor_main_loop_spin(void* executor)
+{
+    return rclc_executor_spin_some(static_cast<rclc_executor_t*>(executor), 0) == RCL_RET_OK;
+}
+
+static double rclc_executor_main_loop_next_due_ms(void* executor)
+{
+    int64_t until = 0;
+    if (rclc_executor_get_time_until_next_timer(static_cast<rclc_executor_t*>(executor), &until) != RCL_RET_OK) {
+        return -1.0;
+    }
+    return until > 0 ? until / 1000000.0 : 0.0;
+}
+
+static inline MainLoopWorkWASM rclc_executor_main_loop_work(rclc_executor_t* executor)
+{
+    MainLoopWorkWASM work;
+    work.spin = rclc_executor_main_loop_spin;
+    work.next_due_ms = rclc_executor_main_loop_next_due_ms;
+    work.context = executor;
+    return work;
 }
 
 // Types are now in rcl_types_wasm.h
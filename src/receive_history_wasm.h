@@ -0,0 +1,66 @@
+/*
+ * Receive History for WASM
+ *
+ * The last `capacity` received values and their receive times, kept so JS
+ * can read them in place through typed_memory_view (no copy, no decoding):
+ * - Each sample is written twice, at i and i + capacity, so the latest N are
+ *   always contiguous and oldest first; the ring is allocated once.
+ * - A change sequence goes up with every received message (and every
+ *   reconfigure), so a dashboard can skip refreshes when nothing changed.
+ * Views point into WASM memory: take them again after each call into the
+ * module (memory growth detaches old views) and do not keep them.
+ */
+
+#ifndef RECEIVE_HISTORY_WASM_H
+#define RECEIVE_HISTORY_WASM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define RECEIVE_HISTORY_WASM_DEFAULT_CAPACITY 256
+
+class ReceiveHistoryWASM {
+private:
+    size_t capacity;
+    std::vector<double> values;  // 2 * capacity, mirrored
+    std::vector<double> times;
+    size_t next;                 // Slot of the next sample, 0..capacity-1
+    size_t count;
+    uint64_t sequence;
+
+public:
+    explicit ReceiveHistoryWASM(size_t capacity = RECEIVE_HISTORY_WASM_DEFAULT_CAPACITY) : sequence(0) {
+        configure(capacity);
+    }
+
+    // Resizes the ring (allocates) and clears it
+    void configure(size_t new_capacity) {
+        capacity = new_capacity > 0 ? new_capacity : 1;
+        values.assign(2 * capacity, 0);
+        times.assign(2 * capacity, 0);
+        next = 0;
+        count = 0;
+        sequence++;
+    }
+
+    void add(double value, double time_ms) {
+        values[next] = values[next + capacity] = value;
+        times[next] = times[next + capacity] = time_ms;
+        next = next + 1 == capacity ? 0 : next + 1;
+        if (count < capacity) count++;
+        sequence++;
+    }
+
+    // A message arrived without a value to record
+    void touch() { sequence++; }
+
+    // Latest size() samples, oldest first
+    const double* getValues() const { return values.data() + next + capacity - count; }
+    const double* getTimes() const { return times.data() + next + capacity - count; }
+    size_t size() const { return count; }
+    size_t getCapacity() const { return capacity; }
+    uint64_t getSequence() const { return sequence; }
+};
+
+#endif // RECEIVE_HISTORY_WASM_H
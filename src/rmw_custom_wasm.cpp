@@ -5,10 +5,11 @@
  * This allows microROS to use our DDS implementation instead of FastDDS.
  */
 
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
 #include <string>
 #include <cstdio>
+#include <unordered_map>
 
 // TODO: Include rmw headers when available
 // #include <rmw/rmw.h>
@@ -16,18 +17,331 @@
 
 // Include our DDS layer
 #include "dds_minimal_wasm.cpp"
+#include "rosidl_typesupport_wasm.h"
+#include "rmw_graph_wasm.h"
+#include "log_wasm.h"
 
 using namespace emscripten;
 
+// Received payloads kept per subscription until rcl_take (KEEP_LAST depth),
+// unless the subscription asks for its own
+#define RMW_WASM_SUBSCRIPTION_DEPTH 10
+
+// Pool slot size for variable-size messages; fixed-size types use their own size.
+// Larger payloads still get through but are allocated one by one.
+#ifndef RMW_WASM_MAX_MESSAGE_SIZE
+#define RMW_WASM_MAX_MESSAGE_SIZE 1024
+#endif
+
+// Requests one client may have in flight; also the depth of service request queues
+#ifndef RMW_WASM_MAX_REQUESTS_IN_FLIGHT
+#define RMW_WASM_MAX_REQUESTS_IN_FLIGHT 16
+#endif
+
+// Callbacks told when anything is queued for a take (e.g. a main loop driver)
+#ifndef RMW_WASM_MAX_ACTIVITY_LISTENERS
+#define RMW_WASM_MAX_ACTIVITY_LISTENERS 8
+#endif
+
+static_assert(sizeof(rmw_request_id_t) == sizeof(DDSRequestHeader), "rmw_request_id_t is the wire request header");
+
+class RMWCustomWASM;
+typedef void (*RMWActivityCallbackWASM)(void* context);
+
+struct RMWPublisherEntry {
+    DDSPublisherWASM* publisher;
+    const rosidl_message_type_support_t* type_support;  // nullptr = untyped string
+};
+
+struct RMWReceivedSlot {
+    uint8_t* data;
+    size_t length;
+    bool pooled;  // false: oversized payload allocated outside the pool
+    TraceKeyWASM trace;  // Sample's writer and sequence while tracing, for the take's spans
+};
+
+// Bounded queue of received payloads; ring and pool are allocated at creation
+struct RMWReceiveQueue {
+    rcl_allocator_t allocator;
+    PoolAllocatorWASM pool;  // One slot per queue entry
+    RMWReceivedSlot* ring;
+    size_t depth;
+    size_t head;
+    size_t count;
+    
+    RMWReceiveQueue() : allocator(rcl_get_default_allocator()), ring(nullptr), depth(0), head(0), count(0) {}
+    
+    ~RMWReceiveQueue() {
+        while (count > 0) {
+            popFront();
+        }
+        if (ring) {
+            allocator.deallocate(ring, allocator.state);
+        }
+    }
+    
+    bool init(size_t slot_size, size_t queue_depth, const rcl_allocator_t& alloc) {
+        allocator = alloc;
+        ring = static_cast<RMWReceivedSlot*>(allocator.zero_allocate(queue_depth, sizeof(RMWReceivedSlot), allocator.state));
+        if (!ring) {
+            return false;
+        }
+        depth = queue_depth;
+        return pool.init(slot_size, depth, allocator);
+    }
+    
+    // KEEP_LAST: a full queue drops its oldest payload. False if out of memory.
+    bool push(const uint8_t* data, size_t length) {
+        if (depth == 0) {
+            return false;
+        }
+        if (count == depth) {
+            popFront();
+        }
+        
+        RMWReceivedSlot slot;
+        slot.length = length;
+        slot.pooled = length <= pool.getBlockSize();
+        slot.trace = traceWASMEnabled() ? traceWASMCurrentKey() : TraceKeyWASM();
+        slot.data = static_cast<uint8_t*>(slot.pooled ? pool.acquire() : allocator.allocate(length, allocator.state));
+        if (!slot.data) {
+            return false;
+        }
+        if (length > 0) {
+            memcpy(slot.data, data, length);
+        }
+        ring[(head + count) % depth] = slot;
+        count++;
+        return true;
+    }
+    
+    void releaseSlot(RMWReceivedSlot& slot) {
+        if (slot.pooled) {
+            pool.release(slot.data);
+        } else {
+            allocator.deallocate(slot.data, allocator.state);
+        }
+        slot.data = nullptr;
+    }
+    
+    RMWReceivedSlot& front() { return ring[head]; }
+    
+    void popFront() {
+        releaseSlot(ring[head]);
+        head = (head + 1) % depth;
+        count--;
+    }
+};
+
+enum RMWSubscriptionMetricWASM {
+    RMW_SAMPLES_QUEUED,
+    RMW_SAMPLES_OVERWRITTEN,  // KEEP_LAST: oldest sample dropped for a new one
+    RMW_SAMPLES_DROPPED,      // Out of memory
+    RMW_QUEUE_MAX_DEPTH,
+    RMW_SUBSCRIPTION_METRIC_COUNT
+};
+
+static const MetricInfoWASM RMW_SUBSCRIPTION_METRICS[RMW_SUBSCRIPTION_METRIC_COUNT] = {
+    {"samples_queued", METRIC_COUNTER},
+    {"samples_overwritten", METRIC_COUNTER},
+    {"samples_dropped", METRIC_COUNTER},
+    {"queue_max_depth", METRIC_GAUGE},
+};
+
+struct RMWSubscriberEntry {
+    RMWCustomWASM* owner;
+    DDSSubscriberWASM* subscriber;
+    const rosidl_message_type_support_t* type_support;
+    RMWReceiveQueue queue;  // KEEP_LAST depth slots
+    MetricGroupWASM<RMW_SUBSCRIPTION_METRIC_COUNT> metrics;  // In the participant's registry
+    
+    RMWSubscriberEntry()
+        : owner(nullptr), subscriber(nullptr), type_support(nullptr), metrics(RMW_SUBSCRIPTION_METRICS) {}
+};
+
+struct RMWServiceEntry {
+    RMWCustomWASM* owner;
+    DDSServiceServerWASM* server;
+    const rosidl_service_type_support_t* type_support;
+    RMWReceiveQueue requests;  // DDSRequestHeader + serialized request
+};
+
+struct RMWPendingRequest {
+    int64_t sequence_number;  // 0 = free slot
+    double deadline_ms;       // 0 = no timeout
+};
+
+struct RMWClientEntry {
+    RMWCustomWASM* owner;
+    DDSServiceClientWASM* client;
+    const rosidl_service_type_support_t* type_support;
+    RMWReceiveQueue responses;  // DDSRequestHeader + serialized response
+    RMWPendingRequest pending[RMW_WASM_MAX_REQUESTS_IN_FLIGHT];
+    size_t in_flight;
+    double timeout_ms;
+    int64_t timed_out[RMW_WASM_MAX_REQUESTS_IN_FLIGHT];  // Expired sequence numbers not yet reported
+    size_t timed_out_head;
+    size_t timed_out_count;
+    uint32_t late_responses;  // Responses that arrived after their request timed out
+    
+    RMWPendingRequest* findPending(int64_t sequence_number) {
+        for (RMWPendingRequest& request : pending) {
+            if (request.sequence_number == sequence_number) {
+                return &request;
+            }
+        }
+        return nullptr;
+    }
+    
+    // Moves overdue requests to the timed-out list; O(in-flight limit)
+    void expire(double now) {
+        if (timeout_ms <= 0 || in_flight == 0) return;
+        for (RMWPendingRequest& request : pending) {
+            if (request.sequence_number != 0 && now >= request.deadline_ms) {
+                if (timed_out_count == RMW_WASM_MAX_REQUESTS_IN_FLIGHT) {
+                    timed_out_head = (timed_out_head + 1) % RMW_WASM_MAX_REQUESTS_IN_FLIGHT;
+                    timed_out_count--;
+                }
+                timed_out[(timed_out_head + timed_out_count) % RMW_WASM_MAX_REQUESTS_IN_FLIGHT] = request.sequence_number;
+                timed_out_count++;
+                request.sequence_number = 0;
+                in_flight--;
+            }
+        }
+    }
+};
+
 // Custom RMW implementation using our DDS
 class RMWCustomWASM {
 private:
-    // Map ROS2 entities to our DDS entities
+    // Map ROS2 entities to our DDS entities. Hashed so each rcl call on a
+    // handle is O(1); entries never move, so callbacks may point into them.
     std::map<void*, DDSParticipantWASM*> participants;
-    std::map<void*, DDSPublisherWASM*> publishers;
-    std::map<void*, DDSSubscriberWASM*> subscribers;
+    std::unordered_map<void*, RMWPublisherEntry> publishers;
+    std::unordered_map<void*, RMWSubscriberEntry> subscribers;
+    std::unordered_map<void*, RMWServiceEntry> services;
+    std::unordered_map<void*, RMWClientEntry> clients;
+    uint32_t next_client_index;
+    std::map<void*, RMWGuardConditionWASM*> graph_guard_conditions;  // One per participant (node)
+    RMWGraphCacheWASM graph;
+    rcl_allocator_t allocator;
+    struct {
+        RMWActivityCallbackWASM callback;
+        void* context;
+    } activity_listeners[RMW_WASM_MAX_ACTIVITY_LISTENERS];
+    size_t activity_listener_count;
+    bool io_threads;  // Participants read their sockets on I/O threads
+    
+    void signalActivity() {
+        for (size_t i = 0; i < activity_listener_count; i++) {
+            activity_listeners[i].callback(activity_listeners[i].context);
+        }
+    }
+    
+    static void onDiscoveryEvent(void* context, const DDSDiscoveryEvent& event) {
+        RMWGraphCacheWASM& graph = static_cast<RMWCustomWASM*>(context)->graph;
+        switch (event.kind) {
+            case DDSDiscoveryEvent::ENDPOINT_ADDED:
+                graph.addEndpoint(event.participant_guid, event.endpoint_guid, event.is_writer, event.topic_name,
+                                  event.type_name);
+                break;
+            case DDSDiscoveryEvent::ENDPOINT_REMOVED:
+                graph.removeEndpoint(event.participant_guid, event.endpoint_guid);
+                break;
+            case DDSDiscoveryEvent::PARTICIPANT_REMOVED:
+                graph.removeParticipant(event.participant_guid);
+                break;
+        }
+    }
+    
+    static void enqueue(void* context, const uint8_t* data, size_t length) {
+        RMWSubscriberEntry& entry = *static_cast<RMWSubscriberEntry*>(context);
+        TraceSpanWASM span(TRACE_ENQUEUE);
+        bool full = entry.queue.count == entry.queue.depth;
+        if (!entry.queue.push(data, length)) {
+            WASM_LOG_WARN("WASM: Dropped %zu byte sample on '%s' (out of memory)\n",
+                          length, entry.subscriber->getTopicName().c_str());
+            entry.metrics[RMW_SAMPLES_DROPPED].add();
+            return;
+        }
+        entry.metrics[RMW_SAMPLES_QUEUED].add();
+        if (full) {
+            entry.metrics[RMW_SAMPLES_OVERWRITTEN].add();
+        }
+        entry.metrics[RMW_QUEUE_MAX_DEPTH].raise(entry.queue.count);
+        entry.owner->signalActivity();
+    }
+    
+    static void enqueueRequest(void* context, const uint8_t* data, size_t length) {
+        RMWServiceEntry& entry = *static_cast<RMWServiceEntry*>(context);
+        if (length < sizeof(DDSRequestHeader) || !entry.requests.push(data, length)) {
+            WASM_LOG_WARN("WASM: Dropped request on service '%s'\n", entry.server->getServiceName().c_str());
+            return;
+        }
+        entry.owner->signalActivity();
+    }
+    
+    // Correlates a response with its pending request by sequence number
+    static void enqueueResponse(void* context, const uint8_t* data, size_t length) {
+        RMWClientEntry& entry = *static_cast<RMWClientEntry*>(context);
+        DDSRequestHeader header;
+        memcpy(&header, data, sizeof(header));
+        RMWPendingRequest* request = entry.findPending(header.sequence_number);
+        if (!request) {
+            entry.late_responses++;
+            return;
+        }
+        request->sequence_number = 0;
+        entry.in_flight--;
+        if (!entry.responses.push(data, length)) {
+            WASM_LOG_WARN("WASM: Dropped response on service '%s'\n", entry.client->getServiceName().c_str());
+            return;
+        }
+        entry.owner->signalActivity();
+    }
+    
+    // From an I/O thread, once per batch: the next rcl_wait has data to deliver
+    static void onReceiveWake(void* context) {
+        static_cast<RMWCustomWASM*>(context)->signalActivity();
+    }
+    
+    bool startIOThread(DDSParticipantWASM* participant) {
+        NetworkManagerWASM* net_mgr = participant->getNetworkManager();
+        if (!net_mgr) {
+            return false;
+        }
+        net_mgr->setReceiveWakeCallback(&RMWCustomWASM::onReceiveWake, this);
+        return participant->startIOThread();
+    }
+    
+    static void pollNetwork(DDSParticipantWASM* participant) {
+        NetworkManagerWASM* net_mgr = participant ? participant->getNetworkManager() : nullptr;
+        if (net_mgr) {
+            net_mgr->poll();
+            participant->publishMetricsIfDue();
+        }
+    }
+    
+    static void enqueueString(RMWSubscriberEntry* entry, const std::string& data) {
+        enqueue(entry, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+    
+    RMWSubscriberEntry* findSubscriber(void* subscriber_handle) {
+        auto it = subscribers.find(subscriber_handle);
+        return it == subscribers.end() ? nullptr : &it->second;
+    }
     
 public:
+    RMWCustomWASM()
+        : next_client_index(1), allocator(rcl_get_default_allocator()), activity_listener_count(0), io_threads(false) {}
+    
+    // Allocator for all entity buffers; set before creating entities (rcl_init does this)
+    void configureAllocator(const rcl_allocator_t& alloc) {
+        if (rcl_allocator_is_valid(&alloc)) {
+            allocator = alloc;
+        }
+    }
+    
     // Initialize RMW
     bool init() {
         printf("WASM: Initializing custom RMW (using our DDS layer)\n");
@@ -37,9 +351,17 @@ public:
     // Create participant (maps to our DDSParticipantWASM)
     void* createParticipant(const std::string& name, int domain_id) {
         DDSParticipantWASM* participant = new DDSParticipantWASM(name, domain_id);
+        participant->setDiscoveryListener(&RMWCustomWASM::onDiscoveryEvent, this);
         if (participant->init()) {
             void* handle = static_cast<void*>(participant);
             participants[handle] = participant;
+            
+            RMWGuardConditionWASM* guard = new RMWGuardConditionWASM();
+            graph_guard_conditions[handle] = guard;
+            graph.addGuardCondition(guard);
+            if (io_threads) {
+                startIOThread(participant);
+            }
             return handle;
         }
         delete participant;
@@ -48,67 +370,523 @@ public:
     
     // Create publisher (maps to our DDSPublisherWASM)
     void* createPublisher(void* participant_handle, const std::string& topic, const std::string& type) {
+        return createPublisherEntry(participant_handle, topic, type, nullptr);
+    }
+    
+    // Create publisher whose messages are serialized by rosidl type support
+    void* createTypedPublisher(void* participant_handle, const std::string& topic,
+                               const rosidl_message_type_support_t* type_support) {
+        if (!type_support) {
+            return nullptr;
+        }
+        return createPublisherEntry(participant_handle, topic, type_support->type_name, type_support);
+    }
+    
+    void* createPublisherEntry(void* participant_handle, const std::string& topic, const std::string& type,
+                               const rosidl_message_type_support_t* type_support) {
         auto it = participants.find(participant_handle);
         if (it == participants.end()) {
             return nullptr;
         }
         
-        DDSPublisherWASM* publisher = new DDSPublisherWASM(it->second, topic, type);
+        uint64_t type_hash = type_support ? type_support->type_hash : 0;
+        DDSPublisherWASM* publisher = new DDSPublisherWASM(it->second, topic, type, type_hash);
+        publisher->setAllocator(allocator);
         if (publisher->init()) {
+            // Preallocate the frame so steady-state publishing does not reallocate
+            publisher->reserveFrame(maxPayload(type_support));
             void* handle = static_cast<void*>(publisher);
-            publishers[handle] = publisher;
+            RMWPublisherEntry& entry = publishers[handle];
+            entry.publisher = publisher;
+            entry.type_support = type_support;
             return handle;
         }
         delete publisher;
         return nullptr;
     }
     
+    // Receive slot / frame size for a type: its fixed size, or the variable-size bound
+    static size_t maxPayload(const rosidl_message_type_support_t* type_support) {
+        return type_support && type_support->fixed_size ? type_support->fixed_size : RMW_WASM_MAX_MESSAGE_SIZE;
+    }
+    
     // Create subscriber (maps to our DDSSubscriberWASM)
     void* createSubscriber(void* participant_handle, const std::string& topic, const std::string& type) {
+        return createSubscriberEntry(participant_handle, topic, type, nullptr, 0);
+    }
+    
+    // Same, keeping the last `depth` samples until taken (0 = RMW_WASM_SUBSCRIPTION_DEPTH)
+    void* createSubscriberWithDepth(void* participant_handle, const std::string& topic, const std::string& type,
+                                    int depth) {
+        return createSubscriberEntry(participant_handle, topic, type, nullptr, depth > 0 ? depth : 0);
+    }
+    
+    // Create subscriber whose messages are deserialized by rosidl type support
+    void* createTypedSubscriber(void* participant_handle, const std::string& topic,
+                                const rosidl_message_type_support_t* type_support, size_t depth = 0) {
+        if (!type_support) {
+            return nullptr;
+        }
+        return createSubscriberEntry(participant_handle, topic, type_support->type_name, type_support, depth);
+    }
+    
+    void* createSubscriberEntry(void* participant_handle, const std::string& topic, const std::string& type,
+                                const rosidl_message_type_support_t* type_support, size_t depth) {
         auto it = participants.find(participant_handle);
         if (it == participants.end()) {
             return nullptr;
         }
         
-        DDSSubscriberWASM* subscriber = new DDSSubscriberWASM(it->second, topic, type);
+        uint64_t type_hash = type_support ? type_support->type_hash : 0;
+        DDSSubscriberWASM* subscriber = new DDSSubscriberWASM(it->second, topic, type, type_hash);
         if (subscriber->init()) {
             void* handle = static_cast<void*>(subscriber);
-            subscribers[handle] = subscriber;
+            RMWSubscriberEntry& entry = subscribers[handle];
+            entry.owner = this;
+            entry.subscriber = subscriber;
+            entry.type_support = type_support;
+            if (!entry.queue.init(maxPayload(type_support), depth ? depth : RMW_WASM_SUBSCRIPTION_DEPTH, allocator)) {
+                printf("WASM: Failed to allocate receive pool for '%s'\n", topic.c_str());
+            }
+            entry.metrics.attach(it->second->getMetrics(), "rmw_subscription", topic);
+            
+            // Map nodes are stable, so the entry can be captured directly
+            RMWSubscriberEntry* entry_ptr = &entry;
+            subscriber->setRawCallback(&RMWCustomWASM::enqueue, entry_ptr);
+            subscriber->setCallback([entry_ptr](const std::string& data) {
+                enqueueString(entry_ptr, data);
+            });
             return handle;
         }
         delete subscriber;
         return nullptr;
     }
     
+    // Destroy publisher; its endpoint leaves the graph (here and at remote peers)
+    bool destroyPublisher(void* publisher_handle) {
+        auto it = publishers.find(publisher_handle);
+        if (it == publishers.end()) {
+            return false;
+        }
+        delete it->second.publisher;
+        publishers.erase(it);
+        return true;
+    }
+    
+    // Destroy subscriber; samples not taken yet are released with its queue
+    bool destroySubscriber(void* subscriber_handle) {
+        auto it = subscribers.find(subscriber_handle);
+        if (it == subscribers.end()) {
+            return false;
+        }
+        delete it->second.subscriber;  // First: its callbacks point into the entry
+        subscribers.erase(it);
+        return true;
+    }
+    
     // Publish message
     bool publish(void* publisher_handle, const std::string& data) {
         auto it = publishers.find(publisher_handle);
         if (it == publishers.end()) {
             return false;
         }
-        return it->second->publish(data);
+        return it->second.publisher->publish(data);
+    }
+    
+    // Publish a ROS message struct through the publisher's type support
+    bool publishMessage(void* publisher_handle, const void* ros_message) {
+        auto it = publishers.find(publisher_handle);
+        if (it == publishers.end() || !it->second.type_support || !ros_message) {
+            return false;
+        }
+        
+        // Serialize straight into the DDS frame buffer
+        RMWPublisherEntry& entry = it->second;
+        const rosidl_message_type_support_t* ts = entry.type_support;
+        DDSPublisherWASM* publisher = entry.publisher;
+        TraceContextWASM trace(publisher->getWriterGuid(), publisher->getSequenceNumber() + 1, publisher->getTopicHash());
+        size_t length = ts->fixed_size ? ts->fixed_size : ts->get_serialized_size(ros_message);
+        uint8_t* payload = publisher->loanPayload(length);
+        {
+            TraceSpanWASM span(TRACE_SERIALIZE);
+            if (!payload || ts->serialize(ros_message, payload, length) != length) {
+                return false;
+            }
+        }
+        return publisher->publishLoaned(length);
+    }
+    
+    // Called after each sample, request or response is queued for a take
+    bool addActivityListener(RMWActivityCallbackWASM callback, void* context) {
+        if (!callback || activity_listener_count == RMW_WASM_MAX_ACTIVITY_LISTENERS) {
+            return false;
+        }
+        activity_listeners[activity_listener_count].callback = callback;
+        activity_listeners[activity_listener_count].context = context;
+        activity_listener_count++;
+        return true;
+    }
+    
+    void removeActivityListener(RMWActivityCallbackWASM callback, void* context) {
+        for (size_t i = 0; i < activity_listener_count; i++) {
+            if (activity_listeners[i].callback == callback && activity_listeners[i].context == context) {
+                activity_listeners[i] = activity_listeners[--activity_listener_count];
+                return;
+            }
+        }
+    }
+    
+    // Socket reads of every participant, current and later ones, move to I/O
+    // threads; pollAll() then delivers what they queued. Activity listeners
+    // are also called from those threads, so register them first.
+    bool enableIOThreads() {
+        io_threads = true;
+        bool ok = true;
+        for (auto& participant : participants) {
+            ok = startIOThread(participant.second) && ok;
+        }
+        return ok;
+    }
+    
+    // Hand-off queues of all participants combined (depths and counts summed, latencies worst/weighted)
+    IOHandoffStatsWASM getIOStats() const {
+        IOHandoffStatsWASM total = IOHandoffStatsWASM();
+        for (const auto& participant : participants) {
+            NetworkManagerWASM* net_mgr = participant.second->getNetworkManager();
+            const IOHandoffWASM* handoff = net_mgr ? net_mgr->getHandoff() : nullptr;
+            if (!handoff) continue;
+            IOHandoffStatsWASM stats = handoff->getStats();
+            if (total.delivered + stats.delivered > 0) {
+                total.mean_latency_ms = (total.mean_latency_ms * total.delivered +
+                                         stats.mean_latency_ms * stats.delivered) /
+                                        static_cast<double>(total.delivered + stats.delivered);
+            }
+            total.committed += stats.committed;
+            total.delivered += stats.delivered;
+            total.dropped += stats.dropped;
+            total.wakeups += stats.wakeups;
+            total.depth += stats.depth;
+            total.max_depth += stats.max_depth;
+            if (stats.max_latency_ms > total.max_latency_ms) total.max_latency_ms = stats.max_latency_ms;
+        }
+        return total;
+    }
+    
+    // Metrics of one participant and everything on it (see DDSParticipantWASM::getStats)
+    std::string getStats(void* participant_handle) const {
+        auto it = participants.find(participant_handle);
+        return it == participants.end() ? std::string("{}") : it->second->getStats();
+    }
+    
+    // Periodic getStats() on DDS_METRICS_TOPIC, checked on every pollAll(); 0 stops
+    bool enableMetricsTopic(void* participant_handle, double period_ms) {
+        auto it = participants.find(participant_handle);
+        return it != participants.end() && it->second->enableMetricsTopic(period_ms);
+    }
+    
+    // Pipeline tracing for the whole process (see DDSParticipantWASM::startTrace)
+    void startTrace(int events_per_thread) {
+        traceWASMStart(events_per_thread > 0 ? static_cast<size_t>(events_per_thread) : TRACE_WASM_DEFAULT_EVENTS);
+    }
+    
+    void stopTrace() {
+        traceWASMStop();
+    }
+    
+    // Chrome Trace Event JSON, under the participant's name
+    std::string getTrace(void* participant_handle) const {
+        auto it = participants.find(participant_handle);
+        return traceWASMExportJSON(it == participants.end() ? std::string("rmw") : it->second->getName());
+    }
+    
+    // Receive I/O for every participant; takes only read what this delivered
+    void pollAll() {
+        for (auto& participant : participants) {
+            pollNetwork(participant.second);
+        }
+    }
+    
+    // Readiness checks for rcl_wait, O(1) per handle
+    bool hasData(void* subscriber_handle) const {
+        auto it = subscribers.find(subscriber_handle);
+        return it != subscribers.end() && it->second.queue.count > 0;
+    }
+    
+    bool hasRequest(void* service_handle) const {
+        auto it = services.find(service_handle);
+        return it != services.end() && it->second.requests.count > 0;
+    }
+    
+    bool hasResponse(void* client_handle) const {
+        auto it = clients.find(client_handle);
+        return it != clients.end() && it->second.responses.count > 0;
     }
     
     // Receive message
     bool take(void* subscriber_handle, std::string& data) {
-        auto it = subscribers.find(subscriber_handle);
-        if (it == subscribers.end()) {
+        RMWSubscriberEntry* entry = findSubscriber(subscriber_handle);
+        if (!entry || entry->queue.count == 0) {
             return false;
         }
+        RMWReceivedSlot& slot = entry->queue.front();
+        traceWASMSetCurrentKey(slot.trace);
+        data.assign(reinterpret_cast<const char*>(slot.data), slot.length);
+        entry->queue.popFront();
+        return true;
+    }
+    
+    // Receive message into a ROS message struct through the subscriber's type support
+    bool takeMessage(void* subscriber_handle, void* ros_message) {
+        RMWSubscriberEntry* entry = findSubscriber(subscriber_handle);
+        if (!entry || !entry->type_support || !ros_message || entry->queue.count == 0) {
+            return false;
+        }
+        RMWReceivedSlot& slot = entry->queue.front();
+        traceWASMSetCurrentKey(slot.trace);  // Also the executor's dispatch and callback spans
+        bool ok;
+        {
+            TraceSpanWASM span(TRACE_DECODE);
+            ok = entry->type_support->deserialize(slot.data, slot.length, ros_message);
+        }
+        entry->queue.popFront();
+        return ok;
+    }
+    
+    // Create service server; requests queue up until takeRequest()
+    void* createService(void* participant_handle, const std::string& service_name,
+                        const rosidl_service_type_support_t* type_support) {
+        auto it = participants.find(participant_handle);
+        if (it == participants.end() || !type_support) {
+            return nullptr;
+        }
         
-        // Poll for incoming messages
-        DDSSubscriberWASM* subscriber = it->second;
-        if (subscriber && subscriber->getParticipant()) {
-            NetworkManagerWASM* net_mgr = subscriber->getParticipant()->getNetworkManager();
-            if (net_mgr) {
-                net_mgr->poll();
-            }
+        const rosidl_message_type_support_t* request_ts = type_support->request_typesupport;
+        const rosidl_message_type_support_t* response_ts = type_support->response_typesupport;
+        DDSServiceServerWASM* server = new DDSServiceServerWASM(it->second, service_name,
+                                                                request_ts->type_name, request_ts->type_hash,
+                                                                response_ts->type_name, response_ts->type_hash);
+        if (!server->init(allocator, maxPayload(response_ts))) {
+            delete server;
+            return nullptr;
+        }
+        
+        void* handle = static_cast<void*>(server);
+        RMWServiceEntry& entry = services[handle];
+        entry.owner = this;
+        entry.server = server;
+        entry.type_support = type_support;
+        if (!entry.requests.init(sizeof(DDSRequestHeader) + maxPayload(request_ts),
+                                 RMW_WASM_MAX_REQUESTS_IN_FLIGHT, allocator)) {
+            printf("WASM: Failed to allocate request queue for '%s'\n", service_name.c_str());
+        }
+        server->setRequestCallback(&RMWCustomWASM::enqueueRequest, &entry);
+        return handle;
+    }
+    
+    // Create service client; timeout_ms = 0 keeps requests pending until answered
+    void* createClient(void* participant_handle, const std::string& service_name,
+                       const rosidl_service_type_support_t* type_support, double timeout_ms) {
+        auto it = participants.find(participant_handle);
+        if (it == participants.end() || !type_support) {
+            return nullptr;
+        }
+        
+        const rosidl_message_type_support_t* request_ts = type_support->request_typesupport;
+        const rosidl_message_type_support_t* response_ts = type_support->response_typesupport;
+        DDSServiceClientWASM* client = new DDSServiceClientWASM(it->second, service_name,
+                                                                request_ts->type_name, request_ts->type_hash,
+                                                                response_ts->type_name, response_ts->type_hash,
+                                                                next_client_index++);
+        if (!client->init(allocator, maxPayload(request_ts))) {
+            delete client;
+            return nullptr;
+        }
+        
+        void* handle = static_cast<void*>(client);
+        RMWClientEntry& entry = clients[handle];
+        entry.owner = this;
+        entry.client = client;
+        entry.type_support = type_support;
+        memset(entry.pending, 0, sizeof(entry.pending));
+        entry.in_flight = 0;
+        entry.timeout_ms = timeout_ms;
+        entry.timed_out_head = 0;
+        entry.timed_out_count = 0;
+        entry.late_responses = 0;
+        if (!entry.responses.init(sizeof(DDSRequestHeader) + maxPayload(response_ts),
+                                  RMW_WASM_MAX_REQUESTS_IN_FLIGHT, allocator)) {
+            printf("WASM: Failed to allocate response queue for '%s'\n", service_name.c_str());
+        }
+        client->setReplyCallback(&RMWCustomWASM::enqueueResponse, &entry);
+        return handle;
+    }
+    
+    // Send a request without waiting for earlier ones; false if the in-flight table is full
+    bool sendRequest(void* client_handle, const void* ros_request, int64_t* sequence_number) {
+        auto it = clients.find(client_handle);
+        if (it == clients.end() || !ros_request) {
+            return false;
+        }
+        
+        RMWClientEntry& entry = it->second;
+        double now = emscripten_get_now();
+        entry.expire(now);
+        RMWPendingRequest* request = entry.findPending(0);
+        if (!request) {
+            WASM_LOG_WARN("WASM: %d requests already in flight on '%s'\n",
+                          RMW_WASM_MAX_REQUESTS_IN_FLIGHT, entry.client->getServiceName().c_str());
+            return false;
+        }
+        
+        const rosidl_message_type_support_t* ts = entry.type_support->request_typesupport;
+        size_t length = ts->fixed_size ? ts->fixed_size : ts->get_serialized_size(ros_request);
+        uint8_t* payload = entry.client->loanRequest(length);
+        if (!payload || ts->serialize(ros_request, payload, length) != length) {
+            return false;
+        }
+        
+        // Registered before sending: a local server may answer synchronously
+        request->sequence_number = entry.client->getNextSequenceNumber();
+        request->deadline_ms = entry.timeout_ms > 0 ? now + entry.timeout_ms : 0;
+        entry.in_flight++;
+        int64_t sent = entry.client->sendRequest(length);
+        if (sent == 0) {
+            request->sequence_number = 0;
+            entry.in_flight--;
+            return false;
+        }
+        if (sequence_number) {
+            *sequence_number = sent;
+        }
+        return true;
+    }
+    
+    bool takeResponse(void* client_handle, rmw_request_id_t* request_header, void* ros_response) {
+        auto it = clients.find(client_handle);
+        if (it == clients.end() || !ros_response) {
+            return false;
         }
         
-        // TODO: Check for queued messages
-        // For now, return false (no message available)
-        // In real implementation, would check message queue
-        return false;
+        RMWClientEntry& entry = it->second;
+        entry.expire(emscripten_get_now());
+        if (entry.responses.count == 0) {
+            return false;
+        }
+        
+        RMWReceivedSlot& slot = entry.responses.front();
+        if (request_header) {
+            memcpy(request_header, slot.data, sizeof(*request_header));
+        }
+        bool ok = entry.type_support->response_typesupport->deserialize(
+            slot.data + sizeof(DDSRequestHeader), slot.length - sizeof(DDSRequestHeader), ros_response);
+        entry.responses.popFront();
+        return ok;
+    }
+    
+    // Report one request that timed out
+    bool takeTimedOut(void* client_handle, rmw_request_id_t* request_header) {
+        auto it = clients.find(client_handle);
+        if (it == clients.end()) {
+            return false;
+        }
+        
+        RMWClientEntry& entry = it->second;
+        entry.expire(emscripten_get_now());
+        if (entry.timed_out_count == 0) {
+            return false;
+        }
+        if (request_header) {
+            memcpy(request_header->writer_guid, entry.client->getGuid(), sizeof(request_header->writer_guid));
+            request_header->sequence_number = entry.timed_out[entry.timed_out_head];
+        }
+        entry.timed_out_head = (entry.timed_out_head + 1) % RMW_WASM_MAX_REQUESTS_IN_FLIGHT;
+        entry.timed_out_count--;
+        return true;
+    }
+    
+    bool takeRequest(void* service_handle, rmw_request_id_t* request_header, void* ros_request) {
+        auto it = services.find(service_handle);
+        if (it == services.end() || !ros_request) {
+            return false;
+        }
+        
+        RMWServiceEntry& entry = it->second;
+        if (entry.requests.count == 0) {
+            return false;
+        }
+        
+        RMWReceivedSlot& slot = entry.requests.front();
+        if (request_header) {
+            memcpy(request_header, slot.data, sizeof(*request_header));
+        }
+        bool ok = entry.type_support->request_typesupport->deserialize(
+            slot.data + sizeof(DDSRequestHeader), slot.length - sizeof(DDSRequestHeader), ros_request);
+        entry.requests.popFront();
+        return ok;
+    }
+    
+    // Answer the request identified by request_header (from takeRequest)
+    bool sendResponse(void* service_handle, const rmw_request_id_t* request_header, const void* ros_response) {
+        auto it = services.find(service_handle);
+        if (it == services.end() || !request_header || !ros_response) {
+            return false;
+        }
+        
+        RMWServiceEntry& entry = it->second;
+        const rosidl_message_type_support_t* ts = entry.type_support->response_typesupport;
+        size_t length = ts->fixed_size ? ts->fixed_size : ts->get_serialized_size(ros_response);
+        uint8_t* payload = entry.server->loanReply(length);
+        if (!payload || ts->serialize(ros_response, payload, length) != length) {
+            return false;
+        }
+        DDSRequestHeader header;
+        memcpy(&header, request_header, sizeof(header));
+        return entry.server->sendReply(header, length);
+    }
+    
+    int getRequestsInFlight(void* client_handle) const {
+        auto it = clients.find(client_handle);
+        return it == clients.end() ? 0 : static_cast<int>(it->second.in_flight);
+    }
+    
+    int getLateResponses(void* client_handle) const {
+        auto it = clients.find(client_handle);
+        return it == clients.end() ? 0 : static_cast<int>(it->second.late_responses);
+    }
+    
+    // Graph queries, answered from the local cache
+    int countPublishers(const std::string& topic) const {
+        return static_cast<int>(graph.countPublishers(topic));
+    }
+    
+    int countSubscribers(const std::string& topic) const {
+        return static_cast<int>(graph.countSubscribers(topic));
+    }
+    
+    int getTopicCount() const {
+        return static_cast<int>(graph.getTopicCount());
+    }
+    
+    // Incremented on every graph change; lets JS skip unchanged dashboards
+    double getGraphVersion() const {
+        return static_cast<double>(graph.getVersion());
+    }
+    
+    const RMWGraphCacheWASM& getGraph() const { return graph; }
+    
+    RMWGuardConditionWASM* getGraphGuardCondition(void* participant_handle) const {
+        auto it = graph_guard_conditions.find(participant_handle);
+        return it == graph_guard_conditions.end() ? nullptr : it->second;
+    }
+    
+    bool isTypedPublisher(void* publisher_handle) const {
+        auto it = publishers.find(publisher_handle);
+        return it != publishers.end() && it->second.type_support;
+    }
+    
+    bool isTypedSubscriber(void* subscriber_handle) const {
+        auto it = subscribers.find(subscriber_handle);
+        return it != subscribers.end() && it->second.type_support;
     }
 };
 
@@ -119,7 +897,19 @@ EMSCRIPTEN_BINDINGS(rmw_custom_wasm) {
         .function("createParticipant", &RMWCustomWASM::createParticipant, allow_raw_pointers())
         .function("createPublisher", &RMWCustomWASM::createPublisher, allow_raw_pointers())
         .function("createSubscriber", &RMWCustomWASM::createSubscriber, allow_raw_pointers())
-        .function("publish", &RMWCustomWASM::publish, allow_raw_pointers());
+        .function("createSubscriberWithDepth", &RMWCustomWASM::createSubscriberWithDepth, allow_raw_pointers())
+        .function("destroyPublisher", &RMWCustomWASM::destroyPublisher, allow_raw_pointers())
+        .function("destroySubscriber", &RMWCustomWASM::destroySubscriber, allow_raw_pointers())
+        .function("publish", &RMWCustomWASM::publish, allow_raw_pointers())
+        .function("countPublishers", &RMWCustomWASM::countPublishers)
+        .function("countSubscribers", &RMWCustomWASM::countSubscribers)
+        .function("getStats", &RMWCustomWASM::getStats, allow_raw_pointers())
+        .function("enableMetricsTopic", &RMWCustomWASM::enableMetricsTopic, allow_raw_pointers())
+        .function("startTrace", &RMWCustomWASM::startTrace)
+        .function("stopTrace", &RMWCustomWASM::stopTrace)
+        .function("getTrace", &RMWCustomWASM::getTrace, allow_raw_pointers())
+        .function("getTopicCount", &RMWCustomWASM::getTopicCount)
+        .function("getGraphVersion", &RMWCustomWASM::getGraphVersion);
         // take() is not exposed - used internally by rcl_take() only
 }
 
@@ -0,0 +1,149 @@
+/*
+ * ROS Graph Cache for WASM RMW
+ *
+ * Keeps per-topic publisher/subscriber counts up to date from discovery
+ * events, so graph queries are answered locally: counts in O(1), topic
+ * listing in O(topics). Endpoints are keyed by their own GUID, so several
+ * endpoints of one participant on one topic each count; repeated
+ * announcements of a known endpoint are ignored, and guard conditions are
+ * triggered only on real changes.
+ */
+
+#ifndef RMW_GRAPH_WASM_H
+#define RMW_GRAPH_WASM_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// Graph guard condition; the executor clears `triggered` after waking
+struct RMWGuardConditionWASM {
+    bool triggered;
+    uint64_t trigger_count;
+
+    RMWGuardConditionWASM() : triggered(false), trigger_count(0) {}
+
+    void trigger() {
+        triggered = true;
+        trigger_count++;
+    }
+
+    bool takeTriggered() {
+        bool was_triggered = triggered;
+        triggered = false;
+        return was_triggered;
+    }
+};
+
+struct RMWGraphTopic {
+    std::string type_name;
+    size_t publishers;
+    size_t subscribers;
+};
+
+class RMWGraphCacheWASM {
+private:
+    struct Endpoint {
+        std::string guid;
+        bool is_writer;
+        std::string topic;
+    };
+
+    std::unordered_map<std::string, RMWGraphTopic> topics;
+    std::unordered_map<std::string, std::vector<Endpoint>> endpoints_by_participant;  // keyed by participant GUID
+    std::vector<RMWGuardConditionWASM*> guard_conditions;
+    uint64_t version;
+
+    void changed() {
+        version++;
+        for (RMWGuardConditionWASM* guard : guard_conditions) {
+            guard->trigger();
+        }
+    }
+
+    void release(const Endpoint& endpoint) {
+        auto it = topics.find(endpoint.topic);
+        if (it == topics.end()) return;
+        size_t& count = endpoint.is_writer ? it->second.publishers : it->second.subscribers;
+        if (count > 0) count--;
+        if (it->second.publishers == 0 && it->second.subscribers == 0) {
+            topics.erase(it);
+        }
+    }
+
+public:
+    RMWGraphCacheWASM() : version(0) {}
+
+    // Returns false if the endpoint was already known
+    bool addEndpoint(const std::string& participant_guid, const std::string& endpoint_guid, bool is_writer,
+                     const std::string& topic, const std::string& type_name) {
+        std::vector<Endpoint>& endpoints = endpoints_by_participant[participant_guid];
+        for (const Endpoint& endpoint : endpoints) {
+            if (endpoint.guid == endpoint_guid) {
+                return false;
+            }
+        }
+        endpoints.push_back(Endpoint{endpoint_guid, is_writer, topic});
+
+        RMWGraphTopic& entry = topics[topic];
+        if (entry.type_name.empty()) {
+            entry.type_name = type_name;
+        }
+        (is_writer ? entry.publishers : entry.subscribers)++;
+        changed();
+        return true;
+    }
+
+    bool removeEndpoint(const std::string& participant_guid, const std::string& endpoint_guid) {
+        auto it = endpoints_by_participant.find(participant_guid);
+        if (it == endpoints_by_participant.end()) return false;
+
+        std::vector<Endpoint>& endpoints = it->second;
+        for (size_t i = 0; i < endpoints.size(); i++) {
+            if (endpoints[i].guid == endpoint_guid) {
+                release(endpoints[i]);
+                endpoints.erase(endpoints.begin() + i);
+                if (endpoints.empty()) {
+                    endpoints_by_participant.erase(it);
+                }
+                changed();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Drops every endpoint of a participant that left
+    bool removeParticipant(const std::string& participant_guid) {
+        auto it = endpoints_by_participant.find(participant_guid);
+        if (it == endpoints_by_participant.end()) return false;
+        for (const Endpoint& endpoint : it->second) {
+            release(endpoint);
+        }
+        endpoints_by_participant.erase(it);
+        changed();
+        return true;
+    }
+
+    size_t countPublishers(const std::string& topic) const {
+        auto it = topics.find(topic);
+        return it == topics.end() ? 0 : it->second.publishers;
+    }
+
+    size_t countSubscribers(const std::string& topic) const {
+        auto it = topics.find(topic);
+        return it == topics.end() ? 0 : it->second.subscribers;
+    }
+
+    const std::unordered_map<std::string, RMWGraphTopic>& getTopics() const { return topics; }
+    size_t getTopicCount() const { return topics.size(); }
+    uint64_t getVersion() const { return version; }
+
+    void addGuardCondition(RMWGuardConditionWASM* guard) {
+        guard_conditions.push_back(guard);
+    }
+};
+
+#endif // RMW_GRAPH_WASM_H
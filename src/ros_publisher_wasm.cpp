@@ -9,13 +9,27 @@
 // Note: In production, this would be a proper header file
 // For now, we include the implementation directly
 #include "dds_minimal_wasm.cpp"
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "main_loop_wasm.h"
+#include "load_generator_wasm.h"
+#include "rosidl_typesupport_wasm.h"
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
 #include <string>
 #include <cstdio>
+#include <vector>
+#ifndef __EMSCRIPTEN__
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#endif
 
 using namespace emscripten;
 
+// Main loop cadence: participant announcements
+#define ROS_WASM_DISCOVERY_PERIOD_MS 1000.0
+// Load generator: messages sent per main loop slice before yielding
+#define ROS_WASM_LOAD_SLICE 256
+
 // ROS Publisher Node - Complete implementation
 class ROSPublisherNodeWASM {
 private:
@@ -25,12 +39,89 @@ private:
     std::string topic_name;
     int message_count;
     double sensor_value;
+    wasm_msgs__msg__SensorReading reading;  // Last reading, as sent on the wire
     bool ros_initialized;
+    double next_discovery_ms;
+    MainLoopDriverWASM main_loop;
+    LoadGeneratorWASM load;
+    std::vector<DDSPublisherWASM*> load_publishers;  // <topic>/load_<i>, std_msgs/String
+    
+    // Main loop hooks: announce periodically and, in load mode, send every
+    // message that is due (a slice at a time)
+    static bool mainLoopSpin(void* context) {
+        ROSPublisherNodeWASM* self = static_cast<ROSPublisherNodeWASM*>(context);
+        double now = emscripten_get_now();
+        if (now >= self->next_discovery_ms) {
+            self->participant->discoverParticipants();
+            self->next_discovery_ms = now + ROS_WASM_DISCOVERY_PERIOD_MS;
+        }
+        if (!self->load.isRunning()) return false;
+        self->load.step(ROS_WASM_LOAD_SLICE, [self](int topic, const LoadStampWASM& stamp, size_t size) {
+            return self->sendLoad(topic, stamp, size);
+        });
+        if (!self->load.isRunning()) {
+            WASM_LOG_INFO("WASM: Load run finished: %s\n", self->load.getReport(emscripten_get_now()).c_str());
+            return false;
+        }
+        return self->load.nextDueMs(emscripten_get_now()) == 0;
+    }
+    
+    static double mainLoopNextDueMs(void* context) {
+        ROSPublisherNodeWASM* self = static_cast<ROSPublisherNodeWASM*>(context);
+        if (!self->ros_initialized) return -1.0;
+        double now = emscripten_get_now();
+        double delay = self->next_discovery_ms - now;
+        double load_delay = self->load.nextDueMs(now);
+        if (load_delay >= 0 && load_delay < delay) delay = load_delay;
+        return delay > 0 ? delay : 0.0;
+    }
+    
+    // One load message: a std_msgs/String whose serialized form is `size`
+    // bytes, starting with the stamp
+    bool sendLoad(int topic, const LoadStampWASM& stamp, size_t size) {
+        DDSPublisherWASM* publisher = load_publishers[topic];
+        uint8_t* payload = publisher->loanPayload(size);
+        if (!payload) return false;
+        uint32_t length = static_cast<uint32_t>(size - sizeof(length));
+        memcpy(payload, &length, sizeof(length));
+        memcpy(payload + sizeof(length), &stamp, sizeof(stamp));
+        return publisher->publishLoaned(size);
+    }
+    
+    void deleteLoadPublishers() {
+        for (DDSPublisherWASM* publisher : load_publishers) delete publisher;
+        load_publishers.clear();
+    }
+    
+    static MainLoopWorkWASM mainLoopWork(ROSPublisherNodeWASM* self) {
+        MainLoopWorkWASM work;
+        work.spin = mainLoopSpin;
+        work.next_due_ms = mainLoopNextDueMs;
+        work.context = self;
+        return work;
+    }
+    
+    // Sensor simulation (business logic)
+    void nextReading() {
+        message_count++;
+        sensor_value = 20.0 + (message_count % 10);
+        
+        double now_ms = emscripten_get_now();
+        reading.stamp.sec = static_cast<int32_t>(now_ms / 1000.0);
+        reading.stamp.nanosec = static_cast<uint32_t>((now_ms - reading.stamp.sec * 1000.0) * 1000000.0);
+        reading.id = static_cast<uint32_t>(message_count);
+        reading.sensor = WASM_MSGS__MSG__SENSOR_READING__SENSOR_TEMPERATURE;
+        reading.unit = WASM_MSGS__MSG__SENSOR_READING__UNIT_CELSIUS;
+        reading.value = static_cast<float>(sensor_value);
+    }
     
 public:
     ROSPublisherNodeWASM(const std::string& node_name, const std::string& topic_name)
-        : node_name(node_name), topic_name(topic_name), message_count(0), 
-          sensor_value(0.0), ros_initialized(false), participant(nullptr), publisher(nullptr) {}
+        : participant(nullptr), publisher(nullptr), node_name(node_name), topic_name(topic_name), message_count(0),
+          sensor_value(0.0), ros_initialized(false), next_discovery_ms(0), main_loop(mainLoopWork(this)),
+          load(sizeof(uint32_t) + sizeof(LoadStampWASM)) {
+        memset(&reading, 0, sizeof(reading));
+    }
     
     // Initialize ROS node and publisher
     bool init() {
@@ -43,9 +134,10 @@ public:
             return false;
         }
         
-        // Create DDS publisher
-        publisher = new DDSPublisherWASM(participant, topic_name);
-        if (!publisher->init()) {
+        // Create DDS publisher: fixed-size binary readings, frame sized once
+        const rosidl_message_type_support_t* ts = ROSIDL_GET_MSG_TYPE_SUPPORT(wasm_msgs, msg, SensorReading);
+        publisher = new DDSPublisherWASM(participant, topic_name, ts->type_name, ts->type_hash);
+        if (!publisher->init() || !publisher->reserveFrame(sizeof(reading))) {
             printf("WASM: Failed to initialize DDS publisher\n");
             return false;
         }
@@ -55,37 +147,48 @@ public:
         return true;
     }
     
-    // Generate sensor data (business logic)
+    // Next reading rendered as JSON, for JS callers that forward it themselves
     std::string generateSensorData() {
-        message_count++;
-        sensor_value = 20.0 + (message_count % 10);
-        
+        nextReading();
+        return getReadingJson();
+    }
+    
+    // JSON view of the last reading (dashboard edge; never on the wire)
+    std::string getReadingJson() const {
         char buffer[256];
-        snprintf(buffer, sizeof(buffer),
-                 "{\"id\": %d, \"sensor\": \"temperature\", \"value\": %.2f, \"unit\": \"celsius\"}",
-                 message_count, sensor_value);
-        
+        wasm_msgs__msg__SensorReading__to_json(&reading, buffer, sizeof(buffer));
         return std::string(buffer);
     }
     
+    // The last reading as sent (the 20-byte record) without copying it;
+    // valid until the next call into the module
+    val getReadingView() const {
+        return val(typed_memory_view(sizeof(reading), reinterpret_cast<const uint8_t*>(&reading)));
+    }
+    
     // Publish message via ROS2 DDS (ALL IN WASM)
     bool publishMessage() {
         if (!ros_initialized) {
-            printf("WASM: ROS node not initialized\n");
+            WASM_LOG_WARN("WASM: ROS node not initialized\n");
             return false;
         }
         
-        std::string data = generateSensorData();
+        nextReading();
         
-        printf("WASM: Publishing message #%d via ROS2 DDS (in WASM)\n", message_count);
+        WASM_LOG_DEBUG("WASM: Publishing message #%d via ROS2 DDS (in WASM)\n", message_count);
         
-        // Publish via DDS - this executes entirely in WASM
-        bool success = publisher->publish(data);
+        // Publish via DDS - the record is written straight into the frame
+        uint8_t* payload = publisher->loanPayload(sizeof(reading));
+        bool success = payload != nullptr;
+        if (success) {
+            memcpy(payload, &reading, sizeof(reading));
+            success = publisher->publishLoaned(sizeof(reading));
+        }
         
         if (success) {
-            printf("WASM: Message published successfully via ROS2 DDS\n");
+            WASM_LOG_DEBUG("WASM: Message published successfully via ROS2 DDS\n");
         } else {
-            printf("WASM: Failed to publish message\n");
+            WASM_LOG_WARN("WASM: Failed to publish message\n");
         }
         
         return success;
@@ -101,6 +204,101 @@ public:
         participant->discoverParticipants();
     }
     
+    // Spin from the browser instead of a JS setInterval: mode 0 checks every
+    // requestAnimationFrame, mode 1 sleeps until the next announcement
+    bool startMainLoop(int mode, double frame_budget_ms) {
+        if (!ros_initialized) return false;
+        return main_loop.start(mode == MAIN_LOOP_EVENT_DRIVEN ? MAIN_LOOP_EVENT_DRIVEN : MAIN_LOOP_ANIMATION_FRAME,
+                               frame_budget_ms);
+    }
+    
+    void stopMainLoop() {
+        main_loop.stop();
+    }
+    
+    // Load-generator mode (profile format in load_generator_wasm.h): creates
+    // the profile's topics and sends on the main loop's timer, event-driven
+    // unless the loop already runs. Native hosts call runLoad() after this.
+    bool startLoad(const std::string& profile) {
+        if (!ros_initialized || !load.configure(profile)) return false;
+        load.stop();
+        deleteLoadPublishers();
+        const rosidl_message_type_support_t* ts = ROSIDL_GET_MSG_TYPE_SUPPORT(std_msgs, msg, String);
+        const LoadProfileWASM& p = load.getProfile();
+        size_t max_payload = p.payload_max > sizeof(uint32_t) + sizeof(LoadStampWASM)
+                                 ? p.payload_max : sizeof(uint32_t) + sizeof(LoadStampWASM);
+        for (int i = 0; i < p.topics; i++) {
+            DDSPublisherWASM* publisher = new DDSPublisherWASM(participant, topic_name + "/load_" + std::to_string(i),
+                                                               ts->type_name, ts->type_hash);
+            load_publishers.push_back(publisher);
+            if (!publisher->init() || !publisher->reserveFrame(max_payload)) {
+                printf("WASM: Failed to initialize load publisher %d\n", i);
+                deleteLoadPublishers();
+                return false;
+            }
+        }
+        
+        printf("WASM: Load run started on %d topic(s): %s\n", p.topics, profile.c_str());
+        load.start(emscripten_get_now());
+        if (!main_loop.isRunning()) {
+            main_loop.start(MAIN_LOOP_EVENT_DRIVEN, MAIN_LOOP_WASM_DEFAULT_BUDGET_MS);
+        }
+        main_loop.notify();
+        return true;
+    }
+    
+    void stopLoad() {
+        load.stop();
+    }
+    
+#ifndef __EMSCRIPTEN__
+    // Without a browser event loop: pump the main loop, sleeping until the
+    // next message is due, until the load profile ends
+    void runLoad() {
+        while (load.isRunning()) {
+            main_loop.pump();
+            double delay = mainLoopNextDueMs(this);
+            if (delay > 0) std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(delay));
+        }
+    }
+#endif
+    
+    // Time spent per main loop frame
+    double getFrameCount() const { return static_cast<double>(main_loop.getStats().frames); }
+    double getBusyFrames() const { return static_cast<double>(main_loop.getStats().busy_frames); }
+    double getDeferredFrames() const { return static_cast<double>(main_loop.getStats().deferred_frames); }
+    double getLastFrameMs() const { return main_loop.getStats().last_frame_ms; }
+    double getMaxFrameMs() const { return main_loop.getStats().max_frame_ms; }
+    double getMeanFrameMs() const { return main_loop.getMeanFrameMs(); }
+    
+    // Load mode: sends against the profile's schedule
+    bool isLoadRunning() const { return load.isRunning(); }
+    double getLoadSent() const { return static_cast<double>(load.getSent()); }
+    double getLoadBytesSent() const { return static_cast<double>(load.getBytesSent()); }
+    double getLoadTargetRate() const { return load.getTargetRate(); }
+    double getLoadActualRate() const { return load.getActualRate(emscripten_get_now()); }
+    double getLoadMeanLagMs() const { return load.getMeanLagMs(); }
+    double getLoadP99LagMs() const { return load.getP99LagMs(); }
+    double getLoadMaxLagMs() const { return load.getMaxLagMs(); }
+    std::string getLoadReport() const { return load.getReport(emscripten_get_now()); }
+    
+    // Counters of the node's participant, endpoints and sockets, as JSON
+    std::string getStats() const { return participant ? participant->getStats() : std::string("{}"); }
+    
+    // getStats() on DDS_METRICS_TOPIC every period_ms, sent with the discovery
+    // announcements (ROS_WASM_DISCOVERY_PERIOD_MS at the finest); 0 stops
+    bool enableMetricsTopic(double period_ms) {
+        return ros_initialized && participant->enableMetricsTopic(period_ms);
+    }
+    
+    // Spans of every message stage in this process (trace_wasm.h), from
+    // startTrace() on; getTrace() is Chrome Trace Event JSON for Perfetto
+    void startTrace(int events_per_thread) {
+        traceWASMStart(events_per_thread > 0 ? static_cast<size_t>(events_per_thread) : TRACE_WASM_DEFAULT_EVENTS);
+    }
+    void stopTrace() { traceWASMStop(); }
+    std::string getTrace() const { return traceWASMExportJSON(node_name); }
+    
     int getMessageCount() const { return message_count; }
     double getSensorValue() const { return sensor_value; }
     bool isInitialized() const { return ros_initialized; }
@@ -108,13 +306,93 @@ public:
     std::string getTopicName() const { return topic_name; }
 };
 
+#ifndef __EMSCRIPTEN__
+// Native executable (src/native/ros_publisher_main.cpp):
+//   ros_publisher_node [topic] [rate_hz] [count]    readings; count 0 = until killed
+//   ros_publisher_node --load "<profile>" [topic]   one load-generator run, report on stdout
+//   --trace FILE (either form): pipeline spans as Chrome Trace Event JSON, written at exit
+int rosPublisherNodeMain(int argc, char** argv) {
+    const char* profile = nullptr;
+    const char* trace_file = nullptr;
+    std::vector<const char*> args;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            profile = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_file = argv[++i];
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    std::string topic = args.size() > 0 ? args[0] : "/sensor/temperature";
+    double rate_hz = args.size() > 1 ? atof(args[1]) : 1.0;
+    long count = args.size() > 2 ? atol(args[2]) : 0;
+    if (!(rate_hz > 0)) {
+        printf("WASM: Publish rate must be positive\n");
+        return 1;
+    }
+
+    ROSPublisherNodeWASM node("wasm_publisher", topic);
+    if (!node.init()) return 1;
+    if (trace_file) node.startTrace(0);
+
+    if (profile) {
+        if (!node.startLoad(profile)) return 1;
+        node.runLoad();
+        printf("%s\n", node.getLoadReport().c_str());
+        return trace_file && !traceWASMWriteFile(trace_file, "wasm_publisher") ? 1 : 0;
+    }
+
+    double next_ms = emscripten_get_now();
+    double next_spin_ms = next_ms;
+    for (long sent = 0; count == 0 || sent < count; sent++) {
+        if (next_ms >= next_spin_ms) {
+            node.spinOnce();
+            next_spin_ms = next_ms + ROS_WASM_DISCOVERY_PERIOD_MS;
+        }
+        if (node.publishMessage()) printf("%s\n", node.getReadingJson().c_str());
+        fflush(stdout);
+        next_ms += 1000.0 / rate_hz;
+        double delay = next_ms - emscripten_get_now();
+        if (delay > 0) std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(delay));
+    }
+    return trace_file && !traceWASMWriteFile(trace_file, "wasm_publisher") ? 1 : 0;
+}
+#endif
+
 EMSCRIPTEN_BINDINGS(ros_publisher_wasm) {
     class_<ROSPublisherNodeWASM>("ROSPublisherNodeWASM")
         .constructor<const std::string&, const std::string&>()
         .function("init", &ROSPublisherNodeWASM::init)
         .function("generateSensorData", &ROSPublisherNodeWASM::generateSensorData)
+        .function("getReadingJson", &ROSPublisherNodeWASM::getReadingJson)
+        .function("getReadingView", &ROSPublisherNodeWASM::getReadingView)
         .function("publishMessage", &ROSPublisherNodeWASM::publishMessage)
         .function("spinOnce", &ROSPublisherNodeWASM::spinOnce)
+        .function("startMainLoop", &ROSPublisherNodeWASM::startMainLoop)
+        .function("stopMainLoop", &ROSPublisherNodeWASM::stopMainLoop)
+        .function("startLoad", &ROSPublisherNodeWASM::startLoad)
+        .function("stopLoad", &ROSPublisherNodeWASM::stopLoad)
+        .function("isLoadRunning", &ROSPublisherNodeWASM::isLoadRunning)
+        .function("getLoadSent", &ROSPublisherNodeWASM::getLoadSent)
+        .function("getLoadBytesSent", &ROSPublisherNodeWASM::getLoadBytesSent)
+        .function("getLoadTargetRate", &ROSPublisherNodeWASM::getLoadTargetRate)
+        .function("getLoadActualRate", &ROSPublisherNodeWASM::getLoadActualRate)
+        .function("getLoadMeanLagMs", &ROSPublisherNodeWASM::getLoadMeanLagMs)
+        .function("getLoadP99LagMs", &ROSPublisherNodeWASM::getLoadP99LagMs)
+        .function("getLoadMaxLagMs", &ROSPublisherNodeWASM::getLoadMaxLagMs)
+        .function("getLoadReport", &ROSPublisherNodeWASM::getLoadReport)
+        .function("getStats", &ROSPublisherNodeWASM::getStats)
+        .function("enableMetricsTopic", &ROSPublisherNodeWASM::enableMetricsTopic)
+        .function("startTrace", &ROSPublisherNodeWASM::startTrace)
+        .function("stopTrace", &ROSPublisherNodeWASM::stopTrace)
+        .function("getTrace", &ROSPublisherNodeWASM::getTrace)
+        .function("getFrameCount", &ROSPublisherNodeWASM::getFrameCount)
+        .function("getBusyFrames", &ROSPublisherNodeWASM::getBusyFrames)
+        .function("getDeferredFrames", &ROSPublisherNodeWASM::getDeferredFrames)
+        .function("getLastFrameMs", &ROSPublisherNodeWASM::getLastFrameMs)
+        .function("getMaxFrameMs", &ROSPublisherNodeWASM::getMaxFrameMs)
+        .function("getMeanFrameMs", &ROSPublisherNodeWASM::getMeanFrameMs)
         .function("getMessageCount", &ROSPublisherNodeWASM::getMessageCount)
         .function("getSensorValue", &ROSPublisherNodeWASM::getSensorValue)
         .function("isInitialized", &ROSPublisherNodeWASM::isInitialized)
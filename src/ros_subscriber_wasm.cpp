@@ -9,56 +9,208 @@
 // Note: In production, this would be a proper header file
 // For now, we include the implementation directly
 #include "dds_minimal_wasm.cpp"
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "main_loop_wasm.h"
+#include "stream_stats_wasm.h"
+#include "receive_history_wasm.h"
+#include "json_extract_wasm.h"
+#include "rule_engine_wasm.h"
+#include "rosidl_typesupport_wasm.h"
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
 #include <string>
 #include <cstdio>
 #include <vector>
+#ifndef __EMSCRIPTEN__
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#endif
 
 using namespace emscripten;
 
+// Main loop cadence: receive polling and participant announcements
+#define ROS_WASM_RECEIVE_POLL_MS 10.0
+#define ROS_WASM_DISCOVERY_PERIOD_MS 1000.0
+// Datagrams delivered per main loop spin when the I/O thread runs
+#define ROS_WASM_RECEIVE_BATCH 64
+// Alarm events go to <topic>/alarms; until loadRules() any channel above 25 alarms
+#define ROS_WASM_ALARM_SUFFIX "/alarms"
+#define ROS_WASM_DEFAULT_RULES "above * 25.0"
+
 // ROS Subscriber Node - Complete implementation
 class ROSSubscriberNodeWASM {
 private:
     DDSParticipantWASM* participant;
     DDSSubscriberWASM* subscriber;
+    DDSPublisherWASM* alarm_publisher;
     std::string node_name;
     std::string topic_name;
     int messages_received;
-    std::vector<double> received_values;
+    StreamStatsWASM value_stats;
+    ReceiveHistoryWASM history;
+    JsonExtractorWASM value_field;
     double last_value;
     std::string last_message;
+    wasm_msgs__msg__SensorReading last_reading;
+    bool last_was_reading;  // getLastMessage() renders last_reading
     bool ros_initialized;
+    bool io_thread;
+    double next_poll_ms;
+    double next_discovery_ms;
+    MainLoopDriverWASM main_loop;
+    std::vector<uint8_t> batch_buffer;  // Reused by reserveBatchBuffer()
+    bool batching;                      // Inside processBatch(): evaluate rules once at the end
+    RuleEngineWASM rules;               // Channel = the reading's sensor field (JSON: 0)
+    bool rules_pending;                 // Values changed since the last evaluation
+    wasm_msgs__msg__AlarmEvent last_alarm;
+    wasm_msgs__msg__AlarmEvent last_raised;  // Latest raise; last_alarm may be a clear after it
+    bool has_alarm;
+    
+    // Main loop hooks: poll every ROS_WASM_RECEIVE_POLL_MS, announce every ROS_WASM_DISCOVERY_PERIOD_MS.
+    // With the I/O thread, its wakeup notifies the loop and each spin delivers one batch.
+    static bool mainLoopSpin(void* context) {
+        ROSSubscriberNodeWASM* self = static_cast<ROSSubscriberNodeWASM*>(context);
+        double now = emscripten_get_now();
+        if (now >= self->next_discovery_ms) {
+            self->participant->discoverParticipants();
+            self->next_discovery_ms = now + ROS_WASM_DISCOVERY_PERIOD_MS;
+        }
+        self->value_stats.expire(now);
+        if (self->io_thread) {
+            NetworkManagerWASM* net_mgr = self->participant->getNetworkManager();
+            net_mgr->pollUpTo(ROS_WASM_RECEIVE_BATCH);
+            self->evaluatePending();
+            return net_mgr->hasPendingReceives();
+        }
+        self->subscriber->spinOnce();
+        self->evaluatePending();
+        self->next_poll_ms = now + ROS_WASM_RECEIVE_POLL_MS;
+        return false;
+    }
+    
+    static double mainLoopNextDueMs(void* context) {
+        ROSSubscriberNodeWASM* self = static_cast<ROSSubscriberNodeWASM*>(context);
+        if (!self->ros_initialized) return -1.0;
+        double due = self->next_discovery_ms;
+        if (!self->io_thread && self->next_poll_ms < due) due = self->next_poll_ms;
+        double delay = due - emscripten_get_now();
+        return delay > 0 ? delay : 0.0;
+    }
+    
+    IOHandoffStatsWASM ioStats() const {
+        NetworkManagerWASM* net_mgr = participant ? participant->getNetworkManager() : nullptr;
+        const IOHandoffWASM* handoff = net_mgr ? net_mgr->getHandoff() : nullptr;
+        return handoff ? handoff->getStats() : IOHandoffStatsWASM();
+    }
+    
+    static MainLoopWorkWASM mainLoopWork(ROSSubscriberNodeWASM* self) {
+        MainLoopWorkWASM work;
+        work.spin = mainLoopSpin;
+        work.next_due_ms = mainLoopNextDueMs;
+        work.context = self;
+        return work;
+    }
     
-    // Message callback
+    // Binary reading, straight from the DDS frame
+    static void readingCallback(void* context, const uint8_t* payload, size_t length) {
+        ROSSubscriberNodeWASM* self = static_cast<ROSSubscriberNodeWASM*>(context);
+        if (length != sizeof(wasm_msgs__msg__SensorReading)) {
+            WASM_LOG_WARN("WASM: Dropped %zu byte payload (expected a sensor reading)\n", length);
+            return;
+        }
+        memcpy(&self->last_reading, payload, sizeof(self->last_reading));
+        self->messages_received++;
+        self->last_was_reading = true;
+        self->last_value = self->last_reading.value;
+        self->value_stats.add(self->last_value);
+        self->history.add(self->last_value, emscripten_get_now());
+        self->processValue(self->last_reading.sensor);
+    }
+    
+    // JSON payload (processMessage() from JS)
     void messageCallback(const std::string& data) {
         messages_received++;
         last_message = data;
+        last_was_reading = false;
         
-        // Parse JSON to extract value
-        size_t pos = data.find("\"value\":");
-        if (pos != std::string::npos) {
-            sscanf(data.c_str() + pos + 8, "%lf", &last_value);
-            received_values.push_back(last_value);
-            
-            // Keep last 10 values
-            if (received_values.size() > 10) {
-                received_values.erase(received_values.begin());
+        // Extract the value field (compact or spaced JSON)
+        JsonFieldWASM value;
+        if (value_field.extract(data.data(), data.size(), &value) && value.type == JSON_FIELD_NUMBER) {
+            last_value = value.number;
+            value_stats.add(last_value);
+            history.add(last_value, emscripten_get_now());
+        } else {
+            history.touch();
+        }
+        processValue(0);
+    }
+    
+    // Rules run over all channels once per message, batch or spin (evaluatePending())
+    void processValue(size_t channel) {
+        rules.setValue(channel, static_cast<float>(last_value));
+        rules_pending = true;
+        if (!batching) {
+            WASM_LOG_DEBUG("WASM: Message processed in WASM: channel %zu value=%.2f\n", channel, last_value);
+        }
+    }
+    
+    void evaluatePending() {
+        if (rules_pending) evaluateRules();
+    }
+    
+    // One AlarmEvent per raised or cleared alarm; one log line per evaluation
+    void publishAlarms() {
+        const std::vector<RuleEventWASM>& events = rules.getEvents();
+        double now_ms = emscripten_get_now();
+        int raised = 0;
+        for (const RuleEventWASM& event : events) {
+            last_alarm.stamp.sec = static_cast<int32_t>(now_ms / 1000.0);
+            last_alarm.stamp.nanosec = static_cast<uint32_t>((now_ms - last_alarm.stamp.sec * 1000.0) * 1000000.0);
+            last_alarm.channel = event.channel;
+            last_alarm.kind = static_cast<uint16_t>(event.kind);
+            last_alarm.raised = event.raised ? 1 : 0;
+            last_alarm.value = event.value;
+            last_alarm.level = event.level;
+            alarm_publisher->publishSerialized(reinterpret_cast<const uint8_t*>(&last_alarm), sizeof(last_alarm));
+            if (event.raised) {
+                last_raised = last_alarm;
+                raised++;
             }
         }
-        
-        printf("WASM: Message processed in WASM: value=%.2f\n", last_value);
+        has_alarm = has_alarm || !events.empty();
         
         // Simulate actuator response
-        if (last_value > 25.0) {
-            printf("WASM: ALARM - Temperature high (%.2f), activating cooling system!\n", last_value);
+        if (events.size() == 1) {
+            const RuleEventWASM& event = events[0];
+            if (event.raised) {
+                WASM_LOG_INFO("WASM: ALARM - channel %u %s %.2f (level %.2f), activating cooling system!\n",
+                              event.channel, ruleKindName(event.kind), event.value, event.level);
+            } else {
+                WASM_LOG_INFO("WASM: Alarm cleared - channel %u %s %.2f\n", event.channel, ruleKindName(event.kind),
+                              event.value);
+            }
+        } else if (raised > 0) {
+            WASM_LOG_INFO("WASM: ALARM - %d raised, %d cleared (%d active), activating cooling system!\n", raised,
+                          static_cast<int>(events.size()) - raised, rules.getActiveAlarms());
+        } else if (!events.empty()) {
+            WASM_LOG_INFO("WASM: Alarms cleared - %zu (%d active)\n", events.size(), rules.getActiveAlarms());
         }
     }
     
 public:
     ROSSubscriberNodeWASM(const std::string& node_name, const std::string& topic_name)
-        : node_name(node_name), topic_name(topic_name), messages_received(0), 
-          last_value(0.0), ros_initialized(false), participant(nullptr), subscriber(nullptr) {}
+        : participant(nullptr), subscriber(nullptr), alarm_publisher(nullptr), node_name(node_name),
+          topic_name(topic_name), messages_received(0), value_field({"value"}), last_value(0.0),
+          last_was_reading(false), ros_initialized(false), io_thread(false), next_poll_ms(0), next_discovery_ms(0),
+          main_loop(mainLoopWork(this)), batching(false), rules_pending(false), has_alarm(false) {
+        memset(&last_reading, 0, sizeof(last_reading));
+        memset(&last_alarm, 0, sizeof(last_alarm));
+        memset(&last_raised, 0, sizeof(last_raised));
+        rules.loadRules(ROS_WASM_DEFAULT_RULES, strlen(ROS_WASM_DEFAULT_RULES));
+    }
     
     // Initialize ROS node and subscriber
     bool init() {
@@ -71,18 +223,29 @@ public:
             return false;
         }
         
-        // Create DDS subscriber
-        subscriber = new DDSSubscriberWASM(participant, topic_name);
+        // Create DDS subscriber for binary readings
+        const rosidl_message_type_support_t* ts = ROSIDL_GET_MSG_TYPE_SUPPORT(wasm_msgs, msg, SensorReading);
+        subscriber = new DDSSubscriberWASM(participant, topic_name, ts->type_name, ts->type_hash);
         if (!subscriber->init()) {
             printf("WASM: Failed to initialize DDS subscriber\n");
             return false;
         }
         
-        // Set callback for received messages
+        // Typed frames decode in place; JSON envelopes (from JS) go through the extractor
+        subscriber->setRawCallback(&ROSSubscriberNodeWASM::readingCallback, this);
         subscriber->setCallback([this](const std::string& data) {
             this->messageCallback(data);
         });
         
+        // Alarm events on their own topic
+        const rosidl_message_type_support_t* alarm_ts = ROSIDL_GET_MSG_TYPE_SUPPORT(wasm_msgs, msg, AlarmEvent);
+        alarm_publisher = new DDSPublisherWASM(participant, topic_name + ROS_WASM_ALARM_SUFFIX, alarm_ts->type_name,
+                                               alarm_ts->type_hash);
+        if (!alarm_publisher->init() || !alarm_publisher->reserveFrame(sizeof(wasm_msgs__msg__AlarmEvent))) {
+            printf("WASM: Failed to initialize alarm publisher\n");
+            return false;
+        }
+        
         ros_initialized = true;
         printf("WASM: ROS Subscriber Node '%s' initialized successfully\n", node_name.c_str());
         return true;
@@ -91,12 +254,39 @@ public:
     // Process incoming message (called by DDS layer)
     void processMessage(const std::string& serialized) {
         if (!ros_initialized) {
-            printf("WASM: ROS node not initialized\n");
+            WASM_LOG_WARN("WASM: ROS node not initialized\n");
             return;
         }
         
         // Receive via DDS - this executes entirely in WASM
         subscriber->receiveMessage(serialized);
+        evaluatePending();
+    }
+    
+    // Space for a batch of `bytes` in WASM memory; JS copies the batch to
+    // HEAPU8 at the returned address (read HEAPU8 after this call, memory may
+    // have grown), then calls processBatch(). Reused across batches.
+    uintptr_t reserveBatchBuffer(int bytes) {
+        if (bytes > 0 && batch_buffer.size() < static_cast<size_t>(bytes)) {
+            batch_buffer.resize(bytes);
+        }
+        return reinterpret_cast<uintptr_t>(batch_buffer.data());
+    }
+    
+    // Many length-prefixed frames (typed readings or JSON envelopes, see
+    // DDS_BATCH_LENGTH_PREFIX) in one JS->WASM call instead of one
+    // processMessage() each. Returns the frames processed.
+    int processBatch(uintptr_t address, int length) {
+        if (!ros_initialized) {
+            WASM_LOG_WARN("WASM: ROS node not initialized\n");
+            return 0;
+        }
+        
+        batching = true;
+        int frames = subscriber->receiveBatchAt(address, length);
+        batching = false;
+        evaluatePending();
+        return frames;
     }
     
     // Spin ROS node (process events and messages)
@@ -108,36 +298,293 @@ public:
         
         // Check for incoming messages
         subscriber->spinOnce();
+        evaluatePending();
+        value_stats.expire(emscripten_get_now());
+    }
+    
+    // Replaces the alarm rules (format in rule_engine_wasm.h); returns the
+    // rules loaded, -1 if the text has an error (the old rules stay)
+    int loadRules(const std::string& text) {
+        return rules.loadRules(text.data(), text.size());
+    }
+    
+    void clearRules() {
+        rules.clearRules();
+    }
+    
+    // Evaluates every rule on every channel now and publishes the alarms
+    // raised or cleared; returns how many
+    int evaluateRules() {
+        if (!ros_initialized) return 0;
+        rules_pending = false;
+        int events = rules.evaluate(emscripten_get_now());
+        if (events > 0) publishAlarms();
+        return events;
+    }
+    
+    bool setChannelCount(int channels) {
+        return channels > 0 && rules.ensureChannels(static_cast<size_t>(channels));
     }
     
+    // Latest value per channel, writable: gateways fill it from JS and call
+    // evaluateRules(). Valid until the next call into the module.
+    val getChannelValuesView() {
+        return val(typed_memory_view(rules.getChannelCount(), rules.getValues()));
+    }
+    
+    // Spin from the browser instead of a JS setInterval: mode 0 checks every
+    // requestAnimationFrame, mode 1 sleeps until the next poll or announcement
+    bool startMainLoop(int mode, double frame_budget_ms) {
+        if (!ros_initialized) return false;
+        return main_loop.start(mode == MAIN_LOOP_EVENT_DRIVEN ? MAIN_LOOP_EVENT_DRIVEN : MAIN_LOOP_ANIMATION_FRAME,
+                               frame_budget_ms);
+    }
+    
+    void stopMainLoop() {
+        main_loop.stop();
+    }
+    
+#ifndef __EMSCRIPTEN__
+    // Without a browser event loop: pump the main loop for duration_ms,
+    // sleeping until the next poll or announcement is due
+    void runFor(double duration_ms) {
+        if (!ros_initialized) return;
+        if (!main_loop.isRunning()) main_loop.start(MAIN_LOOP_EVENT_DRIVEN, MAIN_LOOP_WASM_DEFAULT_BUDGET_MS);
+        double end = emscripten_get_now() + duration_ms;
+        while (true) {
+            main_loop.pump();
+            double now = emscripten_get_now();
+            if (now >= end) break;
+            double delay = mainLoopNextDueMs(this);
+            if (io_thread && delay > ROS_WASM_RECEIVE_POLL_MS) delay = ROS_WASM_RECEIVE_POLL_MS;
+            if (delay > end - now) delay = end - now;
+            if (delay > 0) std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(delay));
+        }
+    }
+#endif
+    
+    // Read the socket on a dedicated thread (pthreads builds); received frames
+    // are queued and wake the main loop once per batch instead of being polled
+    bool startIOThread() {
+        if (!ros_initialized || io_thread) return io_thread;
+        participant->getNetworkManager()->setReceiveWakeCallback(&MainLoopDriverWASM::onActivity, &main_loop);
+        if (!participant->startIOThread()) return false;
+        io_thread = true;
+        return true;
+    }
+    
+    // Time spent per main loop frame
+    double getFrameCount() const { return static_cast<double>(main_loop.getStats().frames); }
+    double getBusyFrames() const { return static_cast<double>(main_loop.getStats().busy_frames); }
+    double getDeferredFrames() const { return static_cast<double>(main_loop.getStats().deferred_frames); }
+    double getLastFrameMs() const { return main_loop.getStats().last_frame_ms; }
+    double getMaxFrameMs() const { return main_loop.getStats().max_frame_ms; }
+    double getMeanFrameMs() const { return main_loop.getMeanFrameMs(); }
+    
+    // Receive hand-off from the I/O thread
+    double getQueueDepth() const { return static_cast<double>(ioStats().depth); }
+    double getMaxQueueDepth() const { return static_cast<double>(ioStats().max_depth); }
+    double getDroppedFrames() const { return static_cast<double>(ioStats().dropped); }
+    double getHandoffLatencyMs() const { return ioStats().mean_latency_ms; }
+    double getMaxHandoffLatencyMs() const { return ioStats().max_latency_ms; }
+    
     int getMessagesReceived() const { return messages_received; }
     double getLastValue() const { return last_value; }
-    std::string getLastMessage() const { return last_message; }
+    // JSON only here, at the JS edge
+    std::string getLastMessage() const {
+        if (!last_was_reading) return last_message;
+        char buffer[256];
+        wasm_msgs__msg__SensorReading__to_json(&last_reading, buffer, sizeof(buffer));
+        return std::string(buffer);
+    }
+    
+    // Received values: window of the last N (and optionally last window_ms),
+    // percentiles since the window was set; all O(1)
+    double getAverageValue() const { return value_stats.getMean(); }
+    double getMinValue() const { return value_stats.getMin(); }
+    double getMaxValue() const { return value_stats.getMax(); }
+    double getStdDevValue() const { return value_stats.getStdDev(); }
+    double getMedianValue() const { return value_stats.getMedian(); }
+    double getP95Value() const { return value_stats.getP95(); }
+    double getP99Value() const { return value_stats.getP99(); }
+    double getWindowCount() const { return static_cast<double>(value_stats.size()); }
+    
+    void setValueWindow(int count, double window_ms) {
+        value_stats.configure(count > 0 ? static_cast<size_t>(count) : STREAM_STATS_WASM_DEFAULT_WINDOW, window_ms);
+    }
     
-    double getAverageValue() const {
-        if (received_values.empty()) return 0.0;
-        double sum = 0.0;
-        for (double val : received_values) {
-            sum += val;
+    // Zero-copy reads for dashboards (receive_history_wasm.h): views into
+    // WASM memory, valid until the next call into the module
+    val getValueHistory() const { return val(typed_memory_view(history.size(), history.getValues())); }
+    val getTimeHistory() const { return val(typed_memory_view(history.size(), history.getTimes())); }
+    // Last message as received: the 20-byte SensorReading record (read it
+    // with a DataView) or, when isLastMessageReading() is false, JSON text
+    val getLastMessageView() const {
+        if (last_was_reading) {
+            return val(typed_memory_view(sizeof(last_reading), reinterpret_cast<const uint8_t*>(&last_reading)));
         }
-        return sum / received_values.size();
+        return val(typed_memory_view(last_message.size(), reinterpret_cast<const uint8_t*>(last_message.data())));
+    }
+    bool isLastMessageReading() const { return last_was_reading; }
+    double getChangeSequence() const { return static_cast<double>(history.getSequence()); }
+    
+    void setHistoryCapacity(int samples) {
+        history.configure(samples > 0 ? static_cast<size_t>(samples) : RECEIVE_HISTORY_WASM_DEFAULT_CAPACITY);
+    }
+    
+    // Alarm rules
+    int getRuleCount() const { return rules.getRuleCount(); }
+    int getChannelCount() const { return static_cast<int>(rules.getChannelCount()); }
+    int getActiveAlarms() const { return rules.getActiveAlarms(); }
+    double getAlarmsRaised() const { return static_cast<double>(rules.getRaisedTotal()); }
+    double getAlarmsCleared() const { return static_cast<double>(rules.getClearedTotal()); }
+    double getRuleChannelsPerSecond() const { return rules.getChannelsPerSecond(); }
+    double getLastRuleEvaluationMs() const { return rules.getLastEvaluateMs(); }
+    std::string getLastAlarm() const {
+        if (!has_alarm) return "";
+        char buffer[256];
+        wasm_msgs__msg__AlarmEvent__to_json(&last_alarm, buffer, sizeof(buffer));
+        return std::string(buffer);
+    }
+    std::string getLastRaisedAlarm() const {
+        if (rules.getRaisedTotal() == 0) return "";
+        char buffer[256];
+        wasm_msgs__msg__AlarmEvent__to_json(&last_raised, buffer, sizeof(buffer));
+        return std::string(buffer);
+    }
+    std::string getAlarmTopicName() const { return topic_name + ROS_WASM_ALARM_SUFFIX; }
+    
+    // Counters of the node's participant, endpoints and sockets, as JSON
+    std::string getStats() const { return participant ? participant->getStats() : std::string("{}"); }
+    
+    // getStats() on DDS_METRICS_TOPIC every period_ms, sent with the discovery
+    // announcements (ROS_WASM_DISCOVERY_PERIOD_MS at the finest); 0 stops
+    bool enableMetricsTopic(double period_ms) {
+        return ros_initialized && participant->enableMetricsTopic(period_ms);
+    }
+    
+    // Spans of every message stage in this process (trace_wasm.h), from
+    // startTrace() on; getTrace() is Chrome Trace Event JSON for Perfetto
+    void startTrace(int events_per_thread) {
+        traceWASMStart(events_per_thread > 0 ? static_cast<size_t>(events_per_thread) : TRACE_WASM_DEFAULT_EVENTS);
     }
+    void stopTrace() { traceWASMStop(); }
+    std::string getTrace() const { return traceWASMExportJSON(node_name); }
     
     bool isInitialized() const { return ros_initialized; }
+    bool isIOThreadRunning() const { return io_thread; }
     std::string getNodeName() const { return node_name; }
     std::string getTopicName() const { return topic_name; }
 };
 
+#ifndef __EMSCRIPTEN__
+// Native executable (src/native/ros_subscriber_main.cpp):
+//   ros_subscriber_node [topic] [seconds] [rules_file] [--trace FILE]
+// Prints a status line per second and every new alarm; seconds 0 = until killed.
+// --trace writes the pipeline spans as Chrome Trace Event JSON at the end.
+int rosSubscriberNodeMain(int argc, char** argv) {
+    const char* trace_file = nullptr;
+    std::vector<const char*> args;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_file = argv[++i];
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    std::string topic = args.size() > 0 ? args[0] : "/sensor/temperature";
+    double seconds = args.size() > 1 ? atof(args[1]) : 0.0;
+    ROSSubscriberNodeWASM node("wasm_subscriber", topic);
+    if (!node.init()) return 1;
+    if (trace_file) node.startTrace(0);
+
+    if (args.size() > 2) {
+        std::ifstream file(args[2]);
+        std::stringstream text;
+        text << file.rdbuf();
+        if (!file || node.loadRules(text.str()) < 0) {
+            printf("WASM: Could not load rules from %s\n", args[2]);
+            return 1;
+        }
+    }
+
+    double end = seconds > 0 ? emscripten_get_now() + seconds * 1000.0 : INFINITY;
+    double raised = 0;
+    while (emscripten_get_now() < end) {
+        node.runFor(1000.0);
+        if (node.getAlarmsRaised() > raised) {
+            raised = node.getAlarmsRaised();
+            printf("alarm %s\n", node.getLastRaisedAlarm().c_str());
+        }
+        printf("received %d, mean %.2f, active alarms %d, last %s\n", node.getMessagesReceived(),
+               node.getAverageValue(), node.getActiveAlarms(), node.getLastMessage().c_str());
+        fflush(stdout);
+    }
+    return trace_file && !traceWASMWriteFile(trace_file, "wasm_subscriber") ? 1 : 0;
+}
+#endif
+
 EMSCRIPTEN_BINDINGS(ros_subscriber_wasm) {
     class_<ROSSubscriberNodeWASM>("ROSSubscriberNodeWASM")
         .constructor<const std::string&, const std::string&>()
         .function("init", &ROSSubscriberNodeWASM::init)
         .function("processMessage", &ROSSubscriberNodeWASM::processMessage)
+        .function("reserveBatchBuffer", &ROSSubscriberNodeWASM::reserveBatchBuffer)
+        .function("processBatch", &ROSSubscriberNodeWASM::processBatch)
         .function("spinOnce", &ROSSubscriberNodeWASM::spinOnce)
+        .function("startMainLoop", &ROSSubscriberNodeWASM::startMainLoop)
+        .function("stopMainLoop", &ROSSubscriberNodeWASM::stopMainLoop)
+        .function("getFrameCount", &ROSSubscriberNodeWASM::getFrameCount)
+        .function("getBusyFrames", &ROSSubscriberNodeWASM::getBusyFrames)
+        .function("getDeferredFrames", &ROSSubscriberNodeWASM::getDeferredFrames)
+        .function("getLastFrameMs", &ROSSubscriberNodeWASM::getLastFrameMs)
+        .function("getMaxFrameMs", &ROSSubscriberNodeWASM::getMaxFrameMs)
+        .function("getMeanFrameMs", &ROSSubscriberNodeWASM::getMeanFrameMs)
+        .function("startIOThread", &ROSSubscriberNodeWASM::startIOThread)
+        .function("isIOThreadRunning", &ROSSubscriberNodeWASM::isIOThreadRunning)
+        .function("getQueueDepth", &ROSSubscriberNodeWASM::getQueueDepth)
+        .function("getMaxQueueDepth", &ROSSubscriberNodeWASM::getMaxQueueDepth)
+        .function("getDroppedFrames", &ROSSubscriberNodeWASM::getDroppedFrames)
+        .function("getHandoffLatencyMs", &ROSSubscriberNodeWASM::getHandoffLatencyMs)
+        .function("getMaxHandoffLatencyMs", &ROSSubscriberNodeWASM::getMaxHandoffLatencyMs)
+        .function("getStats", &ROSSubscriberNodeWASM::getStats)
+        .function("enableMetricsTopic", &ROSSubscriberNodeWASM::enableMetricsTopic)
+        .function("startTrace", &ROSSubscriberNodeWASM::startTrace)
+        .function("stopTrace", &ROSSubscriberNodeWASM::stopTrace)
+        .function("getTrace", &ROSSubscriberNodeWASM::getTrace)
         .function("getMessagesReceived", &ROSSubscriberNodeWASM::getMessagesReceived)
         .function("getLastValue", &ROSSubscriberNodeWASM::getLastValue)
         .function("getLastMessage", &ROSSubscriberNodeWASM::getLastMessage)
         .function("getAverageValue", &ROSSubscriberNodeWASM::getAverageValue)
+        .function("getMinValue", &ROSSubscriberNodeWASM::getMinValue)
+        .function("getMaxValue", &ROSSubscriberNodeWASM::getMaxValue)
+        .function("getStdDevValue", &ROSSubscriberNodeWASM::getStdDevValue)
+        .function("getMedianValue", &ROSSubscriberNodeWASM::getMedianValue)
+        .function("getP95Value", &ROSSubscriberNodeWASM::getP95Value)
+        .function("getP99Value", &ROSSubscriberNodeWASM::getP99Value)
+        .function("getWindowCount", &ROSSubscriberNodeWASM::getWindowCount)
+        .function("setValueWindow", &ROSSubscriberNodeWASM::setValueWindow)
+        .function("getValueHistory", &ROSSubscriberNodeWASM::getValueHistory)
+        .function("getTimeHistory", &ROSSubscriberNodeWASM::getTimeHistory)
+        .function("getLastMessageView", &ROSSubscriberNodeWASM::getLastMessageView)
+        .function("getChangeSequence", &ROSSubscriberNodeWASM::getChangeSequence)
+        .function("setHistoryCapacity", &ROSSubscriberNodeWASM::setHistoryCapacity)
+        .function("isLastMessageReading", &ROSSubscriberNodeWASM::isLastMessageReading)
+        .function("loadRules", &ROSSubscriberNodeWASM::loadRules)
+        .function("clearRules", &ROSSubscriberNodeWASM::clearRules)
+        .function("evaluateRules", &ROSSubscriberNodeWASM::evaluateRules)
+        .function("setChannelCount", &ROSSubscriberNodeWASM::setChannelCount)
+        .function("getChannelValuesView", &ROSSubscriberNodeWASM::getChannelValuesView)
+        .function("getRuleCount", &ROSSubscriberNodeWASM::getRuleCount)
+        .function("getChannelCount", &ROSSubscriberNodeWASM::getChannelCount)
+        .function("getActiveAlarms", &ROSSubscriberNodeWASM::getActiveAlarms)
+        .function("getAlarmsRaised", &ROSSubscriberNodeWASM::getAlarmsRaised)
+        .function("getAlarmsCleared", &ROSSubscriberNodeWASM::getAlarmsCleared)
+        .function("getRuleChannelsPerSecond", &ROSSubscriberNodeWASM::getRuleChannelsPerSecond)
+        .function("getLastRuleEvaluationMs", &ROSSubscriberNodeWASM::getLastRuleEvaluationMs)
+        .function("getLastAlarm", &ROSSubscriberNodeWASM::getLastAlarm)
+        .function("getLastRaisedAlarm", &ROSSubscriberNodeWASM::getLastRaisedAlarm)
+        .function("getAlarmTopicName", &ROSSubscriberNodeWASM::getAlarmTopicName)
         .function("isInitialized", &ROSSubscriberNodeWASM::isInitialized)
         .function("getNodeName", &ROSSubscriberNodeWASM::getNodeName)
         .function("getTopicName", &ROSSubscriberNodeWASM::getTopicName);
@@ -0,0 +1,492 @@
+/*
+ * rosidl Type Support for WASM
+ *
+ * Message structs laid out like the rosidl C generator output, plus
+ * serializers generated at compile time from a per-message field list.
+ * Wire format: little-endian, unaligned, strings as uint32 length + bytes.
+ * Messages whose fields are all scalars/fixed arrays with no padding are
+ * serialized as a single memcpy of the struct. Services pair a request and
+ * a response type under one rosidl_service_type_support_t.
+ */
+
+#ifndef ROSIDL_TYPESUPPORT_WASM_H
+#define ROSIDL_TYPESUPPORT_WASM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include "rcl_types_wasm.h"
+
+// rosidl runtime types
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} rosidl_runtime_c__String;
+
+inline bool rosidl_runtime_c__String__init(rosidl_runtime_c__String* str) {
+    if (!str) return false;
+    str->data = nullptr;
+    str->size = 0;
+    str->capacity = 0;
+    return true;
+}
+
+inline void rosidl_runtime_c__String__fini(rosidl_runtime_c__String* str) {
+    if (!str) return;
+    free(str->data);
+    rosidl_runtime_c__String__init(str);
+}
+
+inline bool rosidl_runtime_c__String__assignn(rosidl_runtime_c__String* str, const char* value, size_t n) {
+    if (!str || (!value && n > 0)) return false;
+    if (n + 1 > str->capacity) {
+        char* data = static_cast<char*>(realloc(str->data, n + 1));
+        if (!data) return false;
+        str->data = data;
+        str->capacity = n + 1;
+    }
+    if (n > 0) memcpy(str->data, value, n);
+    str->data[n] = '\0';
+    str->size = n;
+    return true;
+}
+
+// Message types
+typedef struct {
+    int32_t sec;
+    uint32_t nanosec;
+} builtin_interfaces__msg__Time;
+
+typedef struct {
+    builtin_interfaces__msg__Time stamp;
+    rosidl_runtime_c__String frame_id;
+} std_msgs__msg__Header;
+
+typedef struct {
+    rosidl_runtime_c__String data;
+} std_msgs__msg__String;
+
+typedef struct {
+    double data;
+} std_msgs__msg__Float64;
+
+typedef struct {
+    std_msgs__msg__Header header;
+    double temperature;
+    double variance;
+} sensor_msgs__msg__Temperature;
+
+// Fixed-size block of samples from one sensor (no ROS upstream equivalent)
+#define WASM_MSGS__MSG__SENSOR_BLOCK__VALUES_MAX 16
+typedef struct {
+    builtin_interfaces__msg__Time stamp;
+    uint32_t sensor_id;
+    uint32_t count;
+    float values[WASM_MSGS__MSG__SENSOR_BLOCK__VALUES_MAX];
+} wasm_msgs__msg__SensorBlock;
+
+// One sensor reading as a fixed-size record (no ROS upstream equivalent);
+// replaces the JSON sensor payload, 20 bytes on the wire
+#define WASM_MSGS__MSG__SENSOR_READING__SENSOR_TEMPERATURE 0
+#define WASM_MSGS__MSG__SENSOR_READING__SENSOR_HUMIDITY 1
+#define WASM_MSGS__MSG__SENSOR_READING__SENSOR_PRESSURE 2
+#define WASM_MSGS__MSG__SENSOR_READING__UNIT_CELSIUS 0
+#define WASM_MSGS__MSG__SENSOR_READING__UNIT_PERCENT 1
+#define WASM_MSGS__MSG__SENSOR_READING__UNIT_PASCAL 2
+typedef struct {
+    builtin_interfaces__msg__Time stamp;
+    uint32_t id;
+    uint16_t sensor;
+    uint16_t unit;
+    float value;
+} wasm_msgs__msg__SensorReading;
+
+// An alarm raised or cleared by a rule (rule_engine_wasm.h), on <topic>/alarms
+#define WASM_MSGS__MSG__ALARM_EVENT__KIND_ABOVE 0
+#define WASM_MSGS__MSG__ALARM_EVENT__KIND_BELOW 1
+#define WASM_MSGS__MSG__ALARM_EVENT__KIND_RATE 2
+#define WASM_MSGS__MSG__ALARM_EVENT__KIND_MEAN_ABOVE 3
+typedef struct {
+    builtin_interfaces__msg__Time stamp;
+    uint32_t channel;
+    uint16_t kind;
+    uint16_t raised;  // 1 raised, 0 cleared
+    float value;      // Value, rate or window mean that crossed the level
+    float level;
+} wasm_msgs__msg__AlarmEvent;
+
+// Service types (request/response pairs)
+typedef struct {
+    int64_t a;
+    int64_t b;
+} example_interfaces__srv__AddTwoInts_Request;
+
+typedef struct {
+    int64_t sum;
+} example_interfaces__srv__AddTwoInts_Response;
+
+struct example_interfaces__srv__AddTwoInts;  // Tag for ROSIDL_GET_SRV_TYPE_SUPPORT
+
+inline bool std_msgs__msg__String__init(std_msgs__msg__String* msg) {
+    return msg && rosidl_runtime_c__String__init(&msg->data);
+}
+
+inline void std_msgs__msg__String__fini(std_msgs__msg__String* msg) {
+    if (msg) rosidl_runtime_c__String__fini(&msg->data);
+}
+
+inline bool sensor_msgs__msg__Temperature__init(sensor_msgs__msg__Temperature* msg) {
+    if (!msg) return false;
+    memset(msg, 0, sizeof(*msg));
+    return rosidl_runtime_c__String__init(&msg->header.frame_id);
+}
+
+inline void sensor_msgs__msg__Temperature__fini(sensor_msgs__msg__Temperature* msg) {
+    if (msg) rosidl_runtime_c__String__fini(&msg->header.frame_id);
+}
+
+// JSON text of a reading, for the JS/dashboard edge only (nothing on the
+// message path renders or parses it). Returns the length, as snprintf.
+inline int wasm_msgs__msg__SensorReading__to_json(const wasm_msgs__msg__SensorReading* msg, char* buffer,
+                                                  size_t capacity) {
+    static const char* const sensors[] = {"temperature", "humidity", "pressure"};
+    static const char* const units[] = {"celsius", "percent", "pascal"};
+    return snprintf(buffer, capacity,
+                    "{\"id\": %u, \"sensor\": \"%s\", \"value\": %.2f, \"unit\": \"%s\", \"stamp\": %d.%09u}",
+                    msg->id, msg->sensor < 3 ? sensors[msg->sensor] : "unknown", msg->value,
+                    msg->unit < 3 ? units[msg->unit] : "unknown", msg->stamp.sec, msg->stamp.nanosec);
+}
+
+inline int wasm_msgs__msg__AlarmEvent__to_json(const wasm_msgs__msg__AlarmEvent* msg, char* buffer, size_t capacity) {
+    static const char* const kinds[] = {"above", "below", "rate", "mean_above"};
+    return snprintf(buffer, capacity,
+                    "{\"channel\": %u, \"kind\": \"%s\", \"raised\": %s, \"value\": %.2f, \"level\": %.2f, "
+                    "\"stamp\": %d.%09u}",
+                    msg->channel, msg->kind < 4 ? kinds[msg->kind] : "unknown", msg->raised ? "true" : "false",
+                    msg->value, msg->level, msg->stamp.sec, msg->stamp.nanosec);
+}
+
+namespace rosidl_typesupport_wasm {
+
+constexpr const char* kIdentifier = "rosidl_typesupport_wasm";
+
+// Field layout description, specialised once per message type
+template <auto... Members>
+struct FieldList {};
+
+template <typename T>
+struct MessageTraits;
+
+template <typename T, typename = void>
+struct HasTraits : std::false_type {};
+
+template <typename T>
+struct HasTraits<T, std::void_t<decltype(MessageTraits<T>::name)>> : std::true_type {};
+
+template <typename M>
+struct MemberType;
+
+template <typename C, typename F>
+struct MemberType<F C::*> { using type = F; };
+
+template <auto Member>
+using member_t = typename MemberType<decltype(Member)>::type;
+
+constexpr uint64_t fnv1a(const char* s, uint64_t h = 14695981039346656037ull) {
+    return *s ? fnv1a(s + 1, (h ^ static_cast<uint8_t>(*s)) * 1099511628211ull) : h;
+}
+
+constexpr uint64_t hashMix(uint64_t h, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        h = (h ^ ((v >> (i * 8)) & 0xFF)) * 1099511628211ull;
+    }
+    return h;
+}
+
+// True when the in-memory image of T is exactly its wire image
+template <typename T>
+constexpr bool isPacked();
+
+template <typename T, auto... Ms>
+constexpr bool fieldsPacked(FieldList<Ms...>) {
+    return (isPacked<member_t<Ms>>() && ...) && (sizeof(member_t<Ms>) + ... + 0) == sizeof(T);
+}
+
+template <typename T>
+constexpr bool isPacked() {
+    if constexpr (std::is_arithmetic_v<T>) {
+        return true;
+    } else if constexpr (std::is_array_v<T>) {
+        return isPacked<std::remove_extent_t<T>>();
+    } else if constexpr (HasTraits<T>::value) {
+        return fieldsPacked<T>(typename MessageTraits<T>::fields{});
+    } else {
+        return false;
+    }
+}
+
+template <typename T>
+constexpr uint64_t typeHash();
+
+template <auto... Ms>
+constexpr uint64_t fieldsHash(uint64_t h, FieldList<Ms...>) {
+    ((h = hashMix(h, typeHash<member_t<Ms>>())), ...);
+    return h;
+}
+
+template <typename T>
+constexpr uint64_t typeHash() {
+    if constexpr (std::is_same_v<T, rosidl_runtime_c__String>) {
+        return fnv1a("string");
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        return hashMix(fnv1a(std::is_floating_point_v<T> ? "float" : "int"),
+                       sizeof(T) * 2 + (std::is_signed_v<T> ? 1 : 0));
+    } else if constexpr (std::is_array_v<T>) {
+        return hashMix(typeHash<std::remove_extent_t<T>>(), std::extent_v<T>);
+    } else {
+        return fieldsHash(fnv1a(MessageTraits<T>::name), typename MessageTraits<T>::fields{});
+    }
+}
+
+template <typename T>
+struct Codec {
+    static constexpr bool packed = isPacked<T>();
+
+    static size_t size(const T& value) {
+        if constexpr (packed) {
+            return sizeof(T);
+        } else if constexpr (std::is_same_v<T, rosidl_runtime_c__String>) {
+            return sizeof(uint32_t) + value.size;
+        } else if constexpr (std::is_array_v<T>) {
+            size_t total = 0;
+            for (const auto& element : value) total += Codec<std::remove_extent_t<T>>::size(element);
+            return total;
+        } else {
+            return fieldsSize(value, typename MessageTraits<T>::fields{});
+        }
+    }
+
+    static uint8_t* write(const T& value, uint8_t* out) {
+        if constexpr (packed) {
+            memcpy(out, &value, sizeof(T));
+            return out + sizeof(T);
+        } else if constexpr (std::is_same_v<T, rosidl_runtime_c__String>) {
+            uint32_t length = static_cast<uint32_t>(value.size);
+            memcpy(out, &length, sizeof(length));
+            if (length > 0) memcpy(out + sizeof(length), value.data, length);
+            return out + sizeof(length) + length;
+        } else if constexpr (std::is_array_v<T>) {
+            for (const auto& element : value) out = Codec<std::remove_extent_t<T>>::write(element, out);
+            return out;
+        } else {
+            return fieldsWrite(value, out, typename MessageTraits<T>::fields{});
+        }
+    }
+
+    // Returns nullptr if the buffer is too short
+    static const uint8_t* read(const uint8_t* in, const uint8_t* end, T& value) {
+        if constexpr (packed) {
+            if (static_cast<size_t>(end - in) < sizeof(T)) return nullptr;
+            memcpy(&value, in, sizeof(T));
+            return in + sizeof(T);
+        } else if constexpr (std::is_same_v<T, rosidl_runtime_c__String>) {
+            uint32_t length = 0;
+            if (static_cast<size_t>(end - in) < sizeof(length)) return nullptr;
+            memcpy(&length, in, sizeof(length));
+            in += sizeof(length);
+            if (static_cast<size_t>(end - in) < length) return nullptr;
+            if (!rosidl_runtime_c__String__assignn(&value, reinterpret_cast<const char*>(in), length)) return nullptr;
+            return in + length;
+        } else if constexpr (std::is_array_v<T>) {
+            for (auto& element : value) {
+                in = Codec<std::remove_extent_t<T>>::read(in, end, element);
+                if (!in) return nullptr;
+            }
+            return in;
+        } else {
+            return fieldsRead(in, end, value, typename MessageTraits<T>::fields{});
+        }
+    }
+
+private:
+    template <auto... Ms>
+    static size_t fieldsSize(const T& value, FieldList<Ms...>) {
+        return (Codec<member_t<Ms>>::size(value.*Ms) + ... + 0);
+    }
+
+    template <auto... Ms>
+    static uint8_t* fieldsWrite(const T& value, uint8_t* out, FieldList<Ms...>) {
+        ((out = Codec<member_t<Ms>>::write(value.*Ms, out)), ...);
+        return out;
+    }
+
+    template <auto... Ms>
+    static const uint8_t* fieldsRead(const uint8_t* in, const uint8_t* end, T& value, FieldList<Ms...>) {
+        ((in = in ? Codec<member_t<Ms>>::read(in, end, value.*Ms) : nullptr), ...);
+        return in;
+    }
+};
+
+template <typename T>
+struct TypeSupport {
+    static size_t getSerializedSize(const void* ros_message) {
+        return Codec<T>::size(*static_cast<const T*>(ros_message));
+    }
+
+    static size_t serialize(const void* ros_message, uint8_t* buffer, size_t capacity) {
+        const T& value = *static_cast<const T*>(ros_message);
+        size_t length = Codec<T>::size(value);
+        if (length > capacity) return 0;
+        Codec<T>::write(value, buffer);
+        return length;
+    }
+
+    static bool deserialize(const uint8_t* buffer, size_t length, void* ros_message) {
+        T& value = *static_cast<T*>(ros_message);
+        if constexpr (Codec<T>::packed) {
+            if (length != sizeof(T)) return false;
+            memcpy(&value, buffer, sizeof(T));
+            return true;
+        } else {
+            return Codec<T>::read(buffer, buffer + length, value) == buffer + length;
+        }
+    }
+
+    static constexpr rosidl_message_type_support_t value = {
+        kIdentifier,
+        MessageTraits<T>::name,
+        typeHash<T>(),
+        Codec<T>::packed ? sizeof(T) : 0,
+        &getSerializedSize,
+        &serialize,
+        &deserialize,
+    };
+};
+
+template <typename T>
+const rosidl_message_type_support_t* getMessageTypeSupport() {
+    return &TypeSupport<T>::value;
+}
+
+template <typename Srv>
+struct ServiceTraits;
+
+template <typename Srv>
+struct ServiceTypeSupport {
+    static constexpr rosidl_service_type_support_t value = {
+        kIdentifier,
+        ServiceTraits<Srv>::name,
+        &TypeSupport<typename ServiceTraits<Srv>::Request>::value,
+        &TypeSupport<typename ServiceTraits<Srv>::Response>::value,
+    };
+};
+
+template <typename Srv>
+const rosidl_service_type_support_t* getServiceTypeSupport() {
+    return &ServiceTypeSupport<Srv>::value;
+}
+
+// Field lists
+template <>
+struct MessageTraits<builtin_interfaces__msg__Time> {
+    static constexpr const char name[] = "builtin_interfaces::msg::Time";
+    using fields = FieldList<&builtin_interfaces__msg__Time::sec, &builtin_interfaces__msg__Time::nanosec>;
+};
+
+template <>
+struct MessageTraits<std_msgs__msg__Header> {
+    static constexpr const char name[] = "std_msgs::msg::Header";
+    using fields = FieldList<&std_msgs__msg__Header::stamp, &std_msgs__msg__Header::frame_id>;
+};
+
+template <>
+struct MessageTraits<std_msgs__msg__String> {
+    static constexpr const char name[] = "std_msgs::msg::String";
+    using fields = FieldList<&std_msgs__msg__String::data>;
+};
+
+template <>
+struct MessageTraits<std_msgs__msg__Float64> {
+    static constexpr const char name[] = "std_msgs::msg::Float64";
+    using fields = FieldList<&std_msgs__msg__Float64::data>;
+};
+
+template <>
+struct MessageTraits<sensor_msgs__msg__Temperature> {
+    static constexpr const char name[] = "sensor_msgs::msg::Temperature";
+    using fields = FieldList<&sensor_msgs__msg__Temperature::header,
+                             &sensor_msgs__msg__Temperature::temperature,
+                             &sensor_msgs__msg__Temperature::variance>;
+};
+
+template <>
+struct MessageTraits<wasm_msgs__msg__SensorBlock> {
+    static constexpr const char name[] = "wasm_msgs::msg::SensorBlock";
+    using fields = FieldList<&wasm_msgs__msg__SensorBlock::stamp,
+                             &wasm_msgs__msg__SensorBlock::sensor_id,
+                             &wasm_msgs__msg__SensorBlock::count,
+                             &wasm_msgs__msg__SensorBlock::values>;
+};
+
+template <>
+struct MessageTraits<wasm_msgs__msg__SensorReading> {
+    static constexpr const char name[] = "wasm_msgs::msg::SensorReading";
+    using fields = FieldList<&wasm_msgs__msg__SensorReading::stamp,
+                             &wasm_msgs__msg__SensorReading::id,
+                             &wasm_msgs__msg__SensorReading::sensor,
+                             &wasm_msgs__msg__SensorReading::unit,
+                             &wasm_msgs__msg__SensorReading::value>;
+};
+
+template <>
+struct MessageTraits<wasm_msgs__msg__AlarmEvent> {
+    static constexpr const char name[] = "wasm_msgs::msg::AlarmEvent";
+    using fields = FieldList<&wasm_msgs__msg__AlarmEvent::stamp,
+                             &wasm_msgs__msg__AlarmEvent::channel,
+                             &wasm_msgs__msg__AlarmEvent::kind,
+                             &wasm_msgs__msg__AlarmEvent::raised,
+                             &wasm_msgs__msg__AlarmEvent::value,
+                             &wasm_msgs__msg__AlarmEvent::level>;
+};
+
+template <>
+struct MessageTraits<example_interfaces__srv__AddTwoInts_Request> {
+    static constexpr const char name[] = "example_interfaces::srv::AddTwoInts_Request";
+    using fields = FieldList<&example_interfaces__srv__AddTwoInts_Request::a,
+                             &example_interfaces__srv__AddTwoInts_Request::b>;
+};
+
+template <>
+struct MessageTraits<example_interfaces__srv__AddTwoInts_Response> {
+    static constexpr const char name[] = "example_interfaces::srv::AddTwoInts_Response";
+    using fields = FieldList<&example_interfaces__srv__AddTwoInts_Response::sum>;
+};
+
+template <>
+struct ServiceTraits<example_interfaces__srv__AddTwoInts> {
+    static constexpr const char name[] = "example_interfaces::srv::AddTwoInts";
+    using Request = example_interfaces__srv__AddTwoInts_Request;
+    using Response = example_interfaces__srv__AddTwoInts_Response;
+};
+
+static_assert(Codec<std_msgs__msg__Float64>::packed, "Float64 must serialize as memcpy");
+static_assert(Codec<wasm_msgs__msg__SensorBlock>::packed, "SensorBlock must serialize as memcpy");
+static_assert(Codec<wasm_msgs__msg__SensorReading>::packed && sizeof(wasm_msgs__msg__SensorReading) == 20,
+              "SensorReading must serialize as a 20-byte memcpy");
+static_assert(Codec<wasm_msgs__msg__AlarmEvent>::packed && sizeof(wasm_msgs__msg__AlarmEvent) == 24,
+              "AlarmEvent must serialize as a 24-byte memcpy");
+static_assert(!Codec<sensor_msgs__msg__Temperature>::packed, "Temperature carries a string");
+
+}  // namespace rosidl_typesupport_wasm
+
+#define ROSIDL_GET_MSG_TYPE_SUPPORT(PkgName, MsgSubfolder, MsgName) \
+    (::rosidl_typesupport_wasm::getMessageTypeSupport<PkgName##__##MsgSubfolder##__##MsgName>())
+
+#define ROSIDL_GET_SRV_TYPE_SUPPORT(PkgName, SrvSubfolder, SrvName) \
+    (::rosidl_typesupport_wasm::getServiceTypeSupport<PkgName##__##SrvSubfolder##__##SrvName>())
+
+#endif // ROSIDL_TYPESUPPORT_WASM_H
@@ -0,0 +1,292 @@
+/*
+ * Streaming Statistics for WASM
+ *
+ * Running statistics over received values with O(1) queries, whatever the
+ * window size. Samples go into a fixed ring allocated once:
+ * - Window: the last `capacity` samples, optionally also only those newer
+ *   than window_ms (evicted on add() and expire()).
+ * - Mean/variance: Welford over the window (samples are added and removed),
+ *   plus over everything since reset(). The window sums are recomputed from
+ *   the ring once per `capacity` evictions so rounding cannot build up.
+ * - Min/max: monotonic deques over the window.
+ * - Percentiles: P² estimators (median, p95, p99) since reset(); five
+ *   markers each, no samples stored.
+ */
+
+#ifndef STREAM_STATS_WASM_H
+#define STREAM_STATS_WASM_H
+
+#include "platform_wasm.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define STREAM_STATS_WASM_DEFAULT_WINDOW 10
+
+// P² quantile estimator (Jain & Chlamtac): one quantile, O(1) per sample
+class P2QuantileWASM {
+private:
+    double p;
+    double heights[5];
+    double positions[5];
+    double desired[5];
+    double increments[5];
+    uint64_t count;
+
+    double parabolic(int i, double d) const {
+        return heights[i] + d / (positions[i + 1] - positions[i - 1]) *
+               ((positions[i] - positions[i - 1] + d) * (heights[i + 1] - heights[i]) /
+                    (positions[i + 1] - positions[i]) +
+                (positions[i + 1] - positions[i] - d) * (heights[i] - heights[i - 1]) /
+                    (positions[i] - positions[i - 1]));
+    }
+
+    double linear(int i, int d) const {
+        return heights[i] + d * (heights[i + d] - heights[i]) / (positions[i + d] - positions[i]);
+    }
+
+public:
+    explicit P2QuantileWASM(double p = 0.5) : p(p) {
+        reset();
+    }
+
+    void reset() {
+        count = 0;
+        for (int i = 0; i < 5; i++) {
+            heights[i] = 0;
+            positions[i] = i + 1;
+        }
+        desired[0] = 1;
+        desired[1] = 1 + 2 * p;
+        desired[2] = 1 + 4 * p;
+        desired[3] = 3 + 2 * p;
+        desired[4] = 5;
+        increments[0] = 0;
+        increments[1] = p / 2;
+        increments[2] = p;
+        increments[3] = (1 + p) / 2;
+        increments[4] = 1;
+    }
+
+    void add(double x) {
+        if (count < 5) {
+            heights[count++] = x;
+            if (count == 5) std::sort(heights, heights + 5);
+            return;
+        }
+        count++;
+
+        int k;
+        if (x < heights[0]) {
+            heights[0] = x;
+            k = 0;
+        } else if (x >= heights[4]) {
+            heights[4] = x;
+            k = 3;
+        } else {
+            k = 0;
+            while (x >= heights[k + 1]) k++;
+        }
+        for (int i = k + 1; i < 5; i++) positions[i]++;
+        for (int i = 0; i < 5; i++) desired[i] += increments[i];
+
+        // Move the three middle markers toward their desired positions
+        for (int i = 1; i <= 3; i++) {
+            double d = desired[i] - positions[i];
+            if ((d >= 1 && positions[i + 1] - positions[i] > 1) || (d <= -1 && positions[i - 1] - positions[i] < -1)) {
+                int step = d > 0 ? 1 : -1;
+                double candidate = parabolic(i, step);
+                if (heights[i - 1] < candidate && candidate < heights[i + 1]) {
+                    heights[i] = candidate;
+                } else {
+                    heights[i] = linear(i, step);
+                }
+                positions[i] += step;
+            }
+        }
+    }
+
+    // Exact (nearest rank) until five samples were seen
+    double get() const {
+        if (count == 0) return 0.0;
+        if (count < 5) {
+            double sorted[5];
+            std::copy(heights, heights + count, sorted);
+            std::sort(sorted, sorted + count);
+            return sorted[static_cast<size_t>(p * (count - 1) + 0.5)];
+        }
+        return heights[2];
+    }
+};
+
+class StreamStatsWASM {
+private:
+    // Sample sequence numbers index the rings (seq % capacity)
+    struct MonotonicDequeWASM {
+        std::vector<uint64_t> seqs;
+        size_t head;
+        size_t length;
+
+        void init(size_t capacity) {
+            seqs.assign(capacity, 0);
+            head = 0;
+            length = 0;
+        }
+        uint64_t front() const { return seqs[head]; }
+        uint64_t back() const { return seqs[(head + length - 1) % seqs.size()]; }
+        void popFront() { head = (head + 1) % seqs.size(); length--; }
+        void popBack() { length--; }
+        void pushBack(uint64_t seq) { seqs[(head + length++) % seqs.size()] = seq; }
+    };
+
+    size_t capacity;
+    double window_ms;          // 0 = count window only
+    std::vector<double> values;
+    std::vector<double> times;
+    uint64_t first_seq;        // Oldest sample in the window
+    uint64_t next_seq;
+    size_t evictions;          // Since the window sums were last recomputed
+
+    double mean;               // Window
+    double m2;
+    double total_mean;         // Since reset()
+    double total_m2;
+    uint64_t total_count;
+    double last;
+
+    MonotonicDequeWASM min_deque;
+    MonotonicDequeWASM max_deque;
+    P2QuantileWASM median;
+    P2QuantileWASM p95;
+    P2QuantileWASM p99;
+
+    double valueAt(uint64_t seq) const { return values[seq % capacity]; }
+
+    void evictOldest() {
+        double x = valueAt(first_seq);
+        if (min_deque.length > 0 && min_deque.front() == first_seq) min_deque.popFront();
+        if (max_deque.length > 0 && max_deque.front() == first_seq) max_deque.popFront();
+        first_seq++;
+
+        size_t n = size();
+        if (n == 0) {
+            mean = 0;
+            m2 = 0;
+        } else if (++evictions >= capacity) {
+            recompute();
+        } else {
+            double d = x - mean;
+            mean -= d / n;
+            m2 -= d * (x - mean);
+            if (m2 < 0) m2 = 0;
+        }
+    }
+
+    void recompute() {
+        evictions = 0;
+        mean = 0;
+        m2 = 0;
+        size_t n = 0;
+        for (uint64_t seq = first_seq; seq < next_seq; seq++) {
+            double d = valueAt(seq) - mean;
+            mean += d / ++n;
+            m2 += d * (valueAt(seq) - mean);
+        }
+    }
+
+public:
+    explicit StreamStatsWASM(size_t capacity = STREAM_STATS_WASM_DEFAULT_WINDOW, double window_ms = 0)
+        : median(0.5), p95(0.95), p99(0.99) {
+        configure(capacity, window_ms);
+    }
+
+    // Resizes the ring (allocates) and clears everything
+    void configure(size_t new_capacity, double new_window_ms = 0) {
+        capacity = new_capacity > 0 ? new_capacity : 1;
+        window_ms = new_window_ms > 0 ? new_window_ms : 0;
+        values.assign(capacity, 0);
+        times.assign(capacity, 0);
+        reset();
+    }
+
+    void reset() {
+        first_seq = 0;
+        next_seq = 0;
+        evictions = 0;
+        mean = 0;
+        m2 = 0;
+        total_mean = 0;
+        total_m2 = 0;
+        total_count = 0;
+        last = 0;
+        min_deque.init(capacity);
+        max_deque.init(capacity);
+        median.reset();
+        p95.reset();
+        p99.reset();
+    }
+
+    void add(double x, double now_ms) {
+        if (size() == capacity) evictOldest();
+        expire(now_ms);
+
+        uint64_t seq = next_seq++;
+        values[seq % capacity] = x;
+        times[seq % capacity] = now_ms;
+        while (min_deque.length > 0 && valueAt(min_deque.back()) >= x) min_deque.popBack();
+        min_deque.pushBack(seq);
+        while (max_deque.length > 0 && valueAt(max_deque.back()) <= x) max_deque.popBack();
+        max_deque.pushBack(seq);
+
+        double d = x - mean;
+        mean += d / size();
+        m2 += d * (x - mean);
+
+        total_count++;
+        d = x - total_mean;
+        total_mean += d / total_count;
+        total_m2 += d * (x - total_mean);
+
+        median.add(x);
+        p95.add(x);
+        p99.add(x);
+        last = x;
+    }
+
+    void add(double x) {
+        add(x, window_ms > 0 ? emscripten_get_now() : 0.0);
+    }
+
+    // Drops samples older than window_ms; call before reading a time window
+    // that may have gone quiet
+    void expire(double now_ms) {
+        if (window_ms <= 0) return;
+        while (size() > 0 && times[first_seq % capacity] < now_ms - window_ms) {
+            evictOldest();
+        }
+    }
+
+    size_t size() const { return static_cast<size_t>(next_seq - first_seq); }
+    size_t getCapacity() const { return capacity; }
+    double getWindowMs() const { return window_ms; }
+    uint64_t getTotalCount() const { return total_count; }
+    double getLast() const { return last; }
+
+    // Window
+    double getMean() const { return mean; }
+    double getVariance() const { return size() > 1 ? m2 / (size() - 1) : 0.0; }
+    double getStdDev() const { return std::sqrt(getVariance()); }
+    double getMin() const { return min_deque.length > 0 ? valueAt(min_deque.front()) : 0.0; }
+    double getMax() const { return max_deque.length > 0 ? valueAt(max_deque.front()) : 0.0; }
+
+    // Since reset()
+    double getTotalMean() const { return total_mean; }
+    double getTotalStdDev() const { return total_count > 1 ? std::sqrt(total_m2 / (total_count - 1)) : 0.0; }
+    double getMedian() const { return median.get(); }
+    double getP95() const { return p95.get(); }
+    double getP99() const { return p99.get(); }
+};
+
+#endif // STREAM_STATS_WASM_H
@@ -12,8 +12,12 @@
 // #include <rclc/rclc.h>
 // #include <std_msgs/msg/string.h>
 
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
+#include "stream_stats_wasm.h"
+#include "receive_history_wasm.h"
+#include "json_extract_wasm.h"
+#include "log_wasm.h"
 #include <string>
 #include <cstdio>
 #include <vector>
@@ -35,13 +39,15 @@ private:
     // std_msgs__msg__String msg;
     
     int messages_received;
-    std::vector<double> received_values;
+    StreamStatsWASM value_stats;
+    ReceiveHistoryWASM history;
+    JsonExtractorWASM value_field;
     double last_value;
     std::string last_message;
     bool ros_initialized;
 
 public:
-    ROSSubscriberWASM() : messages_received(0), last_value(0.0), ros_initialized(false) {}
+    ROSSubscriberWASM() : messages_received(0), value_field({"value"}), last_value(0.0), ros_initialized(false) {}
 
     /**
      * Initialize microROS node in WASM
@@ -77,25 +83,25 @@ public:
      */
     void messageCallback(const std::string& data) {
         if (!ros_initialized) {
-            printf("WASM: ROS not initialized\n");
+            WASM_LOG_WARN("WASM: ROS not initialized\n");
             return;
         }
         
         messages_received++;
         last_message = data;
         
-        // Parse JSON to extract value (simplified)
+        // Extract the value field (compact or spaced JSON)
         // In real implementation, ROS message deserialization happens in WASM
-        size_t value_pos = data.find("\"value\":");
-        if (value_pos != std::string::npos) {
-            sscanf(data.c_str() + value_pos, "\"value\": %lf", &last_value);
-            received_values.push_back(last_value);
-            if (received_values.size() > 10) {
-                received_values.erase(received_values.begin());
-            }
+        JsonFieldWASM value;
+        if (value_field.extract(data.data(), data.size(), &value) && value.type == JSON_FIELD_NUMBER) {
+            last_value = value.number;
+            value_stats.add(last_value);
+            history.add(last_value, emscripten_get_now());
+        } else {
+            history.touch();
         }
         
-        printf("WASM: Message received (via microROS in WASM): %s\n", data.c_str());
+        WASM_LOG_DEBUG("WASM: Message received (via microROS in WASM): %s\n", data.c_str());
     }
 
     /**
@@ -123,11 +129,33 @@ public:
     double getLastValue() const { return last_value; }
     std::string getLastMessage() const { return last_message; }
     
-    double getAverageValue() const {
-        if (received_values.empty()) return 0.0;
-        double sum = 0.0;
-        for (double v : received_values) sum += v;
-        return sum / received_values.size();
+    // Received values: window of the last N (and optionally last window_ms),
+    // percentiles since the window was set; all O(1)
+    double getAverageValue() const { return value_stats.getMean(); }
+    double getMinValue() const { return value_stats.getMin(); }
+    double getMaxValue() const { return value_stats.getMax(); }
+    double getStdDevValue() const { return value_stats.getStdDev(); }
+    double getMedianValue() const { return value_stats.getMedian(); }
+    double getP95Value() const { return value_stats.getP95(); }
+    double getP99Value() const { return value_stats.getP99(); }
+    double getWindowCount() const { return static_cast<double>(value_stats.size()); }
+    
+    void setValueWindow(int count, double window_ms) {
+        value_stats.configure(count > 0 ? static_cast<size_t>(count) : STREAM_STATS_WASM_DEFAULT_WINDOW, window_ms);
+    }
+    
+    // Zero-copy reads for dashboards (receive_history_wasm.h): views into
+    // WASM memory, valid until the next call into the module
+    val getValueHistory() const { return val(typed_memory_view(history.size(), history.getValues())); }
+    val getTimeHistory() const { return val(typed_memory_view(history.size(), history.getTimes())); }
+    // JSON text of the last message
+    val getLastMessageView() const {
+        return val(typed_memory_view(last_message.size(), reinterpret_cast<const uint8_t*>(last_message.data())));
+    }
+    double getChangeSequence() const { return static_cast<double>(history.getSequence()); }
+    
+    void setHistoryCapacity(int samples) {
+        history.configure(samples > 0 ? static_cast<size_t>(samples) : RECEIVE_HISTORY_WASM_DEFAULT_CAPACITY);
     }
     
     bool isROSInitialized() const { return ros_initialized; }
@@ -143,6 +171,19 @@ EMSCRIPTEN_BINDINGS(ros_subscriber_wasm) {
         .function("getLastValue", &ROSSubscriberWASM::getLastValue)
         .function("getLastMessage", &ROSSubscriberWASM::getLastMessage)
         .function("getAverageValue", &ROSSubscriberWASM::getAverageValue)
+        .function("getMinValue", &ROSSubscriberWASM::getMinValue)
+        .function("getMaxValue", &ROSSubscriberWASM::getMaxValue)
+        .function("getStdDevValue", &ROSSubscriberWASM::getStdDevValue)
+        .function("getMedianValue", &ROSSubscriberWASM::getMedianValue)
+        .function("getP95Value", &ROSSubscriberWASM::getP95Value)
+        .function("getP99Value", &ROSSubscriberWASM::getP99Value)
+        .function("getWindowCount", &ROSSubscriberWASM::getWindowCount)
+        .function("setValueWindow", &ROSSubscriberWASM::setValueWindow)
+        .function("getValueHistory", &ROSSubscriberWASM::getValueHistory)
+        .function("getTimeHistory", &ROSSubscriberWASM::getTimeHistory)
+        .function("getLastMessageView", &ROSSubscriberWASM::getLastMessageView)
+        .function("getChangeSequence", &ROSSubscriberWASM::getChangeSequence)
+        .function("setHistoryCapacity", &ROSSubscriberWASM::setHistoryCapacity)
         .function("isROSInitialized", &ROSSubscriberWASM::isROSInitialized);
 }
 
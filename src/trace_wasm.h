@@ -0,0 +1,415 @@
+/*
+ * Message Pipeline Tracing for WASM
+ *
+ * Opt-in spans around each stage a message goes through (publish,
+ * serialize, enqueue, send, recv, decode, dispatch, callback), exported as
+ * Chrome Trace Event JSON, which chrome://tracing and ui.perfetto.dev open.
+ * - Off by default: a span then costs one relaxed atomic load. Building with
+ *   -DTRACE_WASM_ENABLED=0 removes the spans altogether.
+ * - Each thread appends to its own fixed buffer, allocated the first time it
+ *   records, and publishes the count with a release store, so recording
+ *   takes no lock and export reads without stopping the writers. A full
+ *   buffer drops spans (counted) until the next traceWASMStart().
+ * - Spans carry the message's key: writer GUID and sequence number (and
+ *   topic). Publishers set it for what they call, subscribers take it from
+ *   the frame header, RMW queues keep it with each sample until the take.
+ *   The export puts the key in each span's args and links the spans of
+ *   one message with flow arrows (bind_id), in this process and in traces
+ *   of other processes merged into the same file.
+ * - Timestamps are microseconds since the Unix epoch (the monotonic clock
+ *   plus an offset taken at export), so traces of processes on one host
+ *   line up: jq -s '{traceEvents: map(.traceEvents) | add}' pub.json sub.json
+ * Start, stop and export from one control thread.
+ */
+
+#ifndef TRACE_WASM_H
+#define TRACE_WASM_H
+
+#include "platform_wasm.h"
+#include "metrics_wasm.h"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+
+#ifndef __EMSCRIPTEN__
+#include <unistd.h>
+#endif
+
+#ifndef TRACE_WASM_ENABLED
+#define TRACE_WASM_ENABLED 1
+#endif
+
+#define TRACE_WASM_DEFAULT_EVENTS 65536  // Per thread, 48 bytes each
+
+enum TraceStageWASM {
+    TRACE_PUBLISH,
+    TRACE_SERIALIZE,
+    TRACE_ENQUEUE,   // Into the I/O hand-off or an RMW subscription queue
+    TRACE_SEND,      // One remote subscriber's socket
+    TRACE_RECV,      // A subscriber receiving a frame or envelope
+    TRACE_DECODE,
+    TRACE_DISPATCH,  // Routing to subscribers or executor handles
+    TRACE_CALLBACK,  // User code
+    TRACE_STAGE_COUNT
+};
+
+static const char* const TRACE_STAGE_NAMES[TRACE_STAGE_COUNT] = {
+    "publish", "serialize", "enqueue", "send", "recv", "decode", "dispatch", "callback",
+};
+
+// Which message a span belongs to; sequence 0 = not known
+struct TraceKeyWASM {
+    uint8_t writer_guid[16];
+    uint32_t sequence;
+    uint32_t topic_hash;
+};
+
+struct TraceEventWASM {
+    double start_ms;
+    double end_ms;
+    TraceKeyWASM key;
+    uint32_t stage;
+};
+
+// One per thread that recorded; kept (not freed) so export still sees threads that exited
+struct TraceBufferWASM {
+    TraceEventWASM* events;
+    uint32_t capacity;
+    uint32_t generation;                       // Owner's copy
+    std::atomic<uint32_t> count;               // events[0, count) are complete
+    std::atomic<uint32_t> current_generation;  // count belongs to this trace
+    std::atomic<uint64_t> dropped;
+    std::atomic<const char*> name;             // String literal
+    uint32_t tid;
+    TraceBufferWASM* next;
+};
+
+// Reads the key of a received datagram (the I/O thread does not know the frame format)
+typedef bool (*TraceKeyReaderWASM)(const uint8_t* data, size_t length, TraceKeyWASM* key);
+
+struct TraceStateWASM {
+    std::atomic<bool> enabled{false};
+    std::atomic<uint32_t> generation{0};
+    std::atomic<uint32_t> capacity{TRACE_WASM_DEFAULT_EVENTS};
+    std::atomic<TraceBufferWASM*> buffers{nullptr};
+    std::atomic<uint32_t> next_tid{1};
+    std::mutex topics_mutex;
+    std::map<uint32_t, std::string> topics;  // Topic hash -> name, for the export
+};
+
+inline TraceStateWASM trace_wasm_state;
+inline thread_local TraceBufferWASM* trace_wasm_buffer = nullptr;
+inline thread_local const char* trace_wasm_thread_name = nullptr;
+inline thread_local TraceKeyWASM trace_wasm_current = {};  // Message this thread is working on
+
+inline bool traceWASMEnabled() {
+    return TRACE_WASM_ENABLED && trace_wasm_state.enabled.load(std::memory_order_relaxed);
+}
+
+// Clears earlier spans of every thread (each thread resets its buffer on its next span)
+inline void traceWASMStart(size_t events_per_thread = TRACE_WASM_DEFAULT_EVENTS) {
+    trace_wasm_state.capacity.store(static_cast<uint32_t>(events_per_thread), std::memory_order_relaxed);
+    trace_wasm_state.generation.fetch_add(1, std::memory_order_release);
+    trace_wasm_state.enabled.store(true, std::memory_order_release);
+}
+
+inline void traceWASMStop() {
+    trace_wasm_state.enabled.store(false, std::memory_order_release);
+}
+
+inline void traceWASMNameTopic(uint32_t topic_hash, const std::string& name) {
+    std::lock_guard<std::mutex> lock(trace_wasm_state.topics_mutex);
+    trace_wasm_state.topics[topic_hash] = name;
+}
+
+// Shown as the thread's name in the trace; `name` must be a string literal
+inline void traceWASMNameThread(const char* name) {
+    trace_wasm_thread_name = name;
+    if (trace_wasm_buffer) trace_wasm_buffer->name.store(name, std::memory_order_relaxed);
+}
+
+inline TraceBufferWASM* traceWASMThreadBuffer() {
+    TraceBufferWASM* buffer = trace_wasm_buffer;
+    uint32_t generation = trace_wasm_state.generation.load(std::memory_order_acquire);
+    if (!buffer) {
+        buffer = new (std::nothrow) TraceBufferWASM();
+        if (!buffer) return nullptr;
+        buffer->events = nullptr;
+        buffer->capacity = 0;
+        buffer->generation = generation - 1;
+        buffer->name.store(trace_wasm_thread_name, std::memory_order_relaxed);
+        buffer->tid = trace_wasm_state.next_tid.fetch_add(1, std::memory_order_relaxed);
+        buffer->next = trace_wasm_state.buffers.load(std::memory_order_relaxed);
+        while (!trace_wasm_state.buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release,
+                                                                std::memory_order_relaxed)) {}
+        trace_wasm_buffer = buffer;
+    }
+    if (buffer->generation != generation) {
+        uint32_t capacity = trace_wasm_state.capacity.load(std::memory_order_relaxed);
+        buffer->current_generation.store(0, std::memory_order_release);  // Hidden from export while reset
+        if (capacity != buffer->capacity) {
+            delete[] buffer->events;
+            buffer->events = new (std::nothrow) TraceEventWASM[capacity];
+            buffer->capacity = buffer->events ? capacity : 0;
+        }
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->generation = generation;
+        buffer->current_generation.store(generation, std::memory_order_release);
+    }
+    return buffer;
+}
+
+inline void traceWASMRecord(TraceStageWASM stage, double start_ms, double end_ms, const TraceKeyWASM& key) {
+    TraceBufferWASM* buffer = traceWASMThreadBuffer();
+    if (!buffer) return;
+    uint32_t index = buffer->count.load(std::memory_order_relaxed);
+    if (index >= buffer->capacity) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    TraceEventWASM& event = buffer->events[index];
+    event.start_ms = start_ms;
+    event.end_ms = end_ms;
+    event.key = key;
+    event.stage = stage;
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+inline const TraceKeyWASM& traceWASMCurrentKey() {
+    return trace_wasm_current;
+}
+
+// For a message taken from a queue: its spans until the next take or context
+inline void traceWASMSetCurrentKey(const TraceKeyWASM& key) {
+    if (traceWASMEnabled()) trace_wasm_current = key;
+}
+
+// Sets the message spans on this thread belong to, for the scope
+class TraceContextWASM {
+private:
+    bool active;
+    TraceKeyWASM saved;
+
+public:
+    explicit TraceContextWASM(const TraceKeyWASM& key) : active(traceWASMEnabled()) {
+        if (active) {
+            saved = trace_wasm_current;
+            trace_wasm_current = key;
+        }
+    }
+
+    TraceContextWASM(const uint8_t* writer_guid, uint32_t sequence, uint32_t topic_hash)
+        : active(traceWASMEnabled()) {
+        if (active) {
+            saved = trace_wasm_current;
+            memcpy(trace_wasm_current.writer_guid, writer_guid, sizeof(trace_wasm_current.writer_guid));
+            trace_wasm_current.sequence = sequence;
+            trace_wasm_current.topic_hash = topic_hash;
+        }
+    }
+
+    ~TraceContextWASM() {
+        if (active) trace_wasm_current = saved;
+    }
+
+    TraceContextWASM(const TraceContextWASM&) = delete;
+    TraceContextWASM& operator=(const TraceContextWASM&) = delete;
+};
+
+// One stage, from construction to destruction; the key is the thread's at the end unless set
+class TraceSpanWASM {
+private:
+#if TRACE_WASM_ENABLED
+    TraceStageWASM stage;
+    bool active;
+    bool keyed;
+    double start_ms;
+    TraceKeyWASM key;
+#endif
+
+public:
+#if TRACE_WASM_ENABLED
+    explicit TraceSpanWASM(TraceStageWASM stage) : stage(stage), active(traceWASMEnabled()), keyed(false), start_ms(0) {
+        if (active) start_ms = emscripten_get_now();
+    }
+
+    ~TraceSpanWASM() {
+        if (active) traceWASMRecord(stage, start_ms, emscripten_get_now(), keyed ? key : trace_wasm_current);
+    }
+
+    void setKey(const TraceKeyWASM& span_key) {
+        if (!active) return;
+        key = span_key;
+        keyed = true;
+    }
+
+    bool isActive() const { return active; }
+
+    // Nothing happened after all (e.g. an empty socket read)
+    void cancel() { active = false; }
+#else
+    explicit TraceSpanWASM(TraceStageWASM) {}
+    void setKey(const TraceKeyWASM&) {}
+    bool isActive() const { return false; }
+    void cancel() {}
+#endif
+
+    TraceSpanWASM(const TraceSpanWASM&) = delete;
+    TraceSpanWASM& operator=(const TraceSpanWASM&) = delete;
+};
+
+// Spans lost to full buffers in the current trace
+inline uint64_t traceWASMDropped() {
+    uint32_t generation = trace_wasm_state.generation.load(std::memory_order_acquire);
+    uint64_t dropped = 0;
+    for (TraceBufferWASM* buffer = trace_wasm_state.buffers.load(std::memory_order_acquire); buffer;
+         buffer = buffer->next) {
+        if (buffer->current_generation.load(std::memory_order_acquire) == generation) {
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+    }
+    return dropped;
+}
+
+// Spans recorded in the current trace
+inline uint64_t traceWASMEventCount() {
+    uint32_t generation = trace_wasm_state.generation.load(std::memory_order_acquire);
+    uint64_t events = 0;
+    for (TraceBufferWASM* buffer = trace_wasm_state.buffers.load(std::memory_order_acquire); buffer;
+         buffer = buffer->next) {
+        if (buffer->current_generation.load(std::memory_order_acquire) == generation) {
+            events += buffer->count.load(std::memory_order_acquire);
+        }
+    }
+    return events;
+}
+
+// pid in the trace: the process ID natively, a per-instance number in the browser
+inline uint32_t traceWASMProcessId() {
+#ifdef __EMSCRIPTEN__
+    static const uint32_t pid = static_cast<uint32_t>(fmod(emscripten_date_now(), 1e9));
+    return pid;
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+// Unix epoch ms minus emscripten_get_now(), at the time of the call
+inline double traceWASMClockOffsetMs() {
+#ifdef __EMSCRIPTEN__
+    return emscripten_date_now() - emscripten_get_now();
+#else
+    double epoch_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return epoch_ms - emscripten_get_now();
+#endif
+}
+
+// FNV-1a of writer GUID and sequence: the flow ID of one message in every process
+inline uint64_t traceWASMFlowId(const TraceKeyWASM& key) {
+    uint64_t hash = 14695981039346656037ull;
+    for (uint8_t byte : key.writer_guid) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+    for (int shift = 0; shift < 32; shift += 8) {
+        hash = (hash ^ ((key.sequence >> shift) & 0xFF)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// {"displayTimeUnit":"ns","traceEvents":[...],"otherData":{...}}; one "X" event
+// per span, args {"writer","seq","topic"} when the message is known. Spans of
+// one message share a bind_id and each flows into the next in time.
+inline void traceWASMExportJSON(std::string& out, const std::string& process_name) {
+    uint32_t generation = trace_wasm_state.generation.load(std::memory_order_acquire);
+    uint32_t pid = traceWASMProcessId();
+    double offset_us = traceWASMClockOffsetMs() * 1000.0;
+    std::map<uint32_t, std::string> topics;
+    {
+        std::lock_guard<std::mutex> lock(trace_wasm_state.topics_mutex);
+        topics = trace_wasm_state.topics;
+    }
+
+    char line[512];
+    out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    snprintf(line, sizeof(line), "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%u,\"tid\":0,\"args\":{\"name\":", pid);
+    out += line;
+    metricsAppendJSONString(out, process_name);
+    out += "}}";
+
+    uint64_t events = 0;
+    uint64_t dropped = 0;
+    for (TraceBufferWASM* buffer = trace_wasm_state.buffers.load(std::memory_order_acquire); buffer;
+         buffer = buffer->next) {
+        if (buffer->current_generation.load(std::memory_order_acquire) != generation) continue;
+        uint32_t count = buffer->count.load(std::memory_order_acquire);
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+        if (count == 0) continue;
+        const char* name = buffer->name.load(std::memory_order_relaxed);
+        snprintf(line, sizeof(line), ",{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":",
+                 pid, buffer->tid);
+        out += line;
+        if (name) {
+            metricsAppendJSONString(out, name);
+        } else {
+            snprintf(line, sizeof(line), "\"thread %u\"", buffer->tid);
+            out += line;
+        }
+        out += "}}";
+
+        for (uint32_t i = 0; i < count; i++) {
+            const TraceEventWASM& event = buffer->events[i];
+            snprintf(line, sizeof(line), ",{\"ph\":\"X\",\"cat\":\"dds\",\"name\":\"%s\",\"pid\":%u,\"tid\":%u,"
+                     "\"ts\":%.3f,\"dur\":%.3f",
+                     TRACE_STAGE_NAMES[event.stage], pid, buffer->tid, event.start_ms * 1000.0 + offset_us,
+                     (event.end_ms - event.start_ms) * 1000.0);
+            out += line;
+            if (event.key.sequence != 0) {
+                uint32_t words[4];
+                memcpy(words, event.key.writer_guid, sizeof(words));
+                snprintf(line, sizeof(line), ",\"bind_id\":\"0x%016llx\",\"flow_in\":true,\"flow_out\":true,"
+                         "\"args\":{\"writer\":\"%08X-%08X-%08X-%08X\",\"seq\":%u,\"topic\":",
+                         static_cast<unsigned long long>(traceWASMFlowId(event.key)), words[0], words[1], words[2], words[3], event.key.sequence);
+                out += line;
+                auto topic = topics.find(event.key.topic_hash);
+                if (topic != topics.end()) {
+                    metricsAppendJSONString(out, topic->second);
+                } else {
+                    snprintf(line, sizeof(line), "\"%08X\"", event.key.topic_hash);
+                    out += line;
+                }
+                out += '}';
+            }
+            out += '}';
+        }
+        events += count;
+    }
+
+    snprintf(line, sizeof(line), "],\"otherData\":{\"events\":%llu,\"dropped\":%llu,\"clock\":\"unix_us\"}}",
+             static_cast<unsigned long long>(events), static_cast<unsigned long long>(dropped));
+    out += line;
+}
+
+inline std::string traceWASMExportJSON(const std::string& process_name) {
+    std::string out;
+    traceWASMExportJSON(out, process_name);
+    return out;
+}
+
+// Native hosts (and NODERAWFS builds): the export written to a file
+inline bool traceWASMWriteFile(const char* path, const std::string& process_name) {
+    std::string json = traceWASMExportJSON(process_name);
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    bool ok = fwrite(json.data(), 1, json.size(), file) == json.size();
+    return fclose(file) == 0 && ok;
+}
+
+#endif // TRACE_WASM_H
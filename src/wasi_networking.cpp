@@ -5,15 +5,21 @@
  * Uses Emscripten's networking APIs.
  */
 
-#include <emscripten.h>
-#include <emscripten/bind.h>
+#include "platform_wasm.h"
+#include "bindings_wasm.h"
+#ifdef __EMSCRIPTEN__
 #include <emscripten/websocket.h>
+#endif
 #include <string>
 #include <cstdio>
 #include <cstring>
 #include <vector>
 #include <map>
 #include <functional>
+#include "io_handoff_wasm.h"
+#include "log_wasm.h"
+#include "metrics_wasm.h"
+#include "trace_wasm.h"
 
 #ifndef __EMSCRIPTEN__
 #include <sys/socket.h>
@@ -25,6 +31,16 @@
 
 using namespace emscripten;
 
+// Datagrams are read into IO_HANDOFF_WASM_DEFAULT_FRAME_SIZE buffers; a longer
+// one is dropped (and counted), never delivered cut short
+#define NET_MAX_DATAGRAM IO_HANDOFF_WASM_DEFAULT_FRAME_SIZE
+
+// Requested for the unicast (user data) socket: room for the fragments of a
+// few MiB of frames between two polls. Unprivileged processes get at most
+// net.core.rmem_max (doubled by the kernel); getUnicastReceiveBuffer() says
+// what was granted.
+#define NET_UNICAST_RECEIVE_BUFFER (16u << 20)
+
 // Network endpoint
 struct NetworkEndpoint {
     std::string address;
@@ -39,16 +55,47 @@ struct NetworkEndpoint {
     }
 };
 
+enum UDPSocketMetricWASM {
+    UDP_DATAGRAMS_SENT,
+    UDP_BYTES_SENT,
+    UDP_SEND_ERRORS,
+    UDP_DATAGRAMS_RECEIVED,  // Counted on the I/O thread when there is one
+    UDP_BYTES_RECEIVED,
+    UDP_DATAGRAMS_TRUNCATED, // Longer than the read buffer; dropped
+    UDP_METRIC_COUNT
+};
+
+static const MetricInfoWASM UDP_SOCKET_METRICS[UDP_METRIC_COUNT] = {
+    {"datagrams_sent", METRIC_COUNTER},
+    {"bytes_sent", METRIC_COUNTER},
+    {"send_errors", METRIC_COUNTER},
+    {"datagrams_received", METRIC_COUNTER},
+    {"bytes_received", METRIC_COUNTER},
+    {"datagrams_truncated", METRIC_COUNTER},
+};
+
 // UDP Socket for DDS discovery
 class UDPSocketWASM {
 private:
     int socket_fd;
     bool bound;
+    bool shared;  // Bound with SO_REUSEADDR/SO_REUSEPORT
     NetworkEndpoint local_endpoint;
     std::function<void(const std::string&, const NetworkEndpoint&)> receive_callback;
+    MetricGroupWASM<UDP_METRIC_COUNT> metrics;
+    
+    #ifdef __EMSCRIPTEN__
+    // No host port space in the browser: binds are checked against the ports
+    // this module holds (port -> shared sockets, -1 = exclusive), so an
+    // exclusive bind fails on a taken port as it would natively
+    static std::map<int, int>& simulatedPorts() {
+        static std::map<int, int> ports;
+        return ports;
+    }
+    #endif
     
 public:
-    UDPSocketWASM() : socket_fd(-1), bound(false) {}
+    UDPSocketWASM() : socket_fd(-1), bound(false), shared(false), metrics(UDP_SOCKET_METRICS) {}
     
     ~UDPSocketWASM() {
         close();
@@ -76,7 +123,18 @@ public:
         return true;
     }
     
+    // A taken port fails the bind
     bool bind(const std::string& address, int port) {
+        return bindPort(address, port, false);
+    }
+    
+    // Several sockets (of this or other processes) may bind the same port, as
+    // for multicast discovery
+    bool bindShared(const std::string& address, int port) {
+        return bindPort(address, port, true);
+    }
+    
+    bool bindPort(const std::string& address, int port, bool shared) {
         if (socket_fd < 0) {
             if (!create()) return false;
         }
@@ -86,6 +144,14 @@ public:
         #ifdef __EMSCRIPTEN__
         // In browser, we can't bind UDP sockets directly
         // Use WebSocket server or proxy
+        std::map<int, int>& ports = simulatedPorts();
+        std::map<int, int>::iterator taken = ports.find(port);
+        if (taken != ports.end() && (!shared || taken->second < 0)) {
+            WASM_LOG_DEBUG("WASM: UDP port %d already in use\n", port);
+            return false;
+        }
+        ports[port] = shared ? (taken != ports.end() ? taken->second + 1 : 1) : -1;
+        this->shared = shared;
         bound = true;
         printf("WASM: UDP socket bound to %s (Emscripten mode)\n", local_endpoint.toString().c_str());
         #else
@@ -100,10 +166,23 @@ public:
             inet_pton(AF_INET, address.c_str(), &addr.sin_addr);
         }
         
+        if (shared) {
+            int reuse = 1;
+            setsockopt(socket_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            #ifdef SO_REUSEPORT
+            setsockopt(socket_fd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse));
+            #endif
+        }
+        
+        // Expected while probing for a free participant port; callers report failures
         if (::bind(socket_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-            printf("WASM: Failed to bind UDP socket\n");
+            WASM_LOG_DEBUG("WASM: Failed to bind UDP socket to port %d\n", port);
             return false;
         }
+        this->shared = shared;
+        // Reads never block, whichever thread polls
+        int flags = fcntl(socket_fd, F_GETFL, 0);
+        fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK);
         bound = true;
         printf("WASM: UDP socket bound to %s\n", local_endpoint.toString().c_str());
         #endif
@@ -111,21 +190,67 @@ public:
         return true;
     }
     
+    // Kernel receive buffer, past rmem_max when the process may; returns the
+    // size granted (0 when unknown)
+    size_t setReceiveBufferSize(size_t bytes) {
+        #ifdef __EMSCRIPTEN__
+        (void)bytes;
+        return 0;
+        #else
+        if (socket_fd < 0) return 0;
+        int requested = static_cast<int>(bytes);
+        #ifdef SO_RCVBUFFORCE
+        if (setsockopt(socket_fd, SOL_SOCKET, SO_RCVBUFFORCE, &requested, sizeof(requested)) < 0)
+        #endif
+        setsockopt(socket_fd, SOL_SOCKET, SO_RCVBUF, &requested, sizeof(requested));
+        int granted = 0;
+        socklen_t length = sizeof(granted);
+        if (getsockopt(socket_fd, SOL_SOCKET, SO_RCVBUF, &granted, &length) < 0) return 0;
+        return static_cast<size_t>(granted);
+        #endif
+    }
+    
+    // Receive datagrams sent to `group` on the bound port (multicast discovery)
+    bool joinMulticastGroup(const std::string& group) {
+        if (!bound) return false;
+        
+        #ifdef __EMSCRIPTEN__
+        return true;
+        #else
+        struct ip_mreq request;
+        memset(&request, 0, sizeof(request));
+        inet_pton(AF_INET, group.c_str(), &request.imr_multiaddr);
+        request.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (setsockopt(socket_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) < 0) {
+            WASM_LOG_WARN("WASM: Failed to join multicast group %s\n", group.c_str());
+            return false;
+        }
+        return true;
+        #endif
+    }
+    
     bool sendTo(const std::string& data, const NetworkEndpoint& endpoint) {
+        return sendBytes(data.data(), data.size(), endpoint);
+    }
+    
+    bool sendBytes(const char* data, size_t length, const NetworkEndpoint& endpoint) {
         if (!bound) {
-            printf("WASM: UDP socket not bound\n");
+            WASM_LOG_WARN("WASM: UDP socket not bound\n");
+            metrics[UDP_SEND_ERRORS].add();
             return false;
         }
         
-        printf("WASM: UDP send to %s: %s\n", endpoint.toString().c_str(), data.c_str());
+        WASM_LOG_DEBUG("WASM: UDP send to %s: %zu bytes\n", endpoint.toString().c_str(), length);
         
         #ifdef __EMSCRIPTEN__
         // For browser: Use WebSocket or fetch API
         // For now, use Emscripten's networking if available
         // In production, would use WebSocket proxy or WASI sockets
+        #if LOG_WASM_LEVEL <= LOG_WASM_LEVEL_DEBUG
         EM_ASM_({
-            console.log("UDP send (simulated):", UTF8ToString($0), UTF8ToString($1), $2);
-        }, data.c_str(), endpoint.address.c_str(), endpoint.port);
+            console.log("UDP send (simulated):", $0, UTF8ToString($1), $2);
+        }, length, endpoint.address.c_str(), endpoint.port);
+        #endif
         #else
         // Native UDP send
         struct sockaddr_in addr;
@@ -134,14 +259,16 @@ public:
         addr.sin_port = htons(endpoint.port);
         inet_pton(AF_INET, endpoint.address.c_str(), &addr.sin_addr);
         
-        ssize_t sent = sendto(socket_fd, data.c_str(), data.length(), 0,
-                              (struct sockaddr*)&addr, sizeof(addr));
+        ssize_t sent = sendto(socket_fd, data, length, 0, (struct sockaddr*)&addr, sizeof(addr));
         if (sent < 0) {
-            printf("WASM: Failed to send UDP packet\n");
+            WASM_LOG_WARN("WASM: Failed to send UDP packet\n");
+            metrics[UDP_SEND_ERRORS].add();
             return false;
         }
         #endif
         
+        metrics[UDP_DATAGRAMS_SENT].add();
+        metrics[UDP_BYTES_SENT].add(length);
         return true;
     }
     
@@ -149,50 +276,112 @@ public:
         receive_callback = cb;
     }
     
-    void poll() {
-        if (!bound || socket_fd < 0) return;
+    // One non-blocking datagram read; safe on a thread other than the sender's.
+    // source packs the sender's IPv4 address and port (see sourceEndpoint).
+    // Returns the length, or -1 when nothing was waiting. Datagrams longer
+    // than capacity are dropped and the next one is read.
+    long receive(uint8_t* buffer, size_t capacity, uint64_t* source) {
+        if (!bound || socket_fd < 0) return -1;
         
         #ifdef __EMSCRIPTEN__
         // In browser, polling would be done via WebSocket callbacks
-        // For now, simulate polling
         // In production, use WebSocket onmessage or WASI socket polling
+        (void)buffer;
+        (void)capacity;
+        (void)source;
+        return -1;
         #else
-        // Native UDP receive (non-blocking)
         struct sockaddr_in from_addr;
         socklen_t from_len = sizeof(from_addr);
-        char buffer[4096];
-        
-        // Set socket to non-blocking
-        int flags = fcntl(socket_fd, F_GETFL, 0);
-        fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK);
-        
-        ssize_t received = recvfrom(socket_fd, buffer, sizeof(buffer) - 1, 0,
-                                   (struct sockaddr*)&from_addr, &from_len);
-        if (received > 0) {
-            buffer[received] = '\0';
-            char from_ip[INET_ADDRSTRLEN];
-            inet_ntop(AF_INET, &from_addr.sin_addr, from_ip, INET_ADDRSTRLEN);
-            NetworkEndpoint from_endpoint(from_ip, ntohs(from_addr.sin_port));
-            
-            if (receive_callback) {
-                receive_callback(std::string(buffer, received), from_endpoint);
-            }
+        ssize_t received;
+        while (true) {
+            // MSG_TRUNC: the datagram's full length, even when it did not fit
+            received = recvfrom(socket_fd, buffer, capacity, MSG_TRUNC, (struct sockaddr*)&from_addr, &from_len);
+            if (received < 0) return -1;
+            if (static_cast<size_t>(received) <= capacity) break;
+            metrics[UDP_DATAGRAMS_TRUNCATED].add();
+            WASM_LOG_WARN("WASM: Dropped a %zd byte datagram (read buffer %zu bytes)\n", received, capacity);
+            from_len = sizeof(from_addr);
         }
+        metrics[UDP_DATAGRAMS_RECEIVED].add();
+        metrics[UDP_BYTES_RECEIVED].add(static_cast<uint64_t>(received));
+        if (source) {
+            *source = (static_cast<uint64_t>(ntohl(from_addr.sin_addr.s_addr)) << 16) | ntohs(from_addr.sin_port);
+        }
+        return static_cast<long>(received);
         #endif
     }
     
+    static NetworkEndpoint sourceEndpoint(uint64_t source) {
+        uint32_t address = static_cast<uint32_t>(source >> 16);
+        char ip[16];
+        snprintf(ip, sizeof(ip), "%u.%u.%u.%u", (address >> 24) & 0xFF, (address >> 16) & 0xFF,
+                 (address >> 8) & 0xFF, address & 0xFF);
+        return NetworkEndpoint(ip, static_cast<int>(source & 0xFFFF));
+    }
+    
+    // Delivers one datagram if one is waiting; false when the socket is empty
+    bool poll() {
+        uint8_t buffer[NET_MAX_DATAGRAM];
+        uint64_t source = 0;
+        long received = receive(buffer, sizeof(buffer), &source);
+        if (received < 0) return false;
+        if (receive_callback) {
+            receive_callback(std::string(reinterpret_cast<const char*>(buffer), received), sourceEndpoint(source));
+        }
+        return true;
+    }
+    
+    int getFd() const { return socket_fd; }
+    
+    // Reported as "udp_socket" named after the bound endpoint
+    void attachMetrics(MetricsRegistryWASM* registry) {
+        metrics.attach(registry, "udp_socket", local_endpoint.toString());
+    }
+    
+    uint64_t getMetric(UDPSocketMetricWASM metric) const { return metrics[metric].get(); }
+    
     void close() {
         if (socket_fd >= 0) {
             printf("WASM: Closing UDP socket\n");
+            #ifdef __EMSCRIPTEN__
+            std::map<int, int>& ports = simulatedPorts();
+            std::map<int, int>::iterator held = ports.find(local_endpoint.port);
+            if (bound && held != ports.end() && (held->second < 0 || --held->second == 0)) {
+                ports.erase(held);
+            }
+            #else
+            ::close(socket_fd);  // Releases the port for the next participant
+            #endif
             socket_fd = -1;
             bound = false;
         }
     }
     
     bool isBound() const { return bound; }
+    bool isShared() const { return shared; }
     NetworkEndpoint getLocalEndpoint() const { return local_endpoint; }
 };
 
+enum TCPSocketMetricWASM {
+    TCP_BYTES_SENT,          // Accepted by the kernel
+    TCP_SEND_ERRORS,
+    TCP_PARTIAL_WRITES,      // Sends whose remainder went to send_queue
+    TCP_SEND_QUEUE_DEPTH,    // Remainders waiting in send_queue
+    TCP_SEND_QUEUE_BYTES,
+    TCP_BYTES_RECEIVED,
+    TCP_METRIC_COUNT
+};
+
+static const MetricInfoWASM TCP_SOCKET_METRICS[TCP_METRIC_COUNT] = {
+    {"bytes_sent", METRIC_COUNTER},
+    {"send_errors", METRIC_COUNTER},
+    {"partial_writes", METRIC_COUNTER},
+    {"send_queue_depth", METRIC_GAUGE},
+    {"send_queue_bytes", METRIC_GAUGE},
+    {"bytes_received", METRIC_COUNTER},
+};
+
 // TCP Socket for reliable DDS communication
 class TCPSocketWASM {
 private:
@@ -201,9 +390,17 @@ private:
     NetworkEndpoint remote_endpoint;
     std::function<void(const std::string&)> receive_callback;
     std::vector<std::string> send_queue;
+    MetricGroupWASM<TCP_METRIC_COUNT> metrics;
+    
+    void updateSendQueueMetrics() {
+        size_t bytes = 0;
+        for (const std::string& pending : send_queue) bytes += pending.size();
+        metrics[TCP_SEND_QUEUE_DEPTH].set(send_queue.size());
+        metrics[TCP_SEND_QUEUE_BYTES].set(bytes);
+    }
     
 public:
-    TCPSocketWASM() : socket_fd(-1), connected(false) {}
+    TCPSocketWASM() : socket_fd(-1), connected(false), metrics(TCP_SOCKET_METRICS) {}
     
     ~TCPSocketWASM() {
         close();
@@ -259,28 +456,42 @@ public:
     }
     
     bool send(const std::string& data) {
+        return sendBytes(data.data(), data.length());
+    }
+    
+    // Binary-safe send; does not copy unless the kernel takes a partial write
+    bool sendBytes(const char* data, size_t length) {
         if (!connected) {
-            printf("WASM: TCP socket not connected\n");
+            WASM_LOG_WARN("WASM: TCP socket not connected\n");
+            metrics[TCP_SEND_ERRORS].add();
             return false;
         }
         
-        printf("WASM: TCP send to %s: %s\n", remote_endpoint.toString().c_str(), data.c_str());
+        WASM_LOG_DEBUG("WASM: TCP send to %s:%d: %zu bytes\n",
+                       remote_endpoint.address.c_str(), remote_endpoint.port, length);
         
         #ifdef __EMSCRIPTEN__
         // For browser: Use WebSocket send
+        #if LOG_WASM_LEVEL <= LOG_WASM_LEVEL_DEBUG
         EM_ASM_({
-            console.log("TCP send (simulated):", UTF8ToString($0), UTF8ToString($1), $2);
-        }, data.c_str(), remote_endpoint.address.c_str(), remote_endpoint.port);
+            console.log("TCP send (simulated):", $0, "bytes", UTF8ToString($1), $2);
+        }, length, remote_endpoint.address.c_str(), remote_endpoint.port);
+        #endif
+        metrics[TCP_BYTES_SENT].add(length);
         #else
         // Native TCP send
-        ssize_t sent = ::send(socket_fd, data.c_str(), data.length(), 0);
+        ssize_t sent = ::send(socket_fd, data, length, 0);
         if (sent < 0) {
-            printf("WASM: Failed to send TCP data\n");
+            WASM_LOG_WARN("WASM: Failed to send TCP data\n");
+            metrics[TCP_SEND_ERRORS].add();
             return false;
         }
-        if (sent < (ssize_t)data.length()) {
+        metrics[TCP_BYTES_SENT].add(static_cast<uint64_t>(sent));
+        if (sent < (ssize_t)length) {
             // Partial send - queue remainder
-            send_queue.push_back(data.substr(sent));
+            send_queue.push_back(std::string(data + sent, length - sent));
+            metrics[TCP_PARTIAL_WRITES].add();
+            updateSendQueueMetrics();
         }
         #endif
         
@@ -300,6 +511,7 @@ public:
         if (!send_queue.empty()) {
             // In production, would send via WebSocket
             send_queue.clear();
+            updateSendQueueMetrics();
         }
         #else
         // Native TCP receive (non-blocking)
@@ -311,6 +523,7 @@ public:
         
         ssize_t received = recv(socket_fd, buffer, sizeof(buffer) - 1, 0);
         if (received > 0) {
+            metrics[TCP_BYTES_RECEIVED].add(static_cast<uint64_t>(received));
             buffer[received] = '\0';
             if (receive_callback) {
                 receive_callback(std::string(buffer, received));
@@ -326,9 +539,13 @@ public:
             std::string remaining = send_queue.front();
             send_queue.erase(send_queue.begin());
             ssize_t sent = ::send(socket_fd, remaining.c_str(), remaining.length(), 0);
+            if (sent > 0) {
+                metrics[TCP_BYTES_SENT].add(static_cast<uint64_t>(sent));
+            }
             if (sent < (ssize_t)remaining.length() && sent >= 0) {
                 send_queue.insert(send_queue.begin(), remaining.substr(sent));
             }
+            updateSendQueueMetrics();
         }
         #endif
     }
@@ -336,6 +553,9 @@ public:
     void close() {
         if (socket_fd >= 0) {
             printf("WASM: Closing TCP socket\n");
+            #ifndef __EMSCRIPTEN__
+            ::close(socket_fd);  // Releases the port for the next participant
+            #endif
             socket_fd = -1;
             connected = false;
         }
@@ -343,23 +563,102 @@ public:
     
     bool isConnected() const { return connected; }
     NetworkEndpoint getRemoteEndpoint() const { return remote_endpoint; }
+    
+    // Reported as "tcp_socket" named after the remote endpoint
+    void attachMetrics(MetricsRegistryWASM* registry) {
+        metrics.attach(registry, "tcp_socket", remote_endpoint.toString());
+    }
+    
+    uint64_t getMetric(TCPSocketMetricWASM metric) const { return metrics[metric].get(); }
+};
+
+enum NetworkMetricWASM {
+    NET_DISCOVERY_DATAGRAMS_SENT,
+    NET_DISCOVERY_BYTES_SENT,
+    NET_POLLS,                // pollUpTo() calls
+    NET_POLL_US_TOTAL,        // Time spent in them, including delivery callbacks
+    NET_POLL_US_MAX,
+    NET_TCP_CONNECTIONS,
+    NET_TCP_CONNECT_FAILURES,
+    NET_METRIC_COUNT
+};
+
+static const MetricInfoWASM NETWORK_METRICS[NET_METRIC_COUNT] = {
+    {"discovery_datagrams_sent", METRIC_COUNTER},
+    {"discovery_bytes_sent", METRIC_COUNTER},
+    {"polls", METRIC_COUNTER},
+    {"poll_us_total", METRIC_COUNTER},
+    {"poll_us_max", METRIC_GAUGE},
+    {"tcp_connections", METRIC_GAUGE},
+    {"tcp_connect_failures", METRIC_COUNTER},
 };
 
 // Network Manager - manages all network connections
 class NetworkManagerWASM {
 private:
-    UDPSocketWASM* discovery_socket;
+    UDPSocketWASM* discovery_socket;  // Shared port (multicast discovery)
+    UDPSocketWASM* unicast_socket;    // This participant's own port
+    size_t unicast_receive_buffer;    // Granted by the kernel; 0 when unknown
     std::map<std::string, TCPSocketWASM*> tcp_connections;
+    std::function<void(const std::string&, const NetworkEndpoint&)> discovery_callback;
     int discovery_port;
     bool initialized;
+    IOHandoffWASM* handoff;  // Set while the I/O thread owns socket reads
+    IOHandoffWakeWASM receive_wake;
+    void* receive_wake_context;
+    MetricGroupWASM<NET_METRIC_COUNT> metrics;
+    MetricsRegistryWASM* metrics_registry;  // Sockets attach here as they are created
+    TraceKeyReaderWASM trace_key_reader;    // Keys enqueue spans on the I/O thread
+    
+    // I/O thread: read one datagram (own port first) straight into a pooled buffer
+    static bool readDatagram(void* context) {
+        NetworkManagerWASM* self = static_cast<NetworkManagerWASM*>(context);
+        uint32_t index;
+        uint8_t* buffer = self->handoff->acquire(&index);
+        if (!buffer) return false;  // Every buffer queued; the kernel keeps the datagram
+        TraceSpanWASM span(TRACE_ENQUEUE);
+        uint64_t source = 0;
+        long received = -1;
+        if (self->unicast_socket) {
+            received = self->unicast_socket->receive(buffer, self->handoff->getFrameSize(), &source);
+        }
+        if (received < 0) {
+            received = self->discovery_socket->receive(buffer, self->handoff->getFrameSize(), &source);
+        }
+        if (received < 0) {
+            self->handoff->abandon(index);
+            span.cancel();
+            return false;
+        }
+        TraceKeyWASM key;
+        if (span.isActive() && self->trace_key_reader &&
+            self->trace_key_reader(buffer, static_cast<size_t>(received), &key)) {
+            traceWASMNameThread("dds_io");
+            span.setKey(key);
+        } else {
+            span.cancel();  // Discovery traffic
+        }
+        self->handoff->commit(index, static_cast<size_t>(received), source);
+        return true;
+    }
+    
+    // Executor thread
+    static void deliverDatagram(void* context, uint64_t source, const uint8_t* data, size_t length) {
+        static_cast<NetworkManagerWASM*>(context)->handleDiscoveryMessage(
+            std::string(reinterpret_cast<const char*>(data), length), UDPSocketWASM::sourceEndpoint(source));
+    }
     
 public:
-    NetworkManagerWASM() : discovery_socket(nullptr), discovery_port(7400), initialized(false) {}
+    NetworkManagerWASM()
+        : discovery_socket(nullptr), unicast_socket(nullptr), unicast_receive_buffer(0), discovery_port(7400),
+          initialized(false), handoff(nullptr), receive_wake(nullptr), receive_wake_context(nullptr),
+          metrics(NETWORK_METRICS), metrics_registry(nullptr), trace_key_reader(nullptr) {}
     
     ~NetworkManagerWASM() {
         cleanup();
     }
     
+    // The discovery port is shared by every participant of the domain on this host
     bool init(int discovery_port = 7400) {
         if (initialized) return true;
         
@@ -373,7 +672,7 @@ public:
         }
         
         // Bind to discovery port
-        if (!discovery_socket->bind("0.0.0.0", discovery_port)) {
+        if (!discovery_socket->bindShared("0.0.0.0", discovery_port)) {
             printf("WASM: Failed to bind discovery socket\n");
             return false;
         }
@@ -388,18 +687,85 @@ public:
         return true;
     }
     
+    // Announcements sent to `group` arrive on the discovery port too; without
+    // it, unicast and broadcast discovery still do
+    bool joinMulticastGroup(const std::string& group) {
+        return initialized && discovery_socket->joinMulticastGroup(group);
+    }
+    
+    // Binds this manager's own (exclusive) port; false when it is taken, so
+    // callers can probe for a free one. Datagrams on it are handled like
+    // discovery datagrams.
+    bool bindUnicast(int port) {
+        if (!initialized) return false;
+        if (unicast_socket && unicast_socket->isBound()) return unicast_socket->getLocalEndpoint().port == port;
+        if (!unicast_socket) {
+            unicast_socket = new UDPSocketWASM();
+            unicast_socket->setReceiveCallback([this](const std::string& data, const NetworkEndpoint& endpoint) {
+                this->handleDiscoveryMessage(data, endpoint);
+            });
+        }
+        if (!unicast_socket->bind("0.0.0.0", port)) return false;
+        unicast_receive_buffer = unicast_socket->setReceiveBufferSize(NET_UNICAST_RECEIVE_BUFFER);
+        if (unicast_receive_buffer > 0 && unicast_receive_buffer < NET_UNICAST_RECEIVE_BUFFER) {
+            WASM_LOG_WARN("WASM: Unicast receive buffer is %zu bytes; large fragmented frames may be dropped "
+                          "(raise net.core.rmem_max)\n", unicast_receive_buffer);
+        }
+        if (metrics_registry) unicast_socket->attachMetrics(metrics_registry);
+        return true;
+    }
+    
+    // Reports this manager as "network" and each of its sockets, current and
+    // later ones, in `registry` (the owning participant's)
+    void attachMetrics(MetricsRegistryWASM* registry, const std::string& name) {
+        metrics_registry = registry;
+        metrics.attach(registry, "network", name);
+        if (discovery_socket && discovery_socket->isBound()) discovery_socket->attachMetrics(registry);
+        if (unicast_socket && unicast_socket->isBound()) unicast_socket->attachMetrics(registry);
+        for (auto& pair : tcp_connections) {
+            pair.second->attachMetrics(registry);
+        }
+    }
+    
     void handleDiscoveryMessage(const std::string& data, const NetworkEndpoint& endpoint) {
-        printf("WASM: Discovery message from %s: %s\n", endpoint.toString().c_str(), data.c_str());
-        // TODO: Parse discovery message and establish TCP connection if needed
+        WASM_LOG_DEBUG("WASM: Discovery message from %s (%zu bytes)\n", endpoint.toString().c_str(), data.size());
+        // Parsed by the DDS participant that owns this manager
+        if (discovery_callback) {
+            discovery_callback(data, endpoint);
+        }
+    }
+    
+    void setDiscoveryCallback(std::function<void(const std::string&, const NetworkEndpoint&)> cb) {
+        discovery_callback = cb;
     }
     
     bool sendDiscoveryMessage(const std::string& message, const NetworkEndpoint& endpoint) {
         if (!initialized || !discovery_socket) {
             return false;
         }
-        return discovery_socket->sendTo(message, endpoint);
+        if (!discovery_socket->sendTo(message, endpoint)) {
+            return false;
+        }
+        metrics[NET_DISCOVERY_DATAGRAMS_SENT].add();
+        metrics[NET_DISCOVERY_BYTES_SENT].add(message.size());
+        return true;
+    }
+    
+    // User data to another participant's unicast port, sent from this one's.
+    // At most NET_MAX_DATAGRAM bytes, what the receiver reads; DDS fragments
+    // larger frames.
+    bool sendDatagram(const char* data, size_t length, const NetworkEndpoint& endpoint) {
+        if (!unicast_socket || !unicast_socket->isBound() || length > NET_MAX_DATAGRAM) {
+            return false;
+        }
+        return unicast_socket->sendBytes(data, length, endpoint);
     }
     
+    // Discovery traffic sent so far (announcements, endpoint changes, byes)
+    uint64_t getDiscoveryDatagramsSent() const { return metrics[NET_DISCOVERY_DATAGRAMS_SENT].get(); }
+    uint64_t getDiscoveryBytesSent() const { return metrics[NET_DISCOVERY_BYTES_SENT].get(); }
+    uint64_t getMetric(NetworkMetricWASM metric) const { return metrics[metric].get(); }
+    
     TCPSocketWASM* createTCPConnection(const std::string& address, int port) {
         std::string key = NetworkEndpoint(address, port).toString();
         
@@ -410,9 +776,12 @@ public:
         TCPSocketWASM* socket = new TCPSocketWASM();
         if (socket->connect(address, port)) {
             tcp_connections[key] = socket;
+            if (metrics_registry) socket->attachMetrics(metrics_registry);
+            metrics[NET_TCP_CONNECTIONS].set(tcp_connections.size());
             return socket;
         }
         
+        metrics[NET_TCP_CONNECT_FAILURES].add();
         delete socket;
         return nullptr;
     }
@@ -425,33 +794,118 @@ public:
         return socket->send(data);
     }
     
+    // Moves socket reads to a dedicated thread; poll() then only delivers what
+    // it queued. frame_count buffers of IO_HANDOFF_WASM_DEFAULT_FRAME_SIZE bytes.
+    bool startIOThread(size_t frame_count = IO_HANDOFF_WASM_DEFAULT_FRAMES) {
+        if (!initialized || handoff) return handoff != nullptr;
+        handoff = new IOHandoffWASM(frame_count, IO_HANDOFF_WASM_DEFAULT_FRAME_SIZE);
+        handoff->setWakeCallback(receive_wake, receive_wake_context);
+        int unicast_fd = unicast_socket && unicast_socket->isBound() ? unicast_socket->getFd() : -1;
+        if (!handoff->startThread(&NetworkManagerWASM::readDatagram, this, discovery_socket->getFd(), unicast_fd)) {
+            printf("WASM: I/O thread not available (built without pthreads?)\n");
+            delete handoff;
+            handoff = nullptr;
+            return false;
+        }
+        printf("WASM: Network I/O thread started (%zu receive buffers)\n", frame_count);
+        return true;
+    }
+    
+    void stopIOThread() {
+        if (!handoff) return;
+        handoff->stopThread();
+        delete handoff;  // Frames still queued are dropped
+        handoff = nullptr;
+    }
+    
+    // Called from the I/O thread once per batch of received datagrams; set it
+    // before startIOThread(), the thread reads it without a lock
+    void setReceiveWakeCallback(IOHandoffWakeWASM callback, void* context) {
+        receive_wake = callback;
+        receive_wake_context = context;
+    }
+    
+    // Set before startIOThread(), like the wake callback
+    void setTraceKeyReader(TraceKeyReaderWASM reader) {
+        trace_key_reader = reader;
+    }
+    
     void poll() {
-        if (discovery_socket) {
-            discovery_socket->poll();
+        pollUpTo(0);
+    }
+    
+    // Receive on the caller's thread: deliver up to max_datagrams queued by the
+    // I/O thread (0 = all), or read the socket directly when there is none
+    void pollUpTo(size_t max_datagrams) {
+        double start = emscripten_get_now();
+        if (handoff) {
+            handoff->drain(&NetworkManagerWASM::deliverDatagram, this, max_datagrams);
+        } else {
+            // Both sockets in turn until they are empty, so a caller that polls
+            // rarely still keeps up with the announcements
+            size_t delivered = 0;
+            bool more = true;
+            while (more && (max_datagrams == 0 || delivered < max_datagrams)) {
+                more = false;
+                if (discovery_socket && discovery_socket->poll()) {
+                    more = true;
+                    delivered++;
+                }
+                if (unicast_socket && unicast_socket->poll()) {
+                    more = true;
+                    delivered++;
+                }
+            }
         }
         
         for (auto& pair : tcp_connections) {
             pair.second->poll();
         }
+        
+        uint64_t elapsed_us = static_cast<uint64_t>((emscripten_get_now() - start) * 1000.0);
+        metrics[NET_POLLS].add();
+        metrics[NET_POLL_US_TOTAL].add(elapsed_us);
+        metrics[NET_POLL_US_MAX].raise(elapsed_us);
+    }
+    
+    // Datagrams the I/O thread queued that poll() has not delivered yet
+    bool hasPendingReceives() const {
+        return handoff && handoff->getDepth() > 0;
     }
     
+    const IOHandoffWASM* getHandoff() const { return handoff; }
+    
     void cleanup() {
+        stopIOThread();
         if (discovery_socket) {
             discovery_socket->close();
             delete discovery_socket;
             discovery_socket = nullptr;
         }
+        if (unicast_socket) {
+            unicast_socket->close();
+            delete unicast_socket;
+            unicast_socket = nullptr;
+        }
         
         for (auto& pair : tcp_connections) {
             pair.second->close();
             delete pair.second;
         }
         tcp_connections.clear();
+        metrics[NET_TCP_CONNECTIONS].set(0);
         
         initialized = false;
     }
     
     bool isInitialized() const { return initialized; }
+    int getDiscoveryPort() const { return discovery_port; }
+    // -1 until bindUnicast() succeeds
+    int getUnicastPort() const {
+        return unicast_socket && unicast_socket->isBound() ? unicast_socket->getLocalEndpoint().port : -1;
+    }
+    // Kernel buffer for datagrams not yet polled on the unicast port
+    size_t getUnicastReceiveBuffer() const { return unicast_receive_buffer; }
 };
 
 EMSCRIPTEN_BINDINGS(wasi_networking) {
@@ -463,6 +917,8 @@ EMSCRIPTEN_BINDINGS(wasi_networking) {
         .constructor<>()
         .function("create", &UDPSocketWASM::create)
         .function("bind", &UDPSocketWASM::bind)
+        .function("bindShared", &UDPSocketWASM::bindShared)
+        .function("joinMulticastGroup", &UDPSocketWASM::joinMulticastGroup)
         .function("sendTo", &UDPSocketWASM::sendTo)
         .function("poll", &UDPSocketWASM::poll)
         .function("close", &UDPSocketWASM::close)
@@ -480,10 +936,16 @@ EMSCRIPTEN_BINDINGS(wasi_networking) {
     class_<NetworkManagerWASM>("NetworkManagerWASM")
         .constructor<>()
         .function("init", &NetworkManagerWASM::init)
+        .function("joinMulticastGroup", &NetworkManagerWASM::joinMulticastGroup)
+        .function("bindUnicast", &NetworkManagerWASM::bindUnicast)
         .function("sendDiscoveryMessage", &NetworkManagerWASM::sendDiscoveryMessage)
         .function("sendTCPMessage", &NetworkManagerWASM::sendTCPMessage)
         .function("poll", &NetworkManagerWASM::poll)
+        .function("startIOThread", &NetworkManagerWASM::startIOThread)
+        .function("stopIOThread", &NetworkManagerWASM::stopIOThread)
         .function("cleanup", &NetworkManagerWASM::cleanup)
-        .function("isInitialized", &NetworkManagerWASM::isInitialized);
+        .function("isInitialized", &NetworkManagerWASM::isInitialized)
+        .function("getDiscoveryPort", &NetworkManagerWASM::getDiscoveryPort)
+        .function("getUnicastPort", &NetworkManagerWASM::getUnicastPort);
 }
 
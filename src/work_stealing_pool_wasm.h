@@ -0,0 +1,208 @@
+/*
+ * Work-Stealing Thread Pool for WASM
+ *
+ * Backs the multi-threaded rclc executor. Every worker owns a deque: it pops
+ * its own work LIFO and, once that is empty, steals FIFO from the others, so
+ * a few long callbacks do not leave the remaining threads idle. The thread
+ * that calls run() works as worker 0, which means a one-thread pool runs
+ * everything inline with no synchronization cost beyond a mutex per item.
+ *
+ * Natively the workers are std::threads. Under Emscripten they are Web
+ * Workers, which needs -pthread and -s PTHREAD_POOL_SIZE=<threads - 1> so that
+ * starting them does not wait for the main thread to yield; without pthreads
+ * the pool always has one thread.
+ */
+
+#ifndef WORK_STEALING_POOL_WASM_H
+#define WORK_STEALING_POOL_WASM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define WORK_STEALING_POOL_HAS_THREADS 0
+#else
+#define WORK_STEALING_POOL_HAS_THREADS 1
+#endif
+
+struct WorkItemWASM {
+    void (*run)(void* arg);
+    void* arg;
+};
+
+// Bounded ring; the owner uses the back, thieves the front
+class WorkDequeWASM {
+private:
+    std::mutex mutex;
+    std::vector<WorkItemWASM> ring;
+    size_t head;
+    size_t count;
+
+public:
+    explicit WorkDequeWASM(size_t capacity) : ring(capacity > 0 ? capacity : 1), head(0), count(0) {}
+
+    bool pushBack(const WorkItemWASM& item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == ring.size()) return false;
+        ring[(head + count) % ring.size()] = item;
+        count++;
+        return true;
+    }
+
+    bool popBack(WorkItemWASM& item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == 0) return false;
+        count--;
+        item = ring[(head + count) % ring.size()];
+        return true;
+    }
+
+    bool stealFront(WorkItemWASM& item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == 0) return false;
+        item = ring[head];
+        head = (head + 1) % ring.size();
+        count--;
+        return true;
+    }
+};
+
+class WorkStealingPoolWASM {
+private:
+    struct Worker {
+        WorkDequeWASM deque;
+        std::atomic<uint64_t> executed;
+        std::atomic<uint64_t> steals;
+
+        explicit Worker(size_t capacity) : deque(capacity), executed(0), steals(0) {}
+    };
+
+    std::vector<Worker*> workers;  // workers[0] is the thread calling run()
+    std::vector<std::thread> threads;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    std::atomic<size_t> pending;  // Items of the current run not yet finished
+    uint64_t generation;          // Bumped by every run(); guarded by wake_mutex
+    bool stopping;
+
+    bool findWork(size_t self, WorkItemWASM& item) {
+        if (workers[self]->deque.popBack(item)) {
+            return true;
+        }
+        for (size_t i = 1; i < workers.size(); i++) {
+            size_t victim = (self + i) % workers.size();
+            if (workers[victim]->deque.stealFront(item)) {
+                workers[self]->steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void execute(size_t self, const WorkItemWASM& item) {
+        item.run(item.arg);
+        workers[self]->executed.fetch_add(1, std::memory_order_relaxed);
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            finished.notify_all();
+        }
+    }
+
+    void workerLoop(size_t self) {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(wake_mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            WorkItemWASM item;
+            while (findWork(self, item)) {
+                execute(self, item);
+            }
+        }
+    }
+
+public:
+    // capacity: most items one run() may submit
+    WorkStealingPoolWASM(size_t thread_count, size_t capacity)
+        : pending(0), generation(0), stopping(false) {
+        if (thread_count == 0 || !WORK_STEALING_POOL_HAS_THREADS) {
+            thread_count = 1;
+        }
+        for (size_t i = 0; i < thread_count; i++) {
+            workers.push_back(new Worker(capacity));
+        }
+        for (size_t i = 1; i < thread_count; i++) {
+            threads.emplace_back(&WorkStealingPoolWASM::workerLoop, this, i);
+        }
+    }
+
+    ~WorkStealingPoolWASM() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (Worker* worker : workers) {
+            delete worker;
+        }
+    }
+
+    WorkStealingPoolWASM(const WorkStealingPoolWASM&) = delete;
+    WorkStealingPoolWASM& operator=(const WorkStealingPoolWASM&) = delete;
+
+    // Runs every item and returns once all have finished. Items are dealt
+    // round-robin; idle workers steal. Not reentrant: one caller at a time.
+    void run(const WorkItemWASM* items, size_t count) {
+        if (count == 0) return;
+        pending.store(count, std::memory_order_relaxed);
+        for (size_t i = 0; i < count; i++) {
+            workers[i % workers.size()]->deque.pushBack(items[i]);
+        }
+        if (workers.size() > 1) {
+            {
+                std::lock_guard<std::mutex> lock(wake_mutex);
+                generation++;
+            }
+            wake.notify_all();
+        }
+
+        WorkItemWASM item;
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (findWork(0, item)) {
+                execute(0, item);
+                continue;
+            }
+            // Everything left is running on other workers
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            finished.wait(lock, [&] { return pending.load(std::memory_order_acquire) == 0; });
+        }
+    }
+
+    size_t getThreadCount() const { return workers.size(); }
+
+    uint64_t getExecuted(size_t worker) const {
+        return worker < workers.size() ? workers[worker]->executed.load(std::memory_order_relaxed) : 0;
+    }
+
+    uint64_t getSteals() const {
+        uint64_t total = 0;
+        for (const Worker* worker : workers) {
+            total += worker->steals.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+#endif // WORK_STEALING_POOL_WASM_H